@@ -81,7 +81,7 @@ UA_EventLoopPOSIX_pollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout) {
         (long)((listenTimeout % UA_DATETIME_SEC) * 100)
     };
     int events = epoll_pwait2(el->epollfd, epoll_events, 64,
-                              precisionTimeout, NULL);
+                              &precisionTimeout, NULL);
 #endif
 
     /* Handle error conditions */
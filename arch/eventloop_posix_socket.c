@@ -0,0 +1,228 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "eventloop_posix.h"
+
+/* Watches sockets that are opened and closed outside of the EventLoop (e.g. by
+ * the PubSub transport plugins). The registered callback is called from the
+ * EventLoop when the socket has data to read. */
+
+struct UA_RegisteredSocket;
+typedef struct UA_RegisteredSocket UA_RegisteredSocket;
+
+struct UA_RegisteredSocket {
+    /* The memory is released in a delayed callback (first member, the
+     * EventLoop frees the pointer). The EventLoop might still hold a pointer
+     * to the socket for the current cycle. */
+    UA_DelayedCallback cleanupCallback;
+
+    UA_RegisteredFD rfd;
+
+    LIST_ENTRY(UA_RegisteredSocket) socketsEntry; /* List in the InterruptManager */
+
+    UA_Boolean active; /* Sockets are only active when the EventLoop is started */
+    UA_InterruptCallback socketCallback;
+};
+
+typedef struct {
+    UA_InterruptManager im;
+    LIST_HEAD(, UA_RegisteredSocket) sockets;
+} POSIXSocketManager;
+
+static void
+handlePOSIXSocketEvent(UA_EventSource *es, UA_RegisteredFD *rfd, short event) {
+    UA_RegisteredSocket *rs = (UA_RegisteredSocket*)
+        ((uintptr_t)rfd - offsetof(UA_RegisteredSocket, rfd));
+    if(!rs->active)
+        return; /* Deregistered during this EventLoop cycle */
+
+    if(event == UA_FDEVENT_ERR) {
+        UA_LOG_WARNING(es->eventLoop->logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "Socket %u\t| Error condition on the socket, "
+                       "stop watching", (unsigned)rfd->fd);
+        UA_EventLoopPOSIX_deregisterFD((UA_EventLoopPOSIX*)es->eventLoop, rfd);
+        rs->active = false;
+        return;
+    }
+
+    rs->socketCallback((UA_InterruptManager*)es, (uintptr_t)rfd->fd,
+                       rfd->context, 0, NULL);
+}
+
+static UA_StatusCode
+activateSocket(UA_RegisteredSocket *rs) {
+    if(rs->active)
+        return UA_STATUSCODE_GOOD;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX *)rs->rfd.es->eventLoop;
+    UA_StatusCode res = UA_EventLoopPOSIX_registerFD(el, &rs->rfd);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "Socket %u\t| Could not register the socket "
+                       "in the EventLoop", (unsigned)rs->rfd.fd);
+        return res;
+    }
+    rs->active = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deactivateSocket(UA_RegisteredSocket *rs) {
+    if(!rs->active)
+        return;
+    rs->active = false;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX *)rs->rfd.es->eventLoop;
+    UA_EventLoopPOSIX_deregisterFD(el, &rs->rfd);
+}
+
+static UA_StatusCode
+registerPOSIXSocket(UA_InterruptManager *im, uintptr_t interruptHandle,
+                    size_t paramsSize, const UA_KeyValuePair *params,
+                    UA_InterruptCallback callback, void *interruptContext) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX *)im->eventSource.eventLoop;
+    if(paramsSize > 0) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                     "Socket\t| Supplied parameters invalid for the "
+                     "POSIX socket InterruptManager");
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Was the socket already registered? */
+    POSIXSocketManager *psm = (POSIXSocketManager *)im;
+    UA_RegisteredSocket *rs;
+    LIST_FOREACH(rs, &psm->sockets, socketsEntry) {
+        if(rs->rfd.fd == (UA_FD)interruptHandle) {
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                           "Socket %u\t| Already registered",
+                           (unsigned)interruptHandle);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+    }
+
+    rs = (UA_RegisteredSocket *)UA_calloc(1, sizeof(UA_RegisteredSocket));
+    if(!rs)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    rs->socketCallback = callback;
+    rs->rfd.fd = (UA_FD)interruptHandle;
+    rs->rfd.es = &im->eventSource;
+    rs->rfd.context = interruptContext;
+    rs->rfd.listenEvents = UA_FDEVENT_IN;
+    rs->rfd.callback = handlePOSIXSocketEvent;
+
+    /* Activate if we are already running */
+    if(im->eventSource.state == UA_EVENTSOURCESTATE_STARTED) {
+        UA_StatusCode res = activateSocket(rs);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_free(rs);
+            return res;
+        }
+    }
+
+    LIST_INSERT_HEAD(&psm->sockets, rs, socketsEntry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deregisterPOSIXSocket(UA_InterruptManager *im, uintptr_t interruptHandle) {
+    POSIXSocketManager *psm = (POSIXSocketManager *)im;
+    UA_RegisteredSocket *rs;
+    LIST_FOREACH(rs, &psm->sockets, socketsEntry) {
+        if(rs->rfd.fd == (UA_FD)interruptHandle)
+            break;
+    }
+    if(!rs)
+        return;
+
+    deactivateSocket(rs);
+    LIST_REMOVE(rs, socketsEntry);
+
+    /* Free after the current EventLoop cycle */
+    UA_EventLoop *el = im->eventSource.eventLoop;
+    rs->cleanupCallback.callback = NULL;
+    el->addDelayedCallback(el, &rs->cleanupCallback);
+}
+
+static UA_StatusCode
+startPOSIXSocketManager(UA_EventSource *es) {
+    if(es->state != UA_EVENTSOURCESTATE_STOPPED) {
+        UA_LOG_ERROR(es->eventLoop->logger, UA_LOGCATEGORY_EVENTLOOP,
+                     "Socket\t| To start the InterruptManager, "
+                     "it has to be registered in an EventLoop and not started");
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_LOG_DEBUG(es->eventLoop->logger, UA_LOGCATEGORY_EVENTLOOP,
+                 "Socket\t| Starting the socket InterruptManager");
+
+    /* Activate the registered sockets. Failing sockets are logged and stay
+     * inactive. */
+    POSIXSocketManager *psm = (POSIXSocketManager *)es;
+    UA_RegisteredSocket *rs;
+    LIST_FOREACH(rs, &psm->sockets, socketsEntry) {
+        activateSocket(rs);
+    }
+
+    es->state = UA_EVENTSOURCESTATE_STARTED;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+stopPOSIXSocketManager(UA_EventSource *es) {
+    if(es->state != UA_EVENTSOURCESTATE_STARTED)
+        return;
+
+    UA_LOG_DEBUG(es->eventLoop->logger, UA_LOGCATEGORY_EVENTLOOP,
+                 "Socket\t| Stopping the socket InterruptManager");
+
+    /* Stop watching. The sockets themselves are not closed. */
+    POSIXSocketManager *psm = (POSIXSocketManager *)es;
+    UA_RegisteredSocket *rs;
+    LIST_FOREACH(rs, &psm->sockets, socketsEntry) {
+        deactivateSocket(rs);
+    }
+
+    /* Immediately set to stopped */
+    es->state = UA_EVENTSOURCESTATE_STOPPED;
+}
+
+static UA_StatusCode
+freePOSIXSocketManager(UA_EventSource *es) {
+    if(es->state >= UA_EVENTSOURCESTATE_STARTING) {
+        UA_LOG_ERROR(es->eventLoop->logger, UA_LOGCATEGORY_EVENTLOOP,
+                     "Socket\t| The EventSource must be stopped "
+                     "before it can be deleted");
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    POSIXSocketManager *psm = (POSIXSocketManager *)es;
+    UA_RegisteredSocket *rs, *rs_tmp;
+    LIST_FOREACH_SAFE(rs, &psm->sockets, socketsEntry, rs_tmp) {
+        LIST_REMOVE(rs, socketsEntry);
+        UA_free(rs);
+    }
+
+    UA_String_clear(&es->name);
+    UA_free(es);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_InterruptManager *
+UA_InterruptManager_new_POSIX_Socket(const UA_String eventSourceName) {
+    POSIXSocketManager *psm =
+        (POSIXSocketManager *)UA_calloc(1, sizeof(POSIXSocketManager));
+    if(!psm)
+        return NULL;
+
+    LIST_INIT(&psm->sockets);
+
+    UA_InterruptManager *im = &psm->im;
+    im->eventSource.eventSourceType = UA_EVENTSOURCETYPE_INTERRUPTMANAGER;
+    UA_String_copy(&eventSourceName, &im->eventSource.name);
+    im->eventSource.start = startPOSIXSocketManager;
+    im->eventSource.stop = stopPOSIXSocketManager;
+    im->eventSource.free = freePOSIXSocketManager;
+    im->registerInterrupt = registerPOSIXSocket;
+    im->deregisterInterrupt = deregisterPOSIXSocket;
+    return im;
+}
@@ -224,6 +224,27 @@ typedef struct {
     size_t sessionAbortCount;            /* only used by servers */
 } UA_SessionStatistics;
 
+/* Traffic of a SecureChannel. A message can be split into several chunks. */
+typedef struct {
+    size_t bytesSent;
+    size_t bytesReceived;
+    size_t chunksSent;
+    size_t chunksReceived;
+    size_t messagesSent;
+    size_t messagesReceived;
+} UA_SecureChannelTraffic;
+
+/* Latency histogram with logarithmic buckets. The first bucket counts samples
+ * below one microsecond. Bucket i > 0 counts samples d with 2^(i-1) <= d < 2^i
+ * microseconds. The last bucket also takes all longer samples. */
+#define UA_LATENCYHISTOGRAM_BUCKETS 24
+
+typedef struct {
+    size_t count;
+    size_t sum; /* in microseconds */
+    size_t buckets[UA_LATENCYHISTOGRAM_BUCKETS];
+} UA_LatencyHistogram;
+
 /**
  * .. include:: util.rst */
 
@@ -424,6 +424,21 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
 UA_EXPORT UA_InterruptManager *
 UA_InterruptManager_new_POSIX(const UA_String eventSourceName);
 
+/**
+ * Socket Interrupt Manager
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ * Create an instance of the interrupt manager that watches sockets which are
+ * opened and closed outside of the EventLoop. The interruptHandle is the
+ * socket. The callback is triggered from the EventLoop when the socket has data
+ * to read. The callback has to read from the socket. Otherwise it is triggered
+ * again in the next EventLoop cycle.
+ *
+ * The default server configuration registers an instance under the name
+ * "pubsub-sockets". The PubSub subscriber uses it to process NetworkMessages
+ * when they arrive instead of polling the sockets in a cyclic callback. */
+UA_EXPORT UA_InterruptManager *
+UA_InterruptManager_new_POSIX_Socket(const UA_String eventSourceName);
+
 #endif /* defined(UA_ARCHITECTURE_POSIX) || defined(UA_ARCHITECTURE_WIN32) */
 
 _UA_END_DECLS
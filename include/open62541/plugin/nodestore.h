@@ -637,6 +637,19 @@ typedef struct {
     } backend;
 } UA_ValueBackend;
 
+/* With immutable nodes, the value of a VariableNode with a "data" value source
+ * moves into a cell with the first write of the Value attribute. The cell is
+ * shared by the copies that replace the node in the nodestore. Later writes of
+ * the Value attribute swap the DataValue in the cell and leave the node
+ * unchanged. Use the cell only via the server API. */
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+struct UA_ValueCell;
+typedef struct UA_ValueCell UA_ValueCell;
+# define UA_NODE_VALUECELL UA_ValueCell *cell;
+#else
+# define UA_NODE_VALUECELL
+#endif
+
 #define UA_NODE_VARIABLEATTRIBUTES                                      \
     /* Constraints on possible values */                                \
     UA_NodeId dataType;                                                 \
@@ -652,6 +665,7 @@ typedef struct {
         struct {                                                        \
             UA_DataValue value;                                         \
             UA_ValueCallback callback;                                  \
+            UA_NODE_VALUECELL                                           \
         } data;                                                         \
         UA_DataSource dataSource;                                       \
     } value;
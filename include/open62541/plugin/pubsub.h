@@ -84,6 +84,18 @@ struct UA_PubSubChannel {
 
     /* Giving the connection protocoll time to process inbound and outbound traffic. */
     UA_StatusCode (*yield)(UA_PubSubChannel *channel, UA_UInt16 timeout);
+
+    /* Optional. Sending out the content of the buf parameter at the launch
+     * time (UtcTime). Used by the deterministic publisher. If not set, the
+     * message is sent right away. */
+    UA_StatusCode (*sendAt)(UA_PubSubChannel *channel, UA_ExtensionObject *transportSettings,
+                            const UA_ByteString *buf, UA_DateTime launchTime);
+
+    /* Optional. Sending out several messages with as few system calls as
+     * possible (e.g. sendmmsg). Only for channels where the messages do not
+     * depend on the WriterGroup transportSettings. */
+    UA_StatusCode (*sendBatch)(UA_PubSubChannel *channel, size_t bufsSize,
+                               const UA_ByteString *bufs);
 };
 
 /**
@@ -197,6 +197,14 @@ struct UA_ServerConfig {
     UA_UInt16 maxSecureChannels;
     UA_UInt32 maxSecurityTokenLifetime; /* in ms */
 
+#if UA_MULTITHREADING >= 100
+    /* Worker threads to sign/encrypt and decrypt/verify the chunks of large
+     * messages in parallel (0 => disabled). The symmetric crypto of the
+     * SecurityPolicies must allow concurrent use of a channel context. Takes
+     * effect for SecureChannels opened after UA_Server_run_startup. */
+    UA_UInt16 chunkCryptoThreads;
+#endif
+
     /* Limits for Sessions */
     UA_UInt16 maxSessions;
     UA_Double maxSessionTimeout; /* in ms */
@@ -214,6 +222,14 @@ struct UA_ServerConfig {
     /* Limits for Requests */
     UA_UInt32 maxReferencesPerNode;
 
+    /* Responses of the Read, Browse and HistoryRead service with at least this
+     * many results are streamed. All results are produced first. Then they are
+     * encoded one by one, the full chunks are sent right away and every result
+     * is freed after its encoding. So the encoded response is never held in
+     * memory as a whole. But all results are held in memory before the
+     * encoding begins (0 => disabled). */
+    UA_UInt32 streamResponseThreshold;
+
     /* Discovery */
 #ifdef UA_ENABLE_DISCOVERY
     /* Timeout in seconds when to automatically remove a registered server from
@@ -1462,6 +1478,30 @@ UA_StatusCode UA_EXPORT UA_THREADSAFE
 UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId, const UA_NodeId originId,
                        UA_ByteString *outEventId, const UA_Boolean deleteEventNode);
 
+/* Evaluates the where-clause of an EventFilter for a stored event that is no
+ * longer represented as a node. Used by the history databases.
+ *
+ * The SimpleAttributeOperands of the where-clause resolve to the field that
+ * was taken with the same BrowsePath, AttributeId and IndexRange in the
+ * selectClauses. Fields that were not stored do not match. The OfType
+ * operator uses the eventType (no match if NULL).
+ *
+ * @param server The server object
+ * @param whereClause The where-clause to evaluate
+ * @param eventType The EventType of the stored event. Can be NULL.
+ * @param fieldsSize The number of stored fields and select clauses
+ * @param selectClauses The select clauses with which the fields were taken
+ * @param fields The stored fields. Fields that are not used by the
+ *        where-clause can be left empty.
+ * @return UA_STATUSCODE_GOOD if the event matches, UA_STATUSCODE_BADNOMATCH or
+ *         another error code if not */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_evaluateWhereClauseFields(UA_Server *server,
+                                    const UA_ContentFilter *whereClause,
+                                    const UA_NodeId *eventType, size_t fieldsSize,
+                                    const UA_SimpleAttributeOperand *selectClauses,
+                                    const UA_Variant *fields);
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
@@ -1709,6 +1749,69 @@ typedef struct {
 UA_ServerStatistics UA_EXPORT
 UA_Server_getStatistics(UA_Server *server);
 
+/**
+ * The server additionally keeps latency histograms for the processing stages
+ * of the services. The services are grouped as follows. */
+
+typedef enum {
+    UA_SERVICEGROUP_DISCOVERY = 0,  /* GetEndpoints, FindServers, RegisterServer */
+    UA_SERVICEGROUP_SESSION,        /* Create-, Activate- and CloseSession */
+    UA_SERVICEGROUP_READ,
+    UA_SERVICEGROUP_WRITE,
+    UA_SERVICEGROUP_BROWSE,         /* Browse and BrowseNext */
+    UA_SERVICEGROUP_TRANSLATEBROWSEPATHS,
+    UA_SERVICEGROUP_REGISTERNODES,  /* Register- and UnregisterNodes */
+    UA_SERVICEGROUP_HISTORYREAD,
+    UA_SERVICEGROUP_HISTORYUPDATE,
+    UA_SERVICEGROUP_CALL,
+    UA_SERVICEGROUP_SUBSCRIPTION,   /* Subscription services except Publish */
+    UA_SERVICEGROUP_MONITOREDITEM,
+    UA_SERVICEGROUP_PUBLISH,
+    UA_SERVICEGROUP_NODEMANAGEMENT
+} UA_ServiceGroup;
+
+#define UA_SERVICEGROUP_COUNT 14
+
+/* The processing stages of a request. The queue wait is the time until the
+ * service can be executed, i.e. waiting for the service lock. For streamed
+ * responses (see streamResponseThreshold) the encoding is interleaved with the
+ * service execution and counted there. Publish responses are encoded and sent
+ * from the subscription callback. */
+typedef struct {
+    UA_LatencyHistogram decode;
+    UA_LatencyHistogram queueWait;
+    UA_LatencyHistogram execution;
+    UA_LatencyHistogram encode;
+    UA_LatencyHistogram send;
+} UA_ServiceLatencyStatistics;
+
+typedef struct {
+    UA_ServiceLatencyStatistics services[UA_SERVICEGROUP_COUNT];
+    UA_LatencyHistogram chunkCrypto; /* Sign/encrypt or decrypt/verify a chunk */
+    UA_LatencyHistogram publish;     /* Publish cycle of all subscriptions */
+    UA_SecureChannelTraffic traffic; /* Summed up for all SecureChannels */
+} UA_ServiceStatistics;
+
+/* Copy the current service statistics. The counters are updated concurrently
+ * and not reset. */
+void UA_EXPORT UA_THREADSAFE
+UA_Server_getServiceStatistics(UA_Server *server, UA_ServiceStatistics *stats);
+
+/* Traffic of the SecureChannel to which the session is bound */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_getSessionTraffic(UA_Server *server, const UA_NodeId *sessionId,
+                            UA_SecureChannelTraffic *traffic);
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+/* Latency of the publish cycles of a subscription, from the start of the
+ * publishing interval until the NotificationMessage has been sent */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_getSubscriptionPublishLatency(UA_Server *server,
+                                        const UA_NodeId *sessionId,
+                                        UA_UInt32 subscriptionId,
+                                        UA_LatencyHistogram *latency);
+#endif
+
 _UA_END_DECLS
 
 #ifdef UA_ENABLE_PUBSUB
@@ -211,6 +211,14 @@ struct UA_PubSubConfiguration {
 #ifdef UA_ENABLE_PUBSUB_MONITORING
     UA_PubSubMonitoringInterface monitoringInterface;
 #endif
+
+#if UA_MULTITHREADING >= 100
+    /* Worker threads to encode the NetworkMessages of a WriterGroup in
+     * parallel (0 => disabled). Used for UADP WriterGroups without RT level
+     * and without message security. The values are still sampled in the
+     * publish callback. Takes effect at UA_Server_run_startup. */
+    UA_UInt16 encodingThreads;
+#endif
 };
 
 
@@ -327,6 +335,50 @@ UA_Server_getPublishedDataSetMetaData(UA_Server *server, const UA_NodeId pds,
 UA_StatusCode UA_EXPORT
 UA_Server_removePublishedDataSet(UA_Server *server, const UA_NodeId pds);
 
+/**
+ * Exchange Buffers
+ * ----------------
+ * The realtime publisher and subscriber access the values of external data
+ * sources from their own thread. An exchange buffer transports a fixed-size
+ * value between exactly one producer thread and one consumer thread without
+ * locks (triple buffering). Both sides are wait-free. The consumer always gets
+ * the latest complete value and never sees a partial write.
+ *
+ * For a published field, the application is the producer and the publisher is
+ * the consumer. For a subscribed target variable, the subscriber is the
+ * producer and the application is the consumer. Only types without pointers
+ * (numeric types, Boolean, DateTime, Guid, ...) are supported. */
+
+typedef struct {
+    const UA_DataType *type;
+    UA_Byte *slots;    /* Three slots with the memSize of the type */
+    UA_UInt32 middle;  /* Exchanged between both sides. Slot index, plus the
+                        * flag 0x80 if the slot was not yet read. */
+    UA_UInt32 back;    /* Slot written by the producer */
+    UA_UInt32 front;   /* Slot read by the consumer */
+
+    /* The latest value taken by the consumer. The data pointer is constant.
+     * The content only changes in UA_PubSubExchangeBuffer_read. */
+    UA_DataValue value;
+} UA_PubSubExchangeBuffer;
+
+/* The initial value is zero */
+UA_StatusCode UA_EXPORT
+UA_PubSubExchangeBuffer_init(UA_PubSubExchangeBuffer *eb, const UA_DataType *type);
+
+void UA_EXPORT
+UA_PubSubExchangeBuffer_clear(UA_PubSubExchangeBuffer *eb);
+
+/* Producer side. Copies the value (of the buffer type) and hands it over to
+ * the consumer. */
+void UA_EXPORT
+UA_PubSubExchangeBuffer_write(UA_PubSubExchangeBuffer *eb, const void *value);
+
+/* Consumer side. Takes the latest written value into eb->value. Returns true
+ * if a new value was written since the last read. */
+UA_Boolean UA_EXPORT
+UA_PubSubExchangeBuffer_read(UA_PubSubExchangeBuffer *eb);
+
 /**
  * DataSetFields
  * -------------
@@ -350,6 +402,9 @@ typedef struct{
         UA_Boolean rtInformationModelNode;
         //TODO -> decide if suppress C++ warnings and use 'UA_DataValue * * const staticValueSource;'
         UA_DataValue ** staticValueSource;
+        /* If set (together with rtFieldSourceEnabled), the value is read from
+         * the exchange buffer instead of the staticValueSource */
+        UA_PubSubExchangeBuffer *exchangeBuffer;
     } rtValueSource;
 
 
@@ -451,10 +506,14 @@ typedef enum {
  * buffers and use only memcopy operations to generate requested PubSub packages.
  * ---> Requirements: DataSetFields with variable size cannot be used within this mode.
  * ---> Restrictions: The configuration must be frozen and changes are not allowed while the WriterGroup is 'Operational'.
- * UA_PUBSUB_RT_DETERMINISTIC (Preview - not implemented)
- * ---> Description: -
- * ---> Requirements: -
- * ---> Restrictions: -
+ * UA_PUBSUB_RT_DETERMINISTIC
+ * ---> Description: Extends UA_PUBSUB_RT_FIXED_SIZE. The cycles start at integer multiples of the publishing interval
+ * on the system clock, independent of the execution time of previous cycles (no drift). If the UadpWriterGroupMessageDataType
+ * contains a publishingOffset, the NetworkMessage is handed to the transport with the launch time (cycle start + publishingOffset).
+ * The Ethernet transport sends with SO_TXTIME if the connection has the "enablesotxtime" property (ETF qdisc on Linux).
+ * The jitter of the cycle start and the deadline misses are counted, see UA_Server_WriterGroup_getCycleStatistics.
+ * ---> Requirements: Same as UA_PUBSUB_RT_FIXED_SIZE. The publishingOffset must exceed the worst-case jitter.
+ * ---> Restrictions: Same as UA_PUBSUB_RT_FIXED_SIZE.
  *
  * WARNING! For hard real time requirements the underlying system must be rt-capable.
  *
@@ -518,6 +577,22 @@ UA_StatusCode UA_EXPORT
 UA_Server_WriterGroup_getState(UA_Server *server, UA_NodeId writerGroupIdentifier,
                                UA_PubSubState *state);
 
+/* Cycle statistics of a WriterGroup with UA_PUBSUB_RT_DETERMINISTIC. A
+ * deadline is missed if a cycle is skipped or if the NetworkMessage is handed
+ * to the transport after its launch time (without publishingOffset: after the
+ * end of the cycle). The statistics are reset when the WriterGroup starts to
+ * publish. */
+typedef struct {
+    size_t cycles;              /* Executed publish cycles */
+    size_t deadlineMisses;
+    UA_LatencyHistogram jitter; /* Delay after the nominal cycle start */
+} UA_WriterGroupCycleStatistics;
+
+UA_StatusCode UA_EXPORT
+UA_Server_WriterGroup_getCycleStatistics(UA_Server *server,
+                                         UA_NodeId writerGroupIdentifier,
+                                         UA_WriterGroupCycleStatistics *stats);
+
 UA_StatusCode UA_EXPORT
 UA_Server_removeWriterGroup(UA_Server *server, const UA_NodeId writerGroup);
 
@@ -625,6 +700,9 @@ typedef struct {
      * If the afterWrite method pointer is set, it will be called after a memcpy update
      * to the value. */
     UA_DataValue **externalDataValue;
+    /* If set, the realtime subscriber writes the received value into the
+     * exchange buffer instead. The write callbacks are not called. */
+    UA_PubSubExchangeBuffer *exchangeBuffer;
     void *targetVariableContext; /* user-defined pointer */
     void (*beforeWrite)(UA_Server *server,
                         const UA_NodeId *readerIdentifier,
@@ -719,6 +797,16 @@ UA_StatusCode UA_EXPORT
 UA_Server_DataSetReader_getState(UA_Server *server, UA_NodeId dataSetReaderIdentifier,
                                  UA_PubSubState *state);
 
+/* Get the end-to-end latency from the publisher to the write of the target
+ * variables. Measured from the timestamp in the DataSetMessage header. So
+ * only messages with the timestamp in the DataSetMessageContentMask are
+ * counted and the clocks of publisher and subscriber have to be synchronized.
+ * Not available for the fixed-size realtime subscriber. */
+UA_StatusCode UA_EXPORT
+UA_Server_DataSetReader_getReceiveLatency(UA_Server *server,
+                                          UA_NodeId dataSetReaderIdentifier,
+                                          UA_LatencyHistogram *latency);
+
 /**
  * ReaderGroup
  * -----------
@@ -735,7 +823,13 @@ UA_Server_DataSetReader_getState(UA_Server *server, UA_NodeId dataSetReaderIdent
  * - PUBSUB_CONFIG_FASTPATH_FIXED_OFFSETS: Extends PubSub RT functionality and
  *   implements fast path message decoding in the Subscriber. Uses a buffered
  *   network message and only decodes the necessary offsets stored in an offset
- *   buffer. */
+ *   buffer.
+ *
+ * NetworkMessages are processed when they arrive if the EventLoop of the
+ * server has a socket InterruptManager registered under the name
+ * "pubsub-sockets" (the default configuration does that). This requires a
+ * transport with a socket (UDP, Ethernet) and no custom callback. Otherwise
+ * the socket is polled every subscribingInterval. */
 
 /* ReaderGroup configuration */
 typedef struct {
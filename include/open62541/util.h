@@ -182,6 +182,15 @@ UA_RelativePath_parse(UA_RelativePath *rp, const UA_String str);
 #define UA_PRINTF_STRING_FORMAT "\"%.*s\""
 #define UA_PRINTF_STRING_DATA(STRING) (int)(STRING).length, (STRING).data
 
+/**
+ * Latency Histograms
+ * ------------------
+ * Returns the upper bound in microseconds of the histogram bucket that
+ * contains the q-quantile (0 < q <= 1) of the samples. For example q = 0.99
+ * for the p99 latency. Returns zero if the histogram is empty. */
+UA_EXPORT UA_UInt64
+UA_LatencyHistogram_quantile(const UA_LatencyHistogram *h, UA_Double q);
+
 /**
  * Helper functions for converting data types
  * ------------------------------------------ */
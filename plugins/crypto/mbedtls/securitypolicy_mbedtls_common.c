@@ -31,6 +31,104 @@ mbedtls_hmac(mbedtls_md_context_t *context, const UA_ByteString *key,
     mbedtls_md_hmac_finish(context, out);
 }
 
+void
+UA_mbedTLS_SymCache_clear(UA_mbedTLS_SymCache *cache) {
+    mbedtls_aes_context *aes = (mbedtls_aes_context*)
+        UA_atomic_xchg(&cache->aesContext, NULL);
+    if(aes) {
+        mbedtls_aes_free(aes);
+        UA_free(aes);
+    }
+    mbedtls_md_context_t *md = (mbedtls_md_context_t*)
+        UA_atomic_xchg(&cache->mdContext, NULL);
+    if(md) {
+        mbedtls_md_free(md);
+        UA_free(md);
+    }
+}
+
+UA_StatusCode
+mbedtls_hmac_cached(UA_mbedTLS_SymCache *cache, mbedtls_md_type_t mdType,
+                    const UA_ByteString *key, const UA_ByteString *in,
+                    unsigned char *out) {
+    /* Take the keyed context from the cache or set up a new one */
+    int mbedErr;
+    mbedtls_md_context_t *md = (mbedtls_md_context_t*)
+        UA_atomic_xchg(&cache->mdContext, NULL);
+    if(md) {
+        mbedErr = mbedtls_md_hmac_reset(md);
+    } else {
+        md = (mbedtls_md_context_t*)UA_malloc(sizeof(mbedtls_md_context_t));
+        if(!md)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        mbedtls_md_init(md);
+        mbedErr = mbedtls_md_setup(md, mbedtls_md_info_from_type(mdType), 1);
+        if(!mbedErr)
+            mbedErr = mbedtls_md_hmac_starts(md, key->data, key->length);
+    }
+
+    if(!mbedErr)
+        mbedErr = mbedtls_md_hmac_update(md, in->data, in->length);
+    if(!mbedErr)
+        mbedErr = mbedtls_md_hmac_finish(md, out);
+    if(mbedErr) {
+        mbedtls_md_free(md);
+        UA_free(md);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Put back. The cache was refilled by a concurrent operation? */
+    if(UA_atomic_cmpxchg(&cache->mdContext, NULL, md) != NULL) {
+        mbedtls_md_free(md);
+        UA_free(md);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+mbedtls_aes_cbc_cached(UA_mbedTLS_SymCache *cache, int mode,
+                       const UA_ByteString *key, const UA_ByteString *iv,
+                       UA_ByteString *data) {
+    /* The IV is updated during the operation */
+    unsigned char ivCopy[16];
+    if(iv->length != sizeof(ivCopy))
+        return UA_STATUSCODE_BADINTERNALERROR;
+    memcpy(ivCopy, iv->data, sizeof(ivCopy));
+
+    /* Take the context with the key schedule from the cache or set up a new
+     * one. Keylength in bits. */
+    int mbedErr = 0;
+    mbedtls_aes_context *aes = (mbedtls_aes_context*)
+        UA_atomic_xchg(&cache->aesContext, NULL);
+    if(!aes) {
+        aes = (mbedtls_aes_context*)UA_malloc(sizeof(mbedtls_aes_context));
+        if(!aes)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        mbedtls_aes_init(aes);
+        unsigned int keylength = (unsigned int)(key->length * 8);
+        if(mode == MBEDTLS_AES_ENCRYPT)
+            mbedErr = mbedtls_aes_setkey_enc(aes, key->data, keylength);
+        else
+            mbedErr = mbedtls_aes_setkey_dec(aes, key->data, keylength);
+    }
+
+    /* mbedTLS' AES allows in-place encryption and decryption */
+    if(!mbedErr)
+        mbedErr = mbedtls_aes_crypt_cbc(aes, mode, data->length,
+                                        ivCopy, data->data, data->data);
+    if(mbedErr) {
+        mbedtls_aes_free(aes);
+        UA_free(aes);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    if(UA_atomic_cmpxchg(&cache->aesContext, NULL, aes) != NULL) {
+        mbedtls_aes_free(aes);
+        UA_free(aes);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 mbedtls_generateKey(mbedtls_md_context_t *context,
                     const UA_ByteString *secret, const UA_ByteString *seed,
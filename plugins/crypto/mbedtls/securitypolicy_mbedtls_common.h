@@ -33,6 +33,31 @@ void
 mbedtls_hmac(mbedtls_md_context_t *context, const UA_ByteString *key,
              const UA_ByteString *in, unsigned char *out);
 
+/* Symmetric mbedTLS contexts for one direction of a channel. The contexts are
+ * keyed on first use and then reused for all messages. During an operation the
+ * context is taken out of the cache atomically. So the symmetric operations
+ * stay reentrant and concurrent calls work on a temporary context. The cache
+ * has to be cleared when the keys change. */
+typedef struct {
+    void *aesContext; /* mbedtls_aes_context with the key schedule */
+    void *mdContext;  /* mbedtls_md_context_t keyed for the HMAC */
+} UA_mbedTLS_SymCache;
+
+void
+UA_mbedTLS_SymCache_clear(UA_mbedTLS_SymCache *cache);
+
+UA_StatusCode
+mbedtls_hmac_cached(UA_mbedTLS_SymCache *cache, mbedtls_md_type_t mdType,
+                    const UA_ByteString *key, const UA_ByteString *in,
+                    unsigned char *out);
+
+/* AES-CBC in-place with mode MBEDTLS_AES_ENCRYPT or MBEDTLS_AES_DECRYPT. The
+ * data length must be a multiple of the block size. */
+UA_StatusCode
+mbedtls_aes_cbc_cached(UA_mbedTLS_SymCache *cache, int mode,
+                       const UA_ByteString *key, const UA_ByteString *iv,
+                       UA_ByteString *data);
+
 UA_StatusCode
 mbedtls_generateKey(mbedtls_md_context_t *context,
                     const UA_ByteString *secret, const UA_ByteString *seed,
@@ -63,6 +63,9 @@ typedef struct {
     UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
 
+    UA_mbedTLS_SymCache localSymCache;  /* Encrypt and sign */
+    UA_mbedTLS_SymCache remoteSymCache; /* Decrypt and verify */
+
     mbedtls_x509_crt remoteCertificate;
 } Basic256Sha256_ChannelContext;
 
@@ -241,9 +244,12 @@ sym_verify_sp_basic256sha256(Basic256Sha256_ChannelContext *cc,
     if(signature->length != UA_SHA256_LENGTH)
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
 
-    Basic256Sha256_PolicyContext *pc = cc->policyContext;
     unsigned char mac[UA_SHA256_LENGTH];
-    mbedtls_hmac(&pc->sha256MdContext, &cc->remoteSymSigningKey, message, mac);
+    UA_StatusCode res =
+        mbedtls_hmac_cached(&cc->remoteSymCache, MBEDTLS_MD_SHA256,
+                            &cc->remoteSymSigningKey, message, mac);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
 
     /* Compare with Signature */
     if(!UA_constantTimeEqual(signature->data, mac, UA_SHA256_LENGTH))
@@ -252,15 +258,14 @@ sym_verify_sp_basic256sha256(Basic256Sha256_ChannelContext *cc,
 }
 
 static UA_StatusCode
-sym_sign_sp_basic256sha256(const Basic256Sha256_ChannelContext *cc,
+sym_sign_sp_basic256sha256(Basic256Sha256_ChannelContext *cc,
                            const UA_ByteString *message,
                            UA_ByteString *signature) {
     if(signature->length != UA_SHA256_LENGTH)
         return UA_STATUSCODE_BADINTERNALERROR;
 
-    mbedtls_hmac(&cc->policyContext->sha256MdContext, &cc->localSymSigningKey,
-                 message, signature->data);
-    return UA_STATUSCODE_GOOD;
+    return mbedtls_hmac_cached(&cc->localSymCache, MBEDTLS_MD_SHA256,
+                               &cc->localSymSigningKey, message, signature->data);
 }
 
 static size_t
@@ -289,7 +294,7 @@ sym_getPlainTextBlockSize_sp_basic256sha256(const void *channelContext) {
 }
 
 static UA_StatusCode
-sym_encrypt_sp_basic256sha256(const Basic256Sha256_ChannelContext *cc,
+sym_encrypt_sp_basic256sha256(Basic256Sha256_ChannelContext *cc,
                               UA_ByteString *data) {
     if(cc == NULL || data == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
@@ -302,28 +307,12 @@ sym_encrypt_sp_basic256sha256(const Basic256Sha256_ChannelContext *cc,
     if(data->length % plainTextBlockSize != 0)
         return UA_STATUSCODE_BADINTERNALERROR;
 
-    /* Keylength in bits */
-    unsigned int keylength = (unsigned int)(cc->localSymEncryptingKey.length * 8);
-    mbedtls_aes_context aesContext;
-    int mbedErr = mbedtls_aes_setkey_enc(&aesContext, cc->localSymEncryptingKey.data, keylength);
-    if(mbedErr)
-        return UA_STATUSCODE_BADINTERNALERROR;
-
-    UA_ByteString ivCopy;
-    UA_StatusCode retval = UA_ByteString_copy(&cc->localSymIv, &ivCopy);
-    if(retval != UA_STATUSCODE_GOOD)
-        return retval;
-
-    mbedErr = mbedtls_aes_crypt_cbc(&aesContext, MBEDTLS_AES_ENCRYPT, data->length,
-                                    ivCopy.data, data->data, data->data);
-    if(mbedErr)
-        retval = UA_STATUSCODE_BADINTERNALERROR;
-    UA_ByteString_clear(&ivCopy);
-    return retval;
+    return mbedtls_aes_cbc_cached(&cc->localSymCache, MBEDTLS_AES_ENCRYPT,
+                                  &cc->localSymEncryptingKey, &cc->localSymIv, data);
 }
 
 static UA_StatusCode
-sym_decrypt_sp_basic256sha256(const Basic256Sha256_ChannelContext *cc,
+sym_decrypt_sp_basic256sha256(Basic256Sha256_ChannelContext *cc,
                               UA_ByteString *data) {
     if(cc == NULL || data == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
@@ -335,23 +324,8 @@ sym_decrypt_sp_basic256sha256(const Basic256Sha256_ChannelContext *cc,
     if(data->length % encryptionBlockSize != 0)
         return UA_STATUSCODE_BADINTERNALERROR;
 
-    unsigned int keylength = (unsigned int)(cc->remoteSymEncryptingKey.length * 8);
-    mbedtls_aes_context aesContext;
-    int mbedErr = mbedtls_aes_setkey_dec(&aesContext, cc->remoteSymEncryptingKey.data, keylength);
-    if(mbedErr)
-        return UA_STATUSCODE_BADINTERNALERROR;
-
-    UA_ByteString ivCopy;
-    UA_StatusCode retval = UA_ByteString_copy(&cc->remoteSymIv, &ivCopy);
-    if(retval != UA_STATUSCODE_GOOD)
-        return retval;
-
-    mbedErr = mbedtls_aes_crypt_cbc(&aesContext, MBEDTLS_AES_DECRYPT, data->length,
-                                    ivCopy.data, data->data, data->data);
-    if(mbedErr)
-        retval = UA_STATUSCODE_BADINTERNALERROR;
-    UA_ByteString_clear(&ivCopy);
-    return retval;
+    return mbedtls_aes_cbc_cached(&cc->remoteSymCache, MBEDTLS_AES_DECRYPT,
+                                  &cc->remoteSymEncryptingKey, &cc->remoteSymIv, data);
 }
 
 static UA_StatusCode
@@ -409,6 +383,8 @@ channelContext_deleteContext_sp_basic256sha256(Basic256Sha256_ChannelContext *cc
     UA_ByteString_clear(&cc->remoteSymSigningKey);
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     UA_ByteString_clear(&cc->remoteSymIv);
+    UA_mbedTLS_SymCache_clear(&cc->localSymCache);
+    UA_mbedTLS_SymCache_clear(&cc->remoteSymCache);
 
     mbedtls_x509_crt_free(&cc->remoteCertificate);
 
@@ -439,6 +415,8 @@ channelContext_newContext_sp_basic256sha256(const UA_SecurityPolicy *securityPol
     UA_ByteString_init(&cc->remoteSymSigningKey);
     UA_ByteString_init(&cc->remoteSymEncryptingKey);
     UA_ByteString_init(&cc->remoteSymIv);
+    memset(&cc->localSymCache, 0, sizeof(UA_mbedTLS_SymCache));
+    memset(&cc->remoteSymCache, 0, sizeof(UA_mbedTLS_SymCache));
 
     mbedtls_x509_crt_init(&cc->remoteCertificate);
 
@@ -457,6 +435,7 @@ channelContext_setLocalSymEncryptingKey_sp_basic256sha256(Basic256Sha256_Channel
     if(key == NULL || cc == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
 
+    UA_mbedTLS_SymCache_clear(&cc->localSymCache);
     UA_ByteString_clear(&cc->localSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
@@ -467,6 +446,7 @@ channelContext_setLocalSymSigningKey_sp_basic256sha256(Basic256Sha256_ChannelCon
     if(key == NULL || cc == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
 
+    UA_mbedTLS_SymCache_clear(&cc->localSymCache);
     UA_ByteString_clear(&cc->localSymSigningKey);
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
@@ -488,6 +468,7 @@ channelContext_setRemoteSymEncryptingKey_sp_basic256sha256(Basic256Sha256_Channe
     if(key == NULL || cc == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
 
+    UA_mbedTLS_SymCache_clear(&cc->remoteSymCache);
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
@@ -498,6 +479,7 @@ channelContext_setRemoteSymSigningKey_sp_basic256sha256(Basic256Sha256_ChannelCo
     if(key == NULL || cc == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
 
+    UA_mbedTLS_SymCache_clear(&cc->remoteSymCache);
     UA_ByteString_clear(&cc->remoteSymSigningKey);
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
@@ -25,6 +25,9 @@ modification history
 #include <openssl/hmac.h>
 #include <openssl/aes.h>
 #include <openssl/pem.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
+#include <openssl/core_names.h>
+#endif
 
 #include "securitypolicy_openssl_common.h"
 #include "ua_openssl_version_abstraction.h"
@@ -507,16 +510,137 @@ UA_Openssl_RSA_PKCS1_V15_SHA256_Sign (const UA_ByteString * message,
                 NID_sha256, outSignature);
 }
 
+/* Cached symmetric contexts */
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
+#define UA_OPENSSL_EVP_MAC /* HMAC_CTX is deprecated since OpenSSL 3.0 */
+#elif OPENSSL_VERSION_NUMBER >= 0x10100000L || defined(LIBRESSL_VERSION_NUMBER)
+#define UA_OPENSSL_HMAC_CTX
+#endif
+
+static void
+UA_OpenSSL_MacCtx_free (void * ctx) {
+#if defined(UA_OPENSSL_EVP_MAC)
+    EVP_MAC_CTX_free ((EVP_MAC_CTX *) ctx);
+#elif defined(UA_OPENSSL_HMAC_CTX)
+    HMAC_CTX_free ((HMAC_CTX *) ctx);
+#endif
+}
+
+void
+UA_OpenSSL_SymCache_clear (UA_OpenSSL_SymCache * cache) {
+    void * cipherCtx = UA_atomic_xchg (&cache->cipherCtx, NULL);
+    if (cipherCtx != NULL)
+        EVP_CIPHER_CTX_free ((EVP_CIPHER_CTX *) cipherCtx);
+    void * macCtx = UA_atomic_xchg (&cache->macCtx, NULL);
+    if (macCtx != NULL)
+        UA_OpenSSL_MacCtx_free (macCtx);
+}
+
+/* Put a context back into the cache after use. If the cache was refilled in
+ * the meantime (concurrent use of the channel), the context is freed. */
+static void
+UA_OpenSSL_SymCache_putCipherCtx (UA_OpenSSL_SymCache * cache,
+                                  EVP_CIPHER_CTX *      ctx) {
+    if (cache == NULL || UA_atomic_cmpxchg (&cache->cipherCtx, NULL, ctx) != NULL)
+        EVP_CIPHER_CTX_free (ctx);
+}
+
+static void
+UA_OpenSSL_SymCache_putMacCtx (UA_OpenSSL_SymCache * cache,
+                               void *                ctx) {
+    if (cache == NULL || UA_atomic_cmpxchg (&cache->macCtx, NULL, ctx) != NULL)
+        UA_OpenSSL_MacCtx_free (ctx);
+}
+
+/* Computes the HMAC over the message. The keyed HMAC context is taken from the
+ * cache and only reset for every message. */
+static UA_StatusCode
+UA_OpenSSL_HMAC (UA_OpenSSL_SymCache * cache,
+                 const EVP_MD *        md,
+                 const UA_ByteString * key,
+                 const UA_ByteString * message,
+                 unsigned char *       out,
+                 size_t                outSize) {
+#if defined(UA_OPENSSL_EVP_MAC)
+    EVP_MAC_CTX * ctx = (cache != NULL) ?
+        (EVP_MAC_CTX *) UA_atomic_xchg (&cache->macCtx, NULL) : NULL;
+    int opensslRet;
+    if (ctx != NULL) {
+        /* Reuse the key from the previous initialization */
+        opensslRet = EVP_MAC_init (ctx, NULL, 0, NULL);
+    } else {
+        EVP_MAC * mac = EVP_MAC_fetch (NULL, "HMAC", NULL);
+        if (mac == NULL)
+            return UA_STATUSCODE_BADINTERNALERROR;
+        ctx = EVP_MAC_CTX_new (mac);
+        EVP_MAC_free (mac); /* The context holds a reference */
+        if (ctx == NULL)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        char mdName[32];
+        strncpy (mdName, EVP_MD_get0_name (md), sizeof (mdName) - 1);
+        mdName[sizeof (mdName) - 1] = '\0';
+        OSSL_PARAM params[2];
+        params[0] = OSSL_PARAM_construct_utf8_string (OSSL_MAC_PARAM_DIGEST, mdName, 0);
+        params[1] = OSSL_PARAM_construct_end ();
+        opensslRet = EVP_MAC_init (ctx, key->data, key->length, params);
+    }
+    size_t outLen = 0;
+    if (opensslRet == 1)
+        opensslRet = EVP_MAC_update (ctx, message->data, message->length);
+    if (opensslRet == 1)
+        opensslRet = EVP_MAC_final (ctx, out, &outLen, outSize);
+    if (opensslRet != 1 || outLen != outSize) {
+        EVP_MAC_CTX_free (ctx);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    UA_OpenSSL_SymCache_putMacCtx (cache, ctx);
+    return UA_STATUSCODE_GOOD;
+#elif defined(UA_OPENSSL_HMAC_CTX)
+    HMAC_CTX * ctx = (cache != NULL) ?
+        (HMAC_CTX *) UA_atomic_xchg (&cache->macCtx, NULL) : NULL;
+    int opensslRet;
+    if (ctx != NULL) {
+        /* Reuse the key from the previous initialization */
+        opensslRet = HMAC_Init_ex (ctx, NULL, 0, NULL, NULL);
+    } else {
+        ctx = HMAC_CTX_new ();
+        if (ctx == NULL)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        opensslRet = HMAC_Init_ex (ctx, key->data, (int) key->length, md, NULL);
+    }
+    unsigned int outLen = 0;
+    if (opensslRet == 1)
+        opensslRet = HMAC_Update (ctx, message->data, message->length);
+    if (opensslRet == 1)
+        opensslRet = HMAC_Final (ctx, out, &outLen);
+    if (opensslRet != 1 || outLen != outSize) {
+        HMAC_CTX_free (ctx);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    UA_OpenSSL_SymCache_putMacCtx (cache, ctx);
+    return UA_STATUSCODE_GOOD;
+#else
+    unsigned int outLen = 0;
+    if (HMAC (md, key->data, (int) key->length, message->data, message->length,
+              out, &outLen) == NULL || outLen != outSize) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    return UA_STATUSCODE_GOOD;
+#endif
+}
+
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Verify (const UA_ByteString *     message,
+UA_OpenSSL_HMAC_SHA256_Verify (UA_OpenSSL_SymCache *     cache,
+                               const UA_ByteString *     message,
                                const UA_ByteString *     key,
                                const UA_ByteString *     signature
                               ) {
     unsigned char buf[SHA256_DIGEST_LENGTH] = {0};
     UA_ByteString mac = {SHA256_DIGEST_LENGTH, buf};
 
-    if (HMAC (EVP_sha256(), key->data, (int) key->length, message->data, message->length, 
-              mac.data, (unsigned int *) &mac.length) == NULL) {
+    if (UA_OpenSSL_HMAC (cache, EVP_sha256(), key, message,
+                         mac.data, mac.length) != UA_STATUSCODE_GOOD) {
         return UA_STATUSCODE_BADINTERNALERROR;
     }
     if (UA_ByteString_equal (signature, &mac)) {
@@ -528,166 +652,76 @@ UA_OpenSSL_HMAC_SHA256_Verify (const UA_ByteString *     message,
 }
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Sign (const UA_ByteString *     message,
+UA_OpenSSL_HMAC_SHA256_Sign (UA_OpenSSL_SymCache *     cache,
+                             const UA_ByteString *     message,
                              const UA_ByteString *     key,
                              UA_ByteString *           signature
                              ) {
-    if (HMAC (EVP_sha256(), key->data, (int) key->length, message->data,
-              message->length,
-              signature->data, (unsigned int *) &(signature->length)) == NULL) {
+    if (signature->length != SHA256_DIGEST_LENGTH)
         return UA_STATUSCODE_BADINTERNALERROR;
-    }
-    return UA_STATUSCODE_GOOD;
+    return UA_OpenSSL_HMAC (cache, EVP_sha256(), key, message,
+                            signature->data, signature->length);
 }
 
+/* En- or decrypts the data in-place. The data is already padded to the block
+ * size by the SecureChannel. The cipher context is keyed once and taken from
+ * the cache. For every message only the IV is set. */
 static UA_StatusCode
-UA_OpenSSL_Decrypt (const UA_ByteString * iv,
-                    const UA_ByteString * key,
-                    const EVP_CIPHER *    cipherAlg,
-                    UA_ByteString *       data  /* [in/out]*/) {
-    UA_ByteString    ivCopy    = {0, NULL};
-    UA_ByteString    cipherTxt = {0, NULL};
-    EVP_CIPHER_CTX * ctx       = NULL;
-    UA_StatusCode    ret;
-    int              opensslRet;
-    int              outLen;
-    int              tmpLen;
-
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
-
-    ret = UA_ByteString_copy (iv, &ivCopy);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ret = UA_ByteString_copy (data, &cipherTxt);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ctx = EVP_CIPHER_CTX_new ();
-    if (ctx == NULL) {
-        ret = UA_STATUSCODE_BADOUTOFMEMORY;
-        goto errout;
+UA_OpenSSL_CBC_Crypt (UA_OpenSSL_SymCache * cache,
+                      const UA_ByteString * iv,
+                      const UA_ByteString * key,
+                      const EVP_CIPHER *    cipherAlg,
+                      int                   enc,
+                      UA_ByteString *       data  /* [in/out]*/) {
+    EVP_CIPHER_CTX * ctx = (cache != NULL) ?
+        (EVP_CIPHER_CTX *) UA_atomic_xchg (&cache->cipherCtx, NULL) : NULL;
+    int opensslRet;
+    if (ctx != NULL) {
+        opensslRet = EVP_CipherInit_ex (ctx, NULL, NULL, NULL, iv->data, enc);
+    } else {
+        ctx = EVP_CIPHER_CTX_new ();
+        if (ctx == NULL)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        opensslRet = EVP_CipherInit_ex (ctx, cipherAlg, NULL, key->data, iv->data, enc);
     }
 
-    /* call EVP_* to decrypt */
-
-    opensslRet = EVP_DecryptInit_ex (ctx, cipherAlg, NULL, key->data, ivCopy.data);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
     /* EVP_DecryptFinal() will return an error code if padding is enabled
      * and the final block is not correctly formatted.
      */
-    EVP_CIPHER_CTX_set_padding (ctx, 0);
-    opensslRet = EVP_DecryptUpdate (ctx, data->data, &outLen,
-                                    cipherTxt.data, (int) cipherTxt.length);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    opensslRet = EVP_DecryptFinal_ex (ctx, data->data + outLen, &tmpLen);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    outLen += tmpLen;
-    data->length = (size_t) outLen;
-    ret = UA_STATUSCODE_GOOD;
-
-errout:
-    UA_ByteString_clear (&ivCopy);
-    UA_ByteString_clear (&cipherTxt);
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    return ret;
-}
-
-static UA_StatusCode
-UA_OpenSSL_Encrypt (const UA_ByteString * iv,
-                    const UA_ByteString * key,
-                    const EVP_CIPHER *    cipherAlg,
-                    UA_ByteString *       data  /* [in/out]*/
-                    ) {
-
-    UA_ByteString    ivCopy   = {0, NULL};
-    UA_ByteString    plainTxt = {0, NULL};
-    EVP_CIPHER_CTX * ctx      = NULL;
-    UA_StatusCode    ret;
-    int              opensslRet;
-    int              outLen;
-    int              tmpLen;
-
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
-
-    ret = UA_ByteString_copy (iv, &ivCopy);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ret = UA_ByteString_copy (data, &plainTxt);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ctx = EVP_CIPHER_CTX_new ();
-    if (ctx == NULL) {
-        ret = UA_STATUSCODE_BADOUTOFMEMORY;
-        goto errout;
-    }
-
-    /* call EVP_* to encrypt */
-
-    opensslRet = EVP_EncryptInit_ex (ctx, cipherAlg, NULL, key->data, ivCopy.data);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    opensslRet = EVP_EncryptUpdate (ctx, data->data, &outLen,
-                                    plainTxt.data, (int) plainTxt.length);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    /*
-     * Buffer passed to EVP_EncryptFinal() must be after data just
-     * encrypted to avoid overwriting it.
-     */
-    opensslRet = EVP_EncryptFinal_ex(ctx, data->data + outLen, &tmpLen);
+    int outLen = 0;
+    int tmpLen = 0;
+    if (opensslRet == 1)
+        opensslRet = EVP_CIPHER_CTX_set_padding (ctx, 0);
+    if (opensslRet == 1)
+        opensslRet = EVP_CipherUpdate (ctx, data->data, &outLen,
+                                       data->data, (int) data->length);
+    if (opensslRet == 1)
+        opensslRet = EVP_CipherFinal_ex (ctx, data->data + outLen, &tmpLen);
     if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    outLen += tmpLen;
-    data->length = (size_t) outLen;
-    ret = UA_STATUSCODE_GOOD;
-
-errout:
-    UA_ByteString_clear (&ivCopy);
-    UA_ByteString_clear (&plainTxt);
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
+        EVP_CIPHER_CTX_free (ctx);
+        return UA_STATUSCODE_BADINTERNALERROR;
     }
-    return ret;
+    data->length = (size_t) (outLen + tmpLen);
+    UA_OpenSSL_SymCache_putCipherCtx (cache, ctx);
+    return UA_STATUSCODE_GOOD;
 }
 
 UA_StatusCode
-UA_OpenSSL_AES_256_CBC_Decrypt (const UA_ByteString * iv,
+UA_OpenSSL_AES_256_CBC_Decrypt (UA_OpenSSL_SymCache * cache,
+                                const UA_ByteString * iv,
                                 const UA_ByteString * key,
                                 UA_ByteString *       data  /* [in/out]*/
                                 ) {
-    return UA_OpenSSL_Decrypt (iv, key, EVP_aes_256_cbc (), data);
+    return UA_OpenSSL_CBC_Crypt (cache, iv, key, EVP_aes_256_cbc (), 0, data);
 }
 
 UA_StatusCode
-UA_OpenSSL_AES_256_CBC_Encrypt (const UA_ByteString * iv,
-                            const UA_ByteString * key,
-                            UA_ByteString *       data  /* [in/out]*/
-                            ) {
-    return UA_OpenSSL_Encrypt (iv, key, EVP_aes_256_cbc (), data);
+UA_OpenSSL_AES_256_CBC_Encrypt (UA_OpenSSL_SymCache * cache,
+                                const UA_ByteString * iv,
+                                const UA_ByteString * key,
+                                UA_ByteString *       data  /* [in/out]*/
+                                ) {
+    return UA_OpenSSL_CBC_Crypt (cache, iv, key, EVP_aes_256_cbc (), 1, data);
 }
 
 UA_StatusCode
@@ -803,15 +837,16 @@ UA_Openssl_Random_Key_PSHA1_Derive (const UA_ByteString *     secret,
 }
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA1_Verify (const UA_ByteString *     message,
+UA_OpenSSL_HMAC_SHA1_Verify (UA_OpenSSL_SymCache *     cache,
+                             const UA_ByteString *     message,
                              const UA_ByteString *     key,
                              const UA_ByteString *     signature
                              ) {
     unsigned char buf[SHA1_DIGEST_LENGTH] = {0};
     UA_ByteString mac = {SHA1_DIGEST_LENGTH, buf};
 
-    if(HMAC (EVP_sha1(), key->data, (int) key->length, message->data, message->length,
-             mac.data, (unsigned int *) &mac.length) == NULL) {
+    if (UA_OpenSSL_HMAC (cache, EVP_sha1(), key, message,
+                         mac.data, mac.length) != UA_STATUSCODE_GOOD) {
         return UA_STATUSCODE_BADINTERNALERROR;
     }
     if (UA_ByteString_equal (signature, &mac)) {
@@ -823,16 +858,15 @@ UA_OpenSSL_HMAC_SHA1_Verify (const UA_ByteString *     message,
 }
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA1_Sign (const UA_ByteString *     message,
+UA_OpenSSL_HMAC_SHA1_Sign (UA_OpenSSL_SymCache *     cache,
+                           const UA_ByteString *     message,
                            const UA_ByteString *     key,
                            UA_ByteString *           signature
                            ) {
-    if (HMAC (EVP_sha1(), key->data, (int) key->length, message->data,
-              message->length,
-              signature->data, (unsigned int *) &(signature->length)) == NULL) {
+    if (signature->length != SHA1_DIGEST_LENGTH)
         return UA_STATUSCODE_BADINTERNALERROR;
-    }
-    return UA_STATUSCODE_GOOD;
+    return UA_OpenSSL_HMAC (cache, EVP_sha1(), key, message,
+                            signature->data, signature->length);
 }
 
 UA_StatusCode
@@ -860,19 +894,21 @@ UA_Openssl_RSA_PKCS1_V15_Encrypt (UA_ByteString * data,
 }
 
 UA_StatusCode
-UA_OpenSSL_AES_128_CBC_Decrypt (const UA_ByteString * iv,
+UA_OpenSSL_AES_128_CBC_Decrypt (UA_OpenSSL_SymCache * cache,
+                                const UA_ByteString * iv,
                                 const UA_ByteString * key,
                                 UA_ByteString *       data  /* [in/out]*/
                                 ) {
-    return UA_OpenSSL_Decrypt (iv, key, EVP_aes_128_cbc (), data);
+    return UA_OpenSSL_CBC_Crypt (cache, iv, key, EVP_aes_128_cbc (), 0, data);
 }
 
 UA_StatusCode
-UA_OpenSSL_AES_128_CBC_Encrypt (const UA_ByteString * iv,
+UA_OpenSSL_AES_128_CBC_Encrypt (UA_OpenSSL_SymCache * cache,
+                                const UA_ByteString * iv,
                                 const UA_ByteString * key,
                                 UA_ByteString *       data  /* [in/out]*/
                                 ) {
-    return UA_OpenSSL_Encrypt (iv, key, EVP_aes_128_cbc (), data);
+    return UA_OpenSSL_CBC_Crypt (cache, iv, key, EVP_aes_128_cbc (), 1, data);
 }
 
 EVP_PKEY *
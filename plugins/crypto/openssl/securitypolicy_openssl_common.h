@@ -20,6 +20,19 @@
 
 _UA_BEGIN_DECLS
 
+/* Symmetric OpenSSL contexts for one direction of a channel. The contexts are
+ * keyed on first use and then reused for all messages. During an operation the
+ * context is taken out of the cache atomically. So the symmetric operations
+ * stay reentrant and concurrent calls fall back to a temporary context. The
+ * cache has to be cleared when the keys change. */
+typedef struct {
+    void *cipherCtx; /* EVP_CIPHER_CTX */
+    void *macCtx;    /* EVP_MAC_CTX or HMAC_CTX, depending on the version */
+} UA_OpenSSL_SymCache;
+
+void
+UA_OpenSSL_SymCache_clear(UA_OpenSSL_SymCache *cache);
+
 void saveDataToFile(const char *fileName, const UA_ByteString *str);
 void UA_Openssl_Init(void);
 
@@ -57,22 +70,26 @@ UA_Openssl_RSA_PKCS1_V15_SHA256_Sign(const UA_ByteString *data,
                                      UA_ByteString *outSignature);
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Verify(const UA_ByteString *message,
+UA_OpenSSL_HMAC_SHA256_Verify(UA_OpenSSL_SymCache *cache,
+                              const UA_ByteString *message,
                               const UA_ByteString *key,
                               const UA_ByteString *signature);
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Sign(const UA_ByteString *message,
+UA_OpenSSL_HMAC_SHA256_Sign(UA_OpenSSL_SymCache *cache,
+                            const UA_ByteString *message,
                             const UA_ByteString *key,
                             UA_ByteString *signature);
 
 UA_StatusCode
-UA_OpenSSL_AES_256_CBC_Decrypt(const UA_ByteString *iv,
+UA_OpenSSL_AES_256_CBC_Decrypt(UA_OpenSSL_SymCache *cache,
+                               const UA_ByteString *iv,
                                const UA_ByteString *key, 
                                UA_ByteString *data  /* [in/out]*/);
 
 UA_StatusCode
-UA_OpenSSL_AES_256_CBC_Encrypt(const UA_ByteString *iv,
+UA_OpenSSL_AES_256_CBC_Encrypt(UA_OpenSSL_SymCache *cache,
+                               const UA_ByteString *iv,
                                const UA_ByteString *key, 
                                UA_ByteString *data  /* [in/out]*/);
 
@@ -97,12 +114,14 @@ UA_Openssl_Random_Key_PSHA1_Derive(const UA_ByteString *secret,
                                    const UA_ByteString *seed, 
                                    UA_ByteString *out);
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA1_Verify(const UA_ByteString *message,
+UA_OpenSSL_HMAC_SHA1_Verify(UA_OpenSSL_SymCache *cache,
+                            const UA_ByteString *message,
                             const UA_ByteString *key,
                             const UA_ByteString *signature);
 
 UA_StatusCode
-UA_OpenSSL_HMAC_SHA1_Sign(const UA_ByteString *message,
+UA_OpenSSL_HMAC_SHA1_Sign(UA_OpenSSL_SymCache *cache,
+                          const UA_ByteString *message,
                           const UA_ByteString *key,
                           UA_ByteString *signature);
 
@@ -116,12 +135,14 @@ UA_Openssl_RSA_PKCS1_V15_Encrypt(UA_ByteString *data,
                                  X509 *publicX509);
 
 UA_StatusCode
-UA_OpenSSL_AES_128_CBC_Decrypt(const UA_ByteString *iv,
+UA_OpenSSL_AES_128_CBC_Decrypt(UA_OpenSSL_SymCache *cache,
+                               const UA_ByteString *iv,
                                const UA_ByteString *key, 
                                UA_ByteString *data  /* [in/out]*/);
 
 UA_StatusCode
-UA_OpenSSL_AES_128_CBC_Encrypt(const UA_ByteString *iv,
+UA_OpenSSL_AES_128_CBC_Encrypt(UA_OpenSSL_SymCache *cache,
+                               const UA_ByteString *iv,
                                const UA_ByteString *key, 
                                UA_ByteString *data  /* [in/out]*/);
 
@@ -0,0 +1,741 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_history_aggregates.h"
+
+#include <string.h>
+
+#define AGGREGATE_BATCHSIZE 1024
+
+/* Upper bound of intervals in one response. Also if the node setting has no
+ * maxHistoryDataResponseSize. The remaining intervals are paged with a
+ * continuation point. */
+#define AGGREGATE_MAXPAGESIZE 10000
+
+/* Historian bits of the StatusCode (Part 4). They are valid if the InfoType is
+ * DataValue. */
+#define AGGREGATE_INFOTYPE_DATAVALUE 0x00000400
+#define AGGREGATE_HISTORIAN_CALCULATED 0x00000001
+#define AGGREGATE_HISTORIAN_INTERPOLATED 0x00000002
+#define AGGREGATE_HISTORIAN_PARTIAL 0x00000004
+
+typedef enum {
+    AGGREGATE_INTERPOLATIVE,
+    AGGREGATE_AVERAGE,
+    AGGREGATE_TIMEAVERAGE,
+    AGGREGATE_MINIMUM,
+    AGGREGATE_MAXIMUM,
+    AGGREGATE_COUNT,
+    AGGREGATE_START,
+    AGGREGATE_END,
+    AGGREGATE_DELTA
+} AggregateKind;
+
+typedef struct {
+    UA_Boolean valid;
+    UA_DateTime time;
+    UA_Double value;
+} AggregatePoint;
+
+/* Running state of one interval. An interval can span several batches. */
+typedef struct {
+    size_t total;   /* Raw samples */
+    size_t good;    /* Raw samples with good quality */
+    size_t numeric; /* Good raw samples with a numeric value */
+    UA_Double sum;
+    UA_Double area; /* Integral between the first and the last numeric sample */
+    AggregatePoint first;
+    AggregatePoint last;
+    UA_Double extreme;
+    UA_DataValue raw; /* Raw sample of Minimum, Maximum, Start and End */
+} AggregateInterval;
+
+typedef struct {
+    const UA_HistoryDataBackend *backend;
+    UA_Server *server;
+    const UA_NodeId *sessionId;
+    void *sessionContext;
+    const UA_NodeId *nodeId;
+    size_t storeEnd;
+    AggregateKind kind;
+    UA_AggregateConfiguration config;
+
+    /* Raw samples of the current page. They are read in batches. */
+    size_t startIndex;
+    size_t endIndex;
+    UA_ByteString continuationPoint;
+    UA_Boolean done;
+    size_t pos;
+    size_t size;
+    size_t numericSize;
+
+    /* Columns of the batch. The good numeric samples are compacted into
+     * numericTimes/numericValues. The prefix counts map a range of raw samples
+     * to the range of the compacted samples. */
+    UA_DataValue values[AGGREGATE_BATCHSIZE];
+    UA_DateTime times[AGGREGATE_BATCHSIZE];
+    size_t goodBefore[AGGREGATE_BATCHSIZE + 1];
+    size_t numericBefore[AGGREGATE_BATCHSIZE + 1];
+    size_t numericRaw[AGGREGATE_BATCHSIZE];
+    UA_DateTime numericTimes[AGGREGATE_BATCHSIZE];
+    UA_Double numericValues[AGGREGATE_BATCHSIZE];
+
+    /* Last good numeric sample before the current interval */
+    AggregatePoint prev;
+} AggregateCursor;
+
+static UA_Boolean
+aggregateKind(const UA_NodeId *aggregateType, AggregateKind *kind) {
+    if(aggregateType->namespaceIndex != 0 ||
+       aggregateType->identifierType != UA_NODEIDTYPE_NUMERIC)
+        return false;
+    switch(aggregateType->identifier.numeric) {
+    case UA_NS0ID_AGGREGATEFUNCTION_INTERPOLATIVE: *kind = AGGREGATE_INTERPOLATIVE; return true;
+    case UA_NS0ID_AGGREGATEFUNCTION_AVERAGE: *kind = AGGREGATE_AVERAGE; return true;
+    case UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE: *kind = AGGREGATE_TIMEAVERAGE; return true;
+    case UA_NS0ID_AGGREGATEFUNCTION_MINIMUM: *kind = AGGREGATE_MINIMUM; return true;
+    case UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM: *kind = AGGREGATE_MAXIMUM; return true;
+    case UA_NS0ID_AGGREGATEFUNCTION_COUNT: *kind = AGGREGATE_COUNT; return true;
+    case UA_NS0ID_AGGREGATEFUNCTION_START: *kind = AGGREGATE_START; return true;
+    case UA_NS0ID_AGGREGATEFUNCTION_END: *kind = AGGREGATE_END; return true;
+    case UA_NS0ID_AGGREGATEFUNCTION_DELTA: *kind = AGGREGATE_DELTA; return true;
+    default: return false;
+    }
+}
+
+UA_Boolean
+UA_HistoryAggregate_supported(const UA_NodeId *aggregateType) {
+    AggregateKind kind;
+    return aggregateKind(aggregateType, &kind);
+}
+
+/***********/
+/* Samples */
+/***********/
+
+static UA_DateTime
+aggregateRawTime(const UA_DataValue *value) {
+    return value->hasSourceTimestamp ? value->sourceTimestamp : value->serverTimestamp;
+}
+
+static UA_Boolean
+aggregateRawGood(const UA_DataValue *value, UA_Boolean treatUncertainAsBad) {
+    if(!value->hasValue)
+        return false;
+    UA_StatusCode status = value->hasStatus ? value->status : UA_STATUSCODE_GOOD;
+    if(UA_StatusCode_isBad(status))
+        return false;
+    return !(treatUncertainAsBad && UA_StatusCode_isUncertain(status));
+}
+
+/* NaN is not used for the calculations */
+static UA_Boolean
+aggregateRawNumeric(const UA_Variant *value, UA_Double *out) {
+    if(!UA_Variant_isScalar(value))
+        return false;
+    switch(value->type->typeKind) {
+    case UA_DATATYPEKIND_SBYTE: *out = *(const UA_SByte*)value->data; return true;
+    case UA_DATATYPEKIND_BYTE: *out = *(const UA_Byte*)value->data; return true;
+    case UA_DATATYPEKIND_INT16: *out = *(const UA_Int16*)value->data; return true;
+    case UA_DATATYPEKIND_UINT16: *out = *(const UA_UInt16*)value->data; return true;
+    case UA_DATATYPEKIND_INT32: *out = *(const UA_Int32*)value->data; return true;
+    case UA_DATATYPEKIND_UINT32: *out = *(const UA_UInt32*)value->data; return true;
+    case UA_DATATYPEKIND_INT64: *out = (UA_Double)*(const UA_Int64*)value->data; return true;
+    case UA_DATATYPEKIND_UINT64: *out = (UA_Double)*(const UA_UInt64*)value->data; return true;
+    case UA_DATATYPEKIND_FLOAT: *out = *(const UA_Float*)value->data; return *out == *out;
+    case UA_DATATYPEKIND_DOUBLE: *out = *(const UA_Double*)value->data; return *out == *out;
+    default: return false;
+    }
+}
+
+/***********/
+/* Kernels */
+/***********/
+
+/* The kernels work on the contiguous columns of good numeric samples. They are
+ * plain loops with independent accumulators, so that the compiler can
+ * vectorize them. */
+
+static UA_Double
+aggregateSum(const UA_Double *v, size_t n) {
+    UA_Double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+        s0 += v[i];
+        s1 += v[i + 1];
+        s2 += v[i + 2];
+        s3 += v[i + 3];
+    }
+    for(; i < n; i++)
+        s0 += v[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+/* Trapezoidal integral over the samples. The time unit is 100ns. */
+static UA_Double
+aggregateArea(const UA_DateTime *t, const UA_Double *v, size_t n) {
+    UA_Double a0 = 0.0, a1 = 0.0;
+    size_t i = 0;
+    for(; i + 2 < n; i += 2) {
+        a0 += (UA_Double)(t[i + 1] - t[i]) * (v[i] + v[i + 1]);
+        a1 += (UA_Double)(t[i + 2] - t[i + 1]) * (v[i + 1] + v[i + 2]);
+    }
+    for(; i + 1 < n; i++)
+        a0 += (UA_Double)(t[i + 1] - t[i]) * (v[i] + v[i + 1]);
+    return (a0 + a1) * 0.5;
+}
+
+/* Returns the position of the first minimum (or maximum) */
+static size_t
+aggregateExtreme(const UA_Double *v, size_t n, UA_Boolean maximum) {
+    UA_Double m = v[0];
+    if(maximum) {
+        for(size_t i = 1; i < n; i++)
+            m = (v[i] > m) ? v[i] : m;
+    } else {
+        for(size_t i = 1; i < n; i++)
+            m = (v[i] < m) ? v[i] : m;
+    }
+    size_t pos = 0;
+    while(v[pos] < m || v[pos] > m)
+        pos++;
+    return pos;
+}
+
+static UA_Double
+aggregateSegment(UA_DateTime t0, UA_Double v0, UA_DateTime t1, UA_Double v1) {
+    return (UA_Double)(t1 - t0) * (v0 + v1) * 0.5;
+}
+
+/* Linear interpolation between p0 and p1. Stepped extrapolation if only one
+ * side is known. */
+static UA_Boolean
+aggregateBound(const AggregatePoint *p0, const AggregatePoint *p1, UA_DateTime t,
+               UA_Double *value, UA_Boolean *extrapolated) {
+    if(p0->valid && p1->valid) {
+        if(p1->time == p0->time)
+            *value = p1->value;
+        else
+            *value = p0->value + (p1->value - p0->value) *
+                ((UA_Double)(t - p0->time) / (UA_Double)(p1->time - p0->time));
+        return true;
+    }
+    const AggregatePoint *p = p0->valid ? p0 : p1;
+    if(!p->valid)
+        return false;
+    *value = p->value;
+    *extrapolated = true;
+    return true;
+}
+
+/**********/
+/* Cursor */
+/**********/
+
+static void
+AggregateCursor_clearBatch(AggregateCursor *c) {
+    for(size_t i = 0; i < c->size; i++)
+        UA_DataValue_clear(&c->values[i]);
+    c->size = 0;
+    c->pos = 0;
+    c->numericSize = 0;
+}
+
+static void
+AggregateCursor_clear(AggregateCursor *c) {
+    AggregateCursor_clearBatch(c);
+    UA_ByteString_clear(&c->continuationPoint);
+}
+
+static UA_StatusCode
+AggregateCursor_load(AggregateCursor *c) {
+    AggregateCursor_clearBatch(c);
+    if(c->done)
+        return UA_STATUSCODE_GOOD;
+
+    UA_NumericRange range;
+    range.dimensionsSize = 0;
+    range.dimensions = NULL;
+    UA_ByteString outContinuationPoint;
+    UA_ByteString_init(&outContinuationPoint);
+    size_t provided = 0;
+    UA_StatusCode res =
+        c->backend->copyDataValues(c->server, c->backend->context, c->sessionId,
+                                   c->sessionContext, c->nodeId, c->startIndex,
+                                   c->endIndex, false, AGGREGATE_BATCHSIZE, range,
+                                   false, &c->continuationPoint,
+                                   &outContinuationPoint, &provided, c->values);
+    UA_ByteString_clear(&c->continuationPoint);
+    c->continuationPoint = outContinuationPoint;
+    c->done = (outContinuationPoint.length == 0 || provided == 0);
+    if(provided > AGGREGATE_BATCHSIZE)
+        provided = AGGREGATE_BATCHSIZE;
+    c->size = provided;
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Fill the columns */
+    size_t good = 0, numeric = 0;
+    c->goodBefore[0] = 0;
+    c->numericBefore[0] = 0;
+    for(size_t i = 0; i < provided; i++) {
+        const UA_DataValue *value = &c->values[i];
+        c->times[i] = aggregateRawTime(value);
+        if(aggregateRawGood(value, c->config.treatUncertainAsBad)) {
+            good++;
+            UA_Double d;
+            if(aggregateRawNumeric(&value->value, &d)) {
+                c->numericTimes[numeric] = c->times[i];
+                c->numericValues[numeric] = d;
+                c->numericRaw[numeric] = i;
+                numeric++;
+            }
+        }
+        c->goodBefore[i + 1] = good;
+        c->numericBefore[i + 1] = numeric;
+    }
+    c->numericSize = numeric;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Walks from the sample matching (t, first) with the step strategy until a good
+ * numeric sample is found */
+static AggregatePoint
+AggregateCursor_find(const AggregateCursor *c, UA_DateTime t,
+                     MatchStrategy first, MatchStrategy step) {
+    AggregatePoint p;
+    memset(&p, 0, sizeof(AggregatePoint));
+    const UA_HistoryDataBackend *b = c->backend;
+    size_t index = b->getDateTimeMatch(c->server, b->context, c->sessionId,
+                                       c->sessionContext, c->nodeId, t, first);
+    while(index != c->storeEnd) {
+        const UA_DataValue *value =
+            b->getDataValue(c->server, b->context, c->sessionId,
+                            c->sessionContext, c->nodeId, index);
+        if(!value)
+            break;
+        if(aggregateRawGood(value, c->config.treatUncertainAsBad) &&
+           aggregateRawNumeric(&value->value, &p.value)) {
+            p.valid = true;
+            p.time = aggregateRawTime(value);
+            break;
+        }
+        index = b->getDateTimeMatch(c->server, b->context, c->sessionId,
+                                    c->sessionContext, c->nodeId,
+                                    aggregateRawTime(value), step);
+    }
+    return p;
+}
+
+static UA_StatusCode
+AggregateCursor_begin(AggregateCursor *c, UA_DateTime lo, UA_DateTime hi) {
+    const UA_HistoryDataBackend *b = c->backend;
+    c->storeEnd = b->getEnd(c->server, b->context, c->sessionId,
+                            c->sessionContext, c->nodeId);
+    c->startIndex = b->getDateTimeMatch(c->server, b->context, c->sessionId,
+                                        c->sessionContext, c->nodeId, lo,
+                                        MATCH_EQUAL_OR_AFTER);
+    c->endIndex = b->getDateTimeMatch(c->server, b->context, c->sessionId,
+                                      c->sessionContext, c->nodeId, hi,
+                                      MATCH_BEFORE);
+    c->done = true;
+    if(c->startIndex != c->storeEnd && c->endIndex != c->storeEnd) {
+        const UA_DataValue *first =
+            b->getDataValue(c->server, b->context, c->sessionId,
+                            c->sessionContext, c->nodeId, c->startIndex);
+        c->done = (!first || aggregateRawTime(first) >= hi);
+    }
+
+    if(c->kind == AGGREGATE_INTERPOLATIVE || c->kind == AGGREGATE_TIMEAVERAGE)
+        c->prev = AggregateCursor_find(c, lo, MATCH_BEFORE, MATCH_BEFORE);
+    return AggregateCursor_load(c);
+}
+
+/* First good numeric sample at or after hi. Looks into the batch first. */
+static AggregatePoint
+AggregateCursor_next(const AggregateCursor *c, UA_DateTime hi) {
+    if(c->pos < c->size) {
+        size_t k = c->numericBefore[c->pos];
+        if(k < c->numericSize) {
+            AggregatePoint p = {true, c->numericTimes[k], c->numericValues[k]};
+            return p;
+        }
+    }
+    return AggregateCursor_find(c, hi, MATCH_EQUAL_OR_AFTER, MATCH_AFTER);
+}
+
+/* Add the raw samples [from, to) of the batch to the interval */
+static UA_StatusCode
+AggregateCursor_add(const AggregateCursor *c, AggregateInterval *iv,
+                    size_t from, size_t to) {
+    size_t good = c->goodBefore[to] - c->goodBefore[from];
+    size_t n0 = c->numericBefore[from];
+    size_t n = c->numericBefore[to] - n0;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+
+    if(n > 0) {
+        const UA_DateTime *t = &c->numericTimes[n0];
+        const UA_Double *v = &c->numericValues[n0];
+        iv->sum += aggregateSum(v, n);
+        iv->area += aggregateArea(t, v, n);
+        if(iv->last.valid)
+            iv->area += aggregateSegment(iv->last.time, iv->last.value, t[0], v[0]);
+        if(!iv->first.valid) {
+            iv->first.valid = true;
+            iv->first.time = t[0];
+            iv->first.value = v[0];
+        }
+        iv->last.valid = true;
+        iv->last.time = t[n - 1];
+        iv->last.value = v[n - 1];
+
+        if(c->kind == AGGREGATE_MINIMUM || c->kind == AGGREGATE_MAXIMUM) {
+            UA_Boolean maximum = (c->kind == AGGREGATE_MAXIMUM);
+            size_t e = aggregateExtreme(v, n, maximum);
+            if(iv->numeric == 0 ||
+               (maximum && v[e] > iv->extreme) || (!maximum && v[e] < iv->extreme)) {
+                iv->extreme = v[e];
+                UA_DataValue_clear(&iv->raw);
+                res = UA_DataValue_copy(&c->values[c->numericRaw[n0 + e]], &iv->raw);
+            }
+        }
+        iv->numeric += n;
+    }
+
+    if(good > 0 && c->kind == AGGREGATE_START && iv->good == 0) {
+        size_t i = from;
+        while(c->goodBefore[i + 1] == c->goodBefore[i])
+            i++;
+        res = UA_DataValue_copy(&c->values[i], &iv->raw);
+    } else if(good > 0 && c->kind == AGGREGATE_END) {
+        size_t i = to - 1;
+        while(c->goodBefore[i + 1] == c->goodBefore[i])
+            i--;
+        UA_DataValue_clear(&iv->raw);
+        res = UA_DataValue_copy(&c->values[i], &iv->raw);
+    }
+
+    iv->total += to - from;
+    iv->good += good;
+    return res;
+}
+
+/* Add all raw samples before hi to the interval. Loads batches as required. */
+static UA_StatusCode
+AggregateCursor_interval(AggregateCursor *c, AggregateInterval *iv, UA_DateTime hi) {
+    while(true) {
+        if(c->pos == c->size) {
+            if(c->done)
+                return UA_STATUSCODE_GOOD;
+            UA_StatusCode res = AggregateCursor_load(c);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+            if(c->size == 0)
+                return UA_STATUSCODE_GOOD;
+        }
+
+        /* Binary search for the first sample at or after hi */
+        size_t lo = c->pos, up = c->size;
+        while(lo < up) {
+            size_t mid = lo + ((up - lo) / 2);
+            if(c->times[mid] < hi)
+                lo = mid + 1;
+            else
+                up = mid;
+        }
+
+        UA_StatusCode res = AggregateCursor_add(c, iv, c->pos, lo);
+        c->pos = lo;
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        if(lo < c->size)
+            return UA_STATUSCODE_GOOD;
+    }
+}
+
+/**********/
+/* Result */
+/**********/
+
+static UA_StatusCode
+aggregateQuality(const AggregateCursor *c, const AggregateInterval *iv) {
+    if(iv->total == 0 ||
+       iv->good * 100 >= (size_t)c->config.percentDataGood * iv->total)
+        return UA_STATUSCODE_GOOD;
+    if((iv->total - iv->good) * 100 >= (size_t)c->config.percentDataBad * iv->total)
+        return UA_STATUSCODE_BAD;
+    return UA_STATUSCODE_UNCERTAINDATASUBNORMAL;
+}
+
+static UA_StatusCode
+aggregateResult(const AggregateCursor *c, AggregateInterval *iv,
+                UA_DateTime lo, UA_DateTime hi, const AggregatePoint *next,
+                UA_DataValue *out) {
+    UA_StatusCode status = aggregateQuality(c, iv);
+    UA_StatusCode bits = AGGREGATE_HISTORIAN_CALCULATED;
+    UA_Double result = 0.0;
+    UA_Boolean extrapolated = false;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+
+    /* Numeric aggregates cannot use good samples that are not numeric */
+    if(c->kind != AGGREGATE_COUNT && c->kind != AGGREGATE_START &&
+       c->kind != AGGREGATE_END && iv->good > iv->numeric) {
+        out->hasStatus = true;
+        out->status = UA_STATUSCODE_BADAGGREGATEINVALIDINPUTS;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    switch(c->kind) {
+    case AGGREGATE_COUNT: {
+        UA_Int32 count = (UA_Int32)iv->good;
+        res = UA_Variant_setScalarCopy(&out->value, &count, &UA_TYPES[UA_TYPES_INT32]);
+        out->hasValue = true;
+        break;
+    }
+    case AGGREGATE_AVERAGE:
+        if(iv->numeric == 0)
+            goto nodata;
+        result = iv->sum / (UA_Double)iv->numeric;
+        break;
+    case AGGREGATE_DELTA:
+        if(iv->numeric == 0)
+            goto nodata;
+        result = iv->last.value - iv->first.value;
+        break;
+    case AGGREGATE_MINIMUM:
+    case AGGREGATE_MAXIMUM:
+    case AGGREGATE_START:
+    case AGGREGATE_END:
+        if(!iv->raw.hasValue)
+            goto nodata;
+        /* Move the raw value into the result */
+        out->value = iv->raw.value;
+        out->hasValue = true;
+        UA_Variant_init(&iv->raw.value);
+        iv->raw.hasValue = false;
+        if(c->kind == AGGREGATE_START || c->kind == AGGREGATE_END) {
+            /* Return the raw sample */
+            status = iv->raw.hasStatus ? iv->raw.status : UA_STATUSCODE_GOOD;
+            bits = 0;
+        }
+        break;
+    case AGGREGATE_INTERPOLATIVE:
+        bits = AGGREGATE_HISTORIAN_INTERPOLATED;
+        status = UA_STATUSCODE_GOOD;
+        if(iv->first.valid && iv->first.time == lo) {
+            result = iv->first.value;
+            bits = 0;
+        } else if(!aggregateBound(&c->prev, iv->first.valid ? &iv->first : next,
+                                  lo, &result, &extrapolated)) {
+            goto nodata;
+        }
+        break;
+    case AGGREGATE_TIMEAVERAGE: {
+        UA_Double vlo, vhi;
+        if(iv->first.valid && iv->first.time == lo) {
+            vlo = iv->first.value;
+        } else if(!aggregateBound(&c->prev, iv->first.valid ? &iv->first : next,
+                                  lo, &vlo, &extrapolated)) {
+            goto nodata;
+        }
+        if(!aggregateBound(iv->last.valid ? &iv->last : &c->prev, next,
+                           hi, &vhi, &extrapolated))
+            goto nodata;
+        UA_Double area;
+        if(iv->first.valid)
+            area = aggregateSegment(lo, vlo, iv->first.time, iv->first.value) +
+                iv->area + aggregateSegment(iv->last.time, iv->last.value, hi, vhi);
+        else
+            area = aggregateSegment(lo, vlo, hi, vhi);
+        result = area / (UA_Double)(hi - lo);
+        break;
+    }
+    default:
+        goto nodata;
+    }
+
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    if(!out->hasValue) {
+        res = UA_Variant_setScalarCopy(&out->value, &result, &UA_TYPES[UA_TYPES_DOUBLE]);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        out->hasValue = true;
+    }
+    if(extrapolated && status == UA_STATUSCODE_GOOD)
+        status = UA_STATUSCODE_UNCERTAINDATASUBNORMAL;
+    if(UA_StatusCode_isBad(status)) {
+        UA_Variant_clear(&out->value);
+        out->hasValue = false;
+    }
+    if(bits != 0)
+        status |= AGGREGATE_INFOTYPE_DATAVALUE | bits;
+    out->hasStatus = (status != UA_STATUSCODE_GOOD);
+    out->status = status;
+    return UA_STATUSCODE_GOOD;
+
+ nodata:
+    out->hasStatus = true;
+    out->status = UA_STATUSCODE_BADNODATA;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+aggregateTimestamp(UA_DataValue *out, UA_DateTime t,
+                   UA_TimestampsToReturn timestampsToReturn) {
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH) {
+        out->hasSourceTimestamp = true;
+        out->sourceTimestamp = t;
+    }
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH) {
+        out->hasServerTimestamp = true;
+        out->serverTimestamp = t;
+    }
+}
+
+UA_StatusCode
+UA_HistoryAggregate_read(const UA_HistoryDataBackend *backend,
+                         UA_Server *server,
+                         const UA_NodeId *sessionId,
+                         void *sessionContext,
+                         const UA_NodeId *nodeId,
+                         const UA_ReadProcessedDetails *details,
+                         const UA_NodeId *aggregateType,
+                         size_t maxSize,
+                         UA_TimestampsToReturn timestampsToReturn,
+                         const UA_ByteString *continuationPoint,
+                         UA_ByteString *outContinuationPoint,
+                         UA_HistoryData *historyData) {
+    AggregateKind kind;
+    if(!aggregateKind(aggregateType, &kind))
+        return UA_STATUSCODE_BADAGGREGATENOTSUPPORTED;
+
+    /* The aggregates use the index-based API of the backend */
+    if(backend->getHistoryData || !backend->copyDataValues ||
+       !backend->getDataValue || !backend->getDateTimeMatch || !backend->getEnd)
+        return UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED;
+
+    UA_AggregateConfiguration config = details->aggregateConfiguration;
+    if(config.useServerCapabilitiesDefaults) {
+        config.treatUncertainAsBad = true;
+        config.percentDataBad = 100;
+        config.percentDataGood = 100;
+        config.useSlopedExtrapolation = false;
+    }
+    if(config.percentDataBad > 100 || config.percentDataGood > 100)
+        return UA_STATUSCODE_BADAGGREGATECONFIGURATIONREJECTED;
+
+    /* Split the range into intervals */
+    if(details->startTime == details->endTime || !(details->processingInterval >= 0.0))
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    UA_Boolean reverse = details->endTime < details->startTime;
+    UA_DateTime span = reverse ? details->startTime - details->endTime :
+        details->endTime - details->startTime;
+    UA_DateTime step = span;
+    if(details->processingInterval * UA_DATETIME_MSEC < (UA_Double)span)
+        step = (UA_DateTime)(details->processingInterval * UA_DATETIME_MSEC);
+    if(step <= 0)
+        step = span;
+    size_t count = (size_t)(span / step) + ((span % step) ? 1 : 0);
+
+    size_t first = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&first, continuationPoint->data, sizeof(size_t));
+        if(first >= count)
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+    }
+    size_t last = count;
+    if(maxSize == 0 || maxSize > AGGREGATE_MAXPAGESIZE)
+        maxSize = AGGREGATE_MAXPAGESIZE;
+    if(count - first > maxSize)
+        last = first + maxSize;
+
+    /* Time range of the intervals in this response */
+    UA_DateTime pageLo, pageHi;
+    if(!reverse) {
+        pageLo = details->startTime + (UA_DateTime)first * step;
+        pageHi = details->startTime + (UA_DateTime)last * step;
+        if(last == count)
+            pageHi = details->endTime;
+    } else {
+        pageHi = details->startTime - (UA_DateTime)first * step;
+        pageLo = details->startTime - (UA_DateTime)last * step;
+        if(last == count)
+            pageLo = details->endTime;
+    }
+
+    size_t size = last - first;
+    UA_DataValue *results = (UA_DataValue*)
+        UA_Array_new(size, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    AggregateCursor *c = (AggregateCursor*)UA_calloc(1, sizeof(AggregateCursor));
+    if(!results || !c) {
+        UA_Array_delete(results, size, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        UA_free(c);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    c->backend = backend;
+    c->server = server;
+    c->sessionId = sessionId;
+    c->sessionContext = sessionContext;
+    c->nodeId = nodeId;
+    c->kind = kind;
+    c->config = config;
+
+    /* Compute the intervals in ascending order in one pass over the samples */
+    UA_StatusCode res = AggregateCursor_begin(c, pageLo, pageHi);
+    for(size_t i = 0; i < size && res == UA_STATUSCODE_GOOD; i++) {
+        size_t k = reverse ? last - 1 - i : first + i;
+        UA_DateTime lo, hi, label;
+        if(!reverse) {
+            lo = details->startTime + (UA_DateTime)k * step;
+            hi = (k + 1 == count) ? details->endTime : lo + step;
+            label = lo;
+        } else {
+            hi = details->startTime - (UA_DateTime)k * step;
+            lo = (k + 1 == count) ? details->endTime : hi - step;
+            label = hi;
+        }
+
+        AggregateInterval iv;
+        memset(&iv, 0, sizeof(AggregateInterval));
+        res = AggregateCursor_interval(c, &iv, hi);
+        if(res == UA_STATUSCODE_GOOD) {
+            AggregatePoint next;
+            memset(&next, 0, sizeof(AggregatePoint));
+            if(kind == AGGREGATE_TIMEAVERAGE ||
+               (kind == AGGREGATE_INTERPOLATIVE && !iv.first.valid))
+                next = AggregateCursor_next(c, hi);
+            UA_DataValue *out = &results[k - first];
+            res = aggregateResult(c, &iv, lo, hi, &next, out);
+            if(hi - lo < step && (out->status & AGGREGATE_INFOTYPE_DATAVALUE)) {
+                out->status |= AGGREGATE_HISTORIAN_PARTIAL;
+                out->hasStatus = true;
+            }
+            aggregateTimestamp(out, label, timestampsToReturn);
+        }
+        if(iv.last.valid)
+            c->prev = iv.last;
+        UA_DataValue_clear(&iv.raw);
+    }
+    AggregateCursor_clear(c);
+    UA_free(c);
+
+    if(res == UA_STATUSCODE_GOOD && last < count) {
+        res = UA_ByteString_allocBuffer(outContinuationPoint, sizeof(size_t));
+        if(res == UA_STATUSCODE_GOOD)
+            memcpy(outContinuationPoint->data, &last, sizeof(size_t));
+    }
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_Array_delete(results, size, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        return res;
+    }
+    historyData->dataValues = results;
+    historyData->dataValuesSize = size;
+    return UA_STATUSCODE_GOOD;
+}
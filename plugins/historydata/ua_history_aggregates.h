@@ -0,0 +1,48 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORY_AGGREGATES_H_
+#define UA_HISTORY_AGGREGATES_H_
+
+#include <open62541/plugin/historydata/history_data_backend.h>
+
+_UA_BEGIN_DECLS
+
+/* Aggregates for HistoryReadProcessed (Part 13). They are computed from the raw
+ * samples of an index-based backend. The supported aggregates are
+ * Interpolative, Average, TimeAverage, Minimum, Maximum, Count, Start, End and
+ * Delta.
+ *
+ * The request range is split into intervals of processingInterval ms, starting
+ * at startTime. The intervals are half-open [start, end). If the endTime is
+ * before the startTime, the intervals are returned in reverse order and the
+ * timestamp of an interval is its later bound. The raw samples are read once
+ * in ascending order and in batches. The good numeric samples of a batch are
+ * kept in contiguous columns for the calculations.
+ *
+ * Every response contains at most maxSize intervals and never more than a
+ * fixed upper bound (also if maxSize is zero). The continuation point holds
+ * the index of the next interval. */
+
+UA_Boolean
+UA_HistoryAggregate_supported(const UA_NodeId *aggregateType);
+
+UA_StatusCode
+UA_HistoryAggregate_read(const UA_HistoryDataBackend *backend,
+                         UA_Server *server,
+                         const UA_NodeId *sessionId,
+                         void *sessionContext,
+                         const UA_NodeId *nodeId,
+                         const UA_ReadProcessedDetails *details,
+                         const UA_NodeId *aggregateType,
+                         size_t maxSize,
+                         UA_TimestampsToReturn timestampsToReturn,
+                         const UA_ByteString *continuationPoint,
+                         UA_ByteString *outContinuationPoint,
+                         UA_HistoryData *historyData);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORY_AGGREGATES_H_ */
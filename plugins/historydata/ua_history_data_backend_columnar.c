@@ -0,0 +1,1392 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_columnar.h>
+
+#include "ua_history_nodeid_index.h"
+
+#include <string.h>
+
+/* Bit Streams
+ * ~~~~~~~~~~~
+ * The columns are bit streams that are written and read MSB-first. Space is
+ * reserved before a sample is appended. So the writing itself cannot fail. */
+
+typedef struct {
+    UA_Byte *data;
+    size_t size; /* Allocated bytes */
+    size_t bits; /* Written bits */
+} ColumnarBits;
+
+typedef struct {
+    const UA_Byte *data;
+    size_t pos; /* Read bits */
+} ColumnarReader;
+
+/* Maximum size of a signed value in the variable length encoding */
+#define COLUMNAR_SIGNED_MAXBITS 68
+
+/* Maximum size of a XOR'ed floating point value */
+#define COLUMNAR_FLOAT_MAXBITS 78
+
+static UA_StatusCode
+ColumnarBits_reserve(ColumnarBits *b, size_t bits) {
+    size_t required = (b->bits + bits + 7) / 8;
+    if(required <= b->size)
+        return UA_STATUSCODE_GOOD;
+    size_t newSize = b->size * 2;
+    if(newSize < required)
+        newSize = required + 64;
+    UA_Byte *data = (UA_Byte*)UA_realloc(b->data, newSize);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    memset(&data[b->size], 0, newSize - b->size);
+    b->data = data;
+    b->size = newSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Release the unused space at the end */
+static void
+ColumnarBits_shrink(ColumnarBits *b) {
+    size_t used = (b->bits + 7) / 8;
+    if(used == b->size)
+        return;
+    if(used == 0) {
+        UA_free(b->data);
+        b->data = NULL;
+        b->size = 0;
+        return;
+    }
+    UA_Byte *data = (UA_Byte*)UA_realloc(b->data, used);
+    if(!data)
+        return;
+    b->data = data;
+    b->size = used;
+}
+
+/* Append the n least significant bits of v */
+static void
+ColumnarBits_write(ColumnarBits *b, UA_UInt64 v, size_t n) {
+    while(n > 0) {
+        size_t space = 8 - (b->bits & 7);
+        size_t take = (n < space) ? n : space;
+        UA_Byte part = (UA_Byte)((v >> (n - take)) & ((1u << take) - 1));
+        b->data[b->bits >> 3] |= (UA_Byte)(part << (space - take));
+        b->bits += take;
+        n -= take;
+    }
+}
+
+static UA_UInt64
+ColumnarReader_read(ColumnarReader *r, size_t n) {
+    UA_UInt64 v = 0;
+    while(n > 0) {
+        size_t avail = 8 - (r->pos & 7);
+        size_t take = (n < avail) ? n : avail;
+        UA_Byte part = (UA_Byte)((r->data[r->pos >> 3] >> (avail - take)) &
+                                 ((1u << take) - 1));
+        v = (v << take) | part;
+        r->pos += take;
+        n -= take;
+    }
+    return v;
+}
+
+/* Signed values are written with a prefix that selects the number of bits. A
+ * zero (the delta-of-delta of a fixed sampling interval) needs a single bit:
+ *
+ *   0                  -> 0
+ *   10   + 14 bits     -> [-2^13, 2^13)
+ *   110  + 24 bits     -> [-2^23, 2^23)
+ *   1110 + 32 bits     -> [-2^31, 2^31)
+ *   1111 + 64 bits     -> everything else */
+
+static UA_Boolean
+fitsSigned(UA_Int64 v, size_t bits) {
+    UA_Int64 limit = (UA_Int64)1 << (bits - 1);
+    return (v >= -limit && v < limit);
+}
+
+static UA_Int64
+signExtend(UA_UInt64 v, size_t bits) {
+    UA_UInt64 sign = (UA_UInt64)1 << (bits - 1);
+    return (UA_Int64)((v ^ sign) - sign);
+}
+
+static void
+ColumnarBits_writeSigned(ColumnarBits *b, UA_Int64 v) {
+    UA_UInt64 u = (UA_UInt64)v;
+    if(v == 0) {
+        ColumnarBits_write(b, 0, 1);
+    } else if(fitsSigned(v, 14)) {
+        ColumnarBits_write(b, ((UA_UInt64)0x2 << 14) | (u & 0x3fff), 16);
+    } else if(fitsSigned(v, 24)) {
+        ColumnarBits_write(b, ((UA_UInt64)0x6 << 24) | (u & 0xffffff), 27);
+    } else if(fitsSigned(v, 32)) {
+        ColumnarBits_write(b, ((UA_UInt64)0xe << 32) | (u & 0xffffffff), 36);
+    } else {
+        ColumnarBits_write(b, 0xf, 4);
+        ColumnarBits_write(b, u, 64);
+    }
+}
+
+static UA_Int64
+ColumnarReader_readSigned(ColumnarReader *r) {
+    if(ColumnarReader_read(r, 1) == 0)
+        return 0;
+    if(ColumnarReader_read(r, 1) == 0)
+        return signExtend(ColumnarReader_read(r, 14), 14);
+    if(ColumnarReader_read(r, 1) == 0)
+        return signExtend(ColumnarReader_read(r, 24), 24);
+    if(ColumnarReader_read(r, 1) == 0)
+        return signExtend(ColumnarReader_read(r, 32), 32);
+    return (UA_Int64)ColumnarReader_read(r, 64);
+}
+
+static UA_Byte
+leadingZeros(UA_UInt64 x) {
+    UA_Byte n = 0;
+    while(n < 64 && !(x & ((UA_UInt64)1 << (63 - n))))
+        n++;
+    return n;
+}
+
+static UA_Byte
+trailingZeros(UA_UInt64 x) {
+    UA_Byte n = 0;
+    while(n < 64 && !(x & ((UA_UInt64)1 << n)))
+        n++;
+    return n;
+}
+
+/* Numeric Values
+ * ~~~~~~~~~~~~~~
+ * Scalar numeric values are stored as 64bit patterns. Floating point values are
+ * XOR'ed with the previous value. Integers are delta encoded. */
+
+static UA_Boolean
+isNumericScalar(const UA_Variant *v) {
+    if(!v->type || !UA_Variant_isScalar(v))
+        return false;
+    /* Only the builtin types. Not the aliases (e.g. UtcTime) and enums. */
+    if(v->type->typeKind > UA_DATATYPEKIND_DIAGNOSTICINFO ||
+       v->type != &UA_TYPES[v->type->typeKind])
+        return false;
+    switch(v->type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+    case UA_DATATYPEKIND_SBYTE:
+    case UA_DATATYPEKIND_BYTE:
+    case UA_DATATYPEKIND_INT16:
+    case UA_DATATYPEKIND_UINT16:
+    case UA_DATATYPEKIND_INT32:
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_INT64:
+    case UA_DATATYPEKIND_UINT64:
+    case UA_DATATYPEKIND_FLOAT:
+    case UA_DATATYPEKIND_DOUBLE:
+    case UA_DATATYPEKIND_DATETIME:
+    case UA_DATATYPEKIND_STATUSCODE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static UA_Boolean
+isFloat(const UA_DataType *type) {
+    return (type->typeKind == UA_DATATYPEKIND_FLOAT ||
+            type->typeKind == UA_DATATYPEKIND_DOUBLE);
+}
+
+static UA_UInt64
+numericToBits(const UA_DataType *type, const void *p) {
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+        return (*(const UA_Boolean*)p) ? 1 : 0;
+    case UA_DATATYPEKIND_SBYTE:
+        return (UA_UInt64)(UA_Int64)*(const UA_SByte*)p;
+    case UA_DATATYPEKIND_BYTE:
+        return *(const UA_Byte*)p;
+    case UA_DATATYPEKIND_INT16:
+        return (UA_UInt64)(UA_Int64)*(const UA_Int16*)p;
+    case UA_DATATYPEKIND_UINT16:
+        return *(const UA_UInt16*)p;
+    case UA_DATATYPEKIND_INT32:
+        return (UA_UInt64)(UA_Int64)*(const UA_Int32*)p;
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_STATUSCODE:
+        return *(const UA_UInt32*)p;
+    case UA_DATATYPEKIND_FLOAT: {
+        UA_UInt32 f;
+        memcpy(&f, p, sizeof(UA_UInt32));
+        return f;
+    }
+    default: { /* Int64, UInt64, Double, DateTime */
+        UA_UInt64 u;
+        memcpy(&u, p, sizeof(UA_UInt64));
+        return u;
+    }
+    }
+}
+
+static void
+bitsToNumeric(const UA_DataType *type, UA_UInt64 v, void *p) {
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+        *(UA_Boolean*)p = (v != 0);
+        break;
+    case UA_DATATYPEKIND_SBYTE:
+        *(UA_SByte*)p = (UA_SByte)(UA_Int64)v;
+        break;
+    case UA_DATATYPEKIND_BYTE:
+        *(UA_Byte*)p = (UA_Byte)v;
+        break;
+    case UA_DATATYPEKIND_INT16:
+        *(UA_Int16*)p = (UA_Int16)(UA_Int64)v;
+        break;
+    case UA_DATATYPEKIND_UINT16:
+        *(UA_UInt16*)p = (UA_UInt16)v;
+        break;
+    case UA_DATATYPEKIND_INT32:
+        *(UA_Int32*)p = (UA_Int32)(UA_Int64)v;
+        break;
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_STATUSCODE:
+        *(UA_UInt32*)p = (UA_UInt32)v;
+        break;
+    case UA_DATATYPEKIND_FLOAT: {
+        UA_UInt32 f = (UA_UInt32)v;
+        memcpy(p, &f, sizeof(UA_UInt32));
+        break;
+    }
+    default:
+        memcpy(p, &v, sizeof(UA_UInt64));
+        break;
+    }
+}
+
+/* Samples without picoseconds and with an empty or numeric scalar value are
+ * stored in the columns. All others in their binary encoding. */
+static UA_Boolean
+isColumnar(const UA_DataValue *value) {
+    if(value->hasSourcePicoseconds || value->hasServerPicoseconds)
+        return false;
+    return (!value->hasValue || isNumericScalar(&value->value));
+}
+
+/* Chunks
+ * ~~~~~~ */
+
+#define COLUMNAR_HASVALUE  0x01
+#define COLUMNAR_HASSTATUS 0x02
+#define COLUMNAR_HASSOURCE 0x04
+#define COLUMNAR_HASSERVER 0x08
+
+/* Run of samples with the same status and flags */
+typedef struct {
+    UA_StatusCode status;
+    UA_Byte flags;
+    size_t count;
+} ColumnarRun;
+
+typedef struct {
+    size_t startIndex; /* Index of the first sample in the history of the node */
+    size_t count;
+    UA_DateTime first; /* Key timestamps */
+    UA_DateTime last;
+
+    /* Either all samples of the chunk are stored in the columns or in their
+     * binary encoding */
+    UA_Boolean encoded;
+    const UA_DataType *type; /* Type of the numeric values. NULL until a sample
+                              * with a value was added. */
+
+    ColumnarBits timestamps; /* Delta-of-delta of the key timestamps */
+    ColumnarBits offsets;    /* Server timestamp relative to the source
+                              * timestamp (delta encoded) */
+    ColumnarBits values;     /* Numeric values or binary encoded DataValues */
+    ColumnarRun *runs;       /* Status and flags (run-length encoded) */
+    size_t runsSize;
+    size_t runsCapacity;
+
+    /* Encoder state for appending */
+    UA_Int64 lastDelta;
+    UA_Int64 lastOffset;
+    UA_UInt64 lastValue;
+    UA_Byte lastLeading; /* 0xff if no window for the XOR'ed values yet */
+    UA_Byte lastTrailing;
+} ColumnarChunk;
+
+static void
+ColumnarChunk_init(ColumnarChunk *c) {
+    memset(c, 0, sizeof(ColumnarChunk));
+    c->lastLeading = 0xff;
+}
+
+static void
+ColumnarChunk_clear(ColumnarChunk *c) {
+    UA_free(c->timestamps.data);
+    UA_free(c->offsets.data);
+    UA_free(c->values.data);
+    UA_free(c->runs);
+    ColumnarChunk_init(c);
+}
+
+static void
+ColumnarChunk_shrink(ColumnarChunk *c) {
+    ColumnarBits_shrink(&c->timestamps);
+    ColumnarBits_shrink(&c->offsets);
+    ColumnarBits_shrink(&c->values);
+    if(c->runsSize < c->runsCapacity && c->runsSize > 0) {
+        ColumnarRun *runs = (ColumnarRun*)
+            UA_realloc(c->runs, c->runsSize * sizeof(ColumnarRun));
+        if(runs) {
+            c->runs = runs;
+            c->runsCapacity = c->runsSize;
+        }
+    }
+}
+
+static UA_Boolean
+ColumnarChunk_fits(const ColumnarChunk *c, const UA_DataValue *value,
+                   size_t chunkSize) {
+    if(c->count >= chunkSize)
+        return false;
+    if(c->count == 0)
+        return true;
+    UA_Boolean columnar = isColumnar(value);
+    if(c->encoded)
+        return !columnar;
+    if(!columnar)
+        return false;
+    return (!value->hasValue || !c->type || c->type == value->value.type);
+}
+
+static void
+ColumnarChunk_writeFloat(ColumnarChunk *c, UA_UInt64 v) {
+    UA_UInt64 x = v ^ c->lastValue;
+    c->lastValue = v;
+    if(x == 0) {
+        ColumnarBits_write(&c->values, 0, 1);
+        return;
+    }
+
+    /* The meaningful bits fit into the previous window */
+    UA_Byte leading = leadingZeros(x);
+    UA_Byte trailing = trailingZeros(x);
+    if(c->lastLeading != 0xff && leading >= c->lastLeading &&
+       trailing >= c->lastTrailing) {
+        ColumnarBits_write(&c->values, 0x2, 2);
+        ColumnarBits_write(&c->values, x >> c->lastTrailing,
+                           (size_t)(64 - c->lastLeading - c->lastTrailing));
+        return;
+    }
+
+    /* New window */
+    size_t len = (size_t)(64 - leading - trailing);
+    ColumnarBits_write(&c->values, ((UA_UInt64)0x3 << 12) |
+                       ((UA_UInt64)leading << 6) | (len - 1), 14);
+    ColumnarBits_write(&c->values, x >> trailing, len);
+    c->lastLeading = leading;
+    c->lastTrailing = trailing;
+}
+
+static UA_StatusCode
+ColumnarChunk_appendEncoded(ColumnarChunk *c, const UA_DataValue *value) {
+    size_t encSize = UA_calcSizeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if(encSize > UA_UINT32_MAX)
+        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+    UA_StatusCode res = ColumnarBits_reserve(&c->values, (encSize + 4) * 8);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* The binary encoding is byte-aligned */
+    UA_ByteString buf;
+    buf.length = encSize;
+    buf.data = &c->values.data[(c->values.bits / 8) + 4];
+    res = UA_encodeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE], &buf);
+    if(res != UA_STATUSCODE_GOOD) {
+        memset(buf.data, 0, encSize);
+        return res;
+    }
+    ColumnarBits_write(&c->values, encSize, 32);
+    c->values.bits += encSize * 8;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+ColumnarChunk_append(ColumnarChunk *c, UA_DateTime key, const UA_DataValue *value) {
+    if(c->count == 0)
+        c->encoded = !isColumnar(value);
+
+    UA_StatusCode res = ColumnarBits_reserve(&c->timestamps, COLUMNAR_SIGNED_MAXBITS);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    if(c->encoded) {
+        res = ColumnarChunk_appendEncoded(c, value);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    } else {
+        UA_Byte flags = 0;
+        if(value->hasValue)
+            flags |= COLUMNAR_HASVALUE;
+        if(value->hasStatus)
+            flags |= COLUMNAR_HASSTATUS;
+        if(value->hasSourceTimestamp)
+            flags |= COLUMNAR_HASSOURCE;
+        if(value->hasServerTimestamp)
+            flags |= COLUMNAR_HASSERVER;
+        UA_StatusCode status = (value->hasStatus) ? value->status : UA_STATUSCODE_GOOD;
+        UA_Boolean hasOffset = (value->hasSourceTimestamp && value->hasServerTimestamp);
+
+        /* Reserve the space */
+        ColumnarRun *run = (c->runsSize > 0) ? &c->runs[c->runsSize - 1] : NULL;
+        UA_Boolean newRun = (!run || run->flags != flags || run->status != status);
+        if(newRun && c->runsSize == c->runsCapacity) {
+            size_t newCapacity = (c->runsCapacity == 0) ? 4 : c->runsCapacity * 2;
+            ColumnarRun *runs = (ColumnarRun*)
+                UA_realloc(c->runs, newCapacity * sizeof(ColumnarRun));
+            if(!runs)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            c->runs = runs;
+            c->runsCapacity = newCapacity;
+        }
+        if(hasOffset)
+            res |= ColumnarBits_reserve(&c->offsets, COLUMNAR_SIGNED_MAXBITS);
+        if(value->hasValue)
+            res |= ColumnarBits_reserve(&c->values, COLUMNAR_FLOAT_MAXBITS);
+        if(res != UA_STATUSCODE_GOOD)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+
+        /* Status and flags */
+        if(newRun) {
+            run = &c->runs[c->runsSize++];
+            run->status = status;
+            run->flags = flags;
+            run->count = 0;
+        }
+        run->count++;
+
+        /* Server timestamp */
+        if(hasOffset) {
+            UA_Int64 offset = value->serverTimestamp - value->sourceTimestamp;
+            ColumnarBits_writeSigned(&c->offsets, offset - c->lastOffset);
+            c->lastOffset = offset;
+        }
+
+        /* Value */
+        if(value->hasValue) {
+            if(!c->type)
+                c->type = value->value.type;
+            UA_UInt64 v = numericToBits(c->type, value->value.data);
+            if(isFloat(c->type)) {
+                ColumnarChunk_writeFloat(c, v);
+            } else {
+                ColumnarBits_writeSigned(&c->values, (UA_Int64)(v - c->lastValue));
+                c->lastValue = v;
+            }
+        }
+    }
+
+    /* Key timestamp */
+    if(c->count == 0) {
+        c->first = key;
+    } else {
+        UA_Int64 delta = key - c->last;
+        ColumnarBits_writeSigned(&c->timestamps, delta - c->lastDelta);
+        c->lastDelta = delta;
+    }
+    c->last = key;
+    c->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Decodes the samples of a chunk sequentially */
+typedef struct {
+    const ColumnarChunk *chunk;
+    ColumnarReader timestamps;
+    ColumnarReader offsets;
+    ColumnarReader values;
+    size_t pos;
+    size_t run;
+    size_t runPos;
+
+    UA_DateTime key;
+    UA_Int64 delta;
+    UA_Int64 offset;
+    UA_UInt64 value;
+    UA_Byte leading;
+    UA_Byte trailing;
+} ColumnarCursor;
+
+static void
+ColumnarCursor_init(ColumnarCursor *cur, const ColumnarChunk *c) {
+    memset(cur, 0, sizeof(ColumnarCursor));
+    cur->chunk = c;
+    cur->timestamps.data = c->timestamps.data;
+    cur->offsets.data = c->offsets.data;
+    cur->values.data = c->values.data;
+    cur->key = c->first;
+}
+
+static void
+ColumnarCursor_readFloat(ColumnarCursor *cur) {
+    if(ColumnarReader_read(&cur->values, 1) == 0)
+        return; /* Same value */
+    if(ColumnarReader_read(&cur->values, 1) == 1) {
+        cur->leading = (UA_Byte)ColumnarReader_read(&cur->values, 6);
+        size_t len = (size_t)ColumnarReader_read(&cur->values, 6) + 1;
+        cur->trailing = (UA_Byte)(64 - cur->leading - len);
+    }
+    size_t len = (size_t)(64 - cur->leading - cur->trailing);
+    cur->value ^= ColumnarReader_read(&cur->values, len) << cur->trailing;
+}
+
+/* Decode the next sample. The DataValue is only created if value is not
+ * NULL. */
+static UA_StatusCode
+ColumnarCursor_next(ColumnarCursor *cur, UA_DateTime *key, UA_DataValue *value) {
+    const ColumnarChunk *c = cur->chunk;
+
+    /* Key timestamp */
+    if(cur->pos > 0) {
+        cur->delta += ColumnarReader_readSigned(&cur->timestamps);
+        cur->key += cur->delta;
+    }
+    cur->pos++;
+    if(key)
+        *key = cur->key;
+
+    /* Binary encoded */
+    if(c->encoded) {
+        size_t len = (size_t)ColumnarReader_read(&cur->values, 32);
+        UA_StatusCode res = UA_STATUSCODE_GOOD;
+        if(value) {
+            UA_ByteString buf;
+            buf.length = len;
+            buf.data = (UA_Byte*)(uintptr_t)&cur->values.data[cur->values.pos / 8];
+            res = UA_decodeBinary(&buf, value, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
+        }
+        cur->values.pos += len * 8;
+        return res;
+    }
+
+    /* Status and flags */
+    const ColumnarRun *run = &c->runs[cur->run];
+    UA_Byte flags = run->flags;
+    UA_StatusCode status = run->status;
+    if(++cur->runPos >= run->count) {
+        cur->run++;
+        cur->runPos = 0;
+    }
+
+    /* Server timestamp */
+    if((flags & COLUMNAR_HASSOURCE) && (flags & COLUMNAR_HASSERVER))
+        cur->offset += ColumnarReader_readSigned(&cur->offsets);
+
+    /* Value */
+    if(flags & COLUMNAR_HASVALUE) {
+        if(isFloat(c->type))
+            ColumnarCursor_readFloat(cur);
+        else
+            cur->value += (UA_UInt64)ColumnarReader_readSigned(&cur->values);
+    }
+
+    if(!value)
+        return UA_STATUSCODE_GOOD;
+
+    UA_DataValue_init(value);
+    if(flags & COLUMNAR_HASSTATUS) {
+        value->hasStatus = true;
+        value->status = status;
+    }
+    if(flags & COLUMNAR_HASSOURCE) {
+        value->hasSourceTimestamp = true;
+        value->sourceTimestamp = cur->key;
+    }
+    if(flags & COLUMNAR_HASSERVER) {
+        value->hasServerTimestamp = true;
+        value->serverTimestamp = cur->key;
+        if(flags & COLUMNAR_HASSOURCE)
+            value->serverTimestamp += cur->offset;
+    }
+    if(flags & COLUMNAR_HASVALUE) {
+        void *data = UA_new(c->type);
+        if(!data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        bitsToNumeric(c->type, cur->value, data);
+        UA_Variant_setScalar(&value->value, data, c->type);
+        value->hasValue = true;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Decode the samples [from, to) of the chunk. The values array has to be
+ * zeroed. It can contain partially decoded values if this fails. */
+static UA_StatusCode
+ColumnarChunk_decode(const ColumnarChunk *c, size_t from, size_t to,
+                     UA_DateTime *keys, UA_DataValue *values) {
+    ColumnarCursor cur;
+    ColumnarCursor_init(&cur, c);
+    for(size_t i = 0; i < to; i++) {
+        UA_StatusCode res = (i < from) ?
+            ColumnarCursor_next(&cur, NULL, NULL) :
+            ColumnarCursor_next(&cur, &keys[i - from], &values[i - from]);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Nodes
+ * ~~~~~ */
+
+typedef struct {
+    UA_NodeId nodeId;
+    ColumnarChunk *chunks; /* Sorted by the key timestamps */
+    size_t chunksSize;
+    size_t chunksCapacity;
+    size_t count; /* Number of samples in all chunks */
+} ColumnarNode;
+
+typedef struct {
+    ColumnarNode *nodes;
+    size_t nodesSize;
+    size_t nodesCapacity;
+    UA_HistoryNodeIdIndex index; /* Position of the NodeIds in nodes */
+    size_t chunkSize;
+    UA_DataValue sample; /* Returned from getDataValue */
+} ColumnarContext;
+
+static void
+ColumnarNode_clear(ColumnarNode *n) {
+    UA_NodeId_clear(&n->nodeId);
+    for(size_t i = 0; i < n->chunksSize; i++)
+        ColumnarChunk_clear(&n->chunks[i]);
+    UA_free(n->chunks);
+    memset(n, 0, sizeof(ColumnarNode));
+}
+
+static void
+ColumnarContext_clear(ColumnarContext *ctx) {
+    for(size_t i = 0; i < ctx->nodesSize; i++)
+        ColumnarNode_clear(&ctx->nodes[i]);
+    UA_free(ctx->nodes);
+    UA_HistoryNodeIdIndex_clear(&ctx->index);
+    UA_DataValue_clear(&ctx->sample);
+    memset(ctx, 0, sizeof(ColumnarContext));
+}
+
+/* Returns NULL if the node is unknown and cannot be added */
+static ColumnarNode *
+getNode(ColumnarContext *ctx, const UA_NodeId *nodeId) {
+    size_t i = UA_HistoryNodeIdIndex_find(&ctx->index, ctx->nodes, nodeId);
+    if(i != UA_HISTORYNODEIDINDEX_NOTFOUND)
+        return &ctx->nodes[i];
+
+    if(ctx->nodesSize >= ctx->nodesCapacity) {
+        size_t newCapacity = (ctx->nodesCapacity == 0) ? 1 : ctx->nodesCapacity * 2;
+        ColumnarNode *nodes = (ColumnarNode*)
+            UA_realloc(ctx->nodes, newCapacity * sizeof(ColumnarNode));
+        if(!nodes)
+            return NULL;
+        ctx->nodes = nodes;
+        ctx->nodesCapacity = newCapacity;
+    }
+    ColumnarNode *n = &ctx->nodes[ctx->nodesSize];
+    memset(n, 0, sizeof(ColumnarNode));
+    if(UA_NodeId_copy(nodeId, &n->nodeId) != UA_STATUSCODE_GOOD)
+        return NULL;
+    if(UA_HistoryNodeIdIndex_add(&ctx->index, ctx->nodes,
+                                 ctx->nodesSize) != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&n->nodeId);
+        return NULL;
+    }
+    ctx->nodesSize++;
+    return n;
+}
+
+static void
+ColumnarNode_updateIndex(ColumnarNode *n, size_t fromChunk) {
+    size_t index = 0;
+    if(fromChunk > 0) {
+        const ColumnarChunk *prev = &n->chunks[fromChunk - 1];
+        index = prev->startIndex + prev->count;
+    }
+    for(size_t i = fromChunk; i < n->chunksSize; i++) {
+        n->chunks[i].startIndex = index;
+        index += n->chunks[i].count;
+    }
+    n->count = index;
+}
+
+/* The chunk that contains the sample. The index must be valid. */
+static size_t
+ColumnarNode_chunkByIndex(const ColumnarNode *n, size_t index) {
+    size_t lo = 0;
+    size_t hi = n->chunksSize;
+    while(lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if(n->chunks[mid].startIndex <= index)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo - 1;
+}
+
+/* Index of the first sample with a key timestamp >= timestamp (or > timestamp
+ * if after is set). Only the timestamp column is decoded. */
+static size_t
+ColumnarNode_search(const ColumnarNode *n, UA_DateTime timestamp,
+                    UA_Boolean after, UA_Boolean *found) {
+    *found = false;
+    size_t lo = 0;
+    size_t hi = n->chunksSize;
+    while(lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        UA_DateTime last = n->chunks[mid].last;
+        if((after) ? (last <= timestamp) : (last < timestamp))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if(lo == n->chunksSize)
+        return n->count;
+
+    const ColumnarChunk *c = &n->chunks[lo];
+    ColumnarReader r = {c->timestamps.data, 0};
+    UA_DateTime key = c->first;
+    UA_Int64 delta = 0;
+    for(size_t i = 0; i < c->count; i++) {
+        if(i > 0) {
+            delta += ColumnarReader_readSigned(&r);
+            key += delta;
+        }
+        if((after) ? (key > timestamp) : (key >= timestamp)) {
+            *found = (key == timestamp);
+            return c->startIndex + i;
+        }
+    }
+    return c->startIndex + c->count;
+}
+
+/* Decode the samples [lo, hi] into out. In reverse order if reverse is set. */
+static UA_StatusCode
+ColumnarNode_read(const ColumnarNode *n, size_t lo, size_t hi, UA_Boolean reverse,
+                  UA_NumericRange range, UA_DataValue *out) {
+    for(size_t ci = ColumnarNode_chunkByIndex(n, lo); ci < n->chunksSize; ci++) {
+        const ColumnarChunk *c = &n->chunks[ci];
+        if(c->startIndex > hi)
+            break;
+        ColumnarCursor cur;
+        ColumnarCursor_init(&cur, c);
+        for(size_t i = 0; i < c->count; i++) {
+            size_t index = c->startIndex + i;
+            if(index > hi)
+                break;
+            if(index < lo) {
+                ColumnarCursor_next(&cur, NULL, NULL);
+                continue;
+            }
+            UA_DataValue *target = (reverse) ? &out[hi - index] : &out[index - lo];
+            UA_StatusCode res = ColumnarCursor_next(&cur, NULL, target);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+            if(range.dimensionsSize == 0)
+                continue;
+            UA_Variant v = target->value;
+            UA_Variant_init(&target->value);
+            if(target->hasValue)
+                res = UA_Variant_copyRange(&v, &target->value, range);
+            UA_Variant_clear(&v);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static ColumnarChunk *
+ColumnarNode_addChunk(ColumnarNode *n) {
+    if(n->chunksSize >= n->chunksCapacity) {
+        size_t newCapacity = (n->chunksCapacity == 0) ? 4 : n->chunksCapacity * 2;
+        ColumnarChunk *chunks = (ColumnarChunk*)
+            UA_realloc(n->chunks, newCapacity * sizeof(ColumnarChunk));
+        if(!chunks)
+            return NULL;
+        n->chunks = chunks;
+        n->chunksCapacity = newCapacity;
+    }
+    ColumnarChunk *c = &n->chunks[n->chunksSize++];
+    ColumnarChunk_init(c);
+    c->startIndex = n->count;
+    return c;
+}
+
+/* Replace the chunks [pos, pos + replace) with new chunks for the samples */
+static UA_StatusCode
+ColumnarNode_replaceChunks(ColumnarContext *ctx, ColumnarNode *n,
+                           size_t pos, size_t replace, const UA_DateTime *keys,
+                           const UA_DataValue *values, size_t count) {
+    /* Distribute the samples evenly. Otherwise repeated inserts into a full
+     * chunk leave many small chunks behind. */
+    size_t target = ctx->chunkSize;
+    if(count > target) {
+        size_t chunks = (count + target - 1) / target;
+        target = (count + chunks - 1) / chunks;
+    }
+
+    /* Encode into new chunks first. So the node is unchanged if this fails. */
+    ColumnarNode tmp;
+    memset(&tmp, 0, sizeof(ColumnarNode));
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < count; i++) {
+        ColumnarChunk *c = (tmp.chunksSize > 0) ? &tmp.chunks[tmp.chunksSize - 1] : NULL;
+        if(!c || !ColumnarChunk_fits(c, &values[i], target)) {
+            c = ColumnarNode_addChunk(&tmp);
+            if(!c) {
+                res = UA_STATUSCODE_BADOUTOFMEMORY;
+                goto cleanup;
+            }
+        }
+        res = ColumnarChunk_append(c, keys[i], &values[i]);
+        if(res != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
+
+    /* Make room */
+    size_t total = n->chunksSize - replace + tmp.chunksSize;
+    if(total > n->chunksCapacity) {
+        ColumnarChunk *chunks = (ColumnarChunk*)
+            UA_realloc(n->chunks, total * sizeof(ColumnarChunk));
+        if(!chunks) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto cleanup;
+        }
+        n->chunks = chunks;
+        n->chunksCapacity = total;
+    }
+
+    /* Splice the new chunks in */
+    for(size_t i = pos; i < pos + replace; i++)
+        ColumnarChunk_clear(&n->chunks[i]);
+    memmove(&n->chunks[pos + tmp.chunksSize], &n->chunks[pos + replace],
+            (n->chunksSize - pos - replace) * sizeof(ColumnarChunk));
+    for(size_t i = 0; i < tmp.chunksSize; i++) {
+        ColumnarChunk_shrink(&tmp.chunks[i]);
+        n->chunks[pos + i] = tmp.chunks[i];
+    }
+    n->chunksSize = total;
+    tmp.chunksSize = 0;
+    ColumnarNode_updateIndex(n, pos);
+
+ cleanup:
+    ColumnarNode_clear(&tmp);
+    return res;
+}
+
+static UA_StatusCode
+ColumnarNode_insert(ColumnarContext *ctx, ColumnarNode *n,
+                    UA_DateTime key, const UA_DataValue *value) {
+    /* Append to the last chunk. This is the common case. */
+    ColumnarChunk *c = (n->chunksSize > 0) ? &n->chunks[n->chunksSize - 1] : NULL;
+    if(!c || key >= c->last) {
+        if(!c || !ColumnarChunk_fits(c, value, ctx->chunkSize)) {
+            if(c)
+                ColumnarChunk_shrink(c);
+            c = ColumnarNode_addChunk(n);
+            if(!c)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        UA_StatusCode res = ColumnarChunk_append(c, key, value);
+        if(res != UA_STATUSCODE_GOOD) {
+            if(c->count == 0)
+                n->chunksSize--;
+            return res;
+        }
+        n->count++;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Insert before the first sample with the same or a later timestamp.
+     * Decode and re-encode the chunk. */
+    UA_Boolean found;
+    size_t index = ColumnarNode_search(n, key, false, &found);
+    size_t pos = ColumnarNode_chunkByIndex(n, index);
+    c = &n->chunks[pos];
+    size_t offset = index - c->startIndex;
+    size_t count = c->count + 1;
+    UA_DateTime *keys = (UA_DateTime*)UA_malloc(count * sizeof(UA_DateTime));
+    UA_DataValue *values = (UA_DataValue*)
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_StatusCode res = UA_STATUSCODE_BADOUTOFMEMORY;
+    if(!keys || !values)
+        goto cleanup;
+    ColumnarCursor cur;
+    ColumnarCursor_init(&cur, c);
+    for(size_t i = 0; i < count; i++) {
+        if(i == offset)
+            continue;
+        res = ColumnarCursor_next(&cur, &keys[i], &values[i]);
+        if(res != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
+    keys[offset] = key;
+    values[offset] = *value; /* Shallow copy, only read during the encoding */
+    res = ColumnarNode_replaceChunks(ctx, n, pos, 1, keys, values, count);
+    UA_DataValue_init(&values[offset]);
+
+ cleanup:
+    UA_free(keys);
+    UA_Array_delete(values, count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    return res;
+}
+
+static UA_StatusCode
+ColumnarNode_replace(ColumnarContext *ctx, ColumnarNode *n,
+                     size_t index, const UA_DataValue *value) {
+    size_t pos = ColumnarNode_chunkByIndex(n, index);
+    const ColumnarChunk *c = &n->chunks[pos];
+    size_t count = c->count;
+    UA_DateTime *keys = (UA_DateTime*)UA_malloc(count * sizeof(UA_DateTime));
+    UA_DataValue *values = (UA_DataValue*)
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_StatusCode res = UA_STATUSCODE_BADOUTOFMEMORY;
+    if(!keys || !values)
+        goto cleanup;
+    res = ColumnarChunk_decode(c, 0, count, keys, values);
+    if(res != UA_STATUSCODE_GOOD)
+        goto cleanup;
+    size_t offset = index - c->startIndex;
+    UA_DataValue old = values[offset];
+    values[offset] = *value; /* Shallow copy, only read during the encoding */
+    res = ColumnarNode_replaceChunks(ctx, n, pos, 1, keys, values, count);
+    values[offset] = old;
+
+ cleanup:
+    UA_free(keys);
+    UA_Array_delete(values, count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    return res;
+}
+
+/* Remove the samples [from, to) */
+static UA_StatusCode
+ColumnarNode_remove(ColumnarContext *ctx, ColumnarNode *n, size_t from, size_t to) {
+    size_t first = ColumnarNode_chunkByIndex(n, from);
+    size_t last = ColumnarNode_chunkByIndex(n, to - 1);
+    const ColumnarChunk *fc = &n->chunks[first];
+    const ColumnarChunk *lc = &n->chunks[last];
+
+    /* Re-encode the remaining samples of the first and last chunk. The chunks
+     * in between are dropped without decoding. */
+    size_t front = from - fc->startIndex;
+    size_t back = lc->startIndex + lc->count - to;
+    size_t count = front + back;
+    UA_DateTime *keys = NULL;
+    UA_DataValue *values = NULL;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(count > 0) {
+        keys = (UA_DateTime*)UA_malloc(count * sizeof(UA_DateTime));
+        values = (UA_DataValue*)UA_Array_new(count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        if(!keys || !values) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto cleanup;
+        }
+        res = ColumnarChunk_decode(fc, 0, front, keys, values);
+        res |= ColumnarChunk_decode(lc, lc->count - back, lc->count,
+                                    &keys[front], &values[front]);
+        if(res != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
+    res = ColumnarNode_replaceChunks(ctx, n, first, last - first + 1,
+                                     keys, values, count);
+
+ cleanup:
+    UA_free(keys);
+    UA_Array_delete(values, count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    return res;
+}
+
+/* Backend Interface
+ * ~~~~~~~~~~~~~~~~~ */
+
+static const UA_DataValue *
+ColumnarContext_sample(ColumnarContext *ctx, const ColumnarNode *n, size_t index) {
+    UA_DataValue_clear(&ctx->sample);
+    if(!n || index >= n->count)
+        return &ctx->sample;
+    UA_NumericRange range = {0, NULL};
+    ColumnarNode_read(n, index, index, false, range, &ctx->sample);
+    return &ctx->sample;
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_columnar(UA_Server *server,
+                                      void *context,
+                                      const UA_NodeId *sessionId,
+                                      void *sessionContext,
+                                      const UA_NodeId *nodeId,
+                                      UA_Boolean historizing,
+                                      const UA_DataValue *value) {
+    ColumnarContext *ctx = (ColumnarContext*)context;
+    ColumnarNode *n = getNode(ctx, nodeId);
+    if(!n)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_DateTime timestamp;
+    if(value->hasSourceTimestamp)
+        timestamp = value->sourceTimestamp;
+    else if(value->hasServerTimestamp)
+        timestamp = value->serverTimestamp;
+    else
+        timestamp = UA_DateTime_now();
+    return ColumnarNode_insert(ctx, n, timestamp, value);
+}
+
+static size_t
+getEnd_backend_columnar(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    const ColumnarNode *n = getNode((ColumnarContext*)context, nodeId);
+    return (n) ? n->count : 0;
+}
+
+static size_t
+lastIndex_backend_columnar(UA_Server *server,
+                           void *context,
+                           const UA_NodeId *sessionId,
+                           void *sessionContext,
+                           const UA_NodeId *nodeId) {
+    const ColumnarNode *n = getNode((ColumnarContext*)context, nodeId);
+    if(!n || n->count == 0)
+        return 0;
+    return n->count - 1;
+}
+
+static size_t
+firstIndex_backend_columnar(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static size_t
+resultSize_backend_columnar(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId,
+                            size_t startIndex,
+                            size_t endIndex) {
+    const ColumnarNode *n = getNode((ColumnarContext*)context, nodeId);
+    if(!n || n->count == 0 || startIndex == n->count || endIndex == n->count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getDateTimeMatch_backend_columnar(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  const UA_DateTime timestamp,
+                                  const MatchStrategy strategy) {
+    const ColumnarNode *n = getNode((ColumnarContext*)context, nodeId);
+    if(!n)
+        return 0;
+    UA_Boolean found;
+    size_t current = ColumnarNode_search(n, timestamp, false, &found);
+    switch(strategy) {
+    case MATCH_EQUAL:
+        return (found) ? current : n->count;
+    case MATCH_AFTER:
+        return ColumnarNode_search(n, timestamp, true, &found);
+    case MATCH_EQUAL_OR_AFTER:
+        return current;
+    case MATCH_EQUAL_OR_BEFORE:
+        if(found)
+            return current;
+        return (current > 0) ? current - 1 : n->count;
+    case MATCH_BEFORE:
+        return (current > 0) ? current - 1 : n->count;
+    default:
+        return n->count;
+    }
+}
+
+static UA_StatusCode
+copyDataValues_backend_columnar(UA_Server *server,
+                                void *context,
+                                const UA_NodeId *sessionId,
+                                void *sessionContext,
+                                const UA_NodeId *nodeId,
+                                size_t startIndex,
+                                size_t endIndex,
+                                UA_Boolean reverse,
+                                size_t maxValues,
+                                UA_NumericRange range,
+                                UA_Boolean releaseContinuationPoints,
+                                const UA_ByteString *continuationPoint,
+                                UA_ByteString *outContinuationPoint,
+                                size_t *providedValues,
+                                UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&skip, continuationPoint->data, sizeof(size_t));
+    }
+
+    const ColumnarNode *n = getNode((ColumnarContext*)context, nodeId);
+    if(!n)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Compute the range of samples [lo, hi] that is decoded */
+    size_t counter = 0;
+    size_t lo = 0;
+    size_t hi = 0;
+    if(reverse) {
+        if(startIndex < n->count && startIndex >= endIndex &&
+           startIndex - endIndex + 1 > skip) {
+            hi = startIndex - skip;
+            counter = hi - endIndex + 1;
+            if(counter > maxValues)
+                counter = maxValues;
+            lo = hi + 1 - counter;
+        }
+    } else {
+        if(endIndex >= startIndex && endIndex < n->count &&
+           endIndex - startIndex + 1 > skip) {
+            lo = startIndex + skip;
+            counter = endIndex - lo + 1;
+            if(counter > maxValues)
+                counter = maxValues;
+            hi = lo + counter - 1;
+        }
+    }
+
+    if(counter > 0) {
+        UA_StatusCode res = ColumnarNode_read(n, lo, hi, reverse, range, values);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if((!reverse && (endIndex-startIndex-skip+1) > counter) ||
+       (reverse && (startIndex-endIndex-skip+1) > counter)) {
+        outContinuationPoint->data = (UA_Byte*)UA_malloc(sizeof(size_t));
+        if(!outContinuationPoint->data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        outContinuationPoint->length = sizeof(size_t);
+        size_t next = skip + counter;
+        memcpy(outContinuationPoint->data, &next, sizeof(size_t));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_DataValue *
+getDataValue_backend_columnar(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              size_t index) {
+    ColumnarContext *ctx = (ColumnarContext*)context;
+    return ColumnarContext_sample(ctx, getNode(ctx, nodeId), index);
+}
+
+static UA_Boolean
+boundSupported_backend_columnar(UA_Server *server,
+                                void *context,
+                                const UA_NodeId *sessionId,
+                                void *sessionContext,
+                                const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_columnar(UA_Server *server,
+                                             void *context,
+                                             const UA_NodeId *sessionId,
+                                             void *sessionContext,
+                                             const UA_NodeId *nodeId,
+                                             const UA_TimestampsToReturn timestampsToReturn) {
+    ColumnarContext *ctx = (ColumnarContext*)context;
+    const ColumnarNode *n = getNode(ctx, nodeId);
+    if(!n || n->count == 0)
+        return true;
+    const UA_DataValue *first = ColumnarContext_sample(ctx, n, 0);
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_INVALID ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER &&
+        !first->hasServerTimestamp) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE &&
+        !first->hasSourceTimestamp) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH &&
+        !(first->hasSourceTimestamp && first->hasServerTimestamp)))
+        return false;
+    return true;
+}
+
+static UA_StatusCode
+insertDataValue_backend_columnar(UA_Server *server,
+                                 void *hdbContext,
+                                 const UA_NodeId *sessionId,
+                                 void *sessionContext,
+                                 const UA_NodeId *nodeId,
+                                 const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    const UA_DateTime timestamp = (value->hasSourceTimestamp) ?
+        value->sourceTimestamp : value->serverTimestamp;
+    ColumnarContext *ctx = (ColumnarContext*)hdbContext;
+    ColumnarNode *n = getNode(ctx, nodeId);
+    if(!n)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_Boolean found;
+    ColumnarNode_search(n, timestamp, false, &found);
+    if(found)
+        return UA_STATUSCODE_BADENTRYEXISTS;
+    return ColumnarNode_insert(ctx, n, timestamp, value);
+}
+
+static UA_StatusCode
+replaceDataValue_backend_columnar(UA_Server *server,
+                                  void *hdbContext,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    const UA_DateTime timestamp = (value->hasSourceTimestamp) ?
+        value->sourceTimestamp : value->serverTimestamp;
+    ColumnarContext *ctx = (ColumnarContext*)hdbContext;
+    ColumnarNode *n = getNode(ctx, nodeId);
+    if(!n)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_Boolean found;
+    size_t index = ColumnarNode_search(n, timestamp, false, &found);
+    if(!found)
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+    return ColumnarNode_replace(ctx, n, index, value);
+}
+
+static UA_StatusCode
+updateDataValue_backend_columnar(UA_Server *server,
+                                 void *hdbContext,
+                                 const UA_NodeId *sessionId,
+                                 void *sessionContext,
+                                 const UA_NodeId *nodeId,
+                                 const UA_DataValue *value) {
+    /* We first try to replace */
+    UA_StatusCode ret =
+        replaceDataValue_backend_columnar(server, hdbContext, sessionId,
+                                          sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYREPLACED;
+
+    ret = insertDataValue_backend_columnar(server, hdbContext, sessionId,
+                                           sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYINSERTED;
+    return ret;
+}
+
+static UA_StatusCode
+removeDataValue_backend_columnar(UA_Server *server,
+                                 void *hdbContext,
+                                 const UA_NodeId *sessionId,
+                                 void *sessionContext,
+                                 const UA_NodeId *nodeId,
+                                 UA_DateTime startTimestamp,
+                                 UA_DateTime endTimestamp) {
+    if(startTimestamp > endTimestamp)
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+    ColumnarContext *ctx = (ColumnarContext*)hdbContext;
+    ColumnarNode *n = getNode(ctx, nodeId);
+    if(!n)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* The first index which will be deleted and the first index which is not
+     * deleted */
+    UA_Boolean found;
+    size_t index1 = ColumnarNode_search(n, startTimestamp, false, &found);
+    size_t index2;
+    if(startTimestamp == endTimestamp) {
+        if(!found)
+            return UA_STATUSCODE_BADNODATA;
+        index2 = index1 + 1;
+    } else {
+        /* Up to (and excluding) the end timestamp */
+        index2 = ColumnarNode_search(n, endTimestamp, false, &found);
+        if(index1 == n->count || index1 >= index2)
+            return UA_STATUSCODE_BADNODATA;
+    }
+    return ColumnarNode_remove(ctx, n, index1, index2);
+}
+
+static void
+deleteMembers_backend_columnar(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    ColumnarContext_clear((ColumnarContext*)backend->context);
+    UA_free(backend->context);
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_Columnar(size_t initialNodeIdStoreSize, size_t chunkSize) {
+    if(initialNodeIdStoreSize == 0)
+        initialNodeIdStoreSize = 1;
+    if(chunkSize == 0)
+        chunkSize = COLUMNAR_CHUNK_SIZE;
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    ColumnarContext *ctx = (ColumnarContext*)UA_calloc(1, sizeof(ColumnarContext));
+    if(!ctx)
+        return result;
+    ctx->nodes = (ColumnarNode*)UA_calloc(initialNodeIdStoreSize, sizeof(ColumnarNode));
+    if(!ctx->nodes) {
+        UA_free(ctx);
+        return result;
+    }
+    ctx->nodesCapacity = initialNodeIdStoreSize;
+    UA_HistoryNodeIdIndex_init(&ctx->index, sizeof(ColumnarNode),
+                               offsetof(ColumnarNode, nodeId));
+    ctx->chunkSize = chunkSize;
+    result.serverSetHistoryData = &serverSetHistoryData_backend_columnar;
+    result.resultSize = &resultSize_backend_columnar;
+    result.getEnd = &getEnd_backend_columnar;
+    result.lastIndex = &lastIndex_backend_columnar;
+    result.firstIndex = &firstIndex_backend_columnar;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_columnar;
+    result.copyDataValues = &copyDataValues_backend_columnar;
+    result.getDataValue = &getDataValue_backend_columnar;
+    result.boundSupported = &boundSupported_backend_columnar;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_columnar;
+    result.insertDataValue = &insertDataValue_backend_columnar;
+    result.updateDataValue = &updateDataValue_backend_columnar;
+    result.replaceDataValue = &replaceDataValue_backend_columnar;
+    result.removeDataValue = &removeDataValue_backend_columnar;
+    result.deleteMembers = &deleteMembers_backend_columnar;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+}
+
+void
+UA_HistoryDataBackend_Columnar_clear(UA_HistoryDataBackend *backend) {
+    deleteMembers_backend_columnar(backend);
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
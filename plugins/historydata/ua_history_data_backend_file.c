@@ -0,0 +1,1547 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+
+#ifdef UA_ARCHITECTURE_POSIX
+
+#include "ua_history_nodeid_index.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Files
+ * ~~~~~
+ * The directory contains the WAL file "wal" and the sealed segments
+ * "<node>-<seq>.seg". The node number is the position of the NodeId in the
+ * WAL. Both file types begin with an 8 byte magic followed by records:
+ *
+ *   UInt32 length | UInt32 checksum | payload (length bytes)
+ *
+ * The payload of a segment record is the Int64 key timestamp followed by the
+ * binary encoded DataValue. The payload of a WAL record is
+ *
+ *   Byte op | UInt32 node | UInt32 a | UInt32 b | Int64 key | body
+ *
+ * with the binary encoded NodeId (NODE) or DataValue (INSERT, REPLACE) as the
+ * body. The positions in the WAL records are relative to the samples that are
+ * not yet sealed. All integers are little-endian. */
+
+#define FILE_MAGIC_SIZE 8
+#define FILE_RECORD_HEADER 8
+#define FILE_WAL_HEADER 21
+#define FILE_WAL_LIMIT (1 << 20)
+#define FILE_PATH_MAX 1024
+
+static const UA_Byte segmentMagic[FILE_MAGIC_SIZE] = {'U','A','H','S','E','G',0,1};
+static const UA_Byte walMagic[FILE_MAGIC_SIZE] = {'U','A','H','W','A','L',0,1};
+
+typedef enum {
+    FILE_WAL_NODE = 1,    /* a: -, b: - */
+    FILE_WAL_INSERT = 2,  /* a: position */
+    FILE_WAL_REPLACE = 3, /* a: position */
+    FILE_WAL_REMOVE = 4,  /* a: first removed position, b: first kept position */
+    FILE_WAL_SEAL = 5,    /* a: segment sequence number */
+    FILE_WAL_DROP = 6     /* a: segment sequence number */
+} FileWalOp;
+
+typedef struct {
+    UA_Byte op;
+    UA_UInt32 node;
+    UA_UInt32 a;
+    UA_UInt32 b;
+    UA_DateTime key;
+    const UA_NodeId *nodeId;
+    const UA_DataValue *value;
+} FileWalRecord;
+
+static void
+writeUInt32(UA_Byte *p, UA_UInt32 v) {
+    p[0] = (UA_Byte)v;
+    p[1] = (UA_Byte)(v >> 8);
+    p[2] = (UA_Byte)(v >> 16);
+    p[3] = (UA_Byte)(v >> 24);
+}
+
+static UA_UInt32
+readUInt32(const UA_Byte *p) {
+    return (UA_UInt32)p[0] | ((UA_UInt32)p[1] << 8) |
+        ((UA_UInt32)p[2] << 16) | ((UA_UInt32)p[3] << 24);
+}
+
+static void
+writeInt64(UA_Byte *p, UA_Int64 v) {
+    writeUInt32(p, (UA_UInt32)((UA_UInt64)v & 0xffffffff));
+    writeUInt32(p + 4, (UA_UInt32)((UA_UInt64)v >> 32));
+}
+
+static UA_Int64
+readInt64(const UA_Byte *p) {
+    return (UA_Int64)((UA_UInt64)readUInt32(p) | ((UA_UInt64)readUInt32(p + 4) << 32));
+}
+
+/* Returns the size of the record at the offset. Zero if the record is
+ * truncated or the checksum does not match. */
+static size_t
+checkRecord(const UA_Byte *data, size_t size, size_t offset) {
+    if(size - offset < FILE_RECORD_HEADER)
+        return 0;
+    size_t length = readUInt32(&data[offset]);
+    if(length > size - offset - FILE_RECORD_HEADER)
+        return 0;
+    const UA_Byte *payload = &data[offset + FILE_RECORD_HEADER];
+    if(readUInt32(&data[offset + 4]) != UA_ByteString_hash(0, payload, length))
+        return 0;
+    return FILE_RECORD_HEADER + length;
+}
+
+/* Buffers
+ * ~~~~~~~ */
+
+typedef struct {
+    UA_Byte *data;
+    size_t length;
+    size_t capacity;
+} FileBuffer;
+
+static void
+FileBuffer_clear(FileBuffer *b) {
+    UA_free(b->data);
+    memset(b, 0, sizeof(FileBuffer));
+}
+
+static UA_StatusCode
+FileBuffer_reserve(FileBuffer *b, size_t size) {
+    if(b->length + size <= b->capacity)
+        return UA_STATUSCODE_GOOD;
+    size_t newCapacity = (b->capacity == 0) ? 256 : b->capacity;
+    while(newCapacity < b->length + size)
+        newCapacity *= 2;
+    UA_Byte *data = (UA_Byte*)UA_realloc(b->data, newCapacity);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    b->data = data;
+    b->capacity = newCapacity;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+FileBuffer_append(FileBuffer *b, const UA_Byte *data, size_t size) {
+    UA_StatusCode res = FileBuffer_reserve(b, size);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    memcpy(&b->data[b->length], data, size);
+    b->length += size;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+FileBuffer_appendEncoded(FileBuffer *b, const void *p, const UA_DataType *type) {
+    size_t size = UA_calcSizeBinary(p, type);
+    UA_StatusCode res = FileBuffer_reserve(b, size);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_ByteString out = {size, &b->data[b->length]};
+    res = UA_encodeBinary(p, type, &out);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    b->length += out.length;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Reserve space for the record header. Returns the offset of the record. */
+static UA_StatusCode
+FileBuffer_beginRecord(FileBuffer *b, size_t *offset) {
+    UA_StatusCode res = FileBuffer_reserve(b, FILE_RECORD_HEADER);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    *offset = b->length;
+    b->length += FILE_RECORD_HEADER;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+FileBuffer_endRecord(FileBuffer *b, size_t offset) {
+    size_t length = b->length - offset - FILE_RECORD_HEADER;
+    const UA_Byte *payload = &b->data[offset + FILE_RECORD_HEADER];
+    writeUInt32(&b->data[offset], (UA_UInt32)length);
+    writeUInt32(&b->data[offset + 4], UA_ByteString_hash(0, payload, length));
+}
+
+static UA_StatusCode
+FileBuffer_appendSample(FileBuffer *b, UA_DateTime key, const UA_DataValue *value) {
+    size_t offset;
+    UA_Byte k[8];
+    writeInt64(k, key);
+    UA_StatusCode res = FileBuffer_beginRecord(b, &offset);
+    res |= FileBuffer_append(b, k, 8);
+    res |= FileBuffer_appendEncoded(b, value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if(res != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    FileBuffer_endRecord(b, offset);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+FileBuffer_appendWalRecord(FileBuffer *b, const FileWalRecord *r) {
+    size_t offset;
+    UA_Byte h[FILE_WAL_HEADER];
+    h[0] = r->op;
+    writeUInt32(&h[1], r->node);
+    writeUInt32(&h[5], r->a);
+    writeUInt32(&h[9], r->b);
+    writeInt64(&h[13], r->key);
+    UA_StatusCode res = FileBuffer_beginRecord(b, &offset);
+    res |= FileBuffer_append(b, h, FILE_WAL_HEADER);
+    if(r->nodeId)
+        res |= FileBuffer_appendEncoded(b, r->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    if(r->value)
+        res |= FileBuffer_appendEncoded(b, r->value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if(res != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    FileBuffer_endRecord(b, offset);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* File Operations
+ * ~~~~~~~~~~~~~~~ */
+
+static UA_StatusCode
+writeAll(int fd, const UA_Byte *data, size_t size) {
+    while(size > 0) {
+        ssize_t n = write(fd, data, size);
+        if(n < 0) {
+            if(errno == EINTR)
+                continue;
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+syncDirectory(const char *directory) {
+    int fd = open(directory, O_RDONLY);
+    if(fd < 0)
+        return;
+    fsync(fd);
+    close(fd);
+}
+
+/* Write to a temporary file and rename. So the file is replaced atomically. */
+static UA_StatusCode
+writeFileAtomic(const char *directory, const char *path, const FileBuffer *b) {
+    char tmp[FILE_PATH_MAX + 4];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_StatusCode res = writeAll(fd, b->data, b->length);
+    if(res == UA_STATUSCODE_GOOD && fsync(fd) != 0)
+        res = UA_STATUSCODE_BADINTERNALERROR;
+    close(fd);
+    if(res == UA_STATUSCODE_GOOD && rename(tmp, path) != 0)
+        res = UA_STATUSCODE_BADINTERNALERROR;
+    if(res != UA_STATUSCODE_GOOD) {
+        unlink(tmp);
+        return res;
+    }
+    syncDirectory(directory);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Segments
+ * ~~~~~~~~ */
+
+typedef struct {
+    UA_UInt32 seq;
+    size_t startIndex;
+    size_t count;
+    UA_DateTime *keys;
+    size_t *offsets; /* Record offsets in the mapping */
+    UA_Byte *map;
+    size_t mapSize;
+} FileSegment;
+
+static void
+FileSegment_clear(FileSegment *s) {
+    if(s->map)
+        munmap(s->map, s->mapSize);
+    UA_free(s->keys);
+    UA_free(s->offsets);
+    UA_UInt32 seq = s->seq;
+    memset(s, 0, sizeof(FileSegment));
+    s->seq = seq;
+}
+
+/* Map the file and index the records. Sealed segments are written atomically.
+ * A corrupt record (from a damaged disk) ends the segment. */
+static UA_StatusCode
+FileSegment_load(FileSegment *s, const char *path) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return UA_STATUSCODE_BADNOTFOUND;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size <= FILE_MAGIC_SIZE) {
+        close(fd);
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    s->map = (UA_Byte*)map;
+    s->mapSize = size;
+    if(memcmp(s->map, segmentMagic, FILE_MAGIC_SIZE) != 0) {
+        FileSegment_clear(s);
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+
+    size_t count = 0;
+    size_t len;
+    for(size_t offset = FILE_MAGIC_SIZE; offset < size; offset += len, count++) {
+        len = checkRecord(s->map, size, offset);
+        if(len < FILE_RECORD_HEADER + 8)
+            break;
+    }
+    if(count == 0) {
+        FileSegment_clear(s);
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+    s->keys = (UA_DateTime*)UA_malloc(count * sizeof(UA_DateTime));
+    s->offsets = (size_t*)UA_malloc(count * sizeof(size_t));
+    if(!s->keys || !s->offsets) {
+        FileSegment_clear(s);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    size_t offset = FILE_MAGIC_SIZE;
+    for(size_t i = 0; i < count; i++) {
+        s->offsets[i] = offset;
+        s->keys[i] = readInt64(&s->map[offset + FILE_RECORD_HEADER]);
+        offset += FILE_RECORD_HEADER + readUInt32(&s->map[offset]);
+    }
+    s->count = count;
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_Byte *
+FileSegment_record(const FileSegment *s, size_t i, size_t *size) {
+    const UA_Byte *record = &s->map[s->offsets[i]];
+    *size = FILE_RECORD_HEADER + readUInt32(record);
+    return record;
+}
+
+/* Decode from the mapping */
+static UA_StatusCode
+FileSegment_decode(const FileSegment *s, size_t i, UA_DataValue *out) {
+    size_t size;
+    const UA_Byte *record = FileSegment_record(s, i, &size);
+    UA_ByteString payload = {size - FILE_RECORD_HEADER - 8,
+                             (UA_Byte*)(uintptr_t)&record[FILE_RECORD_HEADER + 8]};
+    return UA_decodeBinary(&payload, out, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
+}
+
+/* Nodes
+ * ~~~~~ */
+
+typedef struct {
+    UA_DateTime key;
+    UA_DataValue value;
+} FileSample;
+
+typedef struct {
+    UA_NodeId nodeId;
+    FileSegment *segments; /* Sorted by the key timestamps */
+    size_t segmentsSize;
+    size_t sealedCount; /* Number of samples in all segments */
+    UA_UInt32 nextSeq;
+    FileSample *active; /* Not yet sealed, contained in the WAL */
+    size_t activeSize;
+    size_t activeCapacity;
+} FileNode;
+
+typedef struct {
+    char *directory;
+    int walFd;
+    size_t walSize;
+    size_t walCheckpointSize; /* Size of the WAL after the last checkpoint */
+    size_t segmentSize;
+    UA_DateTime retention;
+    FileNode *nodes;
+    size_t nodesSize;
+    size_t nodesCapacity;
+    UA_HistoryNodeIdIndex index; /* Position of the NodeIds in nodes */
+    FileBuffer buf;
+    UA_DataValue sample; /* Returned from getDataValue */
+} FileContext;
+
+static void
+FileNode_clear(FileNode *n) {
+    UA_NodeId_clear(&n->nodeId);
+    for(size_t i = 0; i < n->segmentsSize; i++)
+        FileSegment_clear(&n->segments[i]);
+    UA_free(n->segments);
+    for(size_t i = 0; i < n->activeSize; i++)
+        UA_DataValue_clear(&n->active[i].value);
+    UA_free(n->active);
+    memset(n, 0, sizeof(FileNode));
+}
+
+static void
+FileContext_clear(FileContext *ctx) {
+    if(ctx->walFd >= 0)
+        close(ctx->walFd);
+    for(size_t i = 0; i < ctx->nodesSize; i++)
+        FileNode_clear(&ctx->nodes[i]);
+    UA_free(ctx->nodes);
+    UA_HistoryNodeIdIndex_clear(&ctx->index);
+    FileBuffer_clear(&ctx->buf);
+    UA_DataValue_clear(&ctx->sample);
+    UA_free(ctx->directory);
+    memset(ctx, 0, sizeof(FileContext));
+    ctx->walFd = -1;
+}
+
+static void
+segmentPath(const FileContext *ctx, size_t node, UA_UInt32 seq, char *path) {
+    snprintf(path, FILE_PATH_MAX, "%s/%lu-%lu.seg", ctx->directory,
+             (unsigned long)node, (unsigned long)seq);
+}
+
+static void
+walPath(const FileContext *ctx, char *path) {
+    snprintf(path, FILE_PATH_MAX, "%s/wal", ctx->directory);
+}
+
+static size_t
+FileNode_count(const FileNode *n) {
+    return n->sealedCount + n->activeSize;
+}
+
+static void
+FileNode_updateIndex(FileNode *n) {
+    size_t index = 0;
+    for(size_t i = 0; i < n->segmentsSize; i++) {
+        n->segments[i].startIndex = index;
+        index += n->segments[i].count;
+    }
+    n->sealedCount = index;
+}
+
+/* The segment that contains the (sealed) sample index */
+static size_t
+FileNode_segmentByIndex(const FileNode *n, size_t index) {
+    size_t lo = 0;
+    size_t hi = n->segmentsSize;
+    while(hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if(n->segments[mid].startIndex <= index)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static UA_DateTime
+FileNode_key(const FileNode *n, size_t index) {
+    if(index >= n->sealedCount)
+        return n->active[index - n->sealedCount].key;
+    const FileSegment *s = &n->segments[FileNode_segmentByIndex(n, index)];
+    return s->keys[index - s->startIndex];
+}
+
+/* Index of the first sample with a key timestamp >= timestamp (or > timestamp
+ * if after is set) */
+static size_t
+FileNode_search(const FileNode *n, UA_DateTime timestamp,
+                UA_Boolean after, UA_Boolean *found) {
+    /* Find the segment (or the active samples) */
+    size_t lo = 0;
+    size_t hi = n->segmentsSize;
+    while(lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const FileSegment *s = &n->segments[mid];
+        UA_DateTime last = s->keys[s->count - 1];
+        if((after) ? (last <= timestamp) : (last < timestamp))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    size_t base = (lo < n->segmentsSize) ? n->segments[lo].startIndex : n->sealedCount;
+    size_t count = (lo < n->segmentsSize) ? n->segments[lo].count : n->activeSize;
+
+    /* Search inside */
+    size_t l = 0;
+    size_t h = count;
+    while(l < h) {
+        size_t mid = (l + h) / 2;
+        UA_DateTime key = (lo < n->segmentsSize) ?
+            n->segments[lo].keys[mid] : n->active[mid].key;
+        if((after) ? (key <= timestamp) : (key < timestamp))
+            l = mid + 1;
+        else
+            h = mid;
+    }
+    size_t index = base + l;
+    *found = (index < FileNode_count(n) && FileNode_key(n, index) == timestamp);
+    return index;
+}
+
+static UA_StatusCode
+FileNode_decode(const FileNode *n, size_t index, UA_DataValue *out) {
+    if(index >= n->sealedCount)
+        return UA_DataValue_copy(&n->active[index - n->sealedCount].value, out);
+    const FileSegment *s = &n->segments[FileNode_segmentByIndex(n, index)];
+    return FileSegment_decode(s, index - s->startIndex, out);
+}
+
+/* Decode the samples [lo, hi] into out. In reverse order if reverse is set. */
+static UA_StatusCode
+FileNode_read(const FileNode *n, size_t lo, size_t hi, UA_Boolean reverse,
+              UA_NumericRange range, UA_DataValue *out) {
+    for(size_t index = lo; index <= hi; index++) {
+        UA_DataValue *target = (reverse) ? &out[hi - index] : &out[index - lo];
+        UA_StatusCode res = FileNode_decode(n, index, target);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        if(range.dimensionsSize == 0)
+            continue;
+        UA_Variant v = target->value;
+        UA_Variant_init(&target->value);
+        if(target->hasValue)
+            res = UA_Variant_copyRange(&v, &target->value, range);
+        UA_Variant_clear(&v);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Changes of the active samples. Used for the live operation and to replay the
+ * WAL. */
+
+static UA_StatusCode
+FileNode_activeInsert(FileNode *n, size_t pos, UA_DateTime key,
+                      const UA_DataValue *value) {
+    if(n->activeSize >= n->activeCapacity) {
+        size_t newCapacity = (n->activeCapacity == 0) ? 16 : n->activeCapacity * 2;
+        FileSample *active = (FileSample*)
+            UA_realloc(n->active, newCapacity * sizeof(FileSample));
+        if(!active)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        n->active = active;
+        n->activeCapacity = newCapacity;
+    }
+    FileSample sample;
+    sample.key = key;
+    UA_StatusCode res = UA_DataValue_copy(value, &sample.value);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    memmove(&n->active[pos + 1], &n->active[pos],
+            (n->activeSize - pos) * sizeof(FileSample));
+    n->active[pos] = sample;
+    n->activeSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+FileNode_activeReplace(FileNode *n, size_t pos, const UA_DataValue *value) {
+    UA_DataValue copy;
+    UA_StatusCode res = UA_DataValue_copy(value, &copy);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_DataValue_clear(&n->active[pos].value);
+    n->active[pos].value = copy;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+FileNode_activeRemove(FileNode *n, size_t from, size_t to) {
+    for(size_t i = from; i < to; i++)
+        UA_DataValue_clear(&n->active[i].value);
+    memmove(&n->active[from], &n->active[to], (n->activeSize - to) * sizeof(FileSample));
+    n->activeSize -= to - from;
+}
+
+static void
+FileNode_activeClear(FileNode *n) {
+    FileNode_activeRemove(n, 0, n->activeSize);
+}
+
+static FileSegment *
+FileNode_addSegment(FileNode *n, UA_UInt32 seq) {
+    FileSegment *segments = (FileSegment*)
+        UA_realloc(n->segments, (n->segmentsSize + 1) * sizeof(FileSegment));
+    if(!segments)
+        return NULL;
+    n->segments = segments;
+    FileSegment *s = &n->segments[n->segmentsSize++];
+    memset(s, 0, sizeof(FileSegment));
+    s->seq = seq;
+    return s;
+}
+
+static void
+FileNode_removeSegment(FileNode *n, size_t si) {
+    FileSegment_clear(&n->segments[si]);
+    memmove(&n->segments[si], &n->segments[si + 1],
+            (n->segmentsSize - si - 1) * sizeof(FileSegment));
+    n->segmentsSize--;
+    FileNode_updateIndex(n);
+}
+
+/* WAL
+ * ~~~ */
+
+static UA_StatusCode
+FileContext_log(FileContext *ctx, const FileWalRecord *r) {
+    ctx->buf.length = 0;
+    UA_StatusCode res = FileBuffer_appendWalRecord(&ctx->buf, r);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = writeAll(ctx->walFd, ctx->buf.data, ctx->buf.length);
+    if(res != UA_STATUSCODE_GOOD) {
+        /* Remove a partially written record. Otherwise the following records
+         * would be lost during the replay. */
+        if(ftruncate(ctx->walFd, (off_t)ctx->walSize) != 0)
+            return UA_STATUSCODE_BADINTERNALERROR;
+        return res;
+    }
+    ctx->walSize += ctx->buf.length;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Write a new WAL with the current state. Replaces the WAL atomically. */
+static UA_StatusCode
+FileContext_checkpoint(FileContext *ctx) {
+    FileBuffer b;
+    memset(&b, 0, sizeof(FileBuffer));
+    UA_StatusCode res = FileBuffer_append(&b, walMagic, FILE_MAGIC_SIZE);
+    for(size_t i = 0; i < ctx->nodesSize && res == UA_STATUSCODE_GOOD; i++) {
+        const FileNode *n = &ctx->nodes[i];
+        FileWalRecord r;
+        memset(&r, 0, sizeof(FileWalRecord));
+        r.node = (UA_UInt32)i;
+        r.op = FILE_WAL_NODE;
+        r.nodeId = &n->nodeId;
+        res |= FileBuffer_appendWalRecord(&b, &r);
+        r.nodeId = NULL;
+        r.op = FILE_WAL_SEAL;
+        for(size_t j = 0; j < n->segmentsSize; j++) {
+            r.a = n->segments[j].seq;
+            res |= FileBuffer_appendWalRecord(&b, &r);
+        }
+        /* Keep the sequence counter if the newest segments were dropped */
+        if(n->nextSeq > 0 &&
+           (n->segmentsSize == 0 || n->segments[n->segmentsSize-1].seq + 1 != n->nextSeq)) {
+            r.a = n->nextSeq - 1;
+            res |= FileBuffer_appendWalRecord(&b, &r);
+            r.op = FILE_WAL_DROP;
+            res |= FileBuffer_appendWalRecord(&b, &r);
+        }
+        r.op = FILE_WAL_INSERT;
+        for(size_t j = 0; j < n->activeSize; j++) {
+            r.a = (UA_UInt32)j;
+            r.key = n->active[j].key;
+            r.value = &n->active[j].value;
+            res |= FileBuffer_appendWalRecord(&b, &r);
+        }
+    }
+
+    char path[FILE_PATH_MAX];
+    walPath(ctx, path);
+    if(res == UA_STATUSCODE_GOOD)
+        res = writeFileAtomic(ctx->directory, path, &b);
+    size_t size = b.length;
+    FileBuffer_clear(&b);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    int fd = open(path, O_WRONLY | O_APPEND);
+    if(fd < 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(ctx->walFd >= 0)
+        close(ctx->walFd);
+    ctx->walFd = fd;
+    ctx->walSize = size;
+    ctx->walCheckpointSize = size;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+FileContext_maybeCheckpoint(FileContext *ctx) {
+    if(ctx->walSize <= FILE_WAL_LIMIT || ctx->walSize <= 2 * ctx->walCheckpointSize)
+        return UA_STATUSCODE_GOOD;
+    return FileContext_checkpoint(ctx);
+}
+
+/* Node Store
+ * ~~~~~~~~~~ */
+
+/* Add the node in memory */
+static FileNode *
+FileContext_addNode(FileContext *ctx, const UA_NodeId *nodeId) {
+    if(ctx->nodesSize >= ctx->nodesCapacity) {
+        size_t newCapacity = (ctx->nodesCapacity == 0) ? 1 : ctx->nodesCapacity * 2;
+        FileNode *nodes = (FileNode*)UA_realloc(ctx->nodes, newCapacity * sizeof(FileNode));
+        if(!nodes)
+            return NULL;
+        ctx->nodes = nodes;
+        ctx->nodesCapacity = newCapacity;
+    }
+    FileNode *n = &ctx->nodes[ctx->nodesSize];
+    memset(n, 0, sizeof(FileNode));
+    if(UA_NodeId_copy(nodeId, &n->nodeId) != UA_STATUSCODE_GOOD)
+        return NULL;
+    if(UA_HistoryNodeIdIndex_add(&ctx->index, ctx->nodes,
+                                 ctx->nodesSize) != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&n->nodeId);
+        return NULL;
+    }
+    ctx->nodesSize++;
+    return n;
+}
+
+/* Returns NULL if the node is unknown and create is not set (or if the node
+ * cannot be added) */
+static FileNode *
+FileContext_getNode(FileContext *ctx, const UA_NodeId *nodeId, UA_Boolean create) {
+    size_t i = UA_HistoryNodeIdIndex_find(&ctx->index, ctx->nodes, nodeId);
+    if(i != UA_HISTORYNODEIDINDEX_NOTFOUND)
+        return &ctx->nodes[i];
+    if(!create || ctx->nodesSize >= UA_UINT32_MAX)
+        return NULL;
+    FileWalRecord r;
+    memset(&r, 0, sizeof(FileWalRecord));
+    r.op = FILE_WAL_NODE;
+    r.node = (UA_UInt32)ctx->nodesSize;
+    r.nodeId = nodeId;
+    if(FileContext_log(ctx, &r) != UA_STATUSCODE_GOOD)
+        return NULL;
+    FileNode *n = FileContext_addNode(ctx, nodeId);
+    if(!n) {
+        /* Remove the node from the WAL. So the numbering remains in sync. */
+        if(ftruncate(ctx->walFd, (off_t)(ctx->walSize - ctx->buf.length)) == 0)
+            ctx->walSize -= ctx->buf.length;
+    }
+    return n;
+}
+
+static size_t
+FileContext_nodeNumber(const FileContext *ctx, const FileNode *n) {
+    return (size_t)(n - ctx->nodes);
+}
+
+/* Remove the file before the WAL record. A crash in between leaves a WAL
+ * record for a missing file, which is skipped during the load. */
+static UA_StatusCode
+FileContext_dropSegment(FileContext *ctx, FileNode *n, size_t si) {
+    char path[FILE_PATH_MAX];
+    size_t node = FileContext_nodeNumber(ctx, n);
+    FileWalRecord r;
+    memset(&r, 0, sizeof(FileWalRecord));
+    r.op = FILE_WAL_DROP;
+    r.node = (UA_UInt32)node;
+    r.a = n->segments[si].seq;
+    segmentPath(ctx, node, r.a, path);
+    if(unlink(path) != 0 && errno != ENOENT)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    FileNode_removeSegment(n, si);
+    return FileContext_log(ctx, &r);
+}
+
+/* Replace the samples [from, to) of the segment with the sample add (if
+ * defined). The records of the remaining samples are copied. */
+static UA_StatusCode
+FileContext_rewriteSegment(FileContext *ctx, FileNode *n, size_t si,
+                           size_t from, size_t to, const FileSample *add) {
+    FileSegment *s = &n->segments[si];
+    if(from == 0 && to == s->count && !add)
+        return FileContext_dropSegment(ctx, n, si);
+
+    ctx->buf.length = 0;
+    UA_StatusCode res = FileBuffer_append(&ctx->buf, segmentMagic, FILE_MAGIC_SIZE);
+    size_t size;
+    for(size_t i = 0; i < from; i++) {
+        const UA_Byte *record = FileSegment_record(s, i, &size);
+        res |= FileBuffer_append(&ctx->buf, record, size);
+    }
+    if(add)
+        res |= FileBuffer_appendSample(&ctx->buf, add->key, &add->value);
+    for(size_t i = to; i < s->count; i++) {
+        const UA_Byte *record = FileSegment_record(s, i, &size);
+        res |= FileBuffer_append(&ctx->buf, record, size);
+    }
+    if(res != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    char path[FILE_PATH_MAX];
+    segmentPath(ctx, FileContext_nodeNumber(ctx, n), s->seq, path);
+    res = writeFileAtomic(ctx->directory, path, &ctx->buf);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* The old mapping remains valid until it is unmapped */
+    FileSegment loaded;
+    memset(&loaded, 0, sizeof(FileSegment));
+    loaded.seq = s->seq;
+    res = FileSegment_load(&loaded, path);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    FileSegment_clear(s);
+    *s = loaded;
+    FileNode_updateIndex(n);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Drop the sealed segments that only contain samples older than the
+ * retention time */
+static UA_StatusCode
+FileContext_retain(FileContext *ctx, FileNode *n) {
+    size_t count = FileNode_count(n);
+    if(ctx->retention <= 0 || count == 0)
+        return UA_STATUSCODE_GOOD;
+    UA_DateTime cutoff = FileNode_key(n, count - 1) - ctx->retention;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    while(n->segmentsSize > 0 && res == UA_STATUSCODE_GOOD) {
+        const FileSegment *s = &n->segments[0];
+        if(s->keys[s->count - 1] >= cutoff)
+            break;
+        res = FileContext_dropSegment(ctx, n, 0);
+    }
+    return res;
+}
+
+/* Write the active samples to a new segment. The segment file is written
+ * before the WAL record. If the WAL record is missing after a crash, the
+ * segment is found with the next sequence number during the load. */
+static UA_StatusCode
+FileContext_seal(FileContext *ctx, FileNode *n) {
+    if(n->activeSize == 0)
+        return UA_STATUSCODE_GOOD;
+    ctx->buf.length = 0;
+    UA_StatusCode res = FileBuffer_append(&ctx->buf, segmentMagic, FILE_MAGIC_SIZE);
+    for(size_t i = 0; i < n->activeSize && res == UA_STATUSCODE_GOOD; i++)
+        res = FileBuffer_appendSample(&ctx->buf, n->active[i].key, &n->active[i].value);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    char path[FILE_PATH_MAX];
+    size_t node = FileContext_nodeNumber(ctx, n);
+    segmentPath(ctx, node, n->nextSeq, path);
+    res = writeFileAtomic(ctx->directory, path, &ctx->buf);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    FileSegment *s = FileNode_addSegment(n, n->nextSeq);
+    if(!s) {
+        unlink(path);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    res = FileSegment_load(s, path);
+    if(res != UA_STATUSCODE_GOOD) {
+        n->segmentsSize--;
+        unlink(path);
+        return res;
+    }
+    FileNode_activeClear(n);
+    n->nextSeq++;
+    FileNode_updateIndex(n);
+
+    FileWalRecord r;
+    memset(&r, 0, sizeof(FileWalRecord));
+    r.op = FILE_WAL_SEAL;
+    r.node = (UA_UInt32)node;
+    r.a = s->seq;
+    res = FileContext_log(ctx, &r);
+    if(res == UA_STATUSCODE_GOOD && fsync(ctx->walFd) != 0)
+        res = UA_STATUSCODE_BADINTERNALERROR;
+    /* The WAL still contains the sealed samples. Write a new WAL, so that the
+     * positions of the following records match during a replay. */
+    if(res != UA_STATUSCODE_GOOD)
+        res = FileContext_checkpoint(ctx);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    return FileContext_retain(ctx, n);
+}
+
+static UA_StatusCode
+FileContext_insert(FileContext *ctx, FileNode *n,
+                   UA_DateTime key, const UA_DataValue *value) {
+    /* Insert after the samples with the same timestamp */
+    UA_Boolean found;
+    size_t index = FileNode_search(n, key, true, &found);
+    if(index < n->sealedCount) {
+        size_t si = FileNode_segmentByIndex(n, index);
+        size_t offset = index - n->segments[si].startIndex;
+        FileSample add;
+        add.key = key;
+        add.value = *value; /* Shallow copy, only encoded */
+        return FileContext_rewriteSegment(ctx, n, si, offset, offset, &add);
+    }
+
+    /* Append to the WAL. This is the common case. */
+    FileWalRecord r;
+    memset(&r, 0, sizeof(FileWalRecord));
+    r.op = FILE_WAL_INSERT;
+    r.node = (UA_UInt32)FileContext_nodeNumber(ctx, n);
+    r.a = (UA_UInt32)(index - n->sealedCount);
+    r.key = key;
+    r.value = value;
+    UA_StatusCode res = FileContext_log(ctx, &r);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = FileNode_activeInsert(n, r.a, key, value);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    if(n->activeSize >= ctx->segmentSize)
+        res = FileContext_seal(ctx, n);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    return FileContext_maybeCheckpoint(ctx);
+}
+
+static UA_StatusCode
+FileContext_replace(FileContext *ctx, FileNode *n, size_t index,
+                    const UA_DataValue *value) {
+    if(index < n->sealedCount) {
+        size_t si = FileNode_segmentByIndex(n, index);
+        size_t offset = index - n->segments[si].startIndex;
+        FileSample add;
+        add.key = n->segments[si].keys[offset];
+        add.value = *value; /* Shallow copy, only encoded */
+        return FileContext_rewriteSegment(ctx, n, si, offset, offset + 1, &add);
+    }
+
+    FileWalRecord r;
+    memset(&r, 0, sizeof(FileWalRecord));
+    r.op = FILE_WAL_REPLACE;
+    r.node = (UA_UInt32)FileContext_nodeNumber(ctx, n);
+    r.a = (UA_UInt32)(index - n->sealedCount);
+    r.value = value;
+    UA_StatusCode res = FileContext_log(ctx, &r);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = FileNode_activeReplace(n, r.a, value);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    return FileContext_maybeCheckpoint(ctx);
+}
+
+/* Remove the samples [from, to) */
+static UA_StatusCode
+FileContext_remove(FileContext *ctx, FileNode *n, size_t from, size_t to) {
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+
+    /* The active samples first. So the sealed indices remain stable. */
+    if(to > n->sealedCount) {
+        FileWalRecord r;
+        memset(&r, 0, sizeof(FileWalRecord));
+        r.op = FILE_WAL_REMOVE;
+        r.node = (UA_UInt32)FileContext_nodeNumber(ctx, n);
+        r.a = (UA_UInt32)(((from > n->sealedCount) ? from : n->sealedCount) - n->sealedCount);
+        r.b = (UA_UInt32)(to - n->sealedCount);
+        res = FileContext_log(ctx, &r);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        FileNode_activeRemove(n, r.a, r.b);
+        to = n->sealedCount;
+    }
+
+    /* Rewrite or drop the segments from the back */
+    for(size_t si = n->segmentsSize; si > 0 && res == UA_STATUSCODE_GOOD; si--) {
+        const FileSegment *s = &n->segments[si - 1];
+        size_t end = s->startIndex + s->count;
+        if(end <= from)
+            break;
+        if(s->startIndex >= to)
+            continue;
+        size_t f = (from > s->startIndex) ? from - s->startIndex : 0;
+        size_t t = ((to < end) ? to : end) - s->startIndex;
+        res = FileContext_rewriteSegment(ctx, n, si - 1, f, t, NULL);
+    }
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    return FileContext_maybeCheckpoint(ctx);
+}
+
+/* Load
+ * ~~~~ */
+
+static UA_Boolean
+FileContext_replayRecord(FileContext *ctx, const UA_Byte *payload, size_t size) {
+    if(size < FILE_WAL_HEADER)
+        return false;
+    FileWalRecord r;
+    memset(&r, 0, sizeof(FileWalRecord));
+    r.op = payload[0];
+    r.node = readUInt32(&payload[1]);
+    r.a = readUInt32(&payload[5]);
+    r.b = readUInt32(&payload[9]);
+    r.key = readInt64(&payload[13]);
+    UA_ByteString body = {size - FILE_WAL_HEADER,
+                          (UA_Byte*)(uintptr_t)&payload[FILE_WAL_HEADER]};
+
+    if(r.op == FILE_WAL_NODE) {
+        if(r.node != ctx->nodesSize)
+            return false;
+        UA_NodeId nodeId;
+        if(UA_decodeBinary(&body, &nodeId, &UA_TYPES[UA_TYPES_NODEID],
+                           NULL) != UA_STATUSCODE_GOOD)
+            return false;
+        FileNode *n = FileContext_addNode(ctx, &nodeId);
+        UA_NodeId_clear(&nodeId);
+        return (n != NULL);
+    }
+
+    if(r.node >= ctx->nodesSize)
+        return false;
+    FileNode *n = &ctx->nodes[r.node];
+    UA_DataValue value;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    switch(r.op) {
+    case FILE_WAL_INSERT:
+    case FILE_WAL_REPLACE:
+        if((r.op == FILE_WAL_INSERT) ? (r.a > n->activeSize) : (r.a >= n->activeSize))
+            return false;
+        res = UA_decodeBinary(&body, &value, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
+        if(res != UA_STATUSCODE_GOOD)
+            return false;
+        if(r.op == FILE_WAL_INSERT)
+            res = FileNode_activeInsert(n, r.a, r.key, &value);
+        else
+            res = FileNode_activeReplace(n, r.a, &value);
+        UA_DataValue_clear(&value);
+        return (res == UA_STATUSCODE_GOOD);
+    case FILE_WAL_REMOVE:
+        if(r.a > r.b || r.b > n->activeSize)
+            return false;
+        FileNode_activeRemove(n, r.a, r.b);
+        return true;
+    case FILE_WAL_SEAL:
+        /* The segment is loaded after the replay */
+        if(!FileNode_addSegment(n, r.a))
+            return false;
+        FileNode_activeClear(n);
+        n->nextSeq = r.a + 1;
+        return true;
+    case FILE_WAL_DROP:
+        for(size_t i = 0; i < n->segmentsSize; i++) {
+            if(n->segments[i].seq == r.a) {
+                FileNode_removeSegment(n, i);
+                break;
+            }
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Replay the WAL up to the first torn or corrupt record */
+static UA_StatusCode
+FileContext_replay(FileContext *ctx) {
+    char path[FILE_PATH_MAX];
+    walPath(ctx, path);
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return (errno == ENOENT) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        close(fd);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    size_t size = (size_t)st.st_size;
+    if(size == 0) {
+        close(fd);
+        return UA_STATUSCODE_GOOD;
+    }
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    const UA_Byte *data = (const UA_Byte*)map;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(size < FILE_MAGIC_SIZE || memcmp(data, walMagic, FILE_MAGIC_SIZE) != 0) {
+        res = UA_STATUSCODE_BADDECODINGERROR;
+    } else {
+        size_t len;
+        for(size_t offset = FILE_MAGIC_SIZE; offset < size; offset += len) {
+            len = checkRecord(data, size, offset);
+            if(len == 0 ||
+               !FileContext_replayRecord(ctx, &data[offset + FILE_RECORD_HEADER],
+                                         len - FILE_RECORD_HEADER))
+                break;
+        }
+    }
+    munmap(map, size);
+    return res;
+}
+
+static UA_StatusCode
+FileContext_loadSegments(FileContext *ctx) {
+    char path[FILE_PATH_MAX];
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        FileNode *n = &ctx->nodes[i];
+        for(size_t j = 0; j < n->segmentsSize; j++) {
+            segmentPath(ctx, i, n->segments[j].seq, path);
+            UA_StatusCode res = FileSegment_load(&n->segments[j], path);
+            if(res == UA_STATUSCODE_BADOUTOFMEMORY)
+                return res;
+            if(res != UA_STATUSCODE_GOOD) {
+                FileNode_removeSegment(n, j); /* Dropped before a crash */
+                j--;
+            }
+        }
+
+        /* Sealed before a crash, but the WAL record is missing. The segment
+         * contains the active samples. */
+        segmentPath(ctx, i, n->nextSeq, path);
+        if(access(path, F_OK) == 0) {
+            FileSegment *s = FileNode_addSegment(n, n->nextSeq);
+            if(!s)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            if(FileSegment_load(s, path) == UA_STATUSCODE_GOOD) {
+                FileNode_activeClear(n);
+                n->nextSeq++;
+            } else {
+                n->segmentsSize--;
+            }
+        }
+        FileNode_updateIndex(n);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Backend
+ * ~~~~~~~ */
+
+static const UA_DataValue *
+FileContext_sample(FileContext *ctx, const FileNode *n, size_t index) {
+    UA_DataValue_clear(&ctx->sample);
+    if(n && index < FileNode_count(n))
+        FileNode_decode(n, index, &ctx->sample);
+    return &ctx->sample;
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_file(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  UA_Boolean historizing,
+                                  const UA_DataValue *value) {
+    FileContext *ctx = (FileContext*)context;
+    FileNode *n = FileContext_getNode(ctx, nodeId, true);
+    if(!n)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_DateTime timestamp;
+    if(value->hasSourceTimestamp)
+        timestamp = value->sourceTimestamp;
+    else if(value->hasServerTimestamp)
+        timestamp = value->serverTimestamp;
+    else
+        timestamp = UA_DateTime_now();
+    return FileContext_insert(ctx, n, timestamp, value);
+}
+
+static size_t
+getEnd_backend_file(UA_Server *server,
+                    void *context,
+                    const UA_NodeId *sessionId,
+                    void *sessionContext,
+                    const UA_NodeId *nodeId) {
+    const FileNode *n = FileContext_getNode((FileContext*)context, nodeId, false);
+    return (n) ? FileNode_count(n) : 0;
+}
+
+static size_t
+lastIndex_backend_file(UA_Server *server,
+                       void *context,
+                       const UA_NodeId *sessionId,
+                       void *sessionContext,
+                       const UA_NodeId *nodeId) {
+    const FileNode *n = FileContext_getNode((FileContext*)context, nodeId, false);
+    if(!n || FileNode_count(n) == 0)
+        return 0;
+    return FileNode_count(n) - 1;
+}
+
+static size_t
+firstIndex_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static size_t
+resultSize_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId,
+                        size_t startIndex,
+                        size_t endIndex) {
+    const FileNode *n = FileContext_getNode((FileContext*)context, nodeId, false);
+    if(!n)
+        return 0;
+    size_t count = FileNode_count(n);
+    if(count == 0 || startIndex == count || endIndex == count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getDateTimeMatch_backend_file(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              const UA_DateTime timestamp,
+                              const MatchStrategy strategy) {
+    const FileNode *n = FileContext_getNode((FileContext*)context, nodeId, false);
+    if(!n)
+        return 0;
+    size_t count = FileNode_count(n);
+    UA_Boolean found;
+    size_t current = FileNode_search(n, timestamp, false, &found);
+    switch(strategy) {
+    case MATCH_EQUAL:
+        return (found) ? current : count;
+    case MATCH_AFTER:
+        return FileNode_search(n, timestamp, true, &found);
+    case MATCH_EQUAL_OR_AFTER:
+        return current;
+    case MATCH_EQUAL_OR_BEFORE:
+        if(found)
+            return current;
+        return (current > 0) ? current - 1 : count;
+    case MATCH_BEFORE:
+        return (current > 0) ? current - 1 : count;
+    default:
+        return count;
+    }
+}
+
+static UA_StatusCode
+copyDataValues_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId,
+                            size_t startIndex,
+                            size_t endIndex,
+                            UA_Boolean reverse,
+                            size_t maxValues,
+                            UA_NumericRange range,
+                            UA_Boolean releaseContinuationPoints,
+                            const UA_ByteString *continuationPoint,
+                            UA_ByteString *outContinuationPoint,
+                            size_t *providedValues,
+                            UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&skip, continuationPoint->data, sizeof(size_t));
+    }
+
+    const FileNode *n = FileContext_getNode((FileContext*)context, nodeId, false);
+    size_t count = (n) ? FileNode_count(n) : 0;
+
+    /* Compute the range of samples [lo, hi] that is decoded */
+    size_t counter = 0;
+    size_t lo = 0;
+    size_t hi = 0;
+    if(reverse) {
+        if(startIndex < count && startIndex >= endIndex &&
+           startIndex - endIndex + 1 > skip) {
+            hi = startIndex - skip;
+            counter = hi - endIndex + 1;
+            if(counter > maxValues)
+                counter = maxValues;
+            lo = hi + 1 - counter;
+        }
+    } else {
+        if(endIndex >= startIndex && endIndex < count &&
+           endIndex - startIndex + 1 > skip) {
+            lo = startIndex + skip;
+            counter = endIndex - lo + 1;
+            if(counter > maxValues)
+                counter = maxValues;
+            hi = lo + counter - 1;
+        }
+    }
+
+    if(counter > 0) {
+        UA_StatusCode res = FileNode_read(n, lo, hi, reverse, range, values);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if((!reverse && (endIndex-startIndex-skip+1) > counter) ||
+       (reverse && (startIndex-endIndex-skip+1) > counter)) {
+        outContinuationPoint->data = (UA_Byte*)UA_malloc(sizeof(size_t));
+        if(!outContinuationPoint->data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        outContinuationPoint->length = sizeof(size_t);
+        size_t next = skip + counter;
+        memcpy(outContinuationPoint->data, &next, sizeof(size_t));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_DataValue *
+getDataValue_backend_file(UA_Server *server,
+                          void *context,
+                          const UA_NodeId *sessionId,
+                          void *sessionContext,
+                          const UA_NodeId *nodeId,
+                          size_t index) {
+    FileContext *ctx = (FileContext*)context;
+    return FileContext_sample(ctx, FileContext_getNode(ctx, nodeId, false), index);
+}
+
+static UA_Boolean
+boundSupported_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_file(UA_Server *server,
+                                         void *context,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         const UA_TimestampsToReturn timestampsToReturn) {
+    FileContext *ctx = (FileContext*)context;
+    const FileNode *n = FileContext_getNode(ctx, nodeId, false);
+    if(!n || FileNode_count(n) == 0)
+        return true;
+    const UA_DataValue *first = FileContext_sample(ctx, n, 0);
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_INVALID ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER &&
+        !first->hasServerTimestamp) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE &&
+        !first->hasSourceTimestamp) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH &&
+        !(first->hasSourceTimestamp && first->hasServerTimestamp)))
+        return false;
+    return true;
+}
+
+static UA_StatusCode
+insertDataValue_backend_file(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    const UA_DateTime timestamp = (value->hasSourceTimestamp) ?
+        value->sourceTimestamp : value->serverTimestamp;
+    FileContext *ctx = (FileContext*)hdbContext;
+    FileNode *n = FileContext_getNode(ctx, nodeId, true);
+    if(!n)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_Boolean found;
+    FileNode_search(n, timestamp, false, &found);
+    if(found)
+        return UA_STATUSCODE_BADENTRYEXISTS;
+    return FileContext_insert(ctx, n, timestamp, value);
+}
+
+static UA_StatusCode
+replaceDataValue_backend_file(UA_Server *server,
+                              void *hdbContext,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    const UA_DateTime timestamp = (value->hasSourceTimestamp) ?
+        value->sourceTimestamp : value->serverTimestamp;
+    FileContext *ctx = (FileContext*)hdbContext;
+    FileNode *n = FileContext_getNode(ctx, nodeId, false);
+    if(!n)
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+    UA_Boolean found;
+    size_t index = FileNode_search(n, timestamp, false, &found);
+    if(!found)
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+    return FileContext_replace(ctx, n, index, value);
+}
+
+static UA_StatusCode
+updateDataValue_backend_file(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             const UA_DataValue *value) {
+    /* We first try to replace */
+    UA_StatusCode ret =
+        replaceDataValue_backend_file(server, hdbContext, sessionId,
+                                      sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYREPLACED;
+
+    ret = insertDataValue_backend_file(server, hdbContext, sessionId,
+                                       sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYINSERTED;
+    return ret;
+}
+
+static UA_StatusCode
+removeDataValue_backend_file(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             UA_DateTime startTimestamp,
+                             UA_DateTime endTimestamp) {
+    if(startTimestamp > endTimestamp)
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+    FileContext *ctx = (FileContext*)hdbContext;
+    FileNode *n = FileContext_getNode(ctx, nodeId, false);
+    if(!n)
+        return UA_STATUSCODE_BADNODATA;
+
+    /* The first index which will be deleted and the first index which is not
+     * deleted */
+    UA_Boolean found;
+    size_t index1 = FileNode_search(n, startTimestamp, false, &found);
+    size_t index2;
+    if(startTimestamp == endTimestamp) {
+        if(!found)
+            return UA_STATUSCODE_BADNODATA;
+        index2 = index1 + 1;
+    } else {
+        /* Up to (and excluding) the end timestamp */
+        index2 = FileNode_search(n, endTimestamp, false, &found);
+        if(index1 == FileNode_count(n) || index1 >= index2)
+            return UA_STATUSCODE_BADNODATA;
+    }
+    return FileContext_remove(ctx, n, index1, index2);
+}
+
+static void
+deleteMembers_backend_file(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    FileContext_clear((FileContext*)backend->context);
+    UA_free(backend->context);
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_File(const char *directory, size_t initialNodeIdStoreSize,
+                           size_t segmentSize, UA_Duration retention) {
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    /* Leave room for the file names */
+    if(!directory || strlen(directory) + 64 > FILE_PATH_MAX)
+        return result;
+    if(initialNodeIdStoreSize == 0)
+        initialNodeIdStoreSize = 1;
+    if(segmentSize == 0)
+        segmentSize = FILE_SEGMENT_SIZE;
+    if(mkdir(directory, 0755) != 0 && errno != EEXIST)
+        return result;
+
+    FileContext *ctx = (FileContext*)UA_calloc(1, sizeof(FileContext));
+    if(!ctx)
+        return result;
+    ctx->walFd = -1;
+    size_t len = strlen(directory);
+    ctx->directory = (char*)UA_malloc(len + 1);
+    ctx->nodes = (FileNode*)UA_calloc(initialNodeIdStoreSize, sizeof(FileNode));
+    if(!ctx->directory || !ctx->nodes)
+        goto error;
+    memcpy(ctx->directory, directory, len + 1);
+    ctx->nodesCapacity = initialNodeIdStoreSize;
+    ctx->segmentSize = segmentSize;
+    ctx->retention = (UA_DateTime)(retention * UA_DATETIME_MSEC);
+    UA_HistoryNodeIdIndex_init(&ctx->index, sizeof(FileNode),
+                               offsetof(FileNode, nodeId));
+
+    /* Restore the history and start with a compacted WAL */
+    if(FileContext_replay(ctx) != UA_STATUSCODE_GOOD ||
+       FileContext_loadSegments(ctx) != UA_STATUSCODE_GOOD ||
+       FileContext_checkpoint(ctx) != UA_STATUSCODE_GOOD)
+        goto error;
+
+    result.serverSetHistoryData = &serverSetHistoryData_backend_file;
+    result.resultSize = &resultSize_backend_file;
+    result.getEnd = &getEnd_backend_file;
+    result.lastIndex = &lastIndex_backend_file;
+    result.firstIndex = &firstIndex_backend_file;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_file;
+    result.copyDataValues = &copyDataValues_backend_file;
+    result.getDataValue = &getDataValue_backend_file;
+    result.boundSupported = &boundSupported_backend_file;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_file;
+    result.insertDataValue = &insertDataValue_backend_file;
+    result.updateDataValue = &updateDataValue_backend_file;
+    result.replaceDataValue = &replaceDataValue_backend_file;
+    result.removeDataValue = &removeDataValue_backend_file;
+    result.deleteMembers = &deleteMembers_backend_file;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+
+ error:
+    FileContext_clear(ctx);
+    UA_free(ctx);
+    return result;
+}
+
+UA_StatusCode
+UA_HistoryDataBackend_File_compact(UA_HistoryDataBackend *backend,
+                                   UA_DateTime before) {
+    FileContext *ctx = (FileContext*)backend->context;
+    if(!ctx)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        FileNode *n = &ctx->nodes[i];
+        UA_Boolean found;
+        size_t end = FileNode_search(n, before, false, &found);
+        if(end == 0)
+            continue;
+        UA_StatusCode res = FileContext_remove(ctx, n, 0, end);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+    return FileContext_checkpoint(ctx);
+}
+
+void
+UA_HistoryDataBackend_File_clear(UA_HistoryDataBackend *backend) {
+    deleteMembers_backend_file(backend);
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
+
+#endif /* UA_ARCHITECTURE_POSIX */
@@ -8,6 +8,8 @@
 
 #include <open62541/plugin/historydata/history_data_backend_memory.h>
 
+#include "ua_history_nodeid_index.h"
+
 #include <limits.h>
 #include <string.h>
 
@@ -46,6 +48,7 @@ typedef struct {
     size_t storeEnd;
     size_t storeSize;
     size_t initialStoreSize;
+    UA_HistoryNodeIdIndex index; /* Position of the NodeIds in the dataStore */
 } UA_MemoryStoreContext;
 
 static void
@@ -54,6 +57,7 @@ UA_MemoryStoreContext_clear(UA_MemoryStoreContext* ctx) {
         UA_NodeIdStoreContextItem_clear(&ctx->dataStore[i]);
     }
     UA_free(ctx->dataStore);
+    UA_HistoryNodeIdIndex_clear(&ctx->index);
     memset(ctx, 0, sizeof(UA_MemoryStoreContext));
 }
 
@@ -83,6 +87,11 @@ getNewNodeIdContext_backend_memory(UA_MemoryStoreContext* context,
     item->dataStore = store;
     item->storeSize = ctx->initialStoreSize;
     item->storeEnd = 0;
+    if(UA_HistoryNodeIdIndex_add(&ctx->index, ctx->dataStore,
+                                 ctx->storeEnd) != UA_STATUSCODE_GOOD) {
+        UA_NodeIdStoreContextItem_clear(item);
+        return NULL;
+    }
     ++ctx->storeEnd;
     return item;
 }
@@ -92,11 +101,9 @@ getNodeIdStoreContextItem_backend_memory(UA_MemoryStoreContext* context,
                                          UA_Server *server,
                                          const UA_NodeId *nodeId)
 {
-    for (size_t i = 0; i < context->storeEnd; ++i) {
-        if (UA_NodeId_equal(nodeId, &context->dataStore[i].nodeId)) {
-            return &context->dataStore[i];
-        }
-    }
+    size_t i = UA_HistoryNodeIdIndex_find(&context->index, context->dataStore, nodeId);
+    if(i != UA_HISTORYNODEIDINDEX_NOTFOUND)
+        return &context->dataStore[i];
     return getNewNodeIdContext_backend_memory(context, server, nodeId);
 }
 
@@ -579,6 +586,8 @@ UA_HistoryDataBackend_Memory(size_t initialNodeIdStoreSize, size_t initialDataSt
     ctx->initialStoreSize = initialDataStoreSize;
     ctx->storeSize = initialNodeIdStoreSize;
     ctx->storeEnd = 0;
+    UA_HistoryNodeIdIndex_init(&ctx->index, sizeof(UA_NodeIdStoreContextItem_backend_memory),
+                               offsetof(UA_NodeIdStoreContextItem_backend_memory, nodeId));
     result.serverSetHistoryData = &serverSetHistoryData_backend_memory;
     result.resultSize = &resultSize_backend_memory;
     result.getEnd = &getEnd_backend_memory;
@@ -627,6 +636,11 @@ getNewNodeIdContext_backend_memory_Circular(UA_MemoryStoreContext *context,
     item->dataStore = store;
     item->storeSize = ctx->initialStoreSize;
     item->storeEnd = 0;
+    if(UA_HistoryNodeIdIndex_add(&ctx->index, ctx->dataStore,
+                                 ctx->storeEnd) != UA_STATUSCODE_GOOD) {
+        UA_NodeIdStoreContextItem_clear(item);
+        return NULL;
+    }
     ++ctx->storeEnd;
     return item;
 }
@@ -635,11 +649,9 @@ static UA_NodeIdStoreContextItem_backend_memory *
 getNodeIdStoreContextItem_backend_memory_Circular(UA_MemoryStoreContext *context,
                                                   UA_Server *server,
                                                   const UA_NodeId *nodeId) {
-    for(size_t i = 0; i < context->storeEnd; ++i) {
-        if(UA_NodeId_equal(nodeId, &context->dataStore[i].nodeId)) {
-            return &context->dataStore[i];
-        }
-    }
+    size_t i = UA_HistoryNodeIdIndex_find(&context->index, context->dataStore, nodeId);
+    if(i != UA_HISTORYNODEIDINDEX_NOTFOUND)
+        return &context->dataStore[i];
     return getNewNodeIdContext_backend_memory_Circular(context, server, nodeId);
 }
 
@@ -10,6 +10,8 @@
 #include <open62541/plugin/historydata/history_data_gathering_default.h>
 #include <open62541/plugin/historydata/history_database_default.h>
 
+#include "ua_history_nodeid_index.h"
+
 #include <string.h>
 
 typedef struct {
@@ -22,6 +24,7 @@ typedef struct {
     UA_NodeIdStoreContextItem_gathering_default *dataStore;
     size_t storeEnd;
     size_t storeSize;
+    UA_HistoryNodeIdIndex index; /* Position of the NodeIds in the dataStore */
 } UA_NodeIdStoreContext;
 
 static void
@@ -47,12 +50,10 @@ static UA_NodeIdStoreContextItem_gathering_default*
 getNodeIdStoreContextItem_gathering_default(UA_NodeIdStoreContext *context,
                                             const UA_NodeId *nodeId)
 {
-    for (size_t i = 0; i < context->storeEnd; ++i) {
-        if (UA_NodeId_equal(&context->dataStore[i].nodeId, nodeId)) {
-            return &context->dataStore[i];
-        }
-    }
-    return NULL;
+    size_t i = UA_HistoryNodeIdIndex_find(&context->index, context->dataStore, nodeId);
+    if(i == UA_HISTORYNODEIDINDEX_NOTFOUND)
+        return NULL;
+    return &context->dataStore[i];
 }
 
 static UA_StatusCode
@@ -136,6 +137,11 @@ registerNodeId_gathering_default(UA_Server *server,
     UA_NodeId_copy(nodeId, &ctx->dataStore[ctx->storeEnd].nodeId);
     size_t current = ctx->storeEnd;
     ctx->dataStore[current].setting = setting;
+    UA_StatusCode res = UA_HistoryNodeIdIndex_add(&ctx->index, ctx->dataStore, current);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&ctx->dataStore[current].nodeId);
+        return res;
+    }
     ++ctx->storeEnd;
     return UA_STATUSCODE_GOOD;
 }
@@ -166,6 +172,7 @@ deleteMembers_gathering_default(UA_HistoryDataGathering *gathering)
         UA_assert(ctx->dataStore[i].monitoredResult.monitoredItemId == 0);
     }
     UA_free(ctx->dataStore);
+    UA_HistoryNodeIdIndex_clear(&ctx->index);
     UA_free(gathering->context);
 }
 
@@ -226,6 +233,8 @@ UA_HistoryDataGathering_Default(size_t initialNodeIdStoreSize)
     context->storeEnd = 0;
     context->storeSize = initialNodeIdStoreSize;
     context->dataStore = (UA_NodeIdStoreContextItem_gathering_default*)UA_calloc(initialNodeIdStoreSize, sizeof(UA_NodeIdStoreContextItem_gathering_default));
+    UA_HistoryNodeIdIndex_init(&context->index, sizeof(UA_NodeIdStoreContextItem_gathering_default),
+                               offsetof(UA_NodeIdStoreContextItem_gathering_default, nodeId));
     gathering.context = context;
     return gathering;
 }
@@ -246,6 +255,11 @@ registerNodeId_gathering_circular(UA_Server *server, void *context,
     UA_NodeId_copy(nodeId, &ctx->dataStore[ctx->storeEnd].nodeId);
     size_t current = ctx->storeEnd;
     ctx->dataStore[current].setting = setting;
+    UA_StatusCode res = UA_HistoryNodeIdIndex_add(&ctx->index, ctx->dataStore, current);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&ctx->dataStore[current].nodeId);
+        return res;
+    }
     ++ctx->storeEnd;
     return UA_STATUSCODE_GOOD;
 }
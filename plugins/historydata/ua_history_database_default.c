@@ -10,10 +10,25 @@
 
 #include <limits.h>
 
+#include "ua_history_aggregates.h"
+#include "ua_history_ingestion_queue.h"
+
 typedef struct {
     UA_HistoryDataGathering gathering;
+    UA_HistoryIngestionQueue *queue; /* NULL if values are stored directly */
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    UA_HistoryEventBackend eventBackend;
+#endif
 } UA_HistoryDatabaseContext_default;
 
+/* Reads and updates see all values that were written before */
+static void
+flushIngestionQueue(UA_Server *server, UA_HistoryDatabaseContext_default *ctx)
+{
+    if (ctx->queue)
+        UA_HistoryIngestionQueue_drain(ctx->queue, server, 0, true);
+}
+
 static size_t
 getResultSize_service_default(const UA_HistoryDataBackend* backend,
                               UA_Server *server,
@@ -142,6 +157,74 @@ getResultSize_service_default(const UA_HistoryDataBackend* backend,
     return size;
 }
 
+/* Continuation point of the default read. Instead of an offset into the
+ * store, the next value is remembered by its timestamp and the number of
+ * values with the same timestamp that were already returned. A page resumes
+ * at that timestamp, so values that are inserted while the client pages
+ * through the result do not shift it. Every page holds at most maxSize
+ * values. */
+typedef struct {
+    UA_UInt64 delivered;   /* Values and bounds returned so far */
+    UA_DateTime timestamp; /* Timestamp of the next value */
+    UA_UInt64 duplicates;  /* Values with the timestamp already returned */
+    UA_Boolean valuesDone; /* Only the last bound remains */
+} UA_HistoryDataCursor;
+
+static UA_DateTime
+getCursorTimestamp(const UA_DataValue *value) {
+    return value->hasSourceTimestamp ? value->sourceTimestamp : value->serverTimestamp;
+}
+
+static UA_DateTime
+getIndexTimestamp(const UA_HistoryDataBackend *backend, UA_Server *server,
+                  const UA_NodeId *sessionId, void *sessionContext,
+                  const UA_NodeId *nodeId, size_t index) {
+    const UA_DataValue *value =
+        backend->getDataValue(server, backend->context, sessionId,
+                              sessionContext, nodeId, index);
+    return value ? getCursorTimestamp(value) : LLONG_MIN;
+}
+
+#define HISTORY_CURSOR_SKIP_CHUNK 16
+
+/* The indices of a backend are opaque. Values after an index are skipped
+ * with the continuation point of the backend. The skipped values are copied
+ * in small chunks and discarded. */
+static UA_StatusCode
+skipHistoryData(const UA_HistoryDataBackend *backend, UA_Server *server,
+                const UA_NodeId *sessionId, void *sessionContext,
+                const UA_NodeId *nodeId, size_t startIndex, size_t endIndex,
+                UA_Boolean reverse, UA_UInt64 count,
+                UA_ByteString *backendContinuationPoint, size_t *skipped) {
+    UA_DataValue chunk[HISTORY_CURSOR_SKIP_CHUNK];
+    UA_NumericRange noRange = {0, NULL};
+    *skipped = 0;
+    while(count > 0) {
+        size_t size = (count < HISTORY_CURSOR_SKIP_CHUNK) ?
+            (size_t)count : HISTORY_CURSOR_SKIP_CHUNK;
+        size_t provided = 0;
+        UA_ByteString next;
+        UA_ByteString_init(&next);
+        memset(chunk, 0, sizeof(chunk));
+        UA_StatusCode ret =
+            backend->copyDataValues(server, backend->context, sessionId,
+                                    sessionContext, nodeId, startIndex, endIndex,
+                                    reverse, size, noRange, false,
+                                    backendContinuationPoint, &next, &provided, chunk);
+        for(size_t i = 0; i < provided; i++)
+            UA_DataValue_clear(&chunk[i]);
+        UA_ByteString_clear(backendContinuationPoint);
+        *backendContinuationPoint = next;
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+        *skipped += provided;
+        count -= provided;
+        if(provided < size || next.length == 0)
+            break;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 getHistoryData_service_default(const UA_HistoryDataBackend* backend,
                                const UA_DateTime start,
@@ -161,21 +244,20 @@ getHistoryData_service_default(const UA_HistoryDataBackend* backend,
                                size_t *resultSize,
                                UA_DataValue ** result)
 {
-    size_t skip = 0;
-    UA_ByteString backendContinuationPoint;
-    UA_ByteString_init(&backendContinuationPoint);
+    UA_HistoryDataCursor cursor;
+    memset(&cursor, 0, sizeof(UA_HistoryDataCursor));
     if (continuationPoint->length > 0) {
-        if (continuationPoint->length >= sizeof(size_t)) {
-            skip = *((size_t*)(continuationPoint->data));
-            if (continuationPoint->length > 0) {
-                backendContinuationPoint.length = continuationPoint->length - sizeof(size_t);
-                backendContinuationPoint.data = continuationPoint->data + sizeof(size_t);
-            }
-        } else {
+        if (continuationPoint->length != sizeof(UA_HistoryDataCursor))
             return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
-        }
+        memcpy(&cursor, continuationPoint->data, sizeof(UA_HistoryDataCursor));
     }
 
+    /* The cursor holds no resources in the backend */
+    *resultSize = 0;
+    if (releaseContinuationPoints)
+        return UA_STATUSCODE_GOOD;
+
+    size_t skip = (size_t)cursor.delivered;
     size_t storeEnd = backend->getEnd(server, backend->context, sessionId, sessionContext, nodeId);
     size_t startIndex;
     size_t endIndex;
@@ -196,11 +278,12 @@ getHistoryData_service_default(const UA_HistoryDataBackend* backend,
                                                        &addFirst,
                                                        &addLast,
                                                        &reverse);
-    *resultSize = _resultSize - skip;
+    *resultSize = (skip < _resultSize) ? _resultSize - skip : 0;
     if (*resultSize > maxSize) {
         *resultSize = maxSize;
     }
-    UA_DataValue *outResult= (UA_DataValue*)UA_Array_new(*resultSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    /* With a spare slot for the value after the page */
+    UA_DataValue *outResult= (UA_DataValue*)UA_Array_new(*resultSize + 1, &UA_TYPES[UA_TYPES_DATAVALUE]);
     if (!outResult) {
         *resultSize = 0;
         return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -209,7 +292,7 @@ getHistoryData_service_default(const UA_HistoryDataBackend* backend,
 
     size_t counter = 0;
     if (addFirst) {
-        if (skip == 0) {
+        if (skip == 0 && *resultSize > 0) {
             outResult[counter].hasStatus = true;
             outResult[counter].status = UA_STATUSCODE_BADBOUNDNOTFOUND;
             outResult[counter].hasSourceTimestamp = true;
@@ -221,46 +304,113 @@ getHistoryData_service_default(const UA_HistoryDataBackend* backend,
             ++counter;
         }
     }
-    UA_ByteString backendOutContinuationPoint;
-    UA_ByteString_init(&backendOutContinuationPoint);
-    if (endIndex != storeEnd && startIndex != storeEnd) {
-        size_t retval = 0;
 
-        size_t valueSize = *resultSize - counter;
-        if (valueSize + skip > _resultSize - addFirst - addLast) {
-            if (skip == 0) {
-                valueSize = _resultSize - addFirst - addLast;
-            } else {
-                valueSize = _resultSize - skip - addLast;
+    /* Find where the values of this page begin. A cursor that moved past
+     * the end of the range leaves only the last bound. */
+    size_t index = storeEnd;
+    if (endIndex != storeEnd && startIndex != storeEnd) {
+        if (skip == 0) {
+            index = startIndex;
+        } else if (!cursor.valuesDone) {
+            index = backend->getDateTimeMatch(server, backend->context, sessionId, sessionContext, nodeId, cursor.timestamp,
+                                              reverse ? MATCH_EQUAL_OR_BEFORE : MATCH_EQUAL_OR_AFTER);
+            if (index != storeEnd) {
+                UA_DateTime t = getIndexTimestamp(backend, server, sessionId, sessionContext, nodeId, index);
+                UA_DateTime last = getIndexTimestamp(backend, server, sessionId, sessionContext, nodeId, endIndex);
+                if (reverse ? t < last : t > last)
+                    index = storeEnd;
             }
-
         }
+    }
+
+    UA_Boolean moreValues = false;
+    UA_Boolean cursorSet = false;
+    if (index != storeEnd) {
+        size_t available = reverse ?
+            backend->resultSize(server, backend->context, sessionId, sessionContext, nodeId, endIndex, index) :
+            backend->resultSize(server, backend->context, sessionId, sessionContext, nodeId, index, endIndex);
 
+        /* Skip the values with the timestamp of the cursor that were already
+         * returned */
         UA_StatusCode ret = UA_STATUSCODE_GOOD;
-        if (valueSize > 0)
+        UA_ByteString backendContinuationPoint;
+        UA_ByteString_init(&backendContinuationPoint);
+        if (skip > 0 && cursor.duplicates > 0 &&
+            getIndexTimestamp(backend, server, sessionId, sessionContext, nodeId, index) == cursor.timestamp) {
+            size_t skipped = 0;
+            ret = skipHistoryData(backend, server, sessionId, sessionContext, nodeId, index, endIndex,
+                                  reverse, cursor.duplicates, &backendContinuationPoint, &skipped);
+            available = (skipped < available) ? available - skipped : 0;
+        }
+
+        /* The page is limited by the free slots, the values left in the range
+         * and the values left for numValuesPerNode */
+        size_t valueSize = *resultSize - counter;
+        if (valueSize > available)
+            valueSize = available;
+        size_t rangeValues = _resultSize - addFirst - addLast;
+        size_t deliveredValues = (skip > 0 && addFirst) ? skip - 1 : skip;
+        if (deliveredValues >= rangeValues)
+            valueSize = 0;
+        else if (valueSize > rangeValues - deliveredValues)
+            valueSize = rangeValues - deliveredValues;
+
+        /* One more value is copied into the spare slot to set the cursor */
+        size_t retval = 0;
+        size_t copySize = (valueSize < available) ? valueSize + 1 : valueSize;
+        UA_ByteString backendOutContinuationPoint;
+        UA_ByteString_init(&backendOutContinuationPoint);
+        if (ret == UA_STATUSCODE_GOOD && copySize > 0)
             ret = backend->copyDataValues(server,
                                           backend->context,
                                           sessionId,
                                           sessionContext,
                                           nodeId,
-                                          startIndex,
+                                          index,
                                           endIndex,
                                           reverse,
-                                          valueSize,
+                                          copySize,
                                           range,
-                                          releaseContinuationPoints,
+                                          false,
                                           &backendContinuationPoint,
                                           &backendOutContinuationPoint,
                                           &retval,
                                           &outResult[counter]);
+        UA_ByteString_clear(&backendContinuationPoint);
+        UA_ByteString_clear(&backendOutContinuationPoint);
         if (ret != UA_STATUSCODE_GOOD) {
-            UA_Array_delete(outResult, *resultSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
+            UA_Array_delete(outResult, *resultSize + 1, &UA_TYPES[UA_TYPES_DATAVALUE]);
             *result = NULL;
             *resultSize = 0;
             return ret;
         }
+
+        if (retval > valueSize) {
+            /* Count the values of the page with the same timestamp as the
+             * next value. The count continues if the page did not move past
+             * the timestamp of the cursor. */
+            UA_DataValue *next = &outResult[counter + valueSize];
+            UA_DateTime t = getCursorTimestamp(next);
+            UA_UInt64 duplicates = 0;
+            size_t i = counter + valueSize;
+            while (i > counter && getCursorTimestamp(&outResult[i-1]) == t) {
+                duplicates++;
+                i--;
+            }
+            if (i == counter && skip > 0 && t == cursor.timestamp)
+                duplicates += cursor.duplicates;
+            UA_DataValue_clear(next);
+            cursor.timestamp = t;
+            cursor.duplicates = duplicates;
+            cursorSet = true;
+            moreValues = valueSize > 0;
+            retval = valueSize;
+        }
         counter += retval;
     }
+    cursor.valuesDone = !cursorSet;
+
+    UA_Boolean lastAdded = false;
     if (addLast && counter < *resultSize) {
         outResult[counter].hasStatus = true;
         outResult[counter].status = UA_STATUSCODE_BADBOUNDNOTFOUND;
@@ -272,25 +422,30 @@ getHistoryData_service_default(const UA_HistoryDataBackend* backend,
         } else {
             outResult[counter].sourceTimestamp = end;
         }
+        ++counter;
+        lastAdded = true;
     }
-    // there are more values
-    if (skip + *resultSize < _resultSize
+    *resultSize = counter;
+
+    // there are more values. Values inserted before the cursor are not
+    // counted, so the cursor decides without a limit of values per node.
+    if ((cursorSet && numValuesPerNode == 0)
+            || (numValuesPerNode != 0 && skip + counter < _resultSize)
+            // the last bound did not fit into this response
+            || (addLast && !lastAdded)
             // there are not more values for this request, but there are more values in database
-            || (backendOutContinuationPoint.length > 0
-                && numValuesPerNode != 0)
+            || (moreValues && numValuesPerNode != 0)
             // we deliver just one value which is a FIRST/LAST value
             || (skip == 0
                 && addFirst == true
-                && *resultSize == 1)) {
-        if(UA_ByteString_allocBuffer(outContinuationPoint, backendOutContinuationPoint.length + sizeof(size_t))
+                && counter == 1)) {
+        if(UA_ByteString_allocBuffer(outContinuationPoint, sizeof(UA_HistoryDataCursor))
                 != UA_STATUSCODE_GOOD) {
             return UA_STATUSCODE_BADOUTOFMEMORY;
         }
-        *((size_t*)(outContinuationPoint->data)) = skip + *resultSize;
-        if(backendOutContinuationPoint.length > 0)
-            memcpy(outContinuationPoint->data + sizeof(size_t), backendOutContinuationPoint.data, backendOutContinuationPoint.length);
+        cursor.delivered = skip + counter;
+        memcpy(outContinuationPoint->data, &cursor, sizeof(UA_HistoryDataCursor));
     }
-    UA_ByteString_clear(&backendOutContinuationPoint);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -304,6 +459,7 @@ updateData_service_default(UA_Server *server,
                            UA_HistoryUpdateResult *result)
 {
     UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)hdbContext;
+    flushIngestionQueue(server, ctx);
     UA_Byte accessLevel = 0;
     UA_Server_readAccessLevel(server,
                               details->nodeId,
@@ -404,6 +560,7 @@ deleteRawModified_service_default(UA_Server *server,
         return;
     }
     UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)hdbContext;
+    flushIngestionQueue(server, ctx);
     UA_Byte accessLevel = 0;
     UA_Server_readAccessLevel(server,
                               details->nodeId,
@@ -469,6 +626,7 @@ readRaw_service_default(UA_Server *server,
                         UA_HistoryData * const * const historyData)
 {
     UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
+    flushIngestionQueue(server, ctx);
     for (size_t i = 0; i < nodesToReadSize; ++i) {
         UA_Byte accessLevel = 0;
         UA_Server_readAccessLevel(server,
@@ -578,6 +736,93 @@ readRaw_service_default(UA_Server *server,
     return;
 }
 
+static void
+readProcessed_service_default(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_RequestHeader *requestHeader,
+                              const UA_ReadProcessedDetails *historyReadDetails,
+                              UA_TimestampsToReturn timestampsToReturn,
+                              UA_Boolean releaseContinuationPoints,
+                              size_t nodesToReadSize,
+                              const UA_HistoryReadValueId *nodesToRead,
+                              UA_HistoryReadResponse *response,
+                              UA_HistoryData * const * const historyData)
+{
+    if (historyReadDetails->aggregateTypeSize != nodesToReadSize) {
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADAGGREGATELISTMISMATCH;
+        return;
+    }
+    UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
+    flushIngestionQueue(server, ctx);
+    for (size_t i = 0; i < nodesToReadSize; ++i) {
+        UA_Byte accessLevel = 0;
+        UA_Server_readAccessLevel(server,
+                                  nodesToRead[i].nodeId,
+                                  &accessLevel);
+        if (!(accessLevel & UA_ACCESSLEVELMASK_HISTORYREAD)) {
+            response->results[i].statusCode = UA_STATUSCODE_BADUSERACCESSDENIED;
+            continue;
+        }
+
+        UA_Boolean historizing = false;
+        UA_Server_readHistorizing(server,
+                                  nodesToRead[i].nodeId,
+                                  &historizing);
+        if (!historizing) {
+            response->results[i].statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+            continue;
+        }
+
+        const UA_HistorizingNodeIdSettings *setting = ctx->gathering.getHistorizingSetting(
+                    server,
+                    ctx->gathering.context,
+                    &nodesToRead[i].nodeId);
+
+        if (!setting) {
+            response->results[i].statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+            continue;
+        }
+
+        if (!UA_HistoryAggregate_supported(&historyReadDetails->aggregateType[i])) {
+            response->results[i].statusCode = UA_STATUSCODE_BADAGGREGATENOTSUPPORTED;
+            continue;
+        }
+
+        if (!setting->historizingBackend.timestampsToReturnSupported(
+                    server,
+                    setting->historizingBackend.context,
+                    sessionId,
+                    sessionContext,
+                    &nodesToRead[i].nodeId,
+                    timestampsToReturn)) {
+            response->results[i].statusCode = UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+            continue;
+        }
+
+        /* The intervals are computed again for every request. So there is
+         * nothing to release. */
+        if (releaseContinuationPoints)
+            continue;
+
+        response->results[i].statusCode =
+            UA_HistoryAggregate_read(&setting->historizingBackend,
+                                     server,
+                                     sessionId,
+                                     sessionContext,
+                                     &nodesToRead[i].nodeId,
+                                     historyReadDetails,
+                                     &historyReadDetails->aggregateType[i],
+                                     setting->maxHistoryDataResponseSize,
+                                     timestampsToReturn,
+                                     &nodesToRead[i].continuationPoint,
+                                     &response->results[i].continuationPoint,
+                                     historyData[i]);
+    }
+    response->responseHeader.serviceResult = UA_STATUSCODE_GOOD;
+}
+
 static void
 setValue_service_default(UA_Server *server,
                          void *context,
@@ -588,6 +833,10 @@ setValue_service_default(UA_Server *server,
                          const UA_DataValue *value)
 {
     UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
+    if (ctx->queue) {
+        UA_HistoryIngestionQueue_enqueue(ctx->queue, server, nodeId, historizing, value);
+        return;
+    }
     if (ctx->gathering.setValue)
         ctx->gathering.setValue(server,
                                 ctx->gathering.context,
@@ -598,13 +847,86 @@ setValue_service_default(UA_Server *server,
                                 value);
 }
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+static void
+readEvent_service_default(UA_Server *server,
+                          void *context,
+                          const UA_NodeId *sessionId,
+                          void *sessionContext,
+                          const UA_RequestHeader *requestHeader,
+                          const UA_ReadEventDetails *historyReadDetails,
+                          UA_TimestampsToReturn timestampsToReturn,
+                          UA_Boolean releaseContinuationPoints,
+                          size_t nodesToReadSize,
+                          const UA_HistoryReadValueId *nodesToRead,
+                          UA_HistoryReadResponse *response,
+                          UA_HistoryEvent * const * const historyData)
+{
+    UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
+    UA_HistoryEventBackend *backend = &ctx->eventBackend;
+    for (size_t i = 0; i < nodesToReadSize; ++i) {
+        UA_Byte eventNotifier = 0;
+        UA_Server_readEventNotifier(server,
+                                    nodesToRead[i].nodeId,
+                                    &eventNotifier);
+        if (!(eventNotifier & UA_EVENTNOTIFIER_HISTORY_READ)) {
+            response->results[i].statusCode = UA_STATUSCODE_BADUSERACCESSDENIED;
+            continue;
+        }
+
+        /* The continuation point only holds the position of the next event.
+         * So there is nothing to release. */
+        if (releaseContinuationPoints)
+            continue;
+
+        response->results[i].statusCode =
+            backend->readEvents(server,
+                                backend->context,
+                                sessionId,
+                                sessionContext,
+                                &nodesToRead[i].nodeId,
+                                historyReadDetails,
+                                0,
+                                &nodesToRead[i].continuationPoint,
+                                &response->results[i].continuationPoint,
+                                historyData[i]);
+    }
+    response->responseHeader.serviceResult = UA_STATUSCODE_GOOD;
+}
+
+static void
+setEvent_service_default(UA_Server *server,
+                         void *context,
+                         const UA_NodeId *originId,
+                         const UA_NodeId *emitterId,
+                         const UA_EventFilter *historicalEventFilter,
+                         UA_EventFieldList *fieldList)
+{
+    UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
+    ctx->eventBackend.serverSetHistoricalEvent(server,
+                                               ctx->eventBackend.context,
+                                               originId,
+                                               emitterId,
+                                               historicalEventFilter,
+                                               fieldList);
+}
+#endif
+
 static void
 clear_service_default(UA_HistoryDatabase *hdb)
 {
     if (hdb == NULL || hdb->context == NULL)
         return;
     UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)hdb->context;
+    if (ctx->queue) {
+        UA_HistoryIngestionQueue_clear(ctx->queue);
+        UA_free(ctx->queue);
+    }
     ctx->gathering.deleteMembers(&ctx->gathering);
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    if (ctx->eventBackend.deleteMembers)
+        ctx->eventBackend.deleteMembers(&ctx->eventBackend);
+#endif
     UA_free(ctx);
 }
 
@@ -619,9 +941,74 @@ UA_HistoryDatabase_default(UA_HistoryDataGathering gathering)
     context->gathering = gathering;
     hdb.context = context;
     hdb.readRaw = &readRaw_service_default;
+    hdb.readProcessed = &readProcessed_service_default;
     hdb.setValue = &setValue_service_default;
     hdb.updateData = &updateData_service_default;
     hdb.deleteRawModified = &deleteRawModified_service_default;
     hdb.clear = clear_service_default;
     return hdb;
 }
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+UA_HistoryDatabase
+UA_HistoryDatabase_defaultWithEvents(UA_HistoryDataGathering gathering,
+                                     UA_HistoryEventBackend eventBackend)
+{
+    UA_HistoryDatabase hdb = UA_HistoryDatabase_default(gathering);
+    UA_HistoryDatabaseContext_default *context =
+            (UA_HistoryDatabaseContext_default*)hdb.context;
+    context->eventBackend = eventBackend;
+    hdb.setEvent = &setEvent_service_default;
+    hdb.readEvent = &readEvent_service_default;
+    return hdb;
+}
+#endif
+
+UA_StatusCode
+UA_HistoryDatabase_enableIngestionQueue(UA_HistoryDatabase *hdb, size_t queueSize,
+                                        size_t batchSize, UA_Double drainInterval)
+{
+    if (hdb == NULL || hdb->context == NULL ||
+        hdb->setValue != &setValue_service_default)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)hdb->context;
+    if (ctx->queue)
+        return UA_STATUSCODE_BADINVALIDSTATE;
+    UA_HistoryIngestionQueue *queue = (UA_HistoryIngestionQueue*)
+        UA_malloc(sizeof(UA_HistoryIngestionQueue));
+    if (!queue)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode res = UA_HistoryIngestionQueue_init(queue, &ctx->gathering, queueSize,
+                                                      batchSize, drainInterval);
+    if (res != UA_STATUSCODE_GOOD) {
+        UA_free(queue);
+        return res;
+    }
+    ctx->queue = queue;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_HistoryDatabase_getIngestionStatistics(const UA_HistoryDatabase *hdb,
+                                          UA_HistoryIngestionStatistics *stats)
+{
+    if (hdb == NULL || hdb->context == NULL ||
+        hdb->setValue != &setValue_service_default)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    const UA_HistoryDatabaseContext_default *ctx =
+        (const UA_HistoryDatabaseContext_default*)hdb->context;
+    if (!ctx->queue)
+        return UA_STATUSCODE_BADINVALIDSTATE;
+    UA_HistoryIngestionQueue_getStatistics(ctx->queue, stats);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_HistoryDatabase_flushIngestionQueue(UA_Server *server, UA_HistoryDatabase *hdb)
+{
+    if (hdb == NULL || hdb->context == NULL ||
+        hdb->setValue != &setValue_service_default)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    flushIngestionQueue(server, (UA_HistoryDatabaseContext_default*)hdb->context);
+    return UA_STATUSCODE_GOOD;
+}
@@ -0,0 +1,894 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_event_backend_memory.h>
+
+#include "ua_history_nodeid_index.h"
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+
+#define EVENT_NOFIELD ((size_t)-1)
+#define EVENT_NOTYPE UA_UINT32_MAX
+
+/* Select clauses of a HistoricalEventFilter. All events of an emitter that
+ * were stored with the same select clauses share the schema. */
+typedef struct {
+    UA_SimpleAttributeOperand *clauses;
+    size_t clausesSize;
+    size_t timeField; /* Position of the Time field or EVENT_NOFIELD */
+    size_t typeField; /* Position of the EventType field or EVENT_NOFIELD */
+} UA_EventSchema;
+
+/* The encoded event starts with the offsets of the fields relative to the
+ * beginning of the encoded event. The offset table has clausesSize + 1
+ * entries, so that the end of the last field is known. */
+typedef struct {
+    UA_DateTime time;
+    UA_UInt64 sequence; /* Order of insertion for events with the same time */
+    UA_UInt32 schema;
+    UA_UInt32 type;     /* Index in the EventTypes of the emitter or EVENT_NOTYPE */
+    size_t offset;      /* Position of the encoded event in the buffer */
+    size_t length;
+} UA_EventMemoryStoreItem;
+
+typedef struct {
+    UA_NodeId nodeId; /* Emitter */
+    UA_EventSchema *schemas;
+    size_t schemasSize;
+    UA_NodeId *types; /* Distinct EventTypes of the stored events */
+    size_t typesSize;
+
+    /* Sorted by (time, sequence). The live events are [eventsBegin,
+     * eventsEnd). Dropped events are removed from the front. */
+    UA_EventMemoryStoreItem *events;
+    size_t eventsBegin;
+    size_t eventsEnd;
+    size_t eventsSize;
+    UA_UInt64 nextSequence;
+
+    /* Encoded events. Dropped events leave gaps that are removed when the
+     * buffer is compacted. */
+    UA_Byte *buffer;
+    size_t bufferEnd;
+    size_t bufferSize;
+    size_t bufferLive;
+} UA_NodeIdStoreContextItem_event_memory;
+
+typedef struct {
+    UA_NodeIdStoreContextItem_event_memory *dataStore;
+    size_t storeEnd;
+    size_t storeSize;
+    size_t maxEventsPerNode;
+    UA_HistoryNodeIdIndex index; /* Position of the NodeIds in the dataStore */
+} UA_EventMemoryStoreContext;
+
+static void
+UA_EventSchema_clear(UA_EventSchema *schema) {
+    UA_Array_delete(schema->clauses, schema->clausesSize,
+                    &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    memset(schema, 0, sizeof(UA_EventSchema));
+}
+
+static void
+UA_NodeIdStoreContextItem_event_memory_clear(UA_NodeIdStoreContextItem_event_memory *item) {
+    UA_NodeId_clear(&item->nodeId);
+    for(size_t i = 0; i < item->schemasSize; i++)
+        UA_EventSchema_clear(&item->schemas[i]);
+    UA_free(item->schemas);
+    UA_Array_delete(item->types, item->typesSize, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_free(item->events);
+    UA_free(item->buffer);
+    memset(item, 0, sizeof(UA_NodeIdStoreContextItem_event_memory));
+}
+
+static UA_NodeIdStoreContextItem_event_memory *
+getNodeIdStoreContextItem_event_memory(UA_EventMemoryStoreContext *ctx,
+                                       const UA_NodeId *nodeId) {
+    size_t i = UA_HistoryNodeIdIndex_find(&ctx->index, ctx->dataStore, nodeId);
+    if(i != UA_HISTORYNODEIDINDEX_NOTFOUND)
+        return &ctx->dataStore[i];
+    return NULL;
+}
+
+static UA_NodeIdStoreContextItem_event_memory *
+getNewNodeIdStoreContextItem_event_memory(UA_EventMemoryStoreContext *ctx,
+                                          const UA_NodeId *nodeId) {
+    if(ctx->storeEnd >= ctx->storeSize) {
+        size_t newStoreSize = (ctx->storeSize == 0) ? 1 : ctx->storeSize * 2;
+        UA_NodeIdStoreContextItem_event_memory *newStore =
+            (UA_NodeIdStoreContextItem_event_memory*)
+            UA_realloc(ctx->dataStore, newStoreSize *
+                       sizeof(UA_NodeIdStoreContextItem_event_memory));
+        if(!newStore)
+            return NULL;
+        ctx->dataStore = newStore;
+        ctx->storeSize = newStoreSize;
+    }
+    UA_NodeIdStoreContextItem_event_memory *item = &ctx->dataStore[ctx->storeEnd];
+    memset(item, 0, sizeof(UA_NodeIdStoreContextItem_event_memory));
+    if(UA_NodeId_copy(nodeId, &item->nodeId) != UA_STATUSCODE_GOOD)
+        return NULL;
+    if(UA_HistoryNodeIdIndex_add(&ctx->index, ctx->dataStore,
+                                 ctx->storeEnd) != UA_STATUSCODE_GOOD) {
+        UA_NodeIdStoreContextItem_event_memory_clear(item);
+        return NULL;
+    }
+    ++ctx->storeEnd;
+    return item;
+}
+
+/***********/
+/* Schemas */
+/***********/
+
+/* The TypeDefinitionId is not compared. The BrowsePath relative to the event
+ * identifies the field. */
+static UA_Boolean
+sameField(const UA_SimpleAttributeOperand *a, const UA_SimpleAttributeOperand *b) {
+    if(a->attributeId != b->attributeId ||
+       a->browsePathSize != b->browsePathSize ||
+       !UA_String_equal(&a->indexRange, &b->indexRange))
+        return false;
+    for(size_t i = 0; i < a->browsePathSize; i++) {
+        if(!UA_QualifiedName_equal(&a->browsePath[i], &b->browsePath[i]))
+            return false;
+    }
+    return true;
+}
+
+static size_t
+findField(const UA_EventSchema *schema, const UA_SimpleAttributeOperand *sao) {
+    for(size_t i = 0; i < schema->clausesSize; i++) {
+        if(sameField(sao, &schema->clauses[i]))
+            return i;
+    }
+    return EVENT_NOFIELD;
+}
+
+static size_t
+findStandardField(const UA_EventSchema *schema, const char *name) {
+    UA_QualifiedName qn = UA_QUALIFIEDNAME(0, (char*)(uintptr_t)name);
+    for(size_t i = 0; i < schema->clausesSize; i++) {
+        const UA_SimpleAttributeOperand *sao = &schema->clauses[i];
+        if(sao->attributeId == UA_ATTRIBUTEID_VALUE && sao->browsePathSize == 1 &&
+           sao->indexRange.length == 0 &&
+           UA_QualifiedName_equal(&sao->browsePath[0], &qn))
+            return i;
+    }
+    return EVENT_NOFIELD;
+}
+
+/* Returns the index of the schema for the select clauses. Adds a new schema
+ * if the HistoricalEventFilter has changed. */
+static UA_StatusCode
+getSchema(UA_NodeIdStoreContextItem_event_memory *item,
+          const UA_EventFilter *filter, UA_UInt32 *out) {
+    for(size_t i = item->schemasSize; i > 0; i--) {
+        const UA_EventSchema *schema = &item->schemas[i - 1];
+        if(schema->clausesSize != filter->selectClausesSize)
+            continue;
+        size_t j = 0;
+        for(; j < schema->clausesSize; j++) {
+            if(!sameField(&schema->clauses[j], &filter->selectClauses[j]))
+                break;
+        }
+        if(j == schema->clausesSize) {
+            *out = (UA_UInt32)(i - 1);
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+
+    UA_EventSchema *schemas = (UA_EventSchema*)
+        UA_realloc(item->schemas, (item->schemasSize + 1) * sizeof(UA_EventSchema));
+    if(!schemas)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    item->schemas = schemas;
+    UA_EventSchema *schema = &schemas[item->schemasSize];
+    memset(schema, 0, sizeof(UA_EventSchema));
+    UA_StatusCode res =
+        UA_Array_copy(filter->selectClauses, filter->selectClausesSize,
+                      (void**)&schema->clauses,
+                      &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    schema->clausesSize = filter->selectClausesSize;
+    schema->timeField = findStandardField(schema, "Time");
+    schema->typeField = findStandardField(schema, "EventType");
+    *out = (UA_UInt32)item->schemasSize;
+    item->schemasSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+getType(UA_NodeIdStoreContextItem_event_memory *item,
+        const UA_NodeId *type, UA_UInt32 *out) {
+    for(size_t i = 0; i < item->typesSize; i++) {
+        if(UA_NodeId_equal(&item->types[i], type)) {
+            *out = (UA_UInt32)i;
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+    UA_StatusCode res = UA_Array_appendCopy((void**)&item->types, &item->typesSize,
+                                            type, &UA_TYPES[UA_TYPES_NODEID]);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    *out = (UA_UInt32)(item->typesSize - 1);
+    return UA_STATUSCODE_GOOD;
+}
+
+/************/
+/* Encoding */
+/************/
+
+static UA_StatusCode
+reserveBuffer(UA_NodeIdStoreContextItem_event_memory *item, size_t length) {
+    if(item->bufferEnd + length <= item->bufferSize)
+        return UA_STATUSCODE_GOOD;
+
+    /* Drop the gaps of dropped events when the buffer is half empty. The
+     * events are copied in the order of their time. */
+    UA_Byte *buffer;
+    if(item->bufferLive < item->bufferEnd / 2 &&
+       item->bufferLive + length <= item->bufferSize) {
+        buffer = (UA_Byte*)UA_malloc(item->bufferSize);
+        if(!buffer)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        size_t pos = 0;
+        for(size_t i = item->eventsBegin; i < item->eventsEnd; i++) {
+            UA_EventMemoryStoreItem *e = &item->events[i];
+            memcpy(&buffer[pos], &item->buffer[e->offset], e->length);
+            e->offset = pos;
+            pos += e->length;
+        }
+        UA_free(item->buffer);
+        item->buffer = buffer;
+        item->bufferEnd = pos;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    size_t newSize = (item->bufferSize == 0) ? 1024 : item->bufferSize * 2;
+    while(newSize < item->bufferEnd + length)
+        newSize *= 2;
+    buffer = (UA_Byte*)UA_realloc(item->buffer, newSize);
+    if(!buffer)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    item->buffer = buffer;
+    item->bufferSize = newSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Encode the fields with an offset table in front */
+static UA_StatusCode
+encodeEvent(UA_NodeIdStoreContextItem_event_memory *item,
+            const UA_EventFieldList *fieldList, size_t *offset, size_t *length) {
+    size_t fields = fieldList->eventFieldsSize;
+    size_t header = (fields + 1) * sizeof(UA_UInt32);
+    size_t total = header;
+    for(size_t i = 0; i < fields; i++)
+        total += UA_calcSizeBinary(&fieldList->eventFields[i], &UA_TYPES[UA_TYPES_VARIANT]);
+    if(total > UA_UINT32_MAX)
+        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+
+    UA_StatusCode res = reserveBuffer(item, total);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    UA_Byte *base = &item->buffer[item->bufferEnd];
+    UA_UInt32 pos = (UA_UInt32)header;
+    for(size_t i = 0; i < fields; i++) {
+        memcpy(&base[i * sizeof(UA_UInt32)], &pos, sizeof(UA_UInt32));
+        UA_ByteString out = {total - pos, &base[pos]};
+        res = UA_encodeBinary(&fieldList->eventFields[i],
+                              &UA_TYPES[UA_TYPES_VARIANT], &out);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        pos += (UA_UInt32)out.length;
+    }
+    memcpy(&base[fields * sizeof(UA_UInt32)], &pos, sizeof(UA_UInt32));
+
+    *offset = item->bufferEnd;
+    *length = total;
+    item->bufferEnd += total;
+    item->bufferLive += total;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+decodeField(const UA_NodeIdStoreContextItem_event_memory *item,
+            const UA_EventMemoryStoreItem *event, size_t field, UA_Variant *out) {
+    const UA_Byte *base = &item->buffer[event->offset];
+    UA_UInt32 begin, end;
+    memcpy(&begin, &base[field * sizeof(UA_UInt32)], sizeof(UA_UInt32));
+    memcpy(&end, &base[(field + 1) * sizeof(UA_UInt32)], sizeof(UA_UInt32));
+    UA_ByteString in = {end - begin, (UA_Byte*)(uintptr_t)&base[begin]};
+    return UA_decodeBinary(&in, out, &UA_TYPES[UA_TYPES_VARIANT], NULL);
+}
+
+/**********/
+/* Insert */
+/**********/
+
+static UA_Order
+compareEvents(UA_DateTime time, UA_UInt64 sequence, const UA_EventMemoryStoreItem *e) {
+    if(time != e->time)
+        return (time < e->time) ? UA_ORDER_LESS : UA_ORDER_MORE;
+    if(sequence != e->sequence)
+        return (sequence < e->sequence) ? UA_ORDER_LESS : UA_ORDER_MORE;
+    return UA_ORDER_EQ;
+}
+
+/* Position of the first event at or after (time, sequence) */
+static size_t
+lowerBound(const UA_NodeIdStoreContextItem_event_memory *item,
+           UA_DateTime time, UA_UInt64 sequence) {
+    size_t lo = item->eventsBegin, hi = item->eventsEnd;
+    while(lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2);
+        if(compareEvents(time, sequence, &item->events[mid]) == UA_ORDER_MORE)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void
+dropOldest(UA_NodeIdStoreContextItem_event_memory *item) {
+    item->bufferLive -= item->events[item->eventsBegin].length;
+    item->eventsBegin++;
+    if(item->eventsBegin == item->eventsEnd) {
+        item->eventsBegin = 0;
+        item->eventsEnd = 0;
+        item->bufferEnd = 0;
+        item->bufferLive = 0;
+    }
+}
+
+static UA_StatusCode
+reserveEvent(UA_NodeIdStoreContextItem_event_memory *item) {
+    if(item->eventsEnd < item->eventsSize)
+        return UA_STATUSCODE_GOOD;
+    /* Reclaim the space of dropped events if they take half of the array */
+    if(item->eventsBegin > 0 && item->eventsBegin >= item->eventsSize / 2) {
+        memmove(item->events, &item->events[item->eventsBegin],
+                (item->eventsEnd - item->eventsBegin) * sizeof(UA_EventMemoryStoreItem));
+        item->eventsEnd -= item->eventsBegin;
+        item->eventsBegin = 0;
+        return UA_STATUSCODE_GOOD;
+    }
+    size_t newSize = (item->eventsSize == 0) ? 64 : item->eventsSize * 2;
+    UA_EventMemoryStoreItem *events = (UA_EventMemoryStoreItem*)
+        UA_realloc(item->events, newSize * sizeof(UA_EventMemoryStoreItem));
+    if(!events)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    item->events = events;
+    item->eventsSize = newSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+serverSetHistoricalEvent_event_memory(UA_Server *server, void *context,
+                                      const UA_NodeId *originId,
+                                      const UA_NodeId *emitterId,
+                                      const UA_EventFilter *historicalEventFilter,
+                                      const UA_EventFieldList *fieldList) {
+    UA_EventMemoryStoreContext *ctx = (UA_EventMemoryStoreContext*)context;
+    if(!historicalEventFilter ||
+       fieldList->eventFieldsSize != historicalEventFilter->selectClausesSize)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    UA_NodeIdStoreContextItem_event_memory *item =
+        getNodeIdStoreContextItem_event_memory(ctx, emitterId);
+    if(!item)
+        item = getNewNodeIdStoreContextItem_event_memory(ctx, emitterId);
+    if(!item)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_EventMemoryStoreItem event;
+    memset(&event, 0, sizeof(UA_EventMemoryStoreItem));
+    UA_StatusCode res = getSchema(item, historicalEventFilter, &event.schema);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    const UA_EventSchema *schema = &item->schemas[event.schema];
+
+    /* Index the Time and the EventType */
+    event.time = UA_DateTime_now();
+    if(schema->timeField != EVENT_NOFIELD) {
+        /* The Time is usually returned with the UtcTime subtype */
+        const UA_Variant *time = &fieldList->eventFields[schema->timeField];
+        if(UA_Variant_isScalar(time) && time->type &&
+           time->type->typeKind == UA_DATATYPEKIND_DATETIME)
+            event.time = *(UA_DateTime*)time->data;
+    }
+    event.type = EVENT_NOTYPE;
+    if(schema->typeField != EVENT_NOFIELD &&
+       UA_Variant_hasScalarType(&fieldList->eventFields[schema->typeField],
+                                &UA_TYPES[UA_TYPES_NODEID])) {
+        res = getType(item, (const UA_NodeId*)
+                      fieldList->eventFields[schema->typeField].data, &event.type);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+
+    if(ctx->maxEventsPerNode > 0 &&
+       item->eventsEnd - item->eventsBegin >= ctx->maxEventsPerNode) {
+        /* The event is older than all retained events */
+        if(event.time < item->events[item->eventsBegin].time)
+            return UA_STATUSCODE_GOOD;
+        dropOldest(item);
+    }
+
+    res = reserveEvent(item);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = encodeEvent(item, fieldList, &event.offset, &event.length);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    event.sequence = item->nextSequence++;
+
+    /* Events usually arrive in the order of their time */
+    size_t pos = item->eventsEnd;
+    if(pos > item->eventsBegin && event.time < item->events[pos - 1].time) {
+        pos = lowerBound(item, event.time, event.sequence);
+        memmove(&item->events[pos + 1], &item->events[pos],
+                (item->eventsEnd - pos) * sizeof(UA_EventMemoryStoreItem));
+    }
+    item->events[pos] = event;
+    item->eventsEnd++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/********/
+/* Read */
+/********/
+
+/* Per-schema mapping of the request to the stored fields */
+typedef struct {
+    UA_Boolean prepared;
+    size_t *select;    /* Stored field of each select clause or EVENT_NOFIELD */
+    UA_Boolean *where; /* Stored fields used by the where-clause */
+    UA_Variant *fields;
+} UA_EventSchemaMapping;
+
+typedef struct {
+    UA_Server *server;
+    UA_NodeIdStoreContextItem_event_memory *item;
+    const UA_EventFilter *filter;
+
+    /* OfType operators that must match for the where-clause to match */
+    const UA_ContentFilterElement *ofType[8];
+    size_t ofTypeSize;
+    UA_Byte *typeMatch; /* 0: unknown, 1: match, 2: no match */
+    UA_EventSchemaMapping *mappings;
+
+    /* The where-clause for events of a matching type. The prefiltered OfType
+     * elements are replaced by a constant true comparison. If nothing else
+     * remains to be checked, the where-clause is not evaluated per event. */
+    UA_ContentFilter where;
+    UA_Boolean whereTypeOnly;
+    UA_Boolean trueValue;
+    UA_LiteralOperand trueLiteral;
+    UA_ExtensionObject trueOperands[2];
+} UA_EventReadContext;
+
+/* Collect the OfType elements that are reached from the first element through
+ * And operators only */
+static void
+collectOfType(UA_EventReadContext *rc, const UA_ContentFilter *where,
+              size_t index, size_t depth) {
+    if(index >= where->elementsSize || depth > where->elementsSize)
+        return;
+    const UA_ContentFilterElement *e = &where->elements[index];
+    if(e->filterOperator == UA_FILTEROPERATOR_OFTYPE) {
+        if(rc->ofTypeSize < 8)
+            rc->ofType[rc->ofTypeSize++] = e;
+        return;
+    }
+    if(e->filterOperator != UA_FILTEROPERATOR_AND)
+        return;
+    for(size_t i = 0; i < e->filterOperandsSize; i++) {
+        const UA_ExtensionObject *op = &e->filterOperands[i];
+        if(op->content.decoded.type != &UA_TYPES[UA_TYPES_ELEMENTOPERAND])
+            continue;
+        const UA_ElementOperand *eo = (const UA_ElementOperand*)op->content.decoded.data;
+        collectOfType(rc, where, eo->index, depth + 1);
+    }
+}
+
+static UA_Boolean
+isPrefiltered(const UA_EventReadContext *rc, const UA_ContentFilterElement *e) {
+    for(size_t i = 0; i < rc->ofTypeSize; i++) {
+        if(rc->ofType[i] == e)
+            return true;
+    }
+    return false;
+}
+
+/* Only And operators and prefiltered OfType elements are reached from the
+ * element */
+static UA_Boolean
+onlyPrefiltered(const UA_EventReadContext *rc, const UA_ContentFilter *where,
+                size_t index, size_t depth) {
+    if(index >= where->elementsSize || depth > where->elementsSize)
+        return false;
+    const UA_ContentFilterElement *e = &where->elements[index];
+    if(isPrefiltered(rc, e))
+        return true;
+    if(e->filterOperator != UA_FILTEROPERATOR_AND || e->filterOperandsSize != 2)
+        return false;
+    for(size_t i = 0; i < 2; i++) {
+        const UA_ExtensionObject *op = &e->filterOperands[i];
+        if(op->content.decoded.type != &UA_TYPES[UA_TYPES_ELEMENTOPERAND])
+            return false;
+        const UA_ElementOperand *eo = (const UA_ElementOperand*)op->content.decoded.data;
+        if(!onlyPrefiltered(rc, where, eo->index, depth + 1))
+            return false;
+    }
+    return true;
+}
+
+/* Set up the where-clause for the events of a matching type */
+static UA_StatusCode
+stripOfType(UA_EventReadContext *rc) {
+    const UA_ContentFilter *where = &rc->filter->whereClause;
+    rc->where = *where;
+    if(rc->ofTypeSize == 0)
+        return UA_STATUSCODE_GOOD;
+    rc->whereTypeOnly = onlyPrefiltered(rc, where, 0, 0);
+    if(rc->whereTypeOnly)
+        return UA_STATUSCODE_GOOD;
+
+    /* Shallow copy of the elements */
+    rc->where.elements = (UA_ContentFilterElement*)
+        UA_malloc(where->elementsSize * sizeof(UA_ContentFilterElement));
+    if(!rc->where.elements)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    memcpy(rc->where.elements, where->elements,
+           where->elementsSize * sizeof(UA_ContentFilterElement));
+
+    rc->trueValue = true;
+    UA_LiteralOperand_init(&rc->trueLiteral);
+    UA_Variant_setScalar(&rc->trueLiteral.value, &rc->trueValue,
+                         &UA_TYPES[UA_TYPES_BOOLEAN]);
+    for(size_t i = 0; i < 2; i++)
+        UA_ExtensionObject_setValueNoDelete(&rc->trueOperands[i], &rc->trueLiteral,
+                                            &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+    for(size_t i = 0; i < rc->ofTypeSize; i++) {
+        UA_ContentFilterElement *e = &rc->where.elements[rc->ofType[i] - where->elements];
+        e->filterOperator = UA_FILTEROPERATOR_EQUALS;
+        e->filterOperandsSize = 2;
+        e->filterOperands = rc->trueOperands;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+markWhereFields(const UA_EventSchema *schema, const UA_ContentFilter *where,
+                UA_Boolean *used) {
+    for(size_t i = 0; i < where->elementsSize; i++) {
+        const UA_ContentFilterElement *e = &where->elements[i];
+        for(size_t j = 0; j < e->filterOperandsSize; j++) {
+            const UA_ExtensionObject *op = &e->filterOperands[j];
+            if(op->content.decoded.type != &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND])
+                continue;
+            size_t f = findField(schema, (const UA_SimpleAttributeOperand*)
+                                 op->content.decoded.data);
+            if(f != EVENT_NOFIELD)
+                used[f] = true;
+        }
+    }
+}
+
+static UA_EventSchemaMapping *
+getMapping(UA_EventReadContext *rc, UA_UInt32 schemaIndex) {
+    UA_EventSchemaMapping *m = &rc->mappings[schemaIndex];
+    if(m->prepared)
+        return m;
+    const UA_EventSchema *schema = &rc->item->schemas[schemaIndex];
+    m->select = (size_t*)UA_calloc(rc->filter->selectClausesSize, sizeof(size_t));
+    m->where = (UA_Boolean*)UA_calloc(schema->clausesSize + 1, sizeof(UA_Boolean));
+    m->fields = (UA_Variant*)UA_calloc(schema->clausesSize + 1, sizeof(UA_Variant));
+    if(!m->select || !m->where || !m->fields)
+        return NULL;
+    for(size_t i = 0; i < rc->filter->selectClausesSize; i++)
+        m->select[i] = findField(schema, &rc->filter->selectClauses[i]);
+    markWhereFields(schema, &rc->filter->whereClause, m->where);
+    m->prepared = true;
+    return m;
+}
+
+static void
+UA_EventReadContext_clear(UA_EventReadContext *rc) {
+    if(rc->mappings) {
+        for(size_t i = 0; i < rc->item->schemasSize; i++) {
+            UA_free(rc->mappings[i].select);
+            UA_free(rc->mappings[i].where);
+            UA_free(rc->mappings[i].fields);
+        }
+    }
+    UA_free(rc->mappings);
+    UA_free(rc->typeMatch);
+    if(rc->where.elements != rc->filter->whereClause.elements)
+        UA_free(rc->where.elements);
+}
+
+/* Check the OfType operators once per stored EventType */
+static UA_Boolean
+typeMatches(UA_EventReadContext *rc, UA_UInt32 type) {
+    if(rc->ofTypeSize == 0 || type == EVENT_NOTYPE)
+        return true;
+    if(rc->typeMatch[type] == 0) {
+        UA_Boolean match = true;
+        for(size_t i = 0; i < rc->ofTypeSize && match; i++) {
+            UA_ContentFilter single;
+            single.elementsSize = 1;
+            single.elements = (UA_ContentFilterElement*)(uintptr_t)rc->ofType[i];
+            match = (UA_Server_evaluateWhereClauseFields(rc->server, &single,
+                                                         &rc->item->types[type],
+                                                         0, NULL, NULL) ==
+                     UA_STATUSCODE_GOOD);
+        }
+        rc->typeMatch[type] = match ? 1 : 2;
+    }
+    return (rc->typeMatch[type] == 1);
+}
+
+/* Evaluate the where-clause on the stored fields. Only the fields used by the
+ * where-clause are decoded. */
+static UA_StatusCode
+eventMatches(UA_EventReadContext *rc, const UA_EventMemoryStoreItem *event,
+             UA_EventSchemaMapping *m, UA_Boolean *match) {
+    *match = typeMatches(rc, event->type);
+    if(!*match)
+        return UA_STATUSCODE_GOOD;
+
+    /* The OfType elements were already checked for the type of the event.
+     * Events without a stored type are checked with the full where-clause. */
+    const UA_ContentFilter *where = &rc->filter->whereClause;
+    if(event->type != EVENT_NOTYPE) {
+        if(rc->whereTypeOnly)
+            return UA_STATUSCODE_GOOD;
+        where = &rc->where;
+    }
+    if(where->elementsSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    const UA_EventSchema *schema = &rc->item->schemas[event->schema];
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < schema->clausesSize && res == UA_STATUSCODE_GOOD; i++) {
+        if(m->where[i])
+            res = decodeField(rc->item, event, i, &m->fields[i]);
+    }
+    if(res == UA_STATUSCODE_GOOD) {
+        const UA_NodeId *type = (event->type != EVENT_NOTYPE) ?
+            &rc->item->types[event->type] : NULL;
+        *match = (UA_Server_evaluateWhereClauseFields(rc->server, where, type,
+                                                      schema->clausesSize,
+                                                      schema->clauses,
+                                                      m->fields) == UA_STATUSCODE_GOOD);
+    }
+    for(size_t i = 0; i < schema->clausesSize; i++)
+        UA_Variant_clear(&m->fields[i]);
+    return res;
+}
+
+static UA_StatusCode
+appendEvent(UA_EventReadContext *rc, const UA_EventMemoryStoreItem *event,
+            UA_EventSchemaMapping *m, UA_HistoryEvent *result, size_t *capacity) {
+    if(result->eventsSize == *capacity) {
+        size_t newCapacity = (*capacity == 0) ? 16 : *capacity * 2;
+        UA_HistoryEventFieldList *events = (UA_HistoryEventFieldList*)
+            UA_realloc(result->events, newCapacity * sizeof(UA_HistoryEventFieldList));
+        if(!events)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        result->events = events;
+        *capacity = newCapacity;
+    }
+
+    size_t fields = rc->filter->selectClausesSize;
+    UA_HistoryEventFieldList *efl = &result->events[result->eventsSize];
+    UA_HistoryEventFieldList_init(efl);
+    efl->eventFields = (UA_Variant*)UA_Array_new(fields, &UA_TYPES[UA_TYPES_VARIANT]);
+    if(!efl->eventFields)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    efl->eventFieldsSize = fields;
+    result->eventsSize++;
+
+    /* Fields that were not stored are left empty */
+    for(size_t i = 0; i < fields; i++) {
+        if(m->select[i] == EVENT_NOFIELD)
+            continue;
+        UA_StatusCode res = decodeField(rc->item, event, m->select[i], &efl->eventFields[i]);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Unspecified times are encoded as zero or as the minimum DateTime */
+static UA_Boolean
+timeSpecified(UA_DateTime t) {
+    return (t != 0 && t != LLONG_MIN);
+}
+
+static UA_StatusCode
+readEvents_event_memory(UA_Server *server, void *context,
+                        const UA_NodeId *sessionId, void *sessionContext,
+                        const UA_NodeId *emitterId,
+                        const UA_ReadEventDetails *details, size_t maxSize,
+                        const UA_ByteString *continuationPoint,
+                        UA_ByteString *outContinuationPoint,
+                        UA_HistoryEvent *result) {
+    UA_EventMemoryStoreContext *ctx = (UA_EventMemoryStoreContext*)context;
+    const UA_EventFilter *filter = &details->filter;
+    if(filter->selectClausesSize == 0)
+        return UA_STATUSCODE_BADEVENTFILTERINVALID;
+
+    /* Two of StartTime, EndTime and NumValuesPerNode must be specified. Read
+     * backwards if the StartTime is unspecified or after the EndTime. */
+    UA_Boolean hasStart = timeSpecified(details->startTime);
+    UA_Boolean hasEnd = timeSpecified(details->endTime);
+    if(!hasStart && !hasEnd)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMPARGUMENT;
+    if((!hasStart || !hasEnd) && details->numValuesPerNode == 0)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMPARGUMENT;
+    UA_Boolean reverse = !hasStart || (hasEnd && details->endTime < details->startTime);
+
+    size_t limit = details->numValuesPerNode;
+    if(maxSize > 0 && (limit == 0 || maxSize < limit))
+        limit = maxSize;
+
+    UA_NodeIdStoreContextItem_event_memory *item =
+        getNodeIdStoreContextItem_event_memory(ctx, emitterId);
+    if(!item || item->eventsBegin == item->eventsEnd)
+        return UA_STATUSCODE_GOOD;
+
+    /* The range is [start, end) forward and (end, start] backwards. The
+     * continuation point holds the time and sequence number of the next
+     * event. */
+    size_t pos, stop;
+    if(!reverse) {
+        pos = lowerBound(item, details->startTime, 0);
+        stop = hasEnd ? lowerBound(item, details->endTime, 0) : item->eventsEnd;
+    } else if(hasStart) {
+        pos = lowerBound(item, details->startTime, UA_UINT64_MAX);
+        stop = lowerBound(item, details->endTime, UA_UINT64_MAX);
+    } else {
+        /* Backwards from the EndTime */
+        pos = lowerBound(item, details->endTime, UA_UINT64_MAX);
+        stop = item->eventsBegin;
+    }
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(UA_DateTime) + sizeof(UA_UInt64))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        UA_DateTime cpTime;
+        UA_UInt64 cpSequence;
+        memcpy(&cpTime, continuationPoint->data, sizeof(UA_DateTime));
+        memcpy(&cpSequence, &continuationPoint->data[sizeof(UA_DateTime)],
+               sizeof(UA_UInt64));
+        size_t cpPos = lowerBound(item, cpTime, cpSequence);
+        if(!reverse) {
+            if(cpPos < pos)
+                return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+            pos = cpPos;
+        } else {
+            /* Resume at the event of the continuation point */
+            if(cpPos < item->eventsEnd &&
+               compareEvents(cpTime, cpSequence, &item->events[cpPos]) == UA_ORDER_EQ)
+                cpPos++;
+            if(cpPos > pos)
+                return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+            pos = cpPos;
+        }
+    }
+
+    UA_EventReadContext rc;
+    memset(&rc, 0, sizeof(UA_EventReadContext));
+    rc.server = server;
+    rc.item = item;
+    rc.filter = filter;
+    collectOfType(&rc, &filter->whereClause, 0, 0);
+    UA_StatusCode res = stripOfType(&rc);
+    rc.typeMatch = (UA_Byte*)UA_calloc(item->typesSize + 1, sizeof(UA_Byte));
+    rc.mappings = (UA_EventSchemaMapping*)
+        UA_calloc(item->schemasSize, sizeof(UA_EventSchemaMapping));
+    if(res != UA_STATUSCODE_GOOD || !rc.typeMatch || !rc.mappings) {
+        UA_EventReadContext_clear(&rc);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    size_t capacity = 0;
+    const UA_EventMemoryStoreItem *next = NULL;
+    while(reverse ? (pos > stop) : (pos < stop)) {
+        const UA_EventMemoryStoreItem *event =
+            &item->events[reverse ? pos - 1 : pos];
+        if(limit > 0 && result->eventsSize == limit) {
+            next = event;
+            break;
+        }
+        pos = reverse ? pos - 1 : pos + 1;
+
+        UA_EventSchemaMapping *m = getMapping(&rc, event->schema);
+        if(!m) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        UA_Boolean match;
+        res = eventMatches(&rc, event, m, &match);
+        if(res != UA_STATUSCODE_GOOD)
+            break;
+        if(!match)
+            continue;
+        res = appendEvent(&rc, event, m, result, &capacity);
+        if(res != UA_STATUSCODE_GOOD)
+            break;
+    }
+    UA_EventReadContext_clear(&rc);
+
+    if(res == UA_STATUSCODE_GOOD && next) {
+        res = UA_ByteString_allocBuffer(outContinuationPoint,
+                                        sizeof(UA_DateTime) + sizeof(UA_UInt64));
+        if(res == UA_STATUSCODE_GOOD) {
+            memcpy(outContinuationPoint->data, &next->time, sizeof(UA_DateTime));
+            memcpy(&outContinuationPoint->data[sizeof(UA_DateTime)],
+                   &next->sequence, sizeof(UA_UInt64));
+        }
+    }
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_HistoryEvent_clear(result);
+        return res;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deleteMembers_event_memory(UA_HistoryEventBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    UA_EventMemoryStoreContext *ctx = (UA_EventMemoryStoreContext*)backend->context;
+    for(size_t i = 0; i < ctx->storeEnd; i++)
+        UA_NodeIdStoreContextItem_event_memory_clear(&ctx->dataStore[i]);
+    UA_free(ctx->dataStore);
+    UA_HistoryNodeIdIndex_clear(&ctx->index);
+    UA_free(ctx);
+}
+
+UA_HistoryEventBackend
+UA_HistoryEventBackend_Memory(size_t initialNodeIdStoreSize, size_t maxEventsPerNode) {
+    if(initialNodeIdStoreSize == 0)
+        initialNodeIdStoreSize = 1;
+    UA_HistoryEventBackend result;
+    memset(&result, 0, sizeof(UA_HistoryEventBackend));
+    UA_EventMemoryStoreContext *ctx = (UA_EventMemoryStoreContext*)
+        UA_calloc(1, sizeof(UA_EventMemoryStoreContext));
+    if(!ctx)
+        return result;
+    ctx->dataStore = (UA_NodeIdStoreContextItem_event_memory*)
+        UA_calloc(initialNodeIdStoreSize, sizeof(UA_NodeIdStoreContextItem_event_memory));
+    if(!ctx->dataStore) {
+        UA_free(ctx);
+        return result;
+    }
+    ctx->storeSize = initialNodeIdStoreSize;
+    ctx->maxEventsPerNode = maxEventsPerNode;
+    UA_HistoryNodeIdIndex_init(&ctx->index, sizeof(UA_NodeIdStoreContextItem_event_memory),
+                               offsetof(UA_NodeIdStoreContextItem_event_memory, nodeId));
+    result.context = ctx;
+    result.deleteMembers = &deleteMembers_event_memory;
+    result.serverSetHistoricalEvent = &serverSetHistoricalEvent_event_memory;
+    result.readEvents = &readEvents_event_memory;
+    return result;
+}
+
+void
+UA_HistoryEventBackend_Memory_clear(UA_HistoryEventBackend *backend) {
+    deleteMembers_event_memory(backend);
+    memset(backend, 0, sizeof(UA_HistoryEventBackend));
+}
+
+#endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
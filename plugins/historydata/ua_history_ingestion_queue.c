@@ -0,0 +1,189 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+
+#include "ua_history_ingestion_queue.h"
+
+#include <string.h>
+
+#define INGESTION_CALLBACK_NONE ((void*)0)
+#define INGESTION_CALLBACK_ADDING ((void*)1)
+#define INGESTION_CALLBACK_ADDED ((void*)2)
+
+/* The positions grow monotonically and are stored in pointer-sized atomics */
+static size_t
+loadQueueHead(UA_HistoryIngestionQueue *q) {
+    UA_atomic_sync();
+    return (size_t)(uintptr_t)q->head;
+}
+
+static UA_Boolean
+casQueueHead(UA_HistoryIngestionQueue *q, size_t expected, size_t next) {
+    void *old = UA_atomic_cmpxchg(&q->head, (void*)(uintptr_t)expected,
+                                  (void*)(uintptr_t)next);
+    return ((size_t)(uintptr_t)old == expected);
+}
+
+UA_StatusCode
+UA_HistoryIngestionQueue_init(UA_HistoryIngestionQueue *q,
+                              UA_HistoryDataGathering *gathering, size_t queueSize,
+                              size_t batchSize, UA_Double drainInterval) {
+    memset(q, 0, sizeof(UA_HistoryIngestionQueue));
+    if(queueSize == 0 || drainInterval <= 0.0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    /* The slot of a position is found with a bitmask */
+    size_t capacity = 1;
+    while(capacity < queueSize) {
+        if(capacity > (SIZE_MAX >> 1) / sizeof(UA_HistorySample))
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        capacity <<= 1;
+    }
+    q->samples = (UA_HistorySample*)UA_calloc(capacity, sizeof(UA_HistorySample));
+    if(!q->samples)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < capacity; i++)
+        q->samples[i].sequence = i;
+
+    q->gathering = gathering;
+    q->capacity = capacity;
+    q->batchSize = (batchSize > 0) ? batchSize : capacity;
+    q->drainInterval = drainInterval;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+drainIngestionQueueCallback(UA_Server *server, void *data) {
+    UA_HistoryIngestionQueue *q = (UA_HistoryIngestionQueue*)data;
+    UA_HistoryIngestionQueue_drain(q, server, q->batchSize, false);
+}
+
+void
+UA_HistoryIngestionQueue_clear(UA_HistoryIngestionQueue *q) {
+    if(!q->samples)
+        return;
+
+    /* The EventLoop of the server is already removed if it was not provided
+     * by the application */
+    if(q->callbackState == INGESTION_CALLBACK_ADDED &&
+       UA_Server_getConfig(q->server)->eventLoop)
+        UA_Server_removeCallback(q->server, q->callbackId);
+
+    UA_HistoryIngestionQueue_drain(q, q->server, 0, true);
+    UA_free(q->samples);
+    memset(q, 0, sizeof(UA_HistoryIngestionQueue));
+}
+
+UA_Boolean
+UA_HistoryIngestionQueue_enqueue(UA_HistoryIngestionQueue *q, UA_Server *server,
+                                 const UA_NodeId *nodeId, UA_Boolean historizing,
+                                 const UA_DataValue *value) {
+    /* Add the drain callback with the first sample */
+    if(q->callbackState != INGESTION_CALLBACK_ADDED &&
+       UA_atomic_cmpxchg(&q->callbackState, INGESTION_CALLBACK_NONE,
+                         INGESTION_CALLBACK_ADDING) == INGESTION_CALLBACK_NONE) {
+        q->server = server;
+        UA_StatusCode res =
+            UA_Server_addRepeatedCallback(server, drainIngestionQueueCallback, q,
+                                          q->drainInterval, &q->callbackId);
+        UA_atomic_xchg(&q->callbackState, (res == UA_STATUSCODE_GOOD) ?
+                       INGESTION_CALLBACK_ADDED : INGESTION_CALLBACK_NONE);
+    }
+
+    /* Reserve a position. The slot is free when its sequence number equals
+     * the position. A smaller sequence number means that the slot still holds
+     * the sample from one round before, so the queue is full. */
+    size_t pos = loadQueueHead(q);
+    UA_HistorySample *sample;
+    for(;;) {
+        sample = &q->samples[pos & (q->capacity - 1)];
+        UA_atomic_sync();
+        size_t seq = sample->sequence;
+        if(seq == pos) {
+            if(casQueueHead(q, pos, pos + 1))
+                break;
+            pos = loadQueueHead(q);
+        } else if(seq < pos) {
+            UA_atomic_addSize(&q->dropped, 1);
+            return false;
+        } else {
+            pos = loadQueueHead(q);
+        }
+    }
+
+    /* The slot is owned until the sequence number is published. If the copy
+     * fails, the sample is published as empty and skipped by the drain. */
+    UA_StatusCode res = UA_NodeId_copy(nodeId, &sample->nodeId);
+    if(res == UA_STATUSCODE_GOOD)
+        res = UA_DataValue_copy(value, &sample->value);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&sample->nodeId);
+        UA_DataValue_clear(&sample->value);
+        UA_atomic_addSize(&q->dropped, 1);
+    } else {
+        UA_atomic_addSize(&q->enqueued, 1);
+    }
+    sample->historizing = historizing;
+    UA_atomic_sync();
+    sample->sequence = pos + 1;
+
+    /* The high watermark is approximate with concurrent producers */
+    size_t queued = pos + 1 - q->tail;
+    if(queued > q->maxQueued)
+        q->maxQueued = queued;
+    return (res == UA_STATUSCODE_GOOD);
+}
+
+size_t
+UA_HistoryIngestionQueue_drain(UA_HistoryIngestionQueue *q, UA_Server *server,
+                               size_t maxSamples, UA_Boolean wait) {
+    while(UA_atomic_cmpxchg(&q->draining, NULL, (void*)1) != NULL) {
+        if(!wait)
+            return 0;
+    }
+
+    size_t count = 0;
+    while(maxSamples == 0 || count < maxSamples) {
+        UA_HistorySample *sample = &q->samples[q->tail & (q->capacity - 1)];
+        UA_atomic_sync();
+        if(sample->sequence != q->tail + 1)
+            break; /* Empty or the producer has not yet published */
+
+        if(!UA_NodeId_isNull(&sample->nodeId) && q->gathering->setValue) {
+            /* The session of the write is not retained */
+            q->gathering->setValue(server, q->gathering->context, NULL, NULL,
+                                   &sample->nodeId, sample->historizing,
+                                   &sample->value);
+            count++;
+        }
+        UA_NodeId_clear(&sample->nodeId);
+        UA_DataValue_clear(&sample->value);
+
+        /* Free the slot for the next round */
+        UA_atomic_sync();
+        sample->sequence = q->tail + q->capacity;
+        q->tail++;
+    }
+    UA_atomic_addSize(&q->stored, count);
+
+    UA_atomic_xchg(&q->draining, NULL);
+    return count;
+}
+
+void
+UA_HistoryIngestionQueue_getStatistics(const UA_HistoryIngestionQueue *q,
+                                       UA_HistoryIngestionStatistics *stats) {
+    memset(stats, 0, sizeof(UA_HistoryIngestionStatistics));
+    if(!q->samples)
+        return;
+    UA_atomic_sync();
+    stats->capacity = q->capacity;
+    stats->queued = (size_t)(uintptr_t)q->head - q->tail;
+    stats->maxQueued = q->maxQueued;
+    stats->enqueued = q->enqueued;
+    stats->stored = q->stored;
+    stats->dropped = q->dropped;
+}
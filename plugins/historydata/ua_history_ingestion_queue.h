@@ -0,0 +1,79 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORY_INGESTION_QUEUE_H_
+#define UA_HISTORY_INGESTION_QUEUE_H_
+
+#include <open62541/plugin/historydata/history_database_default.h>
+
+_UA_BEGIN_DECLS
+
+/* Bounded queue of the samples written to historizing nodes. Any number of
+ * threads can enqueue without taking a lock. Every slot carries a sequence
+ * number that tells whether it is free for the producer at position pos
+ * (sequence == pos) or filled for the consumer (sequence == pos + 1).
+ * Producers reserve a position with a compare-and-swap on the head.
+ *
+ * Only one drain runs at a time. A drain takes the draining flag and stores
+ * the samples in the order they were enqueued. */
+
+typedef struct {
+    volatile size_t sequence;
+    UA_NodeId nodeId;
+    UA_Boolean historizing;
+    UA_DataValue value;
+} UA_HistorySample;
+
+typedef struct {
+    UA_HistoryDataGathering *gathering; /* Receives the drained samples */
+    UA_HistorySample *samples;
+    size_t capacity; /* Power of two */
+    size_t batchSize;
+    UA_Double drainInterval;
+
+    void * volatile head; /* Next position to enqueue */
+    size_t tail;          /* Next position to drain. Owned by the drain. */
+    void * volatile draining;
+
+    /* The drain callback is added on the first enqueue */
+    UA_Server *server;
+    void * volatile callbackState;
+    UA_UInt64 callbackId;
+
+    volatile size_t enqueued;
+    volatile size_t stored;
+    volatile size_t dropped;
+    volatile size_t maxQueued;
+} UA_HistoryIngestionQueue;
+
+UA_StatusCode
+UA_HistoryIngestionQueue_init(UA_HistoryIngestionQueue *q,
+                              UA_HistoryDataGathering *gathering, size_t queueSize,
+                              size_t batchSize, UA_Double drainInterval);
+
+/* Stores the remaining samples before the queue is removed */
+void
+UA_HistoryIngestionQueue_clear(UA_HistoryIngestionQueue *q);
+
+/* Returns false if the queue is full and the sample was dropped */
+UA_Boolean
+UA_HistoryIngestionQueue_enqueue(UA_HistoryIngestionQueue *q, UA_Server *server,
+                                 const UA_NodeId *nodeId, UA_Boolean historizing,
+                                 const UA_DataValue *value);
+
+/* Stores up to maxSamples samples (no limit if zero) in the gathering. If wait
+ * is false, nothing is done while another drain is running. Returns the number
+ * of stored samples. */
+size_t
+UA_HistoryIngestionQueue_drain(UA_HistoryIngestionQueue *q, UA_Server *server,
+                               size_t maxSamples, UA_Boolean wait);
+
+void
+UA_HistoryIngestionQueue_getStatistics(const UA_HistoryIngestionQueue *q,
+                                       UA_HistoryIngestionStatistics *stats);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORY_INGESTION_QUEUE_H_ */
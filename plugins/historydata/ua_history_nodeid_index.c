@@ -0,0 +1,104 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_history_nodeid_index.h"
+
+#include <string.h>
+
+/* Open addressing with linear probing. The table is kept at most half full, so
+ * the probe sequences stay short. Collisions of the 32bit hash are resolved by
+ * comparing with the NodeId in the store. */
+
+#define UA_HISTORYNODEIDINDEX_MINSIZE 16
+
+static const UA_NodeId *
+itemNodeId(const UA_HistoryNodeIdIndex *index, const void *store, size_t position) {
+    return (const UA_NodeId*)((const UA_Byte*)store +
+                              (position * index->itemSize) + index->nodeIdOffset);
+}
+
+static void
+UA_HistoryNodeIdIndex_insertSlot(UA_HistoryNodeIdIndexSlot *slots, UA_UInt32 size,
+                                 UA_UInt32 nodeIdHash, UA_UInt32 position) {
+    UA_UInt32 mask = size - 1;
+    UA_UInt32 i = nodeIdHash & mask;
+    while(slots[i].position != 0)
+        i = (i + 1) & mask;
+    slots[i].nodeIdHash = nodeIdHash;
+    slots[i].position = position;
+}
+
+static UA_StatusCode
+UA_HistoryNodeIdIndex_expand(UA_HistoryNodeIdIndex *index) {
+    UA_UInt32 nsize = (index->size == 0) ? UA_HISTORYNODEIDINDEX_MINSIZE : index->size * 2;
+    if(nsize <= index->size)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_HistoryNodeIdIndexSlot *nslots = (UA_HistoryNodeIdIndexSlot*)
+        UA_calloc(nsize, sizeof(UA_HistoryNodeIdIndexSlot));
+    if(!nslots)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* The slots keep the hash. So the store is not needed to rehash. */
+    for(UA_UInt32 i = 0; i < index->size; i++) {
+        if(index->slots[i].position != 0)
+            UA_HistoryNodeIdIndex_insertSlot(nslots, nsize, index->slots[i].nodeIdHash,
+                                             index->slots[i].position);
+    }
+    UA_free(index->slots);
+    index->slots = nslots;
+    index->size = nsize;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_HistoryNodeIdIndex_init(UA_HistoryNodeIdIndex *index,
+                           size_t itemSize, size_t nodeIdOffset) {
+    memset(index, 0, sizeof(UA_HistoryNodeIdIndex));
+    index->itemSize = itemSize;
+    index->nodeIdOffset = nodeIdOffset;
+}
+
+void
+UA_HistoryNodeIdIndex_clear(UA_HistoryNodeIdIndex *index) {
+    UA_free(index->slots);
+    index->slots = NULL;
+    index->size = 0;
+    index->count = 0;
+}
+
+size_t
+UA_HistoryNodeIdIndex_find(const UA_HistoryNodeIdIndex *index,
+                           const void *store, const UA_NodeId *nodeId) {
+    if(index->count == 0)
+        return UA_HISTORYNODEIDINDEX_NOTFOUND;
+    UA_UInt32 h = UA_NodeId_hash(nodeId);
+    UA_UInt32 mask = index->size - 1;
+    for(UA_UInt32 i = h & mask; index->slots[i].position != 0; i = (i + 1) & mask) {
+        const UA_HistoryNodeIdIndexSlot *slot = &index->slots[i];
+        if(slot->nodeIdHash != h)
+            continue;
+        size_t position = (size_t)slot->position - 1;
+        if(UA_NodeId_equal(itemNodeId(index, store, position), nodeId))
+            return position;
+    }
+    return UA_HISTORYNODEIDINDEX_NOTFOUND;
+}
+
+UA_StatusCode
+UA_HistoryNodeIdIndex_add(UA_HistoryNodeIdIndex *index,
+                          const void *store, size_t position) {
+    if(position >= UA_UINT32_MAX)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    if((index->count + 1) * 2 > index->size) {
+        UA_StatusCode res = UA_HistoryNodeIdIndex_expand(index);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+    UA_HistoryNodeIdIndex_insertSlot(index->slots, index->size,
+                                     UA_NodeId_hash(itemNodeId(index, store, position)),
+                                     (UA_UInt32)position + 1);
+    index->count++;
+    return UA_STATUSCODE_GOOD;
+}
@@ -0,0 +1,55 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORY_NODEID_INDEX_H_
+#define UA_HISTORY_NODEID_INDEX_H_
+
+#include <open62541/types.h>
+
+_UA_BEGIN_DECLS
+
+/* Hash index over the per-NodeId stores of the history plugins. The stores are
+ * arrays of structs that contain the NodeId at a fixed offset. The index only
+ * keeps the NodeId hash and the position of the item in the store. So the
+ * store can be reallocated without updating the index. Items are never removed
+ * from the stores. */
+
+typedef struct {
+    UA_UInt32 nodeIdHash;
+    UA_UInt32 position; /* Position in the store + 1. Zero marks an empty slot. */
+} UA_HistoryNodeIdIndexSlot;
+
+typedef struct {
+    UA_HistoryNodeIdIndexSlot *slots;
+    UA_UInt32 size;  /* Power of two or zero */
+    UA_UInt32 count;
+    size_t itemSize;
+    size_t nodeIdOffset;
+} UA_HistoryNodeIdIndex;
+
+#define UA_HISTORYNODEIDINDEX_NOTFOUND ((size_t)-1)
+
+void
+UA_HistoryNodeIdIndex_init(UA_HistoryNodeIdIndex *index,
+                           size_t itemSize, size_t nodeIdOffset);
+
+void
+UA_HistoryNodeIdIndex_clear(UA_HistoryNodeIdIndex *index);
+
+/* Returns the position of the NodeId in the store or
+ * UA_HISTORYNODEIDINDEX_NOTFOUND */
+size_t
+UA_HistoryNodeIdIndex_find(const UA_HistoryNodeIdIndex *index,
+                           const void *store, const UA_NodeId *nodeId);
+
+/* Index the item at the position in the store. The NodeId of the item must not
+ * be indexed already. */
+UA_StatusCode
+UA_HistoryNodeIdIndex_add(UA_HistoryNodeIdIndex *index,
+                          const void *store, size_t position);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORY_NODEID_INDEX_H_ */
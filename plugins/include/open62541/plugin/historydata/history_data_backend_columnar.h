@@ -0,0 +1,44 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_COLUMNAR_H_
+#define UA_HISTORYDATABACKEND_COLUMNAR_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+#define COLUMNAR_CHUNK_SIZE 1024
+
+/* This function constructs a UA_HistoryDataBackend that keeps the samples in
+ * memory, compressed column-wise in append-only chunks per NodeId:
+ *
+ * - The timestamps are stored delta-of-delta encoded. Samples taken at a fixed
+ *   interval need a single bit per timestamp.
+ * - Scalar numeric values are stored in a compressed bit stream. Floating point
+ *   values are XOR'ed with the previous value (as in Facebook's Gorilla).
+ *   Integer values are delta encoded.
+ * - StatusCodes and the timestamp flags are run-length encoded.
+ * - All other values (arrays, strings, structures, ...) are stored in their
+ *   binary encoding.
+ *
+ * A chunk requires a handful of allocations for up to chunkSize samples. Reads
+ * decode the chunks directly into the HistoryData result. Inserting,
+ * replacing or removing samples in the middle of the history re-encodes the
+ * affected chunks.
+ *
+ * initialNodeIdStoreSize is the initial number of NodeIds that will be
+ *                        historized. The store grows if required.
+ * chunkSize is the maximum number of samples per chunk. Uses
+ *           COLUMNAR_CHUNK_SIZE if zero. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_Columnar(size_t initialNodeIdStoreSize, size_t chunkSize);
+
+void UA_EXPORT
+UA_HistoryDataBackend_Columnar_clear(UA_HistoryDataBackend *backend);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_COLUMNAR_H_ */
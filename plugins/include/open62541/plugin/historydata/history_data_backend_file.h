@@ -0,0 +1,62 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_FILE_H_
+#define UA_HISTORYDATABACKEND_FILE_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+#ifdef UA_ARCHITECTURE_POSIX
+
+#define FILE_SEGMENT_SIZE 4096
+
+/* This function constructs a UA_HistoryDataBackend that persists the samples
+ * in a directory. The history survives a restart of the server.
+ *
+ * - The newest samples of every NodeId are kept in memory and appended to a
+ *   write-ahead log (WAL). When segmentSize samples are collected, they are
+ *   written to a sealed segment file of the NodeId.
+ * - Sealed segments are immutable and memory-mapped. Reads decode the samples
+ *   directly from the mapping. Only the timestamps and the file offsets of the
+ *   samples are held in memory.
+ * - Inserting, replacing or removing samples in sealed segments rewrites the
+ *   affected segment. A new file replaces the old file atomically.
+ * - Torn records at the end of the WAL (e.g. after a crash) are detected by a
+ *   checksum and discarded. The WAL is compacted when it grows and fsync'ed
+ *   when a segment is sealed.
+ *
+ * directory is created if it does not exist. The history found in the
+ *           directory is loaded.
+ * initialNodeIdStoreSize is the initial number of NodeIds that will be
+ *                        historized. The store grows if required.
+ * segmentSize is the number of samples per sealed segment. Uses
+ *             FILE_SEGMENT_SIZE if zero.
+ * retention is the maximum age (in ms) of the samples relative to the newest
+ *           sample of the NodeId. Sealed segments that only contain older
+ *           samples are deleted. Samples are kept forever if zero.
+ *
+ * The context of the returned backend is NULL if the directory cannot be
+ * opened. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_File(const char *directory, size_t initialNodeIdStoreSize,
+                           size_t segmentSize, UA_Duration retention);
+
+/* Removes all samples older than the timestamp from the history of all
+ * NodeIds and compacts the WAL. */
+UA_StatusCode UA_EXPORT
+UA_HistoryDataBackend_File_compact(UA_HistoryDataBackend *backend,
+                                   UA_DateTime before);
+
+/* Closes the files. The history remains in the directory. */
+void UA_EXPORT
+UA_HistoryDataBackend_File_clear(UA_HistoryDataBackend *backend);
+
+#endif /* UA_ARCHITECTURE_POSIX */
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_FILE_H_ */
@@ -11,12 +11,55 @@
 #include <open62541/plugin/historydatabase.h>
 
 #include "history_data_gathering.h"
+#include "history_event_backend.h"
 
 _UA_BEGIN_DECLS
 
 UA_HistoryDatabase UA_EXPORT
 UA_HistoryDatabase_default(UA_HistoryDataGathering gathering);
 
+/* Statistics of the ingestion queue */
+typedef struct {
+    size_t capacity;
+    size_t queued;    /* Samples waiting to be stored */
+    size_t maxQueued; /* Highest number of waiting samples */
+    size_t enqueued;  /* Samples accepted by the queue */
+    size_t stored;    /* Samples handed to the gathering */
+    size_t dropped;   /* Samples rejected because the queue was full */
+} UA_HistoryIngestionStatistics;
+
+/* Decouples the storage of written values from the Write service. The values
+ * are copied into a bounded queue of queueSize samples (rounded up to a power
+ * of two) and a repeated callback of the server hands up to batchSize samples
+ * to the gathering every drainInterval ms. Values that arrive while the queue
+ * is full are dropped and counted. The queue is drained completely before
+ * history is read, updated or deleted and when the database is cleared. The
+ * gathering receives the samples without the session of the write.
+ *
+ * Only for databases created with UA_HistoryDatabase_default or
+ * UA_HistoryDatabase_defaultWithEvents. Enable the queue before the first
+ * value is written. */
+UA_StatusCode UA_EXPORT
+UA_HistoryDatabase_enableIngestionQueue(UA_HistoryDatabase *hdb, size_t queueSize,
+                                        size_t batchSize, UA_Double drainInterval);
+
+UA_StatusCode UA_EXPORT
+UA_HistoryDatabase_getIngestionStatistics(const UA_HistoryDatabase *hdb,
+                                          UA_HistoryIngestionStatistics *stats);
+
+/* Stores all queued samples in the gathering */
+UA_StatusCode UA_EXPORT
+UA_HistoryDatabase_flushIngestionQueue(UA_Server *server, UA_HistoryDatabase *hdb);
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+/* Also stores the events of nodes with a HistoricalEventFilter property in the
+ * eventBackend and implements HistoryReadEvents. The events are read from
+ * nodes whose EventNotifier has the HistoryRead bit set. */
+UA_HistoryDatabase UA_EXPORT
+UA_HistoryDatabase_defaultWithEvents(UA_HistoryDataGathering gathering,
+                                     UA_HistoryEventBackend eventBackend);
+#endif
+
 _UA_END_DECLS
 
 #endif /* UA_HISTORYDATASERVICE_DEFAULT_H_ */
@@ -0,0 +1,72 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_PLUGIN_HISTORY_EVENT_BACKEND_H_
+#define UA_PLUGIN_HISTORY_EVENT_BACKEND_H_
+
+#include <open62541/server.h>
+
+_UA_BEGIN_DECLS
+
+typedef struct UA_HistoryEventBackend UA_HistoryEventBackend;
+
+struct UA_HistoryEventBackend {
+    void *context;
+
+    void
+    (*deleteMembers)(UA_HistoryEventBackend *backend);
+
+    /* This function stores an event that was emitted by a node with a
+     * HistoricalEventFilter property.
+     *
+     * server is the server the node lives in.
+     * context is the context of the UA_HistoryEventBackend.
+     * originId is the node id of the event's origin.
+     * emitterId is the node id of the node that emitted the event. The events
+     *           are read from this node.
+     * historicalEventFilter is the value of the HistoricalEventFilter property
+     *                       of the emitter.
+     * fieldList contains the fields selected by the historicalEventFilter. */
+    UA_StatusCode
+    (*serverSetHistoricalEvent)(UA_Server *server,
+                                void *context,
+                                const UA_NodeId *originId,
+                                const UA_NodeId *emitterId,
+                                const UA_EventFilter *historicalEventFilter,
+                                const UA_EventFieldList *fieldList);
+
+    /* This function reads the stored events of an emitter for the
+     * HistoryReadEvents operation.
+     *
+     * server is the server the node lives in.
+     * context is the context of the UA_HistoryEventBackend.
+     * sessionId and sessionContext identify the session that wants to read
+     *                              the events.
+     * emitterId is the node for which the events are requested.
+     * details contains the time range, the maximum number of events and the
+     *         EventFilter of the request.
+     * maxSize is the maximum number of events per response the server can
+     *         provide. Zero for no limit.
+     * continuationPoint is the continuation point the client wants to start
+     *                   from.
+     * outContinuationPoint is the continuation point that gets passed to the
+     *                      client by the HistoryRead service.
+     * result contains the event field lists passed to the client. */
+    UA_StatusCode
+    (*readEvents)(UA_Server *server,
+                  void *context,
+                  const UA_NodeId *sessionId,
+                  void *sessionContext,
+                  const UA_NodeId *emitterId,
+                  const UA_ReadEventDetails *details,
+                  size_t maxSize,
+                  const UA_ByteString *continuationPoint,
+                  UA_ByteString *outContinuationPoint,
+                  UA_HistoryEvent *result);
+};
+
+_UA_END_DECLS
+
+#endif /* UA_PLUGIN_HISTORY_EVENT_BACKEND_H_ */
@@ -0,0 +1,44 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYEVENTBACKEND_MEMORY_H_
+#define UA_HISTORYEVENTBACKEND_MEMORY_H_
+
+#include "history_event_backend.h"
+
+_UA_BEGIN_DECLS
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+
+/* This function constructs a UA_HistoryEventBackend that keeps the events in
+ * memory, per emitter:
+ *
+ * - The fields of an event are stored in their binary encoding in an
+ *   append-only buffer of the emitter. An offset table in front of the
+ *   encoded fields allows to decode single fields.
+ * - The events are indexed by their Time field (or the time of insertion if
+ *   the HistoricalEventFilter does not select the Time) and by their
+ *   EventType field.
+ *
+ * HistoryReadEvents only decodes the fields that are used. The time range is
+ * looked up in the time index. OfType operators in the where-clause of the
+ * request are checked once per stored EventType. The remaining where-clause
+ * is evaluated on the stored fields during the scan.
+ *
+ * initialNodeIdStoreSize is the initial number of emitters. The store grows
+ *                        if required.
+ * maxEventsPerNode is the maximum number of events per emitter. The oldest
+ *                  events are dropped. No limit if zero. */
+UA_HistoryEventBackend UA_EXPORT
+UA_HistoryEventBackend_Memory(size_t initialNodeIdStoreSize, size_t maxEventsPerNode);
+
+void UA_EXPORT
+UA_HistoryEventBackend_Memory_clear(UA_HistoryEventBackend *backend);
+
+#endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYEVENTBACKEND_MEMORY_H_ */
@@ -139,6 +139,15 @@ setDefaultConfig(UA_ServerConfig *conf) {
     if(conf->eventLoop == NULL) {
         conf->eventLoop = UA_EventLoop_new_POSIX(&conf->logger);
         conf->externalEventLoop = false;
+
+#ifdef UA_ENABLE_PUBSUB
+        /* Watch the sockets of the PubSub subscribers in the EventLoop */
+        UA_InterruptManager *sim = (conf->eventLoop) ?
+            UA_InterruptManager_new_POSIX_Socket(UA_STRING("pubsub-sockets")) : NULL;
+        if(sim)
+            conf->eventLoop->registerEventSource(conf->eventLoop,
+                                                 &sim->eventSource);
+#endif
     }
 
     /* --> Start setting the default static config <-- */
@@ -211,6 +220,9 @@ setDefaultConfig(UA_ServerConfig *conf) {
     conf->maxSessions = 100;
     conf->maxSessionTimeout = 60.0 * 60.0 * 1000.0; /* 1h */
 
+    /* Limits for Requests */
+    conf->streamResponseThreshold = 1024;
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* Limits for Subscriptions */
     conf->publishingIntervalLimits = UA_DURATIONRANGE(100.0, 3600.0 * 1000.0);
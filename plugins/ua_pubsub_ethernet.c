@@ -61,7 +61,6 @@ static UA_THREAD_LOCAL UA_Byte ReceiveMsgBufferETH[RECEIVE_MSG_BUFFER_SIZE];
 #define MIN_ETHERNET_PACKET_SIZE_WITHOUT_FCS 60
 #define VLAN_HEADER_SIZE                     4
 #define VLAN_SHIFT                           13
-#define XDP_FRAME_SHIFT                      11 // Match the frame size 2048
 #define BATCH_SIZE                           16 // Receive buffer batch size
 
 #ifndef XDP_COPY
@@ -76,12 +75,18 @@ static UA_THREAD_LOCAL UA_Byte ReceiveMsgBufferETH[RECEIVE_MSG_BUFFER_SIZE];
 /* Theses structures shall be removed in the future XDP versions
  * (when RT Linux and XDP are mainlined and stable) */
 typedef struct {
-    char                    *frames;
     struct xsk_ring_prod    fq;
     struct xsk_ring_cons    cq;
     struct xsk_umem *       umem;
     void                    *buffer;
-    UA_Int32                fd;
+    UA_UInt32               frame_size;
+    /* The frames [0, rx_frames) are owned by the receive side. They cycle
+     * between the fill ring and the rx ring. The remaining frames are used for
+     * sending. Free tx frames are kept on a stack. Sent frames return from the
+     * completion ring. */
+    UA_UInt32               rx_frames;
+    UA_UInt64               *tx_free;
+    UA_UInt32               tx_free_count;
 } xdp_umem;
 
 typedef struct {
@@ -91,17 +96,10 @@ typedef struct {
     struct xsk_socket *xskfd;
     UA_UInt32 bpf_prog_id;
 
-    UA_UInt32 cur_tx;
-    UA_UInt32 cur_rx;
-
     xdp_umem  *umem;
     UA_UInt32 outstanding_tx;
     UA_UInt64 rx_npkts;
     UA_UInt64 tx_npkts;
-    UA_UInt64 prev_rx_npkts;
-    UA_UInt64 prev_tx_npkts;
-    UA_UInt32 idx_rx;
-    UA_UInt32 idx_fq;
 } xdpsock;
 #endif
 
@@ -114,8 +112,9 @@ typedef struct {
     UA_UInt32 com_queue_no_of_desc;
 } xskconfparam;
 
-/* Default values for xdp socket parameters */
-xskconfparam xsk_default_values = {2048, 2048, 2048, 2048, 2048};
+/* Default values for xdp socket parameters. The fill ring holds all receive
+ * frames. The remaining frames are used for sending. */
+xskconfparam xsk_default_values = {4096, 2048, 2048, 2048, 2048};
 
 /* Ethernet network layer specific internal data */
 typedef struct {
@@ -204,67 +203,86 @@ UA_parseHardwareAddress(UA_String* target, UA_Byte* destinationMac) {
 }
 
 #if defined(LIBBPF_EBPF)
+static void
+xdp_umem_delete(xdp_umem *umem) {
+    if(umem->umem)
+        (void)xsk_umem__delete(umem->umem);
+    UA_free(umem->tx_free);
+    UA_free(umem->buffer);
+    UA_free(umem);
+}
+
 /**
  * UMEM is associated to a netdev and a specific queue id of that netdev.
  * It is created and configured (chunk size, headroom, start address and size) by using the XDP_UMEM_REG setsockopt system call.
  * UMEM uses two rings: FILL and COMPLETION. Each socket associated with the UMEM must have an RX queue, TX queue or both.
  */
-static xdp_umem *xdp_umem_configure(xskconfparam *xskparam) {
+static xdp_umem *xdp_umem_configure(const xskconfparam *xskparam) {
     struct xsk_umem_config uconfig = {
         .fill_size = xskparam->fill_queue_no_of_desc,
         .comp_size = xskparam->com_queue_no_of_desc,
         .frame_size = xskparam->frame_size,
         .frame_headroom = XSK_UMEM__DEFAULT_FRAME_HEADROOM,
     };
-    xdp_umem *umem;
-    int ret;
-    size_t sret;
-    UA_UInt32 frames_per_ring;
-    UA_UInt32 idx;
 
-    umem = (xdp_umem *)UA_calloc(1, sizeof(*umem));
-    if (!umem) {
+    if(xskparam->fill_queue_no_of_desc >= xskparam->no_of_frames) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                     "PubSub XSK UMEM configuration invalid. "
+                     "No frames left for sending.");
         return NULL;
     }
 
-    if (posix_memalign(&umem->buffer, (size_t)getpagesize(),
-                       xskparam->no_of_frames * xskparam->frame_size) != 0) {
+    xdp_umem *umem = (xdp_umem *)UA_calloc(1, sizeof(*umem));
+    if(!umem)
+        return NULL;
+    umem->frame_size = xskparam->frame_size;
+    umem->rx_frames = xskparam->fill_queue_no_of_desc;
+
+    if(posix_memalign(&umem->buffer, (size_t)getpagesize(),
+                      (size_t)xskparam->no_of_frames * xskparam->frame_size) != 0) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
                      "buffer allocation of UMEM failed");
+        umem->buffer = NULL;
+        xdp_umem_delete(umem);
         return NULL;
     }
 
-    ret = xsk_umem__create(&umem->umem, umem->buffer,
-                           xskparam->no_of_frames * xskparam->frame_size,
-                           &umem->fq, &umem->cq,
-                           &uconfig);
-    if (ret) {
+    /* The tx frames are located after the rx frames */
+    UA_UInt32 tx_frames = xskparam->no_of_frames - umem->rx_frames;
+    umem->tx_free = (UA_UInt64 *)UA_calloc(tx_frames, sizeof(UA_UInt64));
+    if(!umem->tx_free) {
+        xdp_umem_delete(umem);
+        return NULL;
+    }
+    for(UA_UInt32 i = 0; i < tx_frames; i++)
+        umem->tx_free[i] = (UA_UInt64)(umem->rx_frames + i) * umem->frame_size;
+    umem->tx_free_count = tx_frames;
+
+    int ret = xsk_umem__create(&umem->umem, umem->buffer,
+                               (UA_UInt64)xskparam->no_of_frames * xskparam->frame_size,
+                               &umem->fq, &umem->cq, &uconfig);
+    if(ret) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
                      "PubSub XSK UMEM creation failed. Out of memory.");
-        UA_free(umem->buffer);
-        UA_free(umem);
+        umem->umem = NULL;
+        xdp_umem_delete(umem);
         return NULL;
     }
 
-    /* Populate rx fill ring with addresses */
-    frames_per_ring = xskparam->fill_queue_no_of_desc;
-
-    sret = xsk_ring_prod__reserve(&umem->fq, frames_per_ring, &idx);
-    if (sret != frames_per_ring){
-        UA_free(umem->buffer);
-        UA_free(umem);
+    /* Populate the fill ring with all rx frames */
+    UA_UInt32 idx = 0;
+    size_t sret = xsk_ring_prod__reserve(&umem->fq, umem->rx_frames, &idx);
+    if(sret != umem->rx_frames) {
+        xdp_umem_delete(umem);
         return NULL;
     }
-
-    for (UA_UInt64 i = 0; i < frames_per_ring; i++)
-        *xsk_ring_prod__fill_addr(&umem->fq, idx++) = i * frames_per_ring;
-
-    xsk_ring_prod__submit(&umem->fq, frames_per_ring);
+    for(UA_UInt64 i = 0; i < umem->rx_frames; i++)
+        *xsk_ring_prod__fill_addr(&umem->fq, idx++) = i * umem->frame_size;
+    xsk_ring_prod__submit(&umem->fq, umem->rx_frames);
 
     return umem;
 }
 
-
 /**
  *  Configure AF_XDP socket to redirect frames to a memory buffer in a user-space application
  *  XSK has two rings: the RX ring and the TX ring
@@ -273,89 +291,52 @@ static xdp_umem *xdp_umem_configure(xskconfparam *xskparam) {
 static xdpsock *xsk_configure(xdp_umem *umem, UA_UInt32 hw_receive_queue,
                               int ifindex, char *ifname,
                               UA_UInt32 xdp_flags, UA_UInt16 xdp_bind_flags) {
-    xdpsock *xdp_socket;
-    int ret;
-    struct xsk_socket_config cfg;
-
-    xskconfparam *xskparam = (xskconfparam *)UA_calloc(1, (sizeof(xskconfparam)));
-    memcpy(xskparam, &xsk_default_values, (sizeof(xskconfparam)));
-
-    xdp_socket = (xdpsock *)UA_calloc(1, sizeof(*xdp_socket));
-    if (!xdp_socket) {
+    const xskconfparam *xskparam = &xsk_default_values;
+    xdpsock *xdp_socket = (xdpsock *)UA_calloc(1, sizeof(*xdp_socket));
+    if(!xdp_socket)
         return NULL;
-    }
 
-    if (umem)
+    if(umem)
         xdp_socket->umem = umem;
     else
         xdp_socket->umem = xdp_umem_configure(xskparam);
-
-    if (!xdp_socket->umem) {
-        UA_close(xsk_socket__fd(xdp_socket->xskfd));
-        bpf_set_link_xdp_fd(ifindex, -1, xdp_flags);
-        UA_free(xskparam);
+    if(!xdp_socket->umem) {
         UA_free(xdp_socket);
         return NULL;
     }
 
-    xdp_socket->outstanding_tx = 0;
-    xdp_socket->idx_rx = 0;
-    xdp_socket->idx_fq = 0;
-
-    cfg.rx_size = xskparam->fill_queue_no_of_desc;
-    cfg.tx_size = xskparam->com_queue_no_of_desc;
-
+    struct xsk_socket_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.rx_size = xskparam->no_of_desc;
+    cfg.tx_size = xskparam->no_of_desc;
     cfg.libbpf_flags = 0;
     cfg.xdp_flags = xdp_flags;
     cfg.bind_flags = xdp_bind_flags;
 
-    ret = xsk_socket__create(&xdp_socket->xskfd,
-                             ifname,
-                             hw_receive_queue,
-                             xdp_socket->umem->umem,
-                             &xdp_socket->rx_ring,
-                             &xdp_socket->tx_ring,
-                             &cfg);
-
-    if (ret == ENOTSUP) {
+    int ret = xsk_socket__create(&xdp_socket->xskfd, ifname, hw_receive_queue,
+                                 xdp_socket->umem->umem, &xdp_socket->rx_ring,
+                                 &xdp_socket->tx_ring, &cfg);
+    if(ret) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
-                      "PubSub connection creation failed."
-                      " xsk_socket__create not supported.");
-        UA_free(xdp_socket->umem->buffer);
-        (void)xsk_umem__delete(xdp_socket->umem->umem);
-        UA_free(xdp_socket->umem);
-        UA_free(xskparam);
-        UA_free(xdp_socket);
-        return NULL;
-    } else if (ret < 0) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
-                    "PubSub connection creation failed."
-                    " xsk_socket__create failed: %s", strerror(errno));
-        UA_free(xdp_socket->umem->buffer);
-        (void)xsk_umem__delete(xdp_socket->umem->umem);
-        UA_free(xdp_socket->umem);
-        UA_close(xsk_socket__fd(xdp_socket->xskfd));
+                     "PubSub connection creation failed."
+                     " xsk_socket__create failed: %s", strerror(-ret));
+        xdp_umem_delete(xdp_socket->umem);
         bpf_set_link_xdp_fd(ifindex, -1, xdp_flags);
-        UA_free(xskparam);
         UA_free(xdp_socket);
         return NULL;
     }
 
     ret = bpf_get_link_xdp_id(ifindex, &xdp_socket->bpf_prog_id, xdp_flags);
-    if (ret) {
+    if(ret) {
         UA_LOG_ERROR (UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
             "PubSub Connection creation failed. Unable to retrieve XDP program.");
-        UA_free(xdp_socket->umem->buffer);
-        (void)xsk_umem__delete(xdp_socket->umem->umem);
-        UA_free(xdp_socket->umem);
-        UA_close(xsk_socket__fd(xdp_socket->xskfd));
+        xsk_socket__delete(xdp_socket->xskfd);
+        xdp_umem_delete(xdp_socket->umem);
         bpf_set_link_xdp_fd(ifindex, -1, xdp_flags);
-        UA_free(xskparam);
         UA_free(xdp_socket);
         return NULL;
     }
 
-    UA_free(xskparam);
     return xdp_socket;
 }
 
@@ -386,35 +367,64 @@ UA_PubSubChannelEthernetXDP_open(UA_PubSubChannelDataEthernet *channelDataEthern
     return UA_STATUSCODE_GOOD;
 }
 
+/* Return the frames of completed transmissions to the free stack */
+static void
+xdpReclaimTxFrames(xdpsock *xdp_socket) {
+    if(xdp_socket->outstanding_tx == 0)
+        return;
+    xdp_umem *umem = xdp_socket->umem;
+    UA_UInt32 idx = 0;
+    UA_UInt32 done = (UA_UInt32)
+        xsk_ring_cons__peek(&umem->cq, xdp_socket->outstanding_tx, &idx);
+    for(UA_UInt32 i = 0; i < done; i++)
+        umem->tx_free[umem->tx_free_count++] = *xsk_ring_cons__comp_addr(&umem->cq, idx++);
+    xsk_ring_cons__release(&umem->cq, done);
+    xdp_socket->outstanding_tx -= done;
+    xdp_socket->tx_npkts += done;
+}
+
+/* Wake up the kernel to process the tx ring */
+static UA_Boolean
+xdpKickTx(xdpsock *xdp_socket) {
+    ssize_t rc = UA_sendto(xsk_socket__fd(xdp_socket->xskfd), NULL, 0, MSG_DONTWAIT, NULL, 0);
+    return (rc >= 0 || errno == ENOBUFS || errno == EAGAIN || errno == EBUSY);
+}
+
 static UA_StatusCode
 UA_PubSubChannelEthernetXDP_send(UA_PubSubChannelDataEthernet *channelDataEthernet,
                                  const UA_ByteString *buf) {
-    struct ether_header* ethHdr;
-    UA_Byte *bufSend, *ptr;
-    xdpsock *xdp_socket;
-    UA_UInt16 vlanTag;
-    UA_UInt32 idx;
-    size_t lenBuf;
-    ssize_t rc;
-
-    xdp_socket = channelDataEthernet->xdpsocket;
+    xdpsock *xdp_socket = channelDataEthernet->xdpsocket;
+    xdp_umem *umem = xdp_socket->umem;
+
+    /* Get a free tx frame. Kick the kernel once if all frames are in flight. */
+    xdpReclaimTxFrames(xdp_socket);
+    if(umem->tx_free_count == 0) {
+        xdpKickTx(xdp_socket);
+        xdpReclaimTxFrames(xdp_socket);
+        if(umem->tx_free_count == 0) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                         "PubSub connection send failed. No free XDP tx frame.");
+            return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+        }
+    }
 
-    bufSend = (UA_Byte *) xsk_umem__get_data(xdp_socket->umem->buffer,
-                                             xdp_socket->cur_tx << XDP_FRAME_SHIFT);
-    ethHdr = (struct ether_header *) bufSend;
+    /* Write the message directly into the frame */
+    UA_UInt64 addr = umem->tx_free[umem->tx_free_count - 1];
+    UA_Byte *bufSend = (UA_Byte *) xsk_umem__get_data(umem->buffer, addr);
+    struct ether_header* ethHdr = (struct ether_header *) bufSend;
 
     /* Set (own) source MAC address */
     memcpy(ethHdr->ether_shost, channelDataEthernet->ifAddress, ETH_ALEN);
     /* Set destination MAC address */
     memcpy(ethHdr->ether_dhost, channelDataEthernet->targetAddress, ETH_ALEN);
     /* Set ethertype */
-    lenBuf = sizeof(*ethHdr) + buf->length;
-    ptr = sizeof(*ethHdr) + bufSend;
+    size_t lenBuf = sizeof(*ethHdr) + buf->length;
+    UA_Byte *ptr = sizeof(*ethHdr) + bufSend;
 
     if(channelDataEthernet->vid > 0) {
         lenBuf += 4;
         ethHdr->ether_type = htons(ETHERTYPE_VLAN);
-        vlanTag = (UA_UInt16) (channelDataEthernet->vid
+        UA_UInt16 vlanTag = (UA_UInt16) (channelDataEthernet->vid
                   + (channelDataEthernet->prio << VLAN_SHIFT));
 
         *((UA_UInt16 *) ptr) = htons(vlanTag);
@@ -426,38 +436,28 @@ UA_PubSubChannelEthernetXDP_send(UA_PubSubChannelDataEthernet *channelDataEthern
         ethHdr->ether_type = htons(ETHERTYPE_UADP);
     }
 
-    if (lenBuf > xsk_default_values.frame_size)
+    if(lenBuf > umem->frame_size)
         return UA_STATUSCODE_BADINTERNALERROR;
 
     /* copy payload of ethernet message */
     memcpy(ptr, buf->data, buf->length);
 
-    /* TODO: Modify XDP TX to handle packet count upto BATCH_SIZE */
-    if (xsk_ring_prod__reserve(&xdp_socket->tx_ring, 1, &idx) != 1) {
+    UA_UInt32 idx;
+    if(xsk_ring_prod__reserve(&xdp_socket->tx_ring, 1, &idx) != 1) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
                      "PubSub connection send failed. xsk_prod_reserve failed.");
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    xsk_ring_prod__tx_desc(&xdp_socket->tx_ring, idx)->addr = xdp_socket->cur_tx << XDP_FRAME_SHIFT;
+    /* Hand the frame over to the kernel */
+    umem->tx_free_count--;
+    xsk_ring_prod__tx_desc(&xdp_socket->tx_ring, idx)->addr = addr;
     xsk_ring_prod__tx_desc(&xdp_socket->tx_ring, idx)->len = (UA_UInt32) lenBuf;
-
     xsk_ring_prod__submit(&xdp_socket->tx_ring, 1);
     xdp_socket->outstanding_tx += 1;
 
-    /* Increase the cur_tx pointer, rollover if exceed */
-    xdp_socket->cur_tx += 1;
-    xdp_socket->cur_tx %= xsk_default_values.frame_size;
-
-    rc = UA_sendto(xsk_socket__fd(xdp_socket->xskfd), NULL, 0, MSG_DONTWAIT, NULL, 0);
-    if (rc >= 0 || errno == ENOBUFS || errno == EAGAIN || errno == EBUSY) {
-        UA_UInt32 rcvd = xsk_ring_cons__peek(&xdp_socket->umem->cq, 1, &idx);
-        if (rcvd > 0) {
-            xsk_ring_cons__release(&xdp_socket->umem->cq, rcvd);
-            xdp_socket->outstanding_tx -= rcvd;
-            xdp_socket->tx_npkts += rcvd;
-        }
-
+    if(xdpKickTx(xdp_socket)) {
+        xdpReclaimTxFrames(xdp_socket);
         return UA_STATUSCODE_GOOD;
     }
 
@@ -465,84 +465,94 @@ UA_PubSubChannelEthernetXDP_send(UA_PubSubChannelDataEthernet *channelDataEthern
                  "PubSub connection send failed."
                  " XSK Send message failed: %s", strerror(errno));
     return UA_STATUSCODE_BADINTERNALERROR;
-
 }
 
-static UA_StatusCode
-UA_PubSubChannelEthernetXDP_receive(UA_PubSubChannelDataEthernet *channelDataEthernet,
-                                    UA_ByteString *message) {
-    struct ether_header *eth_hdr;
-    xdpsock *xdp_socket;
-    UA_UInt64 addr;
-    UA_UInt64 ret;
-    UA_UInt32 rcvd;
-    UA_Byte *pkt, *buf;
-    ssize_t len;
-
-    xdp_socket = channelDataEthernet->xdpsocket;
-    message->length = 0;
-
-    rcvd = xsk_ring_cons__peek(&xdp_socket->rx_ring, BATCH_SIZE, &xdp_socket->idx_rx);
-    if (!rcvd)
-        return UA_STATUSCODE_GOODNODATA; //No packets even after select/poll
-
-    ret = xsk_ring_prod__reserve(&xdp_socket->umem->fq, rcvd, &xdp_socket->idx_fq);
-    if(ret != rcvd)
-        return UA_STATUSCODE_BADINTERNALERROR; //Got data but failed to reserve, something's wrong
-
-    buf = message->data;
-    for(UA_UInt32 i = 0; i < rcvd; i++) {
-        addr = xsk_ring_cons__rx_desc(&xdp_socket->rx_ring, xdp_socket->idx_rx)->addr;
-        len  = (UA_UInt32) xsk_ring_cons__rx_desc(&xdp_socket->rx_ring, xdp_socket->idx_rx++)->len;
-        pkt  = (UA_Byte *) xsk_umem__get_data(xdp_socket->umem->buffer, addr);
-
-        /* AF_XDP does not do any filtering on ethertype or protocol.
-         * Manually check for VLAN headers and ETH UADP ethertype.
-         * Note: we use UA_UInt16 to compare ethertype, which is 2-bytes
-         */
-        UA_UInt16 *pkt_proto = (UA_UInt16 *) (pkt + (ETH_ALEN * 2));
-        if(channelDataEthernet->vid > 0 && *pkt_proto == htons(ETHERTYPE_VLAN))
-            pkt_proto += 2;
-
-        if(*pkt_proto != htons(ETHERTYPE_UADP))
-            return UA_STATUSCODE_GOODNODATA;
-
-        eth_hdr = (struct ether_header *) pkt;
-        /* Make sure we match our target */
-        if(memcmp(eth_hdr->ether_dhost, channelDataEthernet->targetAddress, ETH_ALEN) != 0) {
-            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
-                         "Invalid hardware address - XDP socket receive");
-            return UA_STATUSCODE_GOODNODATA;
-        }
+/* AF_XDP does not do any filtering on ethertype or protocol. Check the VLAN
+ * header, the UADP ethertype and the target address manually. Returns the
+ * payload inside the frame. */
+static UA_Boolean
+xdpFrameToMessage(UA_PubSubChannelDataEthernet *channelDataEthernet,
+                  UA_Byte *pkt, UA_UInt32 len, UA_ByteString *message) {
+    size_t headerLen = sizeof(struct ether_header);
+    if(len < headerLen)
+        return false;
+
+    /* Note: we use UA_UInt16 to compare ethertype, which is 2-bytes */
+    UA_UInt16 *pkt_proto = (UA_UInt16 *) (pkt + (ETH_ALEN * 2));
+    if(channelDataEthernet->vid > 0 && *pkt_proto == htons(ETHERTYPE_VLAN)) {
+        headerLen += VLAN_HEADER_SIZE;
+        if(len < headerLen)
+            return false;
+        pkt_proto += 2;
+    }
+    if(*pkt_proto != htons(ETHERTYPE_UADP))
+        return false;
 
-        UA_Byte *dataReceived = (UA_Byte *)pkt + sizeof(struct ether_header);
-        size_t dataLength = (size_t)len - sizeof(struct ether_header);
-        if(channelDataEthernet->vid > 0) {
-            dataReceived += 4;
-            dataLength -= 4;
-        }
+    /* Make sure we match our target */
+    struct ether_header *eth_hdr = (struct ether_header *) pkt;
+    if(memcmp(eth_hdr->ether_dhost, channelDataEthernet->targetAddress, ETH_ALEN) != 0)
+        return false;
+
+    message->data = pkt + headerLen;
+    message->length = len - headerLen;
+    return true;
+}
 
-        /* Max buffer size allocated to receive a multiple messages is 4096 */
-        if ((message->length + dataLength) > 4096) {
-            UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
-                        "During multiple receive max buffer size reached");
+/* Zero-copy receive. The messages are processed in the UMEM frames. The
+ * frames are returned to the fill ring after processing. Descriptors are
+ * processed in batches until the rx ring is empty. At most rx_frames are
+ * processed per call, so that a flood of frames does not block the caller. */
+static UA_StatusCode
+UA_PubSubChannelEthernetXDP_receive(UA_PubSubChannel *channel,
+                                    UA_PubSubChannelDataEthernet *channelDataEthernet,
+                                    UA_PubSubReceiveCallback receiveCallback,
+                                    void *receiveCallbackContext) {
+    xdpsock *xdp_socket = channelDataEthernet->xdpsocket;
+    xdp_umem *umem = xdp_socket->umem;
+    UA_UInt32 total = 0;
+
+    while(total < umem->rx_frames) {
+        UA_UInt32 idx_rx = 0;
+        UA_UInt32 rcvd = (UA_UInt32)
+            xsk_ring_cons__peek(&xdp_socket->rx_ring, BATCH_SIZE, &idx_rx);
+        if(rcvd == 0)
             break;
-        }
 
-        if((dataLength < 46) && (i > 0)) {
-            message->length += 4;
-            buf += 4;
+        for(UA_UInt32 i = 0; i < rcvd; i++) {
+            const struct xdp_desc *desc =
+                xsk_ring_cons__rx_desc(&xdp_socket->rx_ring, idx_rx + i);
+            UA_Byte *pkt = (UA_Byte *) xsk_umem__get_data(umem->buffer, desc->addr);
+            UA_ByteString message;
+            if(!xdpFrameToMessage(channelDataEthernet, pkt, desc->len, &message))
+                continue;
+            UA_StatusCode retval =
+                receiveCallback(channel, receiveCallbackContext, &message);
+            if(retval != UA_STATUSCODE_GOOD)
+                UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_NETWORK,
+                               "PubSub Connection decode and process failed.");
         }
 
-        memcpy(buf, dataReceived, dataLength);
-        buf += dataLength;
-        message->length += dataLength;
+        /* Recycle the frames. The fill ring has room for all rx frames, so
+         * the reservation cannot fail for frames taken from the rx ring. */
+        UA_UInt32 idx_fq = 0;
+        if(xsk_ring_prod__reserve(&umem->fq, rcvd, &idx_fq) != rcvd) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                         "PubSub connection receive failed. "
+                         "Could not return the XDP frames to the fill ring.");
+            xsk_ring_cons__release(&xdp_socket->rx_ring, rcvd);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+        for(UA_UInt32 i = 0; i < rcvd; i++)
+            *xsk_ring_prod__fill_addr(&umem->fq, idx_fq + i) =
+                xsk_ring_cons__rx_desc(&xdp_socket->rx_ring, idx_rx + i)->addr;
+        xsk_ring_prod__submit(&umem->fq, rcvd);
+        xsk_ring_cons__release(&xdp_socket->rx_ring, rcvd);
+
+        xdp_socket->rx_npkts += rcvd;
+        total += rcvd;
     }
 
-    xsk_ring_prod__submit(&xdp_socket->umem->fq, rcvd);
-    xsk_ring_cons__release(&xdp_socket->rx_ring, rcvd);
-    xdp_socket->rx_npkts += rcvd;
-    return UA_STATUSCODE_GOOD;
+    return (total > 0) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_GOODNODATA;
 }
 #endif
 
@@ -846,7 +856,7 @@ UA_PubSubChannelEthernet_open(const UA_PubSubConnectionConfig *connectionConfig)
         memset(&sk_txtime, 0, sizeof(sk_txtime));
         sk_txtime.clockId = CLOCK_TAI;
         sk_txtime.flags   = (UA_UInt16)(sockOptions.sotxtimeDeadlinemode | sockOptions.sotxtimeReceiveerrors);
-        if (setsockopt(sockFd, SOL_SOCKET, SO_TXTIME, &sk_txtime, sizeof(&sk_txtime))) {
+        if (setsockopt(sockFd, SOL_SOCKET, SO_TXTIME, &sk_txtime, sizeof(sk_txtime))) {
             UA_LOG_SOCKET_ERRNO_WRAP(
                 UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER, "setsockopt SO_TXTIME failed (%s)", errno_str));
             UA_close(sockFd);
@@ -956,7 +966,7 @@ UA_PubSubChannelEthernet_unregist(UA_PubSubChannel *channel,
 #if defined(KERNEL_VERSION)
 #if (LINUX_VERSION_CODE >= KERNEL_VERSION(4,19,0))
 static UA_StatusCode
-sendWithTxTime(UA_PubSubChannel *channel, UA_ExtensionObject *transportSettings, void *bufSend, size_t lenBuf) {
+sendWithTxTime(UA_PubSubChannel *channel, UA_UInt64 txTime, void *bufSend, size_t lenBuf) {
     /* Send the data packet with the tx time */
     char dataPacket[CMSG_SPACE(sizeof(UA_UInt64))] = {0};
     /* Structure for messages sent and received */
@@ -988,10 +998,6 @@ sendWithTxTime(UA_PubSubChannel *channel, UA_ExtensionObject *transportSettings,
     /* Provide the number of elements in the array */
     message.msg_iovlen        = 1;
 
-    /* Get ethernet ETF transport settings */
-    UA_EthernetWriterGroupTransportDataType *ethernettransportSettings;
-    ethernettransportSettings = (UA_EthernetWriterGroupTransportDataType *)transportSettings->content.decoded.data;
-
     /*
      * We specify the transmission time in the CMSG.
      */
@@ -1006,8 +1012,8 @@ sendWithTxTime(UA_PubSubChannel *channel, UA_ExtensionObject *transportSettings,
     controlMsg->cmsg_level = SOL_SOCKET;
     controlMsg->cmsg_type  = SCM_TXTIME;
     controlMsg->cmsg_len   = CMSG_LEN(sizeof(UA_UInt64));
-    if(ethernettransportSettings && (ethernettransportSettings->transmission_time != 0))
-        *((UA_UInt64 *) CMSG_DATA(controlMsg)) = ethernettransportSettings->transmission_time;
+    if(txTime != 0)
+        *((UA_UInt64 *) CMSG_DATA(controlMsg)) = txTime;
 
     msgCount = sendmsg(channel->sockfd, &message, 0);
     if ((msgCount < 1) && (msgCount != (UA_Int32)lenBuf)) {
@@ -1020,14 +1026,14 @@ sendWithTxTime(UA_PubSubChannel *channel, UA_ExtensionObject *transportSettings,
 #endif
 
 /**
- * Send messages to the connection defined address
+ * Send messages to the connection defined address. The txTime (CLOCK_TAI in
+ * nanoseconds) is only used with SO_TXTIME. Zero sends right away.
  *
  * @return UA_STATUSCODE_GOOD if success
  */
 static UA_StatusCode
-UA_PubSubChannelEthernet_send(UA_PubSubChannel *channel,
-                              UA_ExtensionObject *transportSettings,
-                              const UA_ByteString *buf) {
+sendEthernetFrame(UA_PubSubChannel *channel, const UA_ByteString *buf,
+                  UA_UInt64 txTime) {
     UA_PubSubChannelDataEthernet *channelDataEthernet =
         (UA_PubSubChannelDataEthernet *) channel->handle;
 
@@ -1082,7 +1088,7 @@ UA_PubSubChannelEthernet_send(UA_PubSubChannel *channel,
 #if (LINUX_VERSION_CODE >= KERNEL_VERSION(4,19,0))
     if(channelDataEthernet->useSoTxTime) {
         /* Send the packets at the given Txtime */
-        UA_StatusCode rc = sendWithTxTime(channel, transportSettings, bufSend, lenBuf);
+        UA_StatusCode rc = sendWithTxTime(channel, txTime, bufSend, lenBuf);
         if(rc != UA_STATUSCODE_GOOD) {
             UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
                          "PubSub connection send failed. Send message failed.");
@@ -1108,6 +1114,42 @@ UA_PubSubChannelEthernet_send(UA_PubSubChannel *channel,
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_StatusCode
+UA_PubSubChannelEthernet_send(UA_PubSubChannel *channel,
+                              UA_ExtensionObject *transportSettings,
+                              const UA_ByteString *buf) {
+    /* Get ethernet ETF transport settings */
+    UA_UInt64 txTime = 0;
+    if(transportSettings && transportSettings->content.decoded.data) {
+        UA_EthernetWriterGroupTransportDataType *ethernettransportSettings =
+            (UA_EthernetWriterGroupTransportDataType *)transportSettings->content.decoded.data;
+        txTime = ethernettransportSettings->transmission_time;
+    }
+    return sendEthernetFrame(channel, buf, txTime);
+}
+
+#if defined(KERNEL_VERSION)
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4,19,0))
+/* Send with the launch time (UtcTime) converted to CLOCK_TAI for SO_TXTIME */
+static UA_StatusCode
+UA_PubSubChannelEthernet_sendAt(UA_PubSubChannel *channel,
+                                UA_ExtensionObject *transportSettings,
+                                const UA_ByteString *buf, UA_DateTime launchTime) {
+    /* The offset between TAI and UTC is a full number of seconds */
+    struct timespec taiTime, utcTime;
+    clock_gettime(CLOCK_TAI, &taiTime);
+    clock_gettime(CLOCK_REALTIME, &utcTime);
+    UA_Int64 taiOffset = (UA_Int64)(taiTime.tv_sec - utcTime.tv_sec) * 1000000000 +
+        (UA_Int64)(taiTime.tv_nsec - utcTime.tv_nsec);
+    taiOffset = ((taiOffset + 500000000) / 1000000000) * 1000000000;
+    UA_Int64 txTime = (launchTime - UA_DATETIME_UNIX_EPOCH) * 100 + taiOffset;
+    if(txTime <= 0)
+        return sendEthernetFrame(channel, buf, 0);
+    return sendEthernetFrame(channel, buf, (UA_UInt64)txTime);
+}
+#endif
+#endif
+
 /**
  * Receive messages.
  *
@@ -1150,6 +1192,14 @@ UA_PubSubChannelEthernet_receive(UA_PubSubChannel *channel,
         }
     }
 
+#if defined LIBBPF_EBPF
+    /* Process the received frames in place */
+    if(channelDataEthernet->enableXdpSocket)
+        return UA_PubSubChannelEthernetXDP_receive(channel, channelDataEthernet,
+                                                   receiveCallback,
+                                                   receiveCallbackContext);
+#endif
+
 #if !defined(UA_ARCHITECTURE_POSIX)
     clock_gettime(CLOCK_REALTIME, &currentTime);
 #else
@@ -1176,17 +1226,6 @@ UA_PubSubChannelEthernet_receive(UA_PubSubChannel *channel,
         buffer.length = RECEIVE_MSG_BUFFER_SIZE;
         buffer.data = ReceiveMsgBufferETH;
 
-#if defined LIBBPF_EBPF
-        if(channelDataEthernet->enableXdpSocket) {
-            retval = UA_PubSubChannelEthernetXDP_receive(channelDataEthernet, &buffer);
-            if (retval != UA_STATUSCODE_GOOD) {
-                return retval;
-            }
-            retval = receiveCallback(channel, receiveCallbackContext, &buffer);
-            return retval;
-        }
-#endif
-
         struct ether_header eth_hdr;
         struct iovec        iov[2];
         struct msghdr       msg;
@@ -1281,11 +1320,9 @@ UA_PubSubChannelEthernet_close(UA_PubSubChannel *channel) {
 #if defined(LIBBPF_EBPF)
     if(channelDataEthernet->enableXdpSocket) {
         xsk_socket__delete(channelDataEthernet->xdpsocket->xskfd);
-        (void)xsk_umem__delete(channelDataEthernet->xdpsocket->umem->umem);
         /* Detach XDP program from the interface */
         bpf_set_link_xdp_fd(channelDataEthernet->ifindex, -1, channelDataEthernet->xdp_flags);
-        UA_free(channelDataEthernet->xdpsocket->umem->buffer);
-        UA_free(channelDataEthernet->xdpsocket->umem);
+        xdp_umem_delete(channelDataEthernet->xdpsocket->umem);
         UA_free(channelDataEthernet->xdpsocket);
         UA_free(channelDataEthernet);
         UA_free(channel);
@@ -1313,6 +1350,14 @@ TransportLayerEthernet_addChannel(UA_PubSubConnectionConfig *connectionConfig) {
         pubSubChannel->regist = UA_PubSubChannelEthernet_regist;
         pubSubChannel->unregist = UA_PubSubChannelEthernet_unregist;
         pubSubChannel->send = UA_PubSubChannelEthernet_send;
+#if defined(KERNEL_VERSION)
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4,19,0))
+        UA_PubSubChannelDataEthernet *channelDataEthernet =
+            (UA_PubSubChannelDataEthernet *) pubSubChannel->handle;
+        if(channelDataEthernet->useSoTxTime)
+            pubSubChannel->sendAt = UA_PubSubChannelEthernet_sendAt;
+#endif
+#endif
         pubSubChannel->receive = UA_PubSubChannelEthernet_receive;
         pubSubChannel->close = UA_PubSubChannelEthernet_close;
         pubSubChannel->connectionConfig = connectionConfig;
@@ -9,6 +9,10 @@
  * Copyright (c) 2021 Linutronix GmbH (Author: Kurt Kanzenbach)
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE /* sendmmsg */
+#endif
+
 #include <open62541/server_pubsub.h>
 #include <open62541/util.h>
 
@@ -535,6 +539,59 @@ UA_PubSubChannelUDPMC_send(UA_PubSubChannel *channel, UA_ExtensionObject *transp
     return UA_STATUSCODE_GOOD;
 }
 
+#if defined(__linux__)
+#define UA_UDPMC_MAXSENDBATCH 32
+
+/**
+ * Send several messages to the connection defined address. Uses one sendmmsg
+ * system call for up to UA_UDPMC_MAXSENDBATCH messages.
+ *
+ * @return UA_STATUSCODE_GOOD if success
+ */
+static UA_StatusCode
+UA_PubSubChannelUDPMC_sendBatch(UA_PubSubChannel *channel, size_t bufsSize,
+                                const UA_ByteString *bufs) {
+    UA_PubSubChannelDataUDPMC *channelConfigUDPMC = (UA_PubSubChannelDataUDPMC *) channel->handle;
+    if(!(channel->state == UA_PUBSUB_CHANNEL_PUB || channel->state == UA_PUBSUB_CHANNEL_PUB_SUB)){
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                       "PubSub Connection sending failed. Invalid state.");
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    struct mmsghdr msgs[UA_UDPMC_MAXSENDBATCH];
+    struct iovec iovs[UA_UDPMC_MAXSENDBATCH];
+    size_t done = 0;
+    while(done < bufsSize) {
+        /* Prepare the next chunk of messages */
+        size_t chunk = bufsSize - done;
+        if(chunk > UA_UDPMC_MAXSENDBATCH)
+            chunk = UA_UDPMC_MAXSENDBATCH;
+        memset(msgs, 0, sizeof(struct mmsghdr) * chunk);
+        for(size_t i = 0; i < chunk; i++) {
+            iovs[i].iov_base = bufs[done + i].data;
+            iovs[i].iov_len = bufs[done + i].length;
+            msgs[i].msg_hdr.msg_name = &channelConfigUDPMC->ai_addr;
+            msgs[i].msg_hdr.msg_namelen = channelConfigUDPMC->ai_addrlen;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        /* Datagrams are sent completely or not at all. Retry with the
+         * remaining messages if only a part was sent. */
+        int n = sendmmsg(channel->sockfd, msgs, (unsigned int)chunk, 0);
+        if(n <= 0) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+                UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_NETWORK,
+                               "PubSub Connection sending failed: "
+                               "sendmmsg failed. Error: %s", errno_str));
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+        done += (size_t)n;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
 static
 UA_INLINE
 UA_DateTime timevalToDateTime(struct timeval val) {
@@ -672,6 +729,9 @@ TransportLayerUDPMC_addChannel(UA_PubSubConnectionConfig *connectionConfig) {
         pubSubChannel->regist = UA_PubSubChannelUDPMC_regist;
         pubSubChannel->unregist = UA_PubSubChannelUDPMC_unregist;
         pubSubChannel->send = UA_PubSubChannelUDPMC_send;
+#if defined(__linux__)
+        pubSubChannel->sendBatch = UA_PubSubChannelUDPMC_sendBatch;
+#endif
         pubSubChannel->receive = UA_PubSubChannelUDPMC_receive;
         pubSubChannel->close = UA_PubSubChannelUDPMC_close;
         pubSubChannel->connectionConfig = connectionConfig;
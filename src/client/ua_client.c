@@ -248,7 +248,8 @@ serviceFaultId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_SERVICEFAULT_ENCODING_DEFA
 /* Look for the async callback in the linked list, execute and delete it */
 static UA_StatusCode
 processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *responseTypeId,
-                     const UA_ByteString *responseMessage, size_t *offset) {
+                     const UA_ByteString *responseMessage, size_t responseSegments,
+                     size_t *offset) {
     /* Find the callback */
     AsyncServiceCall *ac;
     LIST_FOREACH(ac, &client->asyncServiceCalls, pointers) {
@@ -288,7 +289,8 @@ processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *re
     }
 
     /* Decode the response */
-    retval = UA_decodeBinaryInternal(responseMessage, offset, &response, responseType,
+    retval = UA_decodeBinarySegments(responseMessage, responseSegments, offset,
+                                     &response, responseType,
                                      client->config.customDataTypes);
 
  process:
@@ -320,7 +322,7 @@ processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *re
 static UA_StatusCode
 processServiceResponse(void *application, UA_SecureChannel *channel,
                        UA_MessageType messageType, UA_UInt32 requestId,
-                       UA_ByteString *message) {
+                       UA_ByteString *message, size_t messageSegments) {
     SyncResponseDescription *rd = (SyncResponseDescription*)application;
 
     /* Process ACK response */
@@ -346,14 +348,17 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
     /* Decode the data type identifier of the response */
     size_t offset = 0;
     UA_NodeId responseId;
-    UA_StatusCode retval = UA_NodeId_decodeBinary(message, &offset, &responseId);
+    UA_StatusCode retval =
+        UA_decodeBinarySegments(message, messageSegments, &offset, &responseId,
+                                &UA_TYPES[UA_TYPES_NODEID], NULL);
     if(retval != UA_STATUSCODE_GOOD)
         goto finish;
 
     /* Got an asynchronous response. Don't expected a synchronous response
      * (responseType NULL) or the id does not match. */
     if(!rd->responseType || requestId != rd->requestId) {
-        retval = processAsyncResponse(rd->client, requestId, &responseId, message, &offset);
+        retval = processAsyncResponse(rd->client, requestId, &responseId,
+                                      message, messageSegments, &offset);
         goto finish;
     }
 
@@ -364,7 +369,8 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
     if(!UA_NodeId_equal(&responseId, &rd->responseType->binaryEncodingId)) {
         if(UA_NodeId_equal(&responseId, &serviceFaultId)) {
             UA_init(rd->response, rd->responseType);
-            retval = UA_decodeBinaryInternal(message, &offset, rd->response,
+            retval = UA_decodeBinarySegments(message, messageSegments, &offset,
+                                             rd->response,
                                              &UA_TYPES[UA_TYPES_SERVICEFAULT],
                                              rd->client->config.customDataTypes);
             if(retval != UA_STATUSCODE_GOOD)
@@ -390,7 +396,8 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
 #endif
 
     /* Decode the response */
-    retval = UA_decodeBinaryInternal(message, &offset, rd->response, rd->responseType,
+    retval = UA_decodeBinarySegments(message, messageSegments, &offset,
+                                     rd->response, rd->responseType,
                                      rd->client->config.customDataTypes);
 
 finish:
@@ -17,6 +17,7 @@
 #include <open62541/server_pubsub.h>
 
 #include "open62541_queue.h"
+#include "ziptree.h"
 #include "ua_pubsub_networkmessage.h"
 
 /* The public configuration structs are defined in include/ua_plugin_pubsub.h */
@@ -31,6 +32,9 @@ typedef struct UA_WriterGroup UA_WriterGroup;
 struct UA_ReaderGroup;
 typedef struct UA_ReaderGroup UA_ReaderGroup;
 
+struct UA_PubSubSendBatch;
+typedef struct UA_PubSubSendBatch UA_PubSubSendBatch;
+
 /**********************************************/
 /*            PublishedDataSet                */
 /**********************************************/
@@ -75,6 +79,18 @@ typedef struct UA_PubSubConnection {
     UA_UInt16 configurationFreezeCounter;
     UA_Boolean isRegistered; /* Subscriber requires connection channel regist */
     UA_Boolean configurationFrozen;
+
+    /* The channel socket is watched in the EventLoop while ReaderGroups
+     * receive from it. Then NetworkMessages are processed when they arrive
+     * instead of polling in a cyclic callback. */
+    UA_InterruptManager *socketManager;
+    size_t socketReaderGroups; /* Number of ReaderGroups using the socket */
+    UA_Server *server; /* Backpointer for the socket callback */
+
+    /* NetworkMessages of the WriterGroups that publish in the current
+     * EventLoop cycle. Sent together in a timed callback after the
+     * WriterGroups that are due. */
+    UA_PubSubSendBatch *sendBatch;
 } UA_PubSubConnection;
 
 UA_StatusCode
@@ -91,6 +107,10 @@ UA_PubSubConnectionConfig_clear(UA_PubSubConnectionConfig *connectionConfig);
 void
 UA_PubSubConnection_clear(UA_Server *server, UA_PubSubConnection *connection);
 
+/* Send the batched NetworkMessages right away (before the channel is closed) */
+void
+UA_PubSubConnection_flushSendBatch(UA_Server *server, UA_PubSubConnection *connection);
+
 /* Register channel for given connectionIdentifier */
 UA_StatusCode
 UA_PubSubConnection_regist(UA_Server *server, UA_NodeId *connectionIdentifier);
@@ -107,10 +127,35 @@ UA_Server_processNetworkMessage(UA_Server *server,
 /**********************************************/
 
 #ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+struct UA_DataSetWriter;
+struct UA_TrackedVariable;
+
 typedef struct UA_DataSetWriterSample {
     UA_Boolean valueChanged;
     UA_DataValue value;
+    /* Set for fields that publish a plain variable. Writes to the variable
+     * mark the sample as changed. So the value does not need to be compared
+     * for the delta frames. */
+    struct UA_TrackedVariable *tracked;
 } UA_DataSetWriterSample;
+
+typedef struct {
+    struct UA_DataSetWriter *writer;
+    size_t sampleIndex;
+} UA_TrackedSample;
+
+/* Index from the NodeId of a published variable to the DataSetWriter samples
+ * that publish it */
+typedef struct UA_TrackedVariable {
+    ZIP_ENTRY(UA_TrackedVariable) zipfields;
+    UA_UInt32 nodeIdHash;
+    UA_NodeId nodeId;
+    size_t samplesSize;
+    UA_TrackedSample *samples;
+} UA_TrackedVariable;
+
+ZIP_HEAD(UA_TrackedVariableTree, UA_TrackedVariable);
+typedef struct UA_TrackedVariableTree UA_TrackedVariableTree;
 #endif
 
 typedef struct UA_DataSetWriter {
@@ -126,6 +171,9 @@ typedef struct UA_DataSetWriter {
     UA_UInt16 deltaFrameCounter; /* count of sent deltaFrames */
     size_t lastSamplesCount;
     UA_DataSetWriterSample *lastSamples;
+    size_t untrackedSamplesCount;
+    size_t changedSamplesSize; /* Indices of the tracked samples that were */
+    size_t *changedSamples;    /* written since the last DataSetMessage */
 #endif
     UA_UInt16 actualDataSetMessageSequenceCount;
     UA_Boolean configurationFrozen;
@@ -142,10 +190,30 @@ UA_StatusCode
 UA_DataSetWriter_setPubSubState(UA_Server *server, UA_PubSubState state,
                                 UA_DataSetWriter *dataSetWriter);
 
+/* With zeroCopy, the values of plain variables are not copied during the
+ * generation. They are referenced from the nodestore by
+ * UA_DataSetWriter_sampleZeroCopyFields. */
 UA_StatusCode
 UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
                                         UA_DataSetMessage *dataSetMessage,
-                                        UA_DataSetWriter *dataSetWriter);
+                                        UA_DataSetWriter *dataSetWriter,
+                                        UA_Boolean zeroCopy);
+
+/* Reference the deferred zero-copy fields of a generated DataSetMessage. The
+ * service lock must be held from here until the DataSetMessage is encoded. No
+ * user callbacks must run in between. */
+void
+UA_DataSetWriter_sampleZeroCopyFields(UA_Server *server,
+                                      UA_DataSetMessage *dataSetMessage,
+                                      UA_DataSetWriter *dataSetWriter);
+
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+/* Called from the Write service (with the service lock held) when the value
+ * attribute of a variable was written. Marks the tracked DataSetWriter samples
+ * of the variable for the next delta frame. */
+void
+UA_PubSubManager_markValueChanged(UA_Server *server, const UA_NodeId *nodeId);
+#endif
 
 UA_StatusCode
 UA_DataSetWriter_remove(UA_Server *server, UA_WriterGroup *linkedWriterGroup,
@@ -155,6 +223,19 @@ UA_DataSetWriter_remove(UA_Server *server, UA_WriterGroup *linkedWriterGroup,
 /*               WriterGroup                  */
 /**********************************************/
 
+/* Encoded NetworkMessage of a non-RT WriterGroup from the last publish cycle.
+ * If the layout is unchanged (same DataSetWriters and DataSetMessage sizes),
+ * the headers are kept. Only the SequenceNumber and the DataSetMessages are
+ * encoded into the buffer. */
+typedef struct {
+    UA_ByteString buffer;
+    size_t sequenceNumberOffset; /* Zero if not enabled */
+    size_t payloadOffset; /* Start of the first DataSetMessage */
+    UA_Byte dsmCount;
+    UA_UInt16 *layout; /* dsmCount DataSetWriterIds followed by the
+                        * DataSetMessage sizes */
+} UA_NetworkMessageTemplate;
+
 struct UA_WriterGroup {
     UA_PubSubComponentEnumType componentType;
     UA_WriterGroupConfig config;
@@ -170,6 +251,22 @@ struct UA_WriterGroup {
     UA_UInt16 sequenceNumber; /* Increased after every succressuly sent message */
     UA_Boolean configurationFrozen;
 
+    /* Exchange buffers of the fields in the bufferedMessage. The values are
+     * taken from the buffers before every update of the message. */
+    UA_PubSubExchangeBuffer **exchangeBuffers;
+    size_t exchangeBuffersSize;
+
+    /* Templates of the NetworkMessages sent in one publish cycle (non-RT) */
+    UA_NetworkMessageTemplate *templates;
+    size_t templatesSize;
+    size_t templatesUsed; /* In the current cycle */
+
+    /* Cycle timing of UA_PUBSUB_RT_DETERMINISTIC (on the monotonic clock) */
+    UA_DateTime cycleBaseTime;
+    UA_DateTime publishingOffset;
+    UA_UInt64 lastCycle;
+    UA_WriterGroupCycleStatistics cycleStatistics;
+
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
     UA_UInt32 securityTokenId;
     UA_UInt32 nonceSequenceNumber; /* To be part of the MessageNonce */
@@ -188,6 +285,13 @@ UA_StatusCode
 UA_WriterGroup_setPubSubState(UA_Server *server, UA_PubSubState state,
                               UA_WriterGroup *writerGroup);
 
+/* The deterministic publisher sends the fixed-size buffered message */
+static UA_INLINE UA_Boolean
+UA_WriterGroup_isFixedSize(const UA_WriterGroup *wg) {
+    return (wg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE ||
+            wg->config.rtLevel == UA_PUBSUB_RT_DETERMINISTIC);
+}
+
 /**********************************************/
 /*               DataSetField                 */
 /**********************************************/
@@ -226,6 +330,14 @@ typedef struct UA_DataSetReader {
     UA_Boolean configurationFrozen;
     UA_NetworkMessageOffsetBuffer bufferedMessage;
 
+    /* Latency from the DataSetMessage timestamp to the write of the target
+     * variables */
+    UA_LatencyHistogram receiveLatency;
+
+    /* DataTypes of the DataSetMetaData fields. Resolved when the configuration
+     * is frozen. Otherwise NULL and the types are looked up per message. */
+    const UA_DataType **fieldTypes;
+
 #ifdef UA_ENABLE_PUBSUB_MONITORING
     /* MessageReceiveTimeout handling */
     UA_ServerCallback msgRcvTimeoutTimerCallback;
@@ -241,6 +353,14 @@ UA_DataSetReader_process(UA_Server *server,
                          UA_DataSetReader *dataSetReader,
                          UA_DataSetMessage *dataSetMsg);
 
+/* Resolve and cache the DataTypes of the fields when the configuration is
+ * frozen. Released again when the configuration is unfrozen. */
+UA_StatusCode
+UA_DataSetReader_freezeFieldTypes(UA_Server *server, UA_DataSetReader *dsr);
+
+void
+UA_DataSetReader_unfreezeFieldTypes(UA_DataSetReader *dsr);
+
 /* Copy the configuration of DataSetReader */
 UA_StatusCode UA_DataSetReaderConfig_copy(const UA_DataSetReaderConfig *src,
                                           UA_DataSetReaderConfig *dst);
@@ -302,6 +422,7 @@ struct UA_ReaderGroup {
     /* for simplified information access */
     UA_UInt32 readersCount;
     UA_UInt64 subscribeCallbackId;
+    UA_Boolean receiveOnSocketEvent; /* No cyclic callback, see the connection */
     UA_PubSubState state;
     UA_Boolean configurationFrozen;
 
@@ -374,9 +495,18 @@ UA_StatusCode
 decodeNetworkMessage(UA_Server *server, UA_ByteString *buffer, size_t *pos,
                      UA_NetworkMessage *nm, UA_PubSubConnection *connection);
 
+/* The timeout in microseconds bounds the wait for the first and the following
+ * NetworkMessages */
 UA_StatusCode
 receiveBufferedNetworkMessage(UA_Server *server, UA_ReaderGroup *readerGroup,
-                              UA_PubSubConnection *connection);
+                              UA_PubSubConnection *connection, UA_UInt32 timeout);
+
+/* Receive on the socket of the connection for all ReaderGroups that are
+ * triggered by socket events. Each NetworkMessage is received once and
+ * dispatched to every such ReaderGroup. */
+UA_StatusCode
+receiveSocketNetworkMessage(UA_Server *server, UA_PubSubConnection *connection,
+                            UA_UInt32 timeout);
 
 #endif /* UA_ENABLE_PUBSUB */
 
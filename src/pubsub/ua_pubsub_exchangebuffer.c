@@ -0,0 +1,88 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server_pubsub.h>
+
+#ifdef UA_ENABLE_PUBSUB /* conditional compilation */
+
+/* Triple buffer. The producer writes into the back slot and then swaps it with
+ * the middle slot. The consumer swaps the front slot with the middle slot if
+ * the middle slot contains a value that was not yet read. So producer and
+ * consumer never access the same slot at the same time.
+ *
+ * The atomics from architecture_definitions.h are no-ops without
+ * UA_MULTITHREADING. But the realtime threads of the application exist
+ * independent of the multithreading support of the server. So the exchange of
+ * the middle slot always uses atomic operations. */
+
+#define UA_EXCHANGEBUFFER_FRESH 0x80
+
+#ifdef _MSC_VER /* Visual Studio */
+# include <intrin.h>
+static UA_UInt32
+exchangeMiddle(UA_PubSubExchangeBuffer *eb, UA_UInt32 slot) {
+    return (UA_UInt32)_InterlockedExchange((volatile long*)&eb->middle, (long)slot);
+}
+static UA_UInt32
+loadMiddle(UA_PubSubExchangeBuffer *eb) {
+    return (UA_UInt32)_InterlockedOr((volatile long*)&eb->middle, 0);
+}
+#else /* GCC/Clang */
+static UA_UInt32
+exchangeMiddle(UA_PubSubExchangeBuffer *eb, UA_UInt32 slot) {
+    return __atomic_exchange_n(&eb->middle, slot, __ATOMIC_ACQ_REL);
+}
+static UA_UInt32
+loadMiddle(UA_PubSubExchangeBuffer *eb) {
+    return __atomic_load_n(&eb->middle, __ATOMIC_ACQUIRE);
+}
+#endif
+
+UA_StatusCode
+UA_PubSubExchangeBuffer_init(UA_PubSubExchangeBuffer *eb, const UA_DataType *type) {
+    memset(eb, 0, sizeof(UA_PubSubExchangeBuffer));
+    if(!type || !type->pointerFree || type->memSize == 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    /* Three slots and the storage for the value taken by the consumer */
+    eb->slots = (UA_Byte*)UA_calloc(4, type->memSize);
+    if(!eb->slots)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    eb->type = type;
+    eb->back = 0;
+    eb->middle = 1;
+    eb->front = 2;
+    UA_Variant_setScalar(&eb->value.value, eb->slots + (3 * type->memSize), type);
+    eb->value.value.storageType = UA_VARIANT_DATA_NODELETE;
+    eb->value.hasValue = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_PubSubExchangeBuffer_clear(UA_PubSubExchangeBuffer *eb) {
+    UA_free(eb->slots);
+    memset(eb, 0, sizeof(UA_PubSubExchangeBuffer));
+}
+
+void
+UA_PubSubExchangeBuffer_write(UA_PubSubExchangeBuffer *eb, const void *value) {
+    memcpy(eb->slots + (eb->back * eb->type->memSize), value, eb->type->memSize);
+    UA_UInt32 old = exchangeMiddle(eb, eb->back | UA_EXCHANGEBUFFER_FRESH);
+    eb->back = old & ~(UA_UInt32)UA_EXCHANGEBUFFER_FRESH;
+}
+
+UA_Boolean
+UA_PubSubExchangeBuffer_read(UA_PubSubExchangeBuffer *eb) {
+    if(!(loadMiddle(eb) & UA_EXCHANGEBUFFER_FRESH))
+        return false;
+    UA_UInt32 old = exchangeMiddle(eb, eb->front);
+    eb->front = old & ~(UA_UInt32)UA_EXCHANGEBUFFER_FRESH;
+    memcpy(eb->value.value.data, eb->slots + (eb->front * eb->type->memSize),
+           eb->type->memSize);
+    return true;
+}
+
+#endif /* UA_ENABLE_PUBSUB */
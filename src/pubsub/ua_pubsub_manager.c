@@ -339,6 +339,9 @@ UA_PubSubManager_delete(UA_Server *server, UA_PubSubManager *pubSubManager) {
     TAILQ_FOREACH_SAFE(tmpPDS1, &server->pubSubManager.publishedDataSets, listEntry, tmpPDS2){
         UA_Server_removePublishedDataSet(server, tmpPDS1->identifier);
     }
+
+    UA_ThreadPool_delete(pubSubManager->encodingPool);
+    pubSubManager->encodingPool = NULL;
 }
 
 /***********************************/
@@ -11,6 +11,7 @@
 #include <open62541/server_pubsub.h>
 
 #include "ua_pubsub.h"
+#include "ua_threadpool.h"
 
 _UA_BEGIN_DECLS
 
@@ -28,6 +29,14 @@ typedef struct UA_PubSubManager {
 #ifndef UA_ENABLE_PUBSUB_INFORMATIONMODEL
     UA_UInt32 uniqueIdCount;
 #endif
+
+    /* Encodes the NetworkMessages of a WriterGroup in parallel */
+    UA_ThreadPool *encodingPool;
+
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+    /* Published plain variables for the change detection of delta frames */
+    UA_TrackedVariableTree trackedVariables;
+#endif
 } UA_PubSubManager;
 
 void
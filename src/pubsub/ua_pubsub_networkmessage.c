@@ -927,6 +927,13 @@ increaseOffsetArray(UA_NetworkMessageOffsetBuffer *offsetBuffer) {
 
 size_t
 UA_NetworkMessage_calcSizeBinary(UA_NetworkMessage *p, UA_NetworkMessageOffsetBuffer *offsetBuffer) {
+    return UA_NetworkMessage_calcSizeBinaryInternal(p, offsetBuffer, NULL);
+}
+
+size_t
+UA_NetworkMessage_calcSizeBinaryInternal(UA_NetworkMessage *p,
+                                         UA_NetworkMessageOffsetBuffer *offsetBuffer,
+                                         size_t *sequenceNumberOffset) {
     size_t retval = 0;
     UA_Byte byte = 0;
     size_t size = UA_Byte_calcSizeBinary(&byte); // UADPVersion + UADPFlags
@@ -995,6 +1002,8 @@ UA_NetworkMessage_calcSizeBinary(UA_NetworkMessage *p, UA_NetworkMessageOffsetBu
         }
 
         if(p->groupHeader.sequenceNumberEnabled){
+            if(sequenceNumberOffset)
+                *sequenceNumberOffset = size;
             if(offsetBuffer){
                 size_t pos = offsetBuffer->offsetsSize;
                 if(!increaseOffsetArray(offsetBuffer))
@@ -316,6 +316,14 @@ size_t
 UA_NetworkMessage_calcSizeBinary(UA_NetworkMessage *p,
                                  UA_NetworkMessageOffsetBuffer *offsetBuffer);
 
+/* Like UA_NetworkMessage_calcSizeBinary. Also returns the position of the
+ * SequenceNumber in the encoded message if it is part of the GroupHeader.
+ * Otherwise the sequenceNumberOffset is not changed. */
+size_t
+UA_NetworkMessage_calcSizeBinaryInternal(UA_NetworkMessage *p,
+                                         UA_NetworkMessageOffsetBuffer *offsetBuffer,
+                                         size_t *sequenceNumberOffset);
+
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
 
 UA_StatusCode
@@ -49,6 +49,14 @@ UA_PubSubDSRDataSetField_sampleValue(UA_Server *server, UA_DataSetReader *dataSe
      * This API supports only to external datasource in RT configutation
      * TODO: Extend to support other configuration if required */
 
+    /* The exchange buffer defines the type. The value is only used to compute
+     * the offsets. */
+    if(ftv->exchangeBuffer) {
+        *value = ftv->exchangeBuffer->value;
+        value->value.storageType = UA_VARIANT_DATA_NODELETE;
+        return;
+    }
+
     /* Get the Node */
     const UA_VariableNode *rtNode = (const UA_VariableNode *)
         UA_NODESTORE_GET(server, &ftv->targetVariable.targetNodeId);
@@ -679,6 +687,20 @@ UA_Server_DataSetReader_getState(UA_Server *server, UA_NodeId dataSetReaderIdent
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_Server_DataSetReader_getReceiveLatency(UA_Server *server,
+                                          UA_NodeId dataSetReaderIdentifier,
+                                          UA_LatencyHistogram *latency) {
+    if((server == NULL) || (latency == NULL))
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    UA_DataSetReader *currentDataSetReader =
+        UA_ReaderGroup_findDSRbyId(server, dataSetReaderIdentifier);
+    if(currentDataSetReader == NULL)
+        return UA_STATUSCODE_BADNOTFOUND;
+    *latency = currentDataSetReader->receiveLatency;
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 UA_DataSetReader_setState_disabled(UA_Server *server, UA_DataSetReader *dsr) {
     UA_StatusCode ret = UA_STATUSCODE_GOOD;
@@ -896,7 +918,31 @@ UA_Server_DataSetReader_createDataSetMirror(UA_Server *server, UA_String *parent
     return retval;
 }*/
 
-static void
+UA_StatusCode
+UA_DataSetReader_freezeFieldTypes(UA_Server *server, UA_DataSetReader *dsr) {
+    UA_DataSetReader_unfreezeFieldTypes(dsr);
+    size_t fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+    if(fieldsSize == 0)
+        return UA_STATUSCODE_GOOD;
+    dsr->fieldTypes = (const UA_DataType **)
+        UA_calloc(fieldsSize, sizeof(const UA_DataType *));
+    if(!dsr->fieldTypes)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < fieldsSize; i++)
+        dsr->fieldTypes[i] =
+            UA_findDataTypeWithCustom(&dsr->config.dataSetMetaData.fields[i].dataType,
+                                      server->config.customDataTypes);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_DataSetReader_unfreezeFieldTypes(UA_DataSetReader *dsr) {
+    UA_free((void*)(uintptr_t)dsr->fieldTypes);
+    dsr->fieldTypes = NULL;
+}
+
+/* Returns a bad StatusCode if a field could not be decoded */
+static UA_StatusCode
 DataSetReader_processRaw(UA_Server *server, UA_ReaderGroup *rg,
                          UA_DataSetReader *dsr, UA_DataSetMessage* msg) {
     UA_LOG_TRACE(&server->config.logger, UA_LOGCATEGORY_SERVER,
@@ -904,13 +950,25 @@ DataSetReader_processRaw(UA_Server *server, UA_ReaderGroup *rg,
     msg->data.keyFrameData.fieldCount = (UA_UInt16)
         dsr->config.dataSetMetaData.fieldsSize;
 
+    /* Write all fields of the non-RT message under a single lock */
+    UA_Boolean rt = (rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE);
+    if(!rt)
+        UA_LOCK(&server->serviceMutex);
+
+    UA_StatusCode decodeRes = UA_STATUSCODE_GOOD;
     size_t offset = 0;
     for(size_t i = 0; i < dsr->config.dataSetMetaData.fieldsSize; i++) {
-        /* TODO The datatype reference should be part of the internal
-         * pubsub configuration to avoid the time-expensive lookup */
-        const UA_DataType *type =
+        /* Use the cached DataType of the frozen configuration */
+        const UA_DataType *type = (dsr->fieldTypes) ? dsr->fieldTypes[i] :
             UA_findDataTypeWithCustom(&dsr->config.dataSetMetaData.fields[i].dataType,
                                       server->config.customDataTypes);
+        if(!type) {
+            UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                        "Unknown DataType of Raw-encoded KeyFrame field %u",
+                        (unsigned)i);
+            decodeRes = UA_STATUSCODE_BADDECODINGERROR;
+            break;
+        }
         msg->data.keyFrameData.rawFields.length += type->memSize;
         UA_STACKARRAY(UA_Byte, value, type->memSize);
         UA_StatusCode res =
@@ -920,13 +978,19 @@ DataSetReader_processRaw(UA_Server *server, UA_ReaderGroup *rg,
             UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
                         "Error during Raw-decode KeyFrame field %u: %s",
                         (unsigned)i, UA_StatusCode_name(res));
-            return;
+            decodeRes = res;
+            break;
         }
 
         UA_FieldTargetVariable *tv =
             &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i];
 
-        if(rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+        if(rt && tv->exchangeBuffer) {
+            UA_PubSubExchangeBuffer_write(tv->exchangeBuffer, value);
+            continue;
+        }
+
+        if(rt) {
             if (tv->beforeWrite) {
                 void *pData = (**tv->externalDataValue).value.data;
                 (**tv->externalDataValue).value.data = value;   // set raw data as "preview"
@@ -955,7 +1019,7 @@ DataSetReader_processRaw(UA_Server *server, UA_ReaderGroup *rg,
         writeVal.nodeId = tv->targetVariable.targetNodeId;
         UA_Variant_setScalar(&writeVal.value.value, value, type);
         writeVal.value.hasValue = true;
-        res = UA_Server_write(server, &writeVal);
+        res = writeWithSession(server, &server->adminSession, &writeVal);
         UA_clear(value, type);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
@@ -963,6 +1027,10 @@ DataSetReader_processRaw(UA_Server *server, UA_ReaderGroup *rg,
                         (unsigned)i, UA_StatusCode_name(res));
         }
     }
+
+    if(!rt)
+        UA_UNLOCK(&server->serviceMutex);
+    return decodeRes;
 }
 
 static void
@@ -977,6 +1045,11 @@ DataSetReader_processFixedSize(UA_Server *server, UA_ReaderGroup *rg,
             &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i];
         if(tv->targetVariable.attributeId != UA_ATTRIBUTEID_VALUE)
             continue;
+        if(tv->exchangeBuffer) {
+            UA_PubSubExchangeBuffer_write(tv->exchangeBuffer,
+                                          msg->data.keyFrameData.dataSetFields[i].value.data);
+            continue;
+        }
         if (tv->beforeWrite) {
             UA_DataValue *tmp = &msg->data.keyFrameData.dataSetFields[i];
             tv->beforeWrite(server,
@@ -996,6 +1069,18 @@ DataSetReader_processFixedSize(UA_Server *server, UA_ReaderGroup *rg,
     }
 }
 
+/* The timestamp is set by the publisher when the DataSetMessage is generated.
+ * The buffered message of the RT fixed-size subscriber does not update the
+ * timestamp. */
+static void
+recordReceiveLatency(UA_ReaderGroup *rg, UA_DataSetReader *dsr,
+                     const UA_DataSetMessage *msg) {
+    if(!msg->header.timestampEnabled || rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE)
+        return;
+    UA_LatencyHistogram_add(&dsr->receiveLatency,
+                            UA_DateTime_now() - msg->header.timestamp);
+}
+
 void
 UA_DataSetReader_process(UA_Server *server, UA_ReaderGroup *rg,
                          UA_DataSetReader *dsr, UA_DataSetMessage *msg) {
@@ -1030,7 +1115,9 @@ UA_DataSetReader_process(UA_Server *server, UA_ReaderGroup *rg,
 
     /* Process message with raw encoding (realtime and non-realtime) */
     if(msg->header.fieldEncoding == UA_FIELDENCODING_RAWDATA) {
-        DataSetReader_processRaw(server, rg, dsr, msg);
+        /* Only record the latency of completely decoded messages */
+        if(DataSetReader_processRaw(server, rg, dsr, msg) == UA_STATUSCODE_GOOD)
+            recordReceiveLatency(rg, dsr, msg);
 #ifdef UA_ENABLE_PUBSUB_MONITORING
         UA_DataSetReader_checkMessageReceiveTimeout(server, dsr);
 #endif
@@ -1055,8 +1142,10 @@ UA_DataSetReader_process(UA_Server *server, UA_ReaderGroup *rg,
         return;
     }
 
-    /* Write the message fields via the write service (non realtime) */
+    /* Write the message fields via the write service (non realtime). All
+     * fields are written under a single lock. */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_LOCK(&server->serviceMutex);
     for(size_t i = 0; i < fieldCount; i++) {
         if(!msg->data.keyFrameData.dataSetFields[i].hasValue)
             continue;
@@ -1070,12 +1159,14 @@ UA_DataSetReader_process(UA_Server *server, UA_ReaderGroup *rg,
         writeVal.indexRange = tv->targetVariable.receiverIndexRange;
         writeVal.nodeId = tv->targetVariable.targetNodeId;
         writeVal.value = msg->data.keyFrameData.dataSetFields[i];
-        res = UA_Server_write(server, &writeVal);
+        res = writeWithSession(server, &server->adminSession, &writeVal);
         if(res != UA_STATUSCODE_GOOD)
             UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
                         "Error writing KeyFrame field %u: %s",
                         (unsigned)i, UA_StatusCode_name(res));
     }
+    UA_UNLOCK(&server->serviceMutex);
+    recordReceiveLatency(rg, dsr, msg);
 
 #ifdef UA_ENABLE_PUBSUB_MONITORING
     UA_DataSetReader_checkMessageReceiveTimeout(server, dsr);
@@ -1181,6 +1272,7 @@ static void
 UA_DataSetReader_clear(UA_Server *server, UA_DataSetReader *dsr) {
     /* Delete DataSetReader config */
     UA_DataSetReaderConfig_clear(&dsr->config);
+    UA_DataSetReader_unfreezeFieldTypes(dsr);
 
     /* Delete DataSetReader */
     UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, dsr->linkedReaderGroup);
@@ -1465,7 +1557,7 @@ decodeAndProcessFunRT(UA_PubSubChannel *channel, void *cbContext,
 
 UA_StatusCode
 receiveBufferedNetworkMessage(UA_Server *server, UA_ReaderGroup *readerGroup,
-                              UA_PubSubConnection *connection) {
+                              UA_PubSubConnection *connection, UA_UInt32 timeout) {
     UA_RGContext ctx = {server, connection, readerGroup};
     UA_PubSubReceiveCallback receiveCB;
     if(readerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE)
@@ -1477,15 +1569,73 @@ receiveBufferedNetworkMessage(UA_Server *server, UA_ReaderGroup *readerGroup,
      * use it here instead of a NULL pointer. */
     UA_StatusCode rv =
         connection->channel->receive(connection->channel, NULL,
-                                     receiveCB, &ctx,
-                                     readerGroup->config.timeout);
+                                     receiveCB, &ctx, timeout);
 
-    // TODO attention: here rv is ok if UA_STATUSCODE_GOOD != rv
+    /* Non-bad results (e.g. a timeout without messages) are passed through */
     UA_CHECK_WARN(!UA_StatusCode_isBad(rv), return rv,
                   &server->config.logger, UA_LOGCATEGORY_SERVER,
                   "SubscribeCallback(): Connection receive failed!");
 
-    return UA_STATUSCODE_GOOD;
+    return rv;
+}
+
+static UA_StatusCode
+decodeAndDispatchFun(UA_PubSubChannel *channel, void *cbContext,
+                     const UA_ByteString *buffer) {
+    UA_RGContext *ctx = (UA_RGContext*) cbContext;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_Boolean nonRT = false;
+    UA_ReaderGroup *readerGroup;
+    LIST_FOREACH(readerGroup, &ctx->connection->readerGroups, listEntry) {
+        if(!readerGroup->receiveOnSocketEvent)
+            continue;
+        /* The non-RT processing dispatches to the readers of all ReaderGroups.
+         * Do it once after the RT ReaderGroups. */
+        if(readerGroup->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE) {
+            if(!nonRT) {
+                nonRT = true;
+                ctx->readerGroup = readerGroup;
+            }
+            continue;
+        }
+
+        /* Decryption is in place. Every ReaderGroup gets its own copy. */
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+        UA_ByteString mutableBuffer;
+        if(UA_ByteString_copy(buffer, &mutableBuffer) != UA_STATUSCODE_GOOD)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+#else
+        UA_ByteString mutableBuffer = {buffer->length, buffer->data};
+#endif
+        UA_StatusCode rv =
+            decodeAndProcessNetworkMessageRT(ctx->server, readerGroup,
+                                             ctx->connection, &mutableBuffer);
+        if(rv != UA_STATUSCODE_GOOD)
+            res = rv;
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+        UA_ByteString_clear(&mutableBuffer);
+#endif
+    }
+
+    if(nonRT) {
+        UA_StatusCode rv = decodeAndProcessFun(channel, ctx, buffer);
+        if(rv != UA_STATUSCODE_GOOD)
+            res = rv;
+    }
+    return res;
+}
+
+UA_StatusCode
+receiveSocketNetworkMessage(UA_Server *server, UA_PubSubConnection *connection,
+                            UA_UInt32 timeout) {
+    UA_RGContext ctx = {server, connection, NULL};
+    UA_StatusCode rv =
+        connection->channel->receive(connection->channel, NULL,
+                                     decodeAndDispatchFun, &ctx, timeout);
+    UA_CHECK_WARN(!UA_StatusCode_isBad(rv), return rv,
+                  &server->config.logger, UA_LOGCATEGORY_SERVER,
+                  "SocketCallback(): Connection receive failed!");
+    return rv;
 }
 
 #endif /* UA_ENABLE_PUBSUB */
@@ -447,6 +447,23 @@ UA_Server_freezeReaderGroupConfiguration(UA_Server *server,
     if(!rg)
         return UA_STATUSCODE_BADNOTFOUND;
 
+    /* Resolve the field DataTypes once instead of for every message. Before
+     * the freeze state is changed, so that nothing has to be undone. */
+    UA_DataSetReader *dataSetReader;
+    LIST_FOREACH(dataSetReader, &rg->readers, listEntry) {
+        UA_StatusCode res = UA_DataSetReader_freezeFieldTypes(server, dataSetReader);
+        if(res == UA_STATUSCODE_GOOD)
+            continue;
+        UA_DataSetReader *tmpReader;
+        LIST_FOREACH(tmpReader, &rg->readers, listEntry) {
+            if(tmpReader == dataSetReader)
+                break;
+            if(!tmpReader->configurationFrozen)
+                UA_DataSetReader_unfreezeFieldTypes(tmpReader);
+        }
+        return res;
+    }
+
     /* PubSubConnection freezeCounter++ */
     UA_NodeId pubSubConnectionId =  rg->linkedConnection;
     UA_PubSubConnection *pubSubConnection =
@@ -460,7 +477,6 @@ UA_Server_freezeReaderGroupConfiguration(UA_Server *server,
     rg->configurationFrozen = UA_TRUE;
 
     /* DataSetReader freeze */
-    UA_DataSetReader *dataSetReader;
     UA_UInt16 dsrCount = 0;
     LIST_FOREACH(dataSetReader, &rg->readers, listEntry){
         dataSetReader->configurationFrozen = UA_TRUE;
@@ -495,20 +511,31 @@ UA_Server_freezeReaderGroupConfiguration(UA_Server *server,
     for(size_t i = 0; i < fieldsSize; i++) {
         UA_FieldTargetVariable *tv =
             &dataSetReader->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i];
-        const UA_VariableNode *rtNode = (const UA_VariableNode *)
-            UA_NODESTORE_GET(server, &tv->targetVariable.targetNodeId);
-        if(rtNode != NULL &&
-           rtNode->valueBackend.backendType != UA_VALUEBACKENDTYPE_EXTERNAL) {
-            UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                           "PubSub-RT configuration fail: PDS contains field "
-                           "without external data source.");
+        UA_FieldMetaData *field = &dataSetReader->config.dataSetMetaData.fields[i];
+
+        /* The received values are written into the exchange buffer */
+        if(tv->exchangeBuffer) {
+            if(!tv->exchangeBuffer->type ||
+               !UA_NodeId_equal(&tv->exchangeBuffer->type->typeId, &field->dataType)) {
+                UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                               "PubSub-RT configuration fail: The exchange buffer "
+                               "does not match the DataType of the field.");
+                return UA_STATUSCODE_BADTYPEMISMATCH;
+            }
+        } else {
+            const UA_VariableNode *rtNode = (const UA_VariableNode *)
+                UA_NODESTORE_GET(server, &tv->targetVariable.targetNodeId);
+            if(rtNode != NULL &&
+               rtNode->valueBackend.backendType != UA_VALUEBACKENDTYPE_EXTERNAL) {
+                UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                               "PubSub-RT configuration fail: PDS contains field "
+                               "without external data source.");
+                UA_NODESTORE_RELEASE(server, (const UA_Node *) rtNode);
+                return UA_STATUSCODE_BADNOTSUPPORTED;
+            }
             UA_NODESTORE_RELEASE(server, (const UA_Node *) rtNode);
-            return UA_STATUSCODE_BADNOTSUPPORTED;
         }
 
-        UA_NODESTORE_RELEASE(server, (const UA_Node *) rtNode);
-
-        UA_FieldMetaData *field = &dataSetReader->config.dataSetMetaData.fields[i];
         if((UA_NodeId_equal(&field->dataType, &UA_TYPES[UA_TYPES_STRING].typeId) ||
             UA_NodeId_equal(&field->dataType, &UA_TYPES[UA_TYPES_BYTESTRING].typeId)) &&
            field->maxStringLength == 0) {
@@ -609,6 +636,7 @@ UA_Server_unfreezeReaderGroupConfiguration(UA_Server *server,
     UA_DataSetReader *dataSetReader;
     LIST_FOREACH(dataSetReader, &rg->readers, listEntry) {
         dataSetReader->configurationFrozen = UA_FALSE;
+        UA_DataSetReader_unfreezeFieldTypes(dataSetReader);
     }
 
     if(rg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
@@ -659,13 +687,90 @@ UA_ReaderGroup_subscribeCallback(UA_Server *server,
         return;
     }
 
-    receiveBufferedNetworkMessage(server, readerGroup, connection);
+    receiveBufferedNetworkMessage(server, readerGroup, connection,
+                                  readerGroup->config.timeout);
+}
+
+/* Upper bound of NetworkMessages received in one socket event. So that other
+ * events in the EventLoop are not starved. */
+#define UA_READERGROUP_MAXSOCKETRECEIVE 64
+
+static void
+UA_ReaderGroup_socketCallback(UA_InterruptManager *im, uintptr_t socket,
+                              void *context, size_t instanceInfosSize,
+                              const UA_KeyValuePair *instanceInfos) {
+    UA_PubSubConnection *connection = (UA_PubSubConnection*)context;
+    UA_Server *server = connection->server;
+
+    /* Drain the socket. The minimal timeout of 1us returns as soon as no
+     * further message is pending. Each message is dispatched to all
+     * ReaderGroups of the connection that receive on socket events. */
+    UA_StatusCode res;
+    size_t count = 0;
+    do {
+        res = receiveSocketNetworkMessage(server, connection, 1);
+        count++;
+    } while(res == UA_STATUSCODE_GOOD && connection->socketReaderGroups > 0 &&
+            count < UA_READERGROUP_MAXSOCKETRECEIVE);
+}
+
+/* Look up the socket InterruptManager in the EventLoop and register the
+ * channel socket. Several ReaderGroups share the socket of their connection. */
+static UA_StatusCode
+UA_ReaderGroup_watchSocket(UA_Server *server, UA_ReaderGroup *readerGroup) {
+    if(readerGroup->config.pubsubManagerCallback.addCustomCallback ||
+       readerGroup->config.enableBlockingSocket)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, readerGroup->linkedConnection);
+    if(!connection || !connection->channel || connection->channel->yield ||
+       connection->channel->sockfd == UA_INVALID_SOCKET)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    if(connection->socketReaderGroups == 0) {
+        UA_EventLoop *el = server->config.eventLoop;
+        UA_EventSource *es = el->findEventSource(el, UA_STRING("pubsub-sockets"));
+        if(!es || es->eventSourceType != UA_EVENTSOURCETYPE_INTERRUPTMANAGER)
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        UA_InterruptManager *im = (UA_InterruptManager*)es;
+        connection->server = server;
+        UA_StatusCode res =
+            im->registerInterrupt(im, (uintptr_t)connection->channel->sockfd, 0, NULL,
+                                  UA_ReaderGroup_socketCallback, connection);
+        UA_CHECK_STATUS(res, return res);
+        connection->socketManager = im;
+    }
+
+    connection->socketReaderGroups++;
+    readerGroup->receiveOnSocketEvent = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+UA_ReaderGroup_unwatchSocket(UA_Server *server, UA_ReaderGroup *readerGroup) {
+    readerGroup->receiveOnSocketEvent = false;
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, readerGroup->linkedConnection);
+    if(!connection || connection->socketReaderGroups == 0)
+        return;
+    connection->socketReaderGroups--;
+    if(connection->socketReaderGroups > 0)
+        return;
+    connection->socketManager->
+        deregisterInterrupt(connection->socketManager,
+                            (uintptr_t)connection->channel->sockfd);
+    connection->socketManager = NULL;
 }
 
 /* Add new subscribeCallback. The first execution is triggered directly after
- * creation. */
+ * creation. If the socket of the connection is watched in the EventLoop, no
+ * cyclic callback is added. */
 UA_StatusCode
 UA_ReaderGroup_addSubscribeCallback(UA_Server *server, UA_ReaderGroup *readerGroup) {
+    if(UA_ReaderGroup_watchSocket(server, readerGroup) == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOOD;
+
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     if(readerGroup->config.pubsubManagerCallback.addCustomCallback)
         retval = readerGroup->config.pubsubManagerCallback.
@@ -705,6 +810,10 @@ UA_ReaderGroup_addSubscribeCallback(UA_Server *server, UA_ReaderGroup *readerGro
 
 void
 UA_ReaderGroup_removeSubscribeCallback(UA_Server *server, UA_ReaderGroup *readerGroup) {
+    if(readerGroup->receiveOnSocketEvent) {
+        UA_ReaderGroup_unwatchSocket(server, readerGroup);
+        return;
+    }
     if(readerGroup->config.pubsubManagerCallback.removeCustomCallback)
         readerGroup->config.pubsubManagerCallback.
             removeCustomCallback(server, readerGroup->identifier,
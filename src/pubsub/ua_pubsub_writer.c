@@ -30,6 +30,17 @@
 static void
 UA_DataSetField_clear(UA_DataSetField *field);
 
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+static void
+UA_DataSetWriter_trackSamples(UA_Server *server, UA_DataSetWriter *dataSetWriter,
+                              UA_PublishedDataSet *currentDataSet);
+static void
+UA_DataSetWriter_untrackSamples(UA_Server *server, UA_DataSetWriter *dataSetWriter);
+static void
+UA_DataSetWriter_untrackSample(UA_Server *server, UA_DataSetWriter *dataSetWriter,
+                               size_t sampleIndex);
+#endif
+
 /**********************************************/
 /*               Connection                   */
 /**********************************************/
@@ -111,6 +122,7 @@ UA_PubSubConnection_clear(UA_Server *server, UA_PubSubConnection *connection) {
         UA_Server_removeReaderGroup(server, readerGroups->identifier);
 
     UA_NodeId_clear(&connection->identifier);
+    UA_PubSubConnection_flushSendBatch(server, connection);
     if(connection->channel)
         connection->channel->close(connection->channel);
 
@@ -247,6 +259,21 @@ generateFieldMetaData(UA_Server *server, UA_DataSetField *field,
     UA_StatusCode res = UA_String_copy(&var->fieldNameAlias, &fieldMetaData->name);
     UA_CHECK_STATUS(res, return res);
 
+    /* Exchange buffers contain scalars of a fixed type */
+    if(var->rtValueSource.rtFieldSourceEnabled &&
+       var->rtValueSource.exchangeBuffer) {
+        const UA_PubSubExchangeBuffer *eb = var->rtValueSource.exchangeBuffer;
+        if(!eb->type)
+            return UA_STATUSCODE_BADINVALIDARGUMENT;
+        res = UA_NodeId_copy(&eb->type->typeId, &fieldMetaData->dataType);
+        UA_CHECK_STATUS(res, return res);
+        if(eb->type->typeKind <= UA_DATATYPEKIND_ENUM)
+            fieldMetaData->builtInType = (UA_Byte)eb->type->typeKind;
+        fieldMetaData->valueRank = UA_VALUERANK_SCALAR;
+        fieldMetaData->fieldFlags = UA_DATASETFIELDFLAGS_NONE;
+        return UA_STATUSCODE_GOOD;
+    }
+
     /* Static value source. ToDo after freeze PR, the value source must be
      * checked (other behavior for static value source) */
     if(var->rtValueSource.rtFieldSourceEnabled &&
@@ -615,6 +642,9 @@ UA_DataSetWriter_clear(UA_Server *server, UA_DataSetWriter *dataSetWriter) {
 
     /* Delete lastSamples store */
 #ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetWriter_untrackSamples(server, dataSetWriter);
+    UA_UNLOCK(&server->serviceMutex);
     for(size_t i = 0; i < dataSetWriter->lastSamplesCount; i++) {
         UA_DataValue_clear(&dataSetWriter->lastSamples[i].value);
     }
@@ -783,6 +813,9 @@ UA_Server_addDataSetWriter(UA_Server *server,
             UA_DataValue_init(&newDataSetWriter->lastSamples[i].value);
             newDataSetWriter->lastSamples[i].valueChanged = false;
         }
+        UA_LOCK(&server->serviceMutex);
+        UA_DataSetWriter_trackSamples(server, newDataSetWriter, currentDataSetContext);
+        UA_UNLOCK(&server->serviceMutex);
     }
 #endif
 
@@ -988,16 +1021,87 @@ UA_PubSubDataSetField_sampleValue(UA_Server *server, UA_DataSetField *field,
         rvid.attributeId = params->attributeId;
         rvid.indexRange = params->indexRange;
         *value = UA_Server_read(server, &rvid, UA_TIMESTAMPSTORETURN_BOTH);
+    } else if(field->config.field.variable.rtValueSource.exchangeBuffer) {
+        UA_PubSubExchangeBuffer *eb = field->config.field.variable.rtValueSource.exchangeBuffer;
+        UA_PubSubExchangeBuffer_read(eb);
+        *value = eb->value;
+        value->value.storageType = UA_VARIANT_DATA_NODELETE;
     } else {
         *value = **field->config.field.variable.rtValueSource.staticValueSource;
         value->value.storageType = UA_VARIANT_DATA_NODELETE;
     }
 }
 
+/* Fields that publish the value attribute of a plain variable can be encoded
+ * directly from the nodestore. They are skipped during the DataSetMessage
+ * generation and referenced (without a copy) under the service lock right
+ * before the encoding. DataSources, value callbacks, external value backends
+ * and index ranges go through the normal read. */
+static UA_Boolean
+UA_PubSubDataSetField_isZeroCopy(const UA_DataSetField *field) {
+    const UA_DataSetVariableConfig *var = &field->config.field.variable;
+    return (field->config.dataSetFieldType == UA_PUBSUB_DATASETFIELD_VARIABLE &&
+            !var->rtValueSource.rtInformationModelNode &&
+            !var->rtValueSource.rtFieldSourceEnabled &&
+            var->publishParameters.attributeId == UA_ATTRIBUTEID_VALUE &&
+            var->publishParameters.indexRange.length == 0);
+}
+
+/* Returns the node if its value can be referenced without a copy. The node
+ * needs to be released by the caller. */
+static const UA_VariableNode *
+getZeroCopyNode(UA_Server *server, const UA_DataSetField *field) {
+    const UA_Node *node = UA_NODESTORE_GET(server, &field->config.field.variable.
+                                           publishParameters.publishedVariable);
+    if(!node)
+        return NULL;
+    const UA_VariableNode *vn = &node->variableNode;
+    if(node->head.nodeClass != UA_NODECLASS_VARIABLE ||
+       vn->valueSource != UA_VALUESOURCE_DATA ||
+       (vn->valueBackend.backendType != UA_VALUEBACKENDTYPE_NONE &&
+        vn->valueBackend.backendType != UA_VALUEBACKENDTYPE_INTERNAL) ||
+       vn->value.data.callback.onRead) {
+        UA_NODESTORE_RELEASE(server, node);
+        return NULL;
+    }
+    return vn;
+}
+
+/* A deferred field is empty except for the NODELETE flag. A read always sets
+ * either the value or the status and deep-copies. */
+static UA_Boolean
+isDeferredField(const UA_DataValue *dfv) {
+    return (!dfv->hasValue && !dfv->hasStatus &&
+            dfv->value.storageType == UA_VARIANT_DATA_NODELETE);
+}
+
+static void
+applyFieldContentMask(const UA_DataSetWriter *dataSetWriter, UA_DataValue *dfv) {
+    /* Deactivate statuscode? */
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
+        dfv->hasStatus = false;
+
+    /* Deactivate timestamps */
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
+        dfv->hasSourceTimestamp = false;
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
+        dfv->hasSourcePicoseconds = false;
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
+        dfv->hasServerTimestamp = false;
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
+        dfv->hasServerPicoseconds = false;
+}
+
 static UA_StatusCode
 UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
                                                UA_DataSetMessage *dataSetMessage,
-                                               UA_DataSetWriter *dataSetWriter) {
+                                               UA_DataSetWriter *dataSetWriter,
+                                               UA_Boolean zeroCopy) {
     UA_PublishedDataSet *currentDataSet =
         UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
     if(!currentDataSet)
@@ -1031,41 +1135,289 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
                        &dataSetMessage->data.keyFrameData.fieldNames[counter]);
 #endif
 
-        /* Sample the value */
+        UA_Boolean checkZeroCopy = zeroCopy;
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+        UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[counter];
+        if(ls->tracked)
+            checkZeroCopy = true;
+#endif
+        const UA_VariableNode *vn = NULL;
+        if(checkZeroCopy && UA_PubSubDataSetField_isZeroCopy(dsf))
+            vn = getZeroCopyNode(server, dsf);
+        if(vn)
+            UA_NODESTORE_RELEASE(server, (const UA_Node *)vn);
+
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+        /* The variable is no longer plain (e.g. a DataSource was added). Go
+         * back to comparing the values for the delta frames. */
+        if(ls->tracked && !vn) {
+            UA_LOCK(&server->serviceMutex);
+            UA_DataSetWriter_untrackSample(server, dataSetWriter, counter);
+            UA_UNLOCK(&server->serviceMutex);
+        }
+#endif
+
+        /* Defer the sampling of zero-copy fields until right before the
+         * encoding. See UA_DataSetWriter_sampleZeroCopyFields. */
         UA_DataValue *dfv = &dataSetMessage->data.keyFrameData.dataSetFields[counter];
+        if(zeroCopy && vn) {
+            dfv->value.storageType = UA_VARIANT_DATA_NODELETE;
+            counter++;
+            continue;
+        }
+
+        /* Sample the value */
         UA_PubSubDataSetField_sampleValue(server, dsf, dfv);
+        applyFieldContentMask(dataSetWriter, dfv);
 
-        /* Deactivate statuscode? */
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
-            dfv->hasStatus = false;
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+        /* Update lastValue store. Tracked variables are not compared. */
+        if(!ls->tracked) {
+            UA_DataValue_clear(&ls->value);
+            UA_DataValue_copy(dfv, &ls->value);
+        }
+#endif
 
-        /* Deactivate timestamps */
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
-            dfv->hasSourceTimestamp = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
-            dfv->hasSourcePicoseconds = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
+        counter++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_DataSetWriter_sampleZeroCopyFields(UA_Server *server,
+                                      UA_DataSetMessage *dataSetMessage,
+                                      UA_DataSetWriter *dataSetWriter) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    if(dataSetMessage->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME)
+        return;
+    UA_PublishedDataSet *currentDataSet =
+        UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+    if(!currentDataSet)
+        return;
+
+    UA_DateTime now = UA_DateTime_now();
+    size_t counter = 0;
+    UA_DataSetField *dsf;
+    TAILQ_FOREACH(dsf, &currentDataSet->fields, listEntry) {
+        if(counter >= dataSetMessage->data.keyFrameData.fieldCount)
+            break;
+        UA_DataValue *dfv = &dataSetMessage->data.keyFrameData.dataSetFields[counter];
+        counter++;
+        if(!UA_PubSubDataSetField_isZeroCopy(dsf) || !isDeferredField(dfv))
+            continue;
+
+        /* The node was changed since the DataSetMessage was generated */
+        const UA_VariableNode *vn = getZeroCopyNode(server, dsf);
+        if(!vn) {
+            dfv->hasStatus = true;
+            dfv->status = UA_STATUSCODE_BADNOTREADABLE;
+            applyFieldContentMask(dataSetWriter, dfv);
+            continue;
+        }
+
+        /* Reference the value. It is not freed while the lock is held. Set the
+         * timestamps the same way as a read with TIMESTAMPSTORETURN_BOTH. */
+        *dfv = *getNodeDataValue(vn);
+        dfv->value.storageType = UA_VARIANT_DATA_NODELETE;
+        dfv->hasValue = true;
+        if(!vn->isDynamic) {
             dfv->hasServerTimestamp = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
-            dfv->hasServerPicoseconds = false;
+            dfv->hasSourceTimestamp = false;
+        }
+        if(!dfv->hasServerTimestamp) {
+            dfv->serverTimestamp = now;
+            dfv->hasServerTimestamp = true;
+        }
+        if(!dfv->hasSourceTimestamp) {
+            dfv->sourceTimestamp = now;
+            dfv->hasSourceTimestamp = true;
+        }
+        UA_NODESTORE_RELEASE(server, (const UA_Node *)vn);
+        applyFieldContentMask(dataSetWriter, dfv);
 
 #ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
-        /* Update lastValue store */
-        UA_DataValue_clear(&dataSetWriter->lastSamples[counter].value);
-        UA_DataValue_copy(dfv, &dataSetWriter->lastSamples[counter].value);
+        /* Update lastValue store. Tracked variables are not compared. */
+        UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[counter-1];
+        if(!ls->tracked) {
+            UA_DataValue_clear(&ls->value);
+            UA_DataValue_copy(dfv, &ls->value);
+        }
 #endif
+    }
+}
 
-        counter++;
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+
+/* Delta frames only contain the fields that changed since the last
+ * DataSetMessage. Writes to the tracked (plain) variables mark their samples
+ * in the Write service. So their cost is O(changed fields). Only the untracked
+ * fields (DataSources, callbacks, external values, ...) are sampled and
+ * compared with the last value. Changes to tracked variables that bypass the
+ * Write service (e.g. deleting and re-adding the node) are picked up with the
+ * next keyframe. The tracked variables and the changed samples are protected
+ * by the service mutex. */
+
+static enum ZIP_CMP
+cmpTrackedVariable(const void *a, const void *b) {
+    const UA_TrackedVariable *aa = (const UA_TrackedVariable*)a;
+    const UA_TrackedVariable *bb = (const UA_TrackedVariable*)b;
+    if(aa->nodeIdHash < bb->nodeIdHash)
+        return ZIP_CMP_LESS;
+    if(aa->nodeIdHash > bb->nodeIdHash)
+        return ZIP_CMP_MORE;
+    return (enum ZIP_CMP)UA_NodeId_order(&aa->nodeId, &bb->nodeId);
+}
+
+ZIP_FUNCTIONS(UA_TrackedVariableTree, UA_TrackedVariable, zipfields,
+              UA_TrackedVariable, zipfields, cmpTrackedVariable)
+
+static UA_TrackedVariable *
+findTrackedVariable(UA_Server *server, const UA_NodeId *nodeId) {
+    UA_TrackedVariable dummy;
+    dummy.nodeIdHash = UA_NodeId_hash(nodeId);
+    dummy.nodeId = *nodeId;
+    return ZIP_FIND(UA_TrackedVariableTree,
+                    &server->pubSubManager.trackedVariables, &dummy);
+}
+
+static void
+removeTrackedVariable(UA_Server *server, UA_TrackedVariable *tv) {
+    ZIP_REMOVE(UA_TrackedVariableTree, &server->pubSubManager.trackedVariables, tv);
+    UA_NodeId_clear(&tv->nodeId);
+    UA_free(tv->samples);
+    UA_free(tv);
+}
+
+static UA_StatusCode
+trackSample(UA_Server *server, UA_DataSetWriter *dataSetWriter,
+            size_t sampleIndex, const UA_NodeId *nodeId) {
+    UA_TrackedVariable *tv = findTrackedVariable(server, nodeId);
+    if(!tv) {
+        tv = (UA_TrackedVariable*)UA_calloc(1, sizeof(UA_TrackedVariable));
+        if(!tv)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        UA_StatusCode res = UA_NodeId_copy(nodeId, &tv->nodeId);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_free(tv);
+            return res;
+        }
+        tv->nodeIdHash = UA_NodeId_hash(nodeId);
+        ZIP_INSERT(UA_TrackedVariableTree, &server->pubSubManager.trackedVariables,
+                   tv, UA_UInt32_random());
     }
+
+    UA_TrackedSample *samples = (UA_TrackedSample*)
+        UA_realloc(tv->samples, sizeof(UA_TrackedSample) * (tv->samplesSize + 1));
+    if(!samples) {
+        if(tv->samplesSize == 0)
+            removeTrackedVariable(server, tv);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    tv->samples = samples;
+    tv->samples[tv->samplesSize].writer = dataSetWriter;
+    tv->samples[tv->samplesSize].sampleIndex = sampleIndex;
+    tv->samplesSize++;
+    dataSetWriter->lastSamples[sampleIndex].tracked = tv;
     return UA_STATUSCODE_GOOD;
 }
 
-#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+static void
+UA_DataSetWriter_untrackSample(UA_Server *server, UA_DataSetWriter *dataSetWriter,
+                               size_t sampleIndex) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[sampleIndex];
+    UA_TrackedVariable *tv = ls->tracked;
+    if(!tv)
+        return;
+    ls->tracked = NULL;
+    dataSetWriter->untrackedSamplesCount++;
+
+    for(size_t i = 0; i < tv->samplesSize; i++) {
+        if(tv->samples[i].writer != dataSetWriter ||
+           tv->samples[i].sampleIndex != sampleIndex)
+            continue;
+        tv->samplesSize--;
+        tv->samples[i] = tv->samples[tv->samplesSize];
+        break;
+    }
+    if(tv->samplesSize == 0)
+        removeTrackedVariable(server, tv);
+}
+
+/* Tracking is an optimization. Fields that cannot be tracked (also due to
+ * memory allocation errors) are compared with the last value. */
+static void
+UA_DataSetWriter_trackSamples(UA_Server *server, UA_DataSetWriter *dataSetWriter,
+                              UA_PublishedDataSet *currentDataSet) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    dataSetWriter->untrackedSamplesCount = dataSetWriter->lastSamplesCount;
+    dataSetWriter->changedSamplesSize = 0;
+    if(dataSetWriter->lastSamplesCount == 0)
+        return;
+    dataSetWriter->changedSamples = (size_t*)
+        UA_malloc(sizeof(size_t) * dataSetWriter->lastSamplesCount);
+    if(!dataSetWriter->changedSamples)
+        return;
+
+    size_t counter = 0;
+    UA_DataSetField *dsf;
+    TAILQ_FOREACH(dsf, &currentDataSet->fields, listEntry) {
+        if(counter >= dataSetWriter->lastSamplesCount)
+            break;
+        if(UA_PubSubDataSetField_isZeroCopy(dsf)) {
+            const UA_VariableNode *vn = getZeroCopyNode(server, dsf);
+            if(vn) {
+                UA_NODESTORE_RELEASE(server, (const UA_Node *)vn);
+                UA_StatusCode res =
+                    trackSample(server, dataSetWriter, counter, &dsf->config.
+                                field.variable.publishParameters.publishedVariable);
+                if(res == UA_STATUSCODE_GOOD)
+                    dataSetWriter->untrackedSamplesCount--;
+            }
+        }
+        counter++;
+    }
+}
+
+static void
+UA_DataSetWriter_untrackSamples(UA_Server *server, UA_DataSetWriter *dataSetWriter) {
+    for(size_t i = 0; i < dataSetWriter->lastSamplesCount; i++)
+        UA_DataSetWriter_untrackSample(server, dataSetWriter, i);
+    UA_free(dataSetWriter->changedSamples);
+    dataSetWriter->changedSamples = NULL;
+    dataSetWriter->changedSamplesSize = 0;
+}
+
+/* A keyframe contains all fields. Forget the changes since the last
+ * DataSetMessage. */
+static void
+UA_DataSetWriter_resetChangedSamples(UA_DataSetWriter *dataSetWriter) {
+    for(size_t i = 0; i < dataSetWriter->changedSamplesSize; i++)
+        dataSetWriter->lastSamples[dataSetWriter->changedSamples[i]].valueChanged = false;
+    dataSetWriter->changedSamplesSize = 0;
+}
+
+void
+UA_PubSubManager_markValueChanged(UA_Server *server, const UA_NodeId *nodeId) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    if(!ZIP_ROOT(&server->pubSubManager.trackedVariables))
+        return;
+    UA_TrackedVariable *tv = findTrackedVariable(server, nodeId);
+    if(!tv)
+        return;
+    for(size_t i = 0; i < tv->samplesSize; i++) {
+        UA_DataSetWriter *dsw = tv->samples[i].writer;
+        size_t sampleIndex = tv->samples[i].sampleIndex;
+        UA_DataSetWriterSample *ls = &dsw->lastSamples[sampleIndex];
+        if(ls->valueChanged)
+            continue; /* Already in the list */
+        ls->valueChanged = true;
+        dsw->changedSamples[dsw->changedSamplesSize] = sampleIndex;
+        dsw->changedSamplesSize++;
+    }
+}
+
 static UA_StatusCode
 UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
                                                  UA_DataSetMessage *dataSetMessage,
@@ -1075,79 +1427,96 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
     if(!currentDataSet)
         return UA_STATUSCODE_BADNOTFOUND;
 
-    /* Prepare DataSetMessageContent */
-    memset(dataSetMessage, 0, sizeof(UA_DataSetMessage));
+    /* Prepare DataSetMessageContent. The header was already set up. */
     dataSetMessage->header.dataSetMessageValid = true;
     dataSetMessage->header.dataSetMessageType = UA_DATASETMESSAGE_DATADELTAFRAME;
     if(currentDataSet->fieldSize == 0)
         return UA_STATUSCODE_GOOD;
 
-    UA_DataSetField *dsf;
-    size_t counter = 0;
-    TAILQ_FOREACH(dsf, &currentDataSet->fields, listEntry) {
-        /* Sample the value */
-        UA_DataValue value;
-        UA_DataValue_init(&value);
-        UA_PubSubDataSetField_sampleValue(server, dsf, &value);
-
-        /* Check if the value has changed */
-        UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[counter];
-        if(valueChangedVariant(&ls->value.value, &value.value)) {
-            /* increase fieldCount for current delta message */
-            dataSetMessage->data.deltaFrameData.fieldCount++;
-            ls->valueChanged = true;
-
-            /* Update last stored sample */
-            UA_DataValue_clear(&ls->value);
-            ls->value = value;
-        } else {
-            UA_DataValue_clear(&value);
-            ls->valueChanged = false;
+    /* Sample and compare the untracked fields */
+    size_t untrackedChanged = 0;
+    if(dataSetWriter->untrackedSamplesCount > 0) {
+        UA_DataSetField *dsf;
+        size_t counter = 0;
+        TAILQ_FOREACH(dsf, &currentDataSet->fields, listEntry) {
+            UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[counter];
+            counter++;
+            if(ls->tracked)
+                continue;
+
+            /* Sample the value */
+            UA_DataValue value;
+            UA_DataValue_init(&value);
+            UA_PubSubDataSetField_sampleValue(server, dsf, &value);
+
+            /* Check if the value has changed */
+            if(valueChangedVariant(&ls->value.value, &value.value)) {
+                untrackedChanged++;
+                ls->valueChanged = true;
+
+                /* Update last stored sample */
+                UA_DataValue_clear(&ls->value);
+                ls->value = value;
+            } else {
+                UA_DataValue_clear(&value);
+                ls->valueChanged = false;
+            }
         }
+    }
 
-        counter++;
+    /* Take the tracked fields that were written since the last DataSetMessage.
+     * Allocate for all changed fields. */
+    UA_LOCK(&server->serviceMutex);
+    size_t fieldCount = untrackedChanged + dataSetWriter->changedSamplesSize;
+    UA_DataSetMessage_DeltaFrameField *deltaFields = NULL;
+    if(fieldCount > 0) {
+        deltaFields = (UA_DataSetMessage_DeltaFrameField *)
+            UA_calloc(fieldCount, sizeof(UA_DataSetMessage_DeltaFrameField));
+        if(!deltaFields) {
+            UA_UNLOCK(&server->serviceMutex);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
     }
+    size_t currentDeltaField = 0;
+    for(size_t i = 0; i < dataSetWriter->changedSamplesSize; i++) {
+        size_t sampleIndex = dataSetWriter->changedSamples[i];
+        UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[sampleIndex];
+        ls->valueChanged = false;
+        if(!ls->tracked)
+            continue; /* Untracked since the write. Was compared above. */
+        deltaFields[currentDeltaField].fieldIndex = (UA_UInt16)sampleIndex;
+        currentDeltaField++;
+    }
+    dataSetWriter->changedSamplesSize = 0;
+    UA_UNLOCK(&server->serviceMutex);
 
-    /* Allocate DeltaFrameFields */
-    UA_DataSetMessage_DeltaFrameField *deltaFields = (UA_DataSetMessage_DeltaFrameField *)
-        UA_calloc(dataSetMessage->data.deltaFrameData.fieldCount,
-                  sizeof(UA_DataSetMessage_DeltaFrameField));
-    if(!deltaFields)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
+    /* Sample the written tracked fields */
+    for(size_t i = 0; i < currentDeltaField; i++) {
+        UA_DataSetMessage_DeltaFrameField *dff = &deltaFields[i];
+        UA_ReadValueId rvid;
+        UA_ReadValueId_init(&rvid);
+        rvid.nodeId = dataSetWriter->lastSamples[dff->fieldIndex].tracked->nodeId;
+        rvid.attributeId = UA_ATTRIBUTEID_VALUE;
+        dff->fieldValue = UA_Server_read(server, &rvid, UA_TIMESTAMPSTORETURN_BOTH);
+        applyFieldContentMask(dataSetWriter, &dff->fieldValue);
+    }
 
-    dataSetMessage->data.deltaFrameData.deltaFrameFields = deltaFields;
-    size_t currentDeltaField = 0;
-    for(size_t i = 0; i < currentDataSet->fieldSize; i++) {
-        if(!dataSetWriter->lastSamples[i].valueChanged)
+    /* Add the changed untracked fields */
+    for(size_t i = 0; i < currentDataSet->fieldSize && untrackedChanged > 0; i++) {
+        UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[i];
+        if(ls->tracked || !ls->valueChanged)
             continue;
-
         UA_DataSetMessage_DeltaFrameField *dff = &deltaFields[currentDeltaField];
-
         dff->fieldIndex = (UA_UInt16) i;
-        UA_DataValue_copy(&dataSetWriter->lastSamples[i].value, &dff->fieldValue);
-        dataSetWriter->lastSamples[i].valueChanged = false;
-
-        /* Deactivate statuscode? */
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
-            dff->fieldValue.hasStatus = false;
-
-        /* Deactivate timestamps? */
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
-            dff->fieldValue.hasSourceTimestamp = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
-            dff->fieldValue.hasServerPicoseconds = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
-            dff->fieldValue.hasServerTimestamp = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
-            dff->fieldValue.hasServerPicoseconds = false;
-
+        UA_DataValue_copy(&ls->value, &dff->fieldValue);
+        applyFieldContentMask(dataSetWriter, &dff->fieldValue);
+        ls->valueChanged = false;
+        untrackedChanged--;
         currentDeltaField++;
     }
+
+    dataSetMessage->data.deltaFrameData.deltaFrameFields = deltaFields;
+    dataSetMessage->data.deltaFrameData.fieldCount = (UA_UInt16)currentDeltaField;
     return UA_STATUSCODE_GOOD;
 }
 #endif
@@ -1156,7 +1525,8 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
 UA_StatusCode
 UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
                                         UA_DataSetMessage *dataSetMessage,
-                                        UA_DataSetWriter *dataSetWriter) {
+                                        UA_DataSetWriter *dataSetWriter,
+                                        UA_Boolean zeroCopy) {
     UA_PublishedDataSet *currentDataSet =
         UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
     if(!currentDataSet)
@@ -1297,12 +1667,17 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
     if(dsm) {
 #ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
         /* Check if the PublishedDataSet version has changed -> if yes flush the
-         * lastValue store and send a KeyFrame */
+         * lastValue store and send a KeyFrame. The version can stay the same
+         * if fields are added within the resolution of the version time. */
     if(dataSetWriter->connectedDataSetVersion.majorVersion !=
        currentDataSet->dataSetMetaData.configurationVersion.majorVersion ||
        dataSetWriter->connectedDataSetVersion.minorVersion !=
-       currentDataSet->dataSetMetaData.configurationVersion.minorVersion) {
+       currentDataSet->dataSetMetaData.configurationVersion.minorVersion ||
+       dataSetWriter->lastSamplesCount != currentDataSet->fieldSize) {
         /* Remove old samples */
+        UA_LOCK(&server->serviceMutex);
+        UA_DataSetWriter_untrackSamples(server, dataSetWriter);
+        UA_UNLOCK(&server->serviceMutex);
         for(size_t i = 0; i < dataSetWriter->lastSamplesCount; i++)
             UA_DataValue_clear(&dataSetWriter->lastSamples[i].value);
 
@@ -1316,11 +1691,14 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
         dataSetWriter->lastSamples = newSamplesArray;
         memset(dataSetWriter->lastSamples, 0,
                sizeof(UA_DataSetWriterSample) * dataSetWriter->lastSamplesCount);
+        UA_LOCK(&server->serviceMutex);
+        UA_DataSetWriter_trackSamples(server, dataSetWriter, currentDataSet);
+        UA_UNLOCK(&server->serviceMutex);
 
         dataSetWriter->connectedDataSetVersion =
             currentDataSet->dataSetMetaData.configurationVersion;
         UA_PubSubDataSetWriter_generateKeyFrameMessage(server, dataSetMessage,
-                                                       dataSetWriter);
+                                                       dataSetWriter, zeroCopy);
         dataSetWriter->deltaFrameCounter = 0;
         return UA_STATUSCODE_GOOD;
     }
@@ -1337,11 +1715,14 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
     }
 
     dataSetWriter->deltaFrameCounter = 1;
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetWriter_resetChangedSamples(dataSetWriter);
+    UA_UNLOCK(&server->serviceMutex);
 #endif
     }
 
     return UA_PubSubDataSetWriter_generateKeyFrameMessage(server, dataSetMessage,
-                                                          dataSetWriter);
+                                                          dataSetWriter, zeroCopy);
 }
 
 #endif /* UA_ENABLE_PUBSUB */
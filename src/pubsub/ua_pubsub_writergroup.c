@@ -27,6 +27,16 @@
 static void
 UA_WriterGroup_clear(UA_Server *server, UA_WriterGroup *writerGroup);
 
+static void
+UA_WriterGroup_clearTemplates(UA_WriterGroup *wg);
+
+static void
+UA_WriterGroup_clearExchangeBuffers(UA_WriterGroup *wg) {
+    UA_free(wg->exchangeBuffers);
+    wg->exchangeBuffers = NULL;
+    wg->exchangeBuffersSize = 0;
+}
+
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
 static UA_StatusCode
 encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
@@ -197,7 +207,7 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server,
         }
     }
 
-    if(wg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
+    if(!UA_WriterGroup_isFixedSize(wg))
         return UA_STATUSCODE_GOOD;
 
     /* Freeze the RT writer configuration */
@@ -212,6 +222,7 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server,
     //TODO Clarify: Behaviour if the finale size is more than MTU
 
     /* Generate data set messages  */
+    UA_WriterGroup_clearExchangeBuffers(wg);
     UA_STACKARRAY(UA_UInt16, dsWriterIds, wg->writersCount);
     UA_STACKARRAY(UA_DataSetMessage, dsmStore, wg->writersCount);
     UA_StatusCode res = UA_STATUSCODE_GOOD;
@@ -258,10 +269,24 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server,
                                "PDS contains variable with dynamic size.");
                 return UA_STATUSCODE_BADNOTSUPPORTED;
             }
+
+            /* Remember the exchange buffer */
+            UA_PubSubExchangeBuffer *eb = dsf->config.field.variable.rtValueSource.exchangeBuffer;
+            if(!dsf->config.field.variable.rtValueSource.rtFieldSourceEnabled || !eb)
+                continue;
+            UA_PubSubExchangeBuffer **ebs = (UA_PubSubExchangeBuffer**)
+                UA_realloc(wg->exchangeBuffers, sizeof(UA_PubSubExchangeBuffer*) *
+                           (wg->exchangeBuffersSize + 1));
+            if(!ebs)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            ebs[wg->exchangeBuffersSize] = eb;
+            wg->exchangeBuffers = ebs;
+            wg->exchangeBuffersSize++;
         }
 
         /* Generate the DSM */
-        res = UA_DataSetWriter_generateDataSetMessage(server, &dsmStore[dsmCount], dsw);
+        res = UA_DataSetWriter_generateDataSetMessage(server, &dsmStore[dsmCount], dsw,
+                                                      false);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
                            "PubSub RT Offset calculation: DataSetMessage buffering failed");
@@ -377,7 +402,8 @@ UA_Server_unfreezeWriterGroupConfiguration(UA_Server *server,
         }
         dataSetWriter->configurationFrozen = UA_FALSE;
     }
-    if(wg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+    if(UA_WriterGroup_isFixedSize(wg)) {
+        UA_WriterGroup_clearExchangeBuffers(wg);
         UA_ByteString_clear(&wg->bufferedMessage.buffer);
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
         if (wg->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
@@ -465,6 +491,7 @@ UA_Server_updateWriterGroupConfig(UA_Server *server, UA_NodeId writerGroupIdenti
     //Currently is only a change of the publishing interval possible.
     if(currentWriterGroup->config.maxEncapsulatedDataSetMessageCount != config->maxEncapsulatedDataSetMessageCount) {
         currentWriterGroup->config.maxEncapsulatedDataSetMessageCount = config->maxEncapsulatedDataSetMessageCount;
+        UA_WriterGroup_clearTemplates(currentWriterGroup);
         if(currentWriterGroup->config.messageSettings.encoding == UA_EXTENSIONOBJECT_ENCODED_NOBODY) {
             UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
                            "MaxEncapsulatedDataSetMessag need enabled 'PayloadHeader' within the message settings.");
@@ -509,6 +536,20 @@ UA_Server_WriterGroup_getState(UA_Server *server, UA_NodeId writerGroupIdentifie
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_Server_WriterGroup_getCycleStatistics(UA_Server *server,
+                                         UA_NodeId writerGroupIdentifier,
+                                         UA_WriterGroupCycleStatistics *stats) {
+    if((server == NULL) || (stats == NULL))
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    UA_WriterGroup *currentWriterGroup =
+        UA_WriterGroup_findWGbyId(server, writerGroupIdentifier);
+    if(currentWriterGroup == NULL)
+        return UA_STATUSCODE_BADNOTFOUND;
+    *stats = currentWriterGroup->cycleStatistics;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_WriterGroup *
 UA_WriterGroup_findWGbyId(UA_Server *server, UA_NodeId identifier) {
     UA_PubSubConnection *tmpConnection;
@@ -594,6 +635,9 @@ UA_WriterGroup_clear(UA_Server *server, UA_WriterGroup *writerGroup) {
         UA_free(writerGroup->bufferedMessage.offsets);
     }
 
+    UA_WriterGroup_clearTemplates(writerGroup);
+    UA_WriterGroup_clearExchangeBuffers(writerGroup);
+
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
     if(writerGroup->config.securityPolicy && writerGroup->securityPolicyContext) {
         writerGroup->config.securityPolicy->deleteContext(writerGroup->securityPolicyContext);
@@ -780,11 +824,97 @@ encodeNetworkMessage(UA_WriterGroup *wg, UA_NetworkMessage *nm,
     return UA_STATUSCODE_GOOD;
 }
 
+/* NetworkMessages of WriterGroups that publish in the same EventLoop cycle are
+ * collected per PubSubConnection. They are handed to the transport together in
+ * a timed callback for the current time. The timers process it after the
+ * WriterGroups that were due earlier. If the clock has advanced beyond the
+ * current timer pass, the EventLoop does not wait on the sockets and sends the
+ * batch in the next cycle. */
+#define UA_PUBSUB_MAXSENDBATCH 64
+
+struct UA_PubSubSendBatch {
+    UA_UInt64 callbackId;
+    size_t messagesSize;
+    UA_ByteString messages[UA_PUBSUB_MAXSENDBATCH];
+};
+
+static void
+sendBatchMessages(UA_Server *server, UA_PubSubConnection *connection,
+                  UA_PubSubSendBatch *batch) {
+    if(connection->channel && batch->messagesSize > 0) {
+        UA_StatusCode res = connection->channel->
+            sendBatch(connection->channel, batch->messagesSize, batch->messages);
+        if(res != UA_STATUSCODE_GOOD)
+            UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                         "PubSub Publish: Sending %u batched NetworkMessages "
+                         "failed", (unsigned)batch->messagesSize);
+    }
+    for(size_t i = 0; i < batch->messagesSize; i++)
+        UA_ByteString_clear(&batch->messages[i]);
+    batch->messagesSize = 0;
+}
+
+static void
+sendBatchCallback(void *application, void *data) {
+    UA_PubSubConnection *connection = (UA_PubSubConnection*)data;
+    UA_PubSubSendBatch *batch = connection->sendBatch;
+    if(!batch)
+        return;
+    connection->sendBatch = NULL;
+    sendBatchMessages((UA_Server*)application, connection, batch);
+    UA_free(batch);
+}
+
+void
+UA_PubSubConnection_flushSendBatch(UA_Server *server, UA_PubSubConnection *connection) {
+    UA_PubSubSendBatch *batch = connection->sendBatch;
+    if(!batch)
+        return;
+    UA_EventLoop *el = server->config.eventLoop;
+    el->removeCyclicCallback(el, batch->callbackId);
+    sendBatchCallback(server, connection);
+}
+
+/* Send right away or add a copy of the message to the batch of the
+ * connection */
+static UA_StatusCode
+sendNetworkMessageBuffer(UA_Server *server, UA_PubSubConnection *connection,
+                         UA_ExtensionObject *transportSettings,
+                         const UA_ByteString *buf, UA_Boolean batch) {
+    UA_PubSubChannel *channel = connection->channel;
+    if(!batch || !channel->sendBatch)
+        return channel->send(channel, transportSettings, buf);
+
+    UA_PubSubSendBatch *sb = connection->sendBatch;
+    if(!sb) {
+        sb = (UA_PubSubSendBatch*)UA_calloc(1, sizeof(UA_PubSubSendBatch));
+        if(!sb)
+            return channel->send(channel, transportSettings, buf);
+        UA_EventLoop *el = server->config.eventLoop;
+        UA_StatusCode res =
+            el->addTimedCallback(el, sendBatchCallback, server, connection,
+                                 el->dateTime_nowMonotonic(el), &sb->callbackId);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_free(sb);
+            return channel->send(channel, transportSettings, buf);
+        }
+        connection->sendBatch = sb;
+    } else if(sb->messagesSize == UA_PUBSUB_MAXSENDBATCH) {
+        sendBatchMessages(server, connection, sb); /* Full, send out now */
+    }
+
+    UA_StatusCode res = UA_ByteString_copy(buf, &sb->messages[sb->messagesSize]);
+    UA_CHECK_STATUS(res, return res);
+    sb->messagesSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
 #ifdef UA_ENABLE_JSON_ENCODING
+/* The caller provides a buffer of UA_MAX_STACKBUF bytes. Larger messages are
+ * allocated and ownBuf is set. */
 static UA_StatusCode
-sendNetworkMessageJson(UA_PubSubConnection *connection, UA_DataSetMessage *dsm,
-                       UA_UInt16 *writerIds, UA_Byte dsmCount,
-                       UA_ExtensionObject *transportSettings) {
+encodeNetworkMessageJson(UA_DataSetMessage *dsm, UA_UInt16 *writerIds,
+                         UA_Byte dsmCount, UA_ByteString *buf, UA_Boolean *ownBuf) {
     /* Prepare the NetworkMessage */
     UA_NetworkMessage nm;
     memset(&nm, 0, sizeof(UA_NetworkMessage));
@@ -798,33 +928,24 @@ sendNetworkMessageJson(UA_PubSubConnection *connection, UA_DataSetMessage *dsm,
     /* Compute the message length */
     size_t msgSize = UA_NetworkMessage_calcSizeJson(&nm, NULL, 0, NULL, 0, true);
 
-    /* Allocate the buffer. Allocate on the stack if the buffer is small. */
-    UA_ByteString buf;
-    UA_Byte stackBuf[UA_MAX_STACKBUF];
-    buf.data = stackBuf;
-    buf.length = msgSize;
+    /* Allocate the buffer if the provided buffer is too small */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    if(msgSize > UA_MAX_STACKBUF) {
-        res = UA_ByteString_allocBuffer(&buf, msgSize);
+    if(msgSize > buf->length) {
+        res = UA_ByteString_allocBuffer(buf, msgSize);
         if(res != UA_STATUSCODE_GOOD)
             return res;
+        *ownBuf = true;
     }
+    buf->length = msgSize;
 
     /* Encode the message */
-    UA_Byte *bufPos = buf.data;
-    const UA_Byte *bufEnd = &buf.data[msgSize];
+    UA_Byte *bufPos = buf->data;
+    const UA_Byte *bufEnd = &buf->data[msgSize];
     res = UA_NetworkMessage_encodeJson(&nm, &bufPos, &bufEnd, NULL, 0, NULL, 0, true);
     if(res != UA_STATUSCODE_GOOD)
-        goto cleanup;
+        return res;
     UA_assert(bufPos == bufEnd);
-
-    /* Send the prepared messages */
-    res = connection->channel->send(connection->channel, transportSettings, &buf);
-
- cleanup:
-    if(msgSize > UA_MAX_STACKBUF)
-        UA_ByteString_clear(&buf);
-    return res;
+    return UA_STATUSCODE_GOOD;
 }
 #endif
 
@@ -933,23 +1054,140 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
     return UA_STATUSCODE_GOOD;
 }
 
+static void
+UA_NetworkMessageTemplate_clear(UA_NetworkMessageTemplate *nmt) {
+    UA_ByteString_clear(&nmt->buffer);
+    UA_free(nmt->layout);
+    memset(nmt, 0, sizeof(UA_NetworkMessageTemplate));
+}
+
+static void
+UA_WriterGroup_clearTemplates(UA_WriterGroup *wg) {
+    for(size_t i = 0; i < wg->templatesSize; i++)
+        UA_NetworkMessageTemplate_clear(&wg->templates[i]);
+    UA_free(wg->templates);
+    wg->templates = NULL;
+    wg->templatesSize = 0;
+    wg->templatesUsed = 0;
+}
+
+/* Returns the template slot for the next NetworkMessage of the publish cycle.
+ * NULL if the message cannot be templated. The headers of signed and encrypted
+ * messages change with every nonce, promoted fields have a dynamic size. */
+static UA_NetworkMessageTemplate *
+UA_WriterGroup_nextTemplate(UA_WriterGroup *wg, UA_Boolean promotedFields) {
+    if(wg->config.securityMode > UA_MESSAGESECURITYMODE_NONE || promotedFields)
+        return NULL;
+    if(wg->templatesUsed == wg->templatesSize) {
+        UA_NetworkMessageTemplate *templates = (UA_NetworkMessageTemplate*)
+            UA_realloc(wg->templates, sizeof(UA_NetworkMessageTemplate) *
+                       (wg->templatesSize + 1));
+        if(!templates)
+            return NULL;
+        memset(&templates[wg->templatesSize], 0, sizeof(UA_NetworkMessageTemplate));
+        wg->templates = templates;
+        wg->templatesSize++;
+    }
+    return &wg->templates[wg->templatesUsed++];
+}
+
+static UA_Boolean
+UA_NetworkMessageTemplate_matches(const UA_NetworkMessageTemplate *nmt,
+                                  const UA_NetworkMessage *nm) {
+    UA_Byte count = nm->payloadHeader.dataSetPayloadHeader.count;
+    return (nmt->buffer.length > 0 && nmt->dsmCount == count &&
+            memcmp(nmt->layout, nm->payloadHeader.dataSetPayloadHeader.dataSetWriterIds,
+                   sizeof(UA_UInt16) * count) == 0 &&
+            memcmp(&nmt->layout[count], nm->payload.dataSetPayload.sizes,
+                   sizeof(UA_UInt16) * count) == 0);
+}
+
+/* Keep the encoded message for the next cycle */
+static UA_StatusCode
+UA_NetworkMessageTemplate_set(UA_NetworkMessageTemplate *nmt,
+                              const UA_NetworkMessage *nm, const UA_ByteString *buf,
+                              size_t sequenceNumberOffset) {
+    UA_NetworkMessageTemplate_clear(nmt);
+    UA_Byte count = nm->payloadHeader.dataSetPayloadHeader.count;
+    size_t payloadSize = 0;
+    for(UA_Byte i = 0; i < count; i++)
+        payloadSize += nm->payload.dataSetPayload.sizes[i];
+    if(count == 0 || payloadSize > buf->length)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    nmt->layout = (UA_UInt16*)UA_malloc(sizeof(UA_UInt16) * 2 * count);
+    UA_CHECK_MEM(nmt->layout, return UA_STATUSCODE_BADOUTOFMEMORY);
+    memcpy(nmt->layout, nm->payloadHeader.dataSetPayloadHeader.dataSetWriterIds,
+           sizeof(UA_UInt16) * count);
+    memcpy(&nmt->layout[count], nm->payload.dataSetPayload.sizes,
+           sizeof(UA_UInt16) * count);
+    UA_StatusCode rv = UA_ByteString_copy(buf, &nmt->buffer);
+    if(rv != UA_STATUSCODE_GOOD) {
+        UA_NetworkMessageTemplate_clear(nmt);
+        return rv;
+    }
+    nmt->dsmCount = count;
+    nmt->payloadOffset = buf->length - payloadSize;
+    nmt->sequenceNumberOffset = sequenceNumberOffset;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Encode the SequenceNumber and the DataSetMessages into the template */
+static UA_StatusCode
+UA_NetworkMessageTemplate_update(UA_NetworkMessageTemplate *nmt,
+                                 const UA_NetworkMessage *nm) {
+    UA_StatusCode rv = UA_STATUSCODE_GOOD;
+    UA_Byte *bufPos;
+    const UA_Byte *bufEnd = &nmt->buffer.data[nmt->buffer.length];
+    if(nmt->sequenceNumberOffset > 0) {
+        bufPos = &nmt->buffer.data[nmt->sequenceNumberOffset];
+        rv = UA_UInt16_encodeBinary(&nm->groupHeader.sequenceNumber, &bufPos, bufEnd);
+        UA_CHECK_STATUS(rv, return rv);
+    }
+    bufPos = &nmt->buffer.data[nmt->payloadOffset];
+    for(UA_Byte i = 0; i < nmt->dsmCount; i++) {
+        rv = UA_DataSetMessage_encodeBinary(&nm->payload.dataSetPayload.dataSetMessages[i],
+                                            &bufPos, bufEnd);
+        UA_CHECK_STATUS(rv, return rv);
+    }
+    if(bufPos != bufEnd)
+        return UA_STATUSCODE_BADENCODINGERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The caller provides a buffer of UA_MAX_STACKBUF bytes. Larger messages are
+ * allocated and ownBuf is set. If the template of the last cycle can be
+ * reused, the buffer points into the template. */
 static UA_StatusCode
-sendNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
-                   UA_DataSetMessage *dsm, UA_UInt16 *writerIds, UA_Byte dsmCount,
-                   UA_ExtensionObject *messageSettings,
-                   UA_ExtensionObject *transportSettings) {
+encodeNetworkMessageUadp(UA_PubSubConnection *connection, UA_WriterGroup *wg,
+                         UA_DataSetMessage *dsm, UA_UInt16 *writerIds,
+                         UA_Byte dsmCount, UA_ByteString *buf, UA_Boolean *ownBuf) {
     UA_NetworkMessage nm;
     memset(&nm, 0, sizeof(UA_NetworkMessage));
+    size_t sequenceNumberOffset = 0;
 
     /* Fill the message structure */
     UA_StatusCode rv =
         generateNetworkMessage(connection, wg, dsm, writerIds, dsmCount,
-                               messageSettings, transportSettings, &nm);
+                               &wg->config.messageSettings,
+                               &wg->config.transportSettings, &nm);
     UA_CHECK_STATUS(rv, return rv);
 
+    /* Reuse the message of the last cycle if the layout did not change */
+    UA_NetworkMessageTemplate *nmt = UA_WriterGroup_nextTemplate(wg, nm.promotedFieldsEnabled);
+    if(nmt && UA_NetworkMessageTemplate_matches(nmt, &nm)) {
+        rv = UA_NetworkMessageTemplate_update(nmt, &nm);
+        if(rv == UA_STATUSCODE_GOOD) {
+            *buf = nmt->buffer;
+            goto cleanup;
+        }
+        UA_NetworkMessageTemplate_clear(nmt); /* Fall back to the full encoding */
+    }
+
     /* Compute the message size. Add the overhead for the security signature.
      * There is no padding and the encryption incurs no size overhead. */
-    size_t msgSize = UA_NetworkMessage_calcSizeBinary(&nm, NULL);
+    size_t msgSize =
+        UA_NetworkMessage_calcSizeBinaryInternal(&nm, NULL, &sequenceNumberOffset);
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
     if(wg->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
         UA_PubSubSecurityPolicy *sp = wg->config.securityPolicy;
@@ -958,47 +1196,280 @@ sendNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
     }
 #endif
 
-    /* Allocate the buffer. Allocate on the stack if the buffer is small. */
-    UA_ByteString buf;
-    UA_Byte stackBuf[UA_MAX_STACKBUF];
-    buf.data = stackBuf;
-    buf.length = msgSize;
-    if(msgSize > UA_MAX_STACKBUF) {
-        rv = UA_ByteString_allocBuffer(&buf, msgSize);
+    /* Allocate the buffer if the provided buffer is too small */
+    if(msgSize > buf->length) {
+        rv = UA_ByteString_allocBuffer(buf, msgSize);
         UA_CHECK_STATUS(rv, goto cleanup);
+        *ownBuf = true;
     }
+    buf->length = msgSize;
 
     /* Encode and encrypt the message */
-    rv = encodeNetworkMessage(wg, &nm, &buf);
-    UA_CHECK_STATUS(rv, goto cleanup_with_msg_size);
+    rv = encodeNetworkMessage(wg, &nm, buf);
+    UA_CHECK_STATUS(rv, goto cleanup);
 
-    /* Send out the message */
-    rv = connection->channel->send(connection->channel, transportSettings, &buf);
-    UA_CHECK_STATUS(rv, goto cleanup_with_msg_size);
+    /* Keep as the template for the next cycle */
+    if(nmt)
+        UA_NetworkMessageTemplate_set(nmt, &nm, buf, sequenceNumberOffset);
 
-cleanup_with_msg_size:
-    if(msgSize > UA_MAX_STACKBUF) {
-        UA_ByteString_clear(&buf);
-    }
 cleanup:
     UA_ByteString_clear(&nm.securityHeader.messageNonce);
     UA_free(nm.payload.dataSetPayload.sizes);
     return rv;
 }
 
+/* Reference the zero-copy fields and encode the NetworkMessage under the
+ * service lock. The message is sent after the lock is released. */
+static UA_StatusCode
+publishNetworkMessage(UA_Server *server, UA_PubSubConnection *connection,
+                      UA_WriterGroup *wg, UA_DataSetMessage *dsm,
+                      UA_UInt16 *writerIds, UA_DataSetWriter **writers,
+                      UA_Byte dsmCount, UA_Boolean batch) {
+    /* Use a buffer on the stack if the message is small */
+    UA_ByteString buf;
+    UA_Byte stackBuf[UA_MAX_STACKBUF];
+    buf.data = stackBuf;
+    buf.length = UA_MAX_STACKBUF;
+    UA_Boolean ownBuf = false;
+
+    UA_StatusCode res;
+    UA_LOCK(&server->serviceMutex);
+    for(UA_Byte i = 0; i < dsmCount; i++)
+        UA_DataSetWriter_sampleZeroCopyFields(server, &dsm[i], writers[i]);
+    if(wg->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP) {
+        res = encodeNetworkMessageUadp(connection, wg, dsm, writerIds, dsmCount,
+                                       &buf, &ownBuf);
+    } else { /* if(wg->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON) */
+#ifdef UA_ENABLE_JSON_ENCODING
+        res = encodeNetworkMessageJson(dsm, writerIds, dsmCount, &buf, &ownBuf);
+#else
+        res = UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+    }
+    UA_UNLOCK(&server->serviceMutex);
+
+    if(res == UA_STATUSCODE_GOOD)
+        res = sendNetworkMessageBuffer(server, connection,
+                                       &wg->config.transportSettings, &buf, batch);
+    if(ownBuf)
+        UA_ByteString_clear(&buf);
+    return res;
+}
+
+/* NetworkMessage of a publish cycle that is encoded on the worker pool */
+typedef struct {
+    UA_PubSubConnection *connection;
+    UA_WriterGroup *wg;
+    UA_DataSetMessage *dsm;
+    UA_UInt16 *writerIds;
+    UA_DataSetWriter *firstWriter; /* Set to the error state if sending fails */
+    UA_Byte dsmCount;
+    UA_UInt16 sequenceNumber;
+    size_t templateIndex; /* SIZE_MAX if the message is not templated */
+    UA_ByteString buf;    /* Own allocation or points into the template */
+    UA_Boolean ownBuf;
+    UA_StatusCode res;
+} UA_EncodeJob;
+
+/* Only touches the template slot of the job and can run in parallel. Message
+ * security is not used, so there is no shared crypto context. */
+static void
+encodeNetworkMessageJob(void *context, size_t index) {
+    UA_EncodeJob *job = &((UA_EncodeJob*)context)[index];
+    UA_WriterGroup *wg = job->wg;
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    size_t sequenceNumberOffset = 0;
+    job->res = generateNetworkMessage(job->connection, wg, job->dsm, job->writerIds,
+                                      job->dsmCount, &wg->config.messageSettings,
+                                      &wg->config.transportSettings, &nm);
+    if(job->res != UA_STATUSCODE_GOOD)
+        return;
+    nm.groupHeader.sequenceNumber = job->sequenceNumber;
+
+    /* Reuse the message of the last cycle if the layout did not change */
+    UA_NetworkMessageTemplate *nmt = (job->templateIndex != SIZE_MAX) ?
+        &wg->templates[job->templateIndex] : NULL;
+    if(nmt && UA_NetworkMessageTemplate_matches(nmt, &nm)) {
+        job->res = UA_NetworkMessageTemplate_update(nmt, &nm);
+        if(job->res == UA_STATUSCODE_GOOD) {
+            job->buf = nmt->buffer;
+            goto cleanup;
+        }
+        UA_NetworkMessageTemplate_clear(nmt); /* Fall back to the full encoding */
+    }
+
+    job->res = UA_ByteString_allocBuffer(&job->buf,
+        UA_NetworkMessage_calcSizeBinaryInternal(&nm, NULL, &sequenceNumberOffset));
+    if(job->res != UA_STATUSCODE_GOOD)
+        goto cleanup;
+    job->ownBuf = true;
+    job->res = encodeNetworkMessage(wg, &nm, &job->buf);
+    if(job->res == UA_STATUSCODE_GOOD && nmt)
+        UA_NetworkMessageTemplate_set(nmt, &nm, &job->buf, sequenceNumberOffset);
+
+ cleanup:
+    UA_free(nm.payload.dataSetPayload.sizes);
+}
+
+/* Encode the NetworkMessages of the cycle on the worker pool and send them in
+ * the same order as the sequential publish. The DataSetMessages with promoted
+ * fields are stored from the end of dsmStore and sent individually first.
+ * Then the batched DataSetMessages from the start of dsmStore. */
+static void
+publishWriterGroupParallel(UA_Server *server, UA_WriterGroup *wg,
+                           UA_PubSubConnection *connection, UA_Byte maxDSM,
+                           UA_DataSetMessage *dsmStore, UA_UInt16 *dsWriterIds,
+                           UA_DataSetWriter **dsWriters, size_t batchedCount,
+                           size_t directStart, UA_Boolean batch) {
+    size_t directCount = wg->writersCount - directStart;
+    size_t jobsSize = directCount + (batchedCount + maxDSM - 1) / maxDSM;
+    if(jobsSize == 0)
+        return;
+    UA_EncodeJob *jobs = (UA_EncodeJob*)UA_calloc(jobsSize, sizeof(UA_EncodeJob));
+    if(!jobs) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                     "PubSub Publish: Out of memory");
+        return;
+    }
+
+    /* Set up the jobs in the sending order */
+    size_t j = 0;
+    for(size_t i = wg->writersCount; i > directStart; i--, j++) {
+        jobs[j].dsm = &dsmStore[i-1];
+        jobs[j].writerIds = &dsWriterIds[i-1];
+        jobs[j].firstWriter = dsWriters[i-1];
+        jobs[j].dsmCount = 1;
+    }
+    for(size_t i = 0; i < batchedCount; i += maxDSM, j++) {
+        jobs[j].dsm = &dsmStore[i];
+        jobs[j].writerIds = &dsWriterIds[i];
+        jobs[j].firstWriter = dsWriters[i];
+        jobs[j].dsmCount = (i + maxDSM > batchedCount) ?
+            (UA_Byte)(batchedCount - i) : maxDSM;
+    }
+
+    /* The template slots are assigned before the parallel encoding. The
+     * sequence number is only incremented for batched DataSetMessages. */
+    const UA_ExtensionObject *ms = &wg->config.messageSettings;
+    UA_Boolean promotedFields = (ms->content.decoded.type ==
+                                 &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE]) &&
+        ((u64)((UA_UadpWriterGroupMessageDataType*)ms->content.decoded.data)->
+         networkMessageContentMask &
+         (u64)UA_UADPNETWORKMESSAGECONTENTMASK_PROMOTEDFIELDS) != 0;
+    for(j = 0; j < jobsSize; j++) {
+        jobs[j].connection = connection;
+        jobs[j].wg = wg;
+        jobs[j].sequenceNumber = wg->sequenceNumber;
+        if(j >= directCount)
+            wg->sequenceNumber++;
+        UA_NetworkMessageTemplate *nmt = UA_WriterGroup_nextTemplate(wg, promotedFields);
+        jobs[j].templateIndex = (nmt) ? (size_t)(nmt - wg->templates) : SIZE_MAX;
+    }
+
+    /* Reference the zero-copy fields and encode under the service lock. The
+     * messages are sent after the lock is released. */
+    UA_LOCK(&server->serviceMutex);
+    for(size_t i = 0; i < wg->writersCount; i++) {
+        if(i < batchedCount || i >= directStart)
+            UA_DataSetWriter_sampleZeroCopyFields(server, &dsmStore[i], dsWriters[i]);
+    }
+    UA_ThreadPool_run(server->pubSubManager.encodingPool,
+                      encodeNetworkMessageJob, jobs, jobsSize);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Gather and send in order */
+    for(j = 0; j < jobsSize; j++) {
+        UA_EncodeJob *job = &jobs[j];
+        if(job->res == UA_STATUSCODE_GOOD)
+            job->res = sendNetworkMessageBuffer(server, connection,
+                                                &wg->config.transportSettings,
+                                                &job->buf, batch);
+        if(job->res != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                         "PubSub Publish: Could not send a NetworkMessage");
+            UA_DataSetWriter_setPubSubState(server, UA_PUBSUBSTATE_ERROR,
+                                            job->firstWriter);
+        }
+        if(job->ownBuf)
+            UA_ByteString_clear(&job->buf);
+    }
+    UA_free(jobs);
+}
+
 static UA_StatusCode
 sendBufferedNetworkMessage(UA_Server *server, UA_PubSubConnection *connection,
                            UA_ByteString *buffer,
-                           UA_ExtensionObject *transportSettings) {
-
+                           UA_ExtensionObject *transportSettings,
+                           UA_DateTime launchTime) {
+    /* Convert the launch time from the monotonic clock to UtcTime */
+    if(launchTime != 0 && connection->channel->sendAt) {
+        launchTime += UA_DateTime_now() - UA_DateTime_nowMonotonic();
+        return connection->channel->sendAt(connection->channel, transportSettings,
+                                           buffer, launchTime);
+    }
     return connection->channel->send(connection->channel,
                                      transportSettings, buffer);
 }
 
-/* This callback triggers the collection and publish of NetworkMessages and the
- * contained DataSetMessages. */
-void
-UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
+/* Start the cycles of the deterministic publisher at integer multiples of the
+ * publishing interval on the system clock. So that publishers with
+ * synchronized clocks send in the same phase. */
+static void
+UA_WriterGroup_initCycle(UA_WriterGroup *wg) {
+    UA_DateTime interval = (UA_DateTime)
+        (wg->config.publishingInterval * UA_DATETIME_MSEC);
+    if(interval <= 0)
+        interval = 1;
+    wg->cycleBaseTime = UA_DateTime_nowMonotonic() - (UA_DateTime_now() % interval);
+    wg->lastCycle = 0;
+    memset(&wg->cycleStatistics, 0, sizeof(UA_WriterGroupCycleStatistics));
+
+    /* Launch time relative to the cycle start */
+    wg->publishingOffset = 0;
+    const UA_ExtensionObject *ms = &wg->config.messageSettings;
+    if(ms->content.decoded.type == &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE]) {
+        const UA_UadpWriterGroupMessageDataType *wgm =
+            (const UA_UadpWriterGroupMessageDataType*)ms->content.decoded.data;
+        if(wgm->publishingOffsetSize > 0)
+            wg->publishingOffset = (UA_DateTime)
+                (wgm->publishingOffset[0] * UA_DATETIME_MSEC);
+    }
+}
+
+/* Returns the deadline of the current cycle (monotonic clock). Skipped cycles
+ * count as missed deadlines. */
+static UA_DateTime
+UA_WriterGroup_beginCycle(UA_WriterGroup *wg) {
+    UA_DateTime interval = (UA_DateTime)
+        (wg->config.publishingInterval * UA_DATETIME_MSEC);
+    if(interval <= 0)
+        interval = 1;
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    UA_UInt64 cycle = (UA_UInt64)((now - wg->cycleBaseTime) / interval);
+    UA_DateTime cycleStart = wg->cycleBaseTime + ((UA_DateTime)cycle * interval);
+    UA_LatencyHistogram_add(&wg->cycleStatistics.jitter, now - cycleStart);
+    if(wg->cycleStatistics.cycles > 0 && cycle > wg->lastCycle + 1)
+        wg->cycleStatistics.deadlineMisses += (size_t)(cycle - wg->lastCycle - 1);
+    wg->lastCycle = cycle;
+    if(wg->publishingOffset > 0)
+        return cycleStart + wg->publishingOffset;
+    return cycleStart + interval;
+}
+
+static void
+UA_WriterGroup_endCycle(UA_WriterGroup *wg, UA_DateTime deadline) {
+    wg->cycleStatistics.cycles++;
+    if(UA_DateTime_nowMonotonic() > deadline)
+        wg->cycleStatistics.deadlineMisses++;
+}
+
+/* Collect and publish the NetworkMessages and the contained DataSetMessages.
+ * With batching, the messages are sent after all WriterGroups that are due in
+ * the current timer pass. */
+static void
+publishWriterGroup(UA_Server *server, UA_WriterGroup *writerGroup,
+                   UA_Boolean batch) {
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER, "Publish Callback");
 
@@ -1034,7 +1505,22 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
         return;
     }
 
-    if(writerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+    if(UA_WriterGroup_isFixedSize(writerGroup)) {
+        /* The launch time is only set with a publishingOffset. Otherwise the
+         * message is sent right away. */
+        UA_DateTime deadline = 0;
+        UA_DateTime launchTime = 0;
+        if(writerGroup->config.rtLevel == UA_PUBSUB_RT_DETERMINISTIC) {
+            deadline = UA_WriterGroup_beginCycle(writerGroup);
+            if(writerGroup->publishingOffset > 0)
+                launchTime = deadline;
+        }
+
+        /* Take the latest values from the exchange buffers. The buffered
+         * message points to their value storage. */
+        for(size_t i = 0; i < writerGroup->exchangeBuffersSize; i++)
+            UA_PubSubExchangeBuffer_read(writerGroup->exchangeBuffers[i]);
+
         if(UA_NetworkMessage_updateBufferedMessage(&writerGroup->bufferedMessage) != UA_STATUSCODE_GOOD)
             UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
                          "PubSub sending. Unknown field type.");
@@ -1056,12 +1542,15 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
             /* Send the encrypted buffered network message
              * if PubSub encryption is enabled */
             res = sendBufferedNetworkMessage(server, connection, &writerGroup->bufferedMessage.encryptBuffer,
-                                             &writerGroup->config.transportSettings);
+                                             &writerGroup->config.transportSettings, launchTime);
         }
 #endif
         if (writerGroup->config.securityMode < UA_MESSAGESECURITYMODE_NONE)
             res = sendBufferedNetworkMessage(server, connection, &writerGroup->bufferedMessage.buffer,
-                                             &writerGroup->config.transportSettings);
+                                             &writerGroup->config.transportSettings, launchTime);
+
+        if(writerGroup->config.rtLevel == UA_PUBSUB_RT_DETERMINISTIC)
+            UA_WriterGroup_endCycle(writerGroup, deadline);
 
         if(res == UA_STATUSCODE_GOOD) {
             writerGroup->sequenceNumber++;
@@ -1073,6 +1562,9 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
         return;
     }
 
+    /* The templates are used in the order of the NetworkMessages */
+    writerGroup->templatesUsed = 0;
+
     /* How many DSM can be sent in one NM? */
     UA_Byte maxDSM = (UA_Byte)writerGroup->config.maxEncapsulatedDataSetMessageCount;
     if(writerGroup->config.maxEncapsulatedDataSetMessageCount > UA_BYTE_MAX)
@@ -1081,11 +1573,23 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
     if(maxDSM == 0)
         maxDSM = 1;
 
+    /* Encode the NetworkMessages on the worker pool? */
+    UA_Boolean parallel =
+        (UA_ThreadPool_concurrency(server->pubSubManager.encodingPool) > 1 &&
+         writerGroup->writersCount > 1 &&
+         writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP &&
+         writerGroup->config.rtLevel == UA_PUBSUB_RT_NONE &&
+         writerGroup->config.securityMode <= UA_MESSAGESECURITYMODE_NONE);
+
     /* It is possible to put several DataSetMessages into one NetworkMessage.
      * But only if they do not contain promoted fields. NM with only DSM are
-     * sent out right away. The others are kept in a buffer for "batching". */
+     * sent out right away. The others are kept in a buffer for "batching".
+     * For the parallel encoding, the DSM that are sent individually are stored
+     * from the end of the buffer. */
     size_t dsmCount = 0;
+    size_t directStart = writerGroup->writersCount;
     UA_STACKARRAY(UA_UInt16, dsWriterIds, writerGroup->writersCount);
+    UA_STACKARRAY(UA_DataSetWriter *, dsWriters, writerGroup->writersCount);
     UA_STACKARRAY(UA_DataSetMessage, dsmStore, writerGroup->writersCount);
     UA_DataSetWriter *dsw;
     LIST_FOREACH(dsw, &writerGroup->writers, listEntry) {
@@ -1103,7 +1607,10 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
         }
 
         /* Generate the DSM */
-        res = UA_DataSetWriter_generateDataSetMessage(server, &dsmStore[dsmCount], dsw);
+        UA_Boolean direct = (pds->promotedFieldsCount > 0 || maxDSM == 1);
+        size_t pos = (parallel && direct) ? directStart - 1 : dsmCount;
+        res = UA_DataSetWriter_generateDataSetMessage(server, &dsmStore[pos], dsw,
+                                                      true);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
                          "PubSub Publish: DataSetMessage creation failed");
@@ -1112,28 +1619,19 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
         }
 
         /* There is no promoted field and we can batch dsm. So do the batching. */
-        if(pds->promotedFieldsCount == 0 && maxDSM > 1) {
-            dsWriterIds[dsmCount] = dsw->config.dataSetWriterId;
-            dsmCount++;
+        if(!direct || parallel) {
+            dsWriterIds[pos] = dsw->config.dataSetWriterId;
+            dsWriters[pos] = dsw;
+            if(pos == dsmCount)
+                dsmCount++;
+            else
+                directStart--;
             continue;
         }
 
         /* Send right away */
-        if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP){
-            res = sendNetworkMessage(connection, writerGroup, &dsmStore[dsmCount],
-                                     &dsw->config.dataSetWriterId, 1,
-                                     &writerGroup->config.messageSettings,
-                                     &writerGroup->config.transportSettings);
-        } else { /* if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON) */
-#ifdef UA_ENABLE_JSON_ENCODING
-            res = sendNetworkMessageJson(connection, &dsmStore[dsmCount],
-                                         &dsw->config.dataSetWriterId, 1,
-                                         &writerGroup->config.transportSettings);
-#else
-            res = UA_STATUSCODE_BADNOTSUPPORTED;
-#endif
-        }
-
+        res = publishNetworkMessage(server, connection, writerGroup, &dsmStore[dsmCount],
+                                    &dsw->config.dataSetWriterId, &dsw, 1, batch);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
                          "PubSub Publish: Could not send a NetworkMessage");
@@ -1151,6 +1649,15 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
 
     /* Send the NetworkMessages with batched DataSetMessages */
     size_t i = 0;
+    if(parallel) {
+        publishWriterGroupParallel(server, writerGroup, connection, maxDSM, dsmStore,
+                                   dsWriterIds, dsWriters, dsmCount, directStart, batch);
+        for(i = 0; i < writerGroup->writersCount; i++) {
+            if(i < dsmCount || i >= directStart)
+                UA_DataSetMessage_clear(&dsmStore[i]);
+        }
+        return;
+    }
     while(i < dsmCount) {
         /* How many dsm in this iteration? */
         UA_Byte nmDsmCount = maxDSM;
@@ -1158,21 +1665,8 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
             nmDsmCount = (UA_Byte)(dsmCount - i);
         }
 
-        if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP){
-            res = sendNetworkMessage(connection, writerGroup, &dsmStore[i],
-                                     &dsWriterIds[i], nmDsmCount,
-                                     &writerGroup->config.messageSettings,
-                                     &writerGroup->config.transportSettings);
-        } else { /* if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON) */
-#ifdef UA_ENABLE_JSON_ENCODING
-            res = sendNetworkMessageJson(connection, &dsmStore[i],
-                                         &dsWriterIds[i], nmDsmCount,
-                                         &writerGroup->config.transportSettings);
-#else
-            res = UA_STATUSCODE_BADNOTSUPPORTED;
-#endif
-        }
-
+        res = publishNetworkMessage(server, connection, writerGroup, &dsmStore[i],
+                                    &dsWriterIds[i], &dsWriters[i], nmDsmCount, batch);
         if(res == UA_STATUSCODE_GOOD) {
             writerGroup->sequenceNumber++; /* TODO: Why not in the direct-send case? */
         } else {
@@ -1194,25 +1688,48 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
         UA_DataSetMessage_clear(&dsmStore[i]);
 }
 
+/* This callback triggers the collection and publish of NetworkMessages and the
+ * contained DataSetMessages. */
+void
+UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
+    publishWriterGroup(server, writerGroup, false);
+}
+
+/* Cyclic callback from the EventLoop. The NetworkMessages of all WriterGroups
+ * of a connection that are due in the current cycle are sent as a batch. The
+ * fixed-size RT path is not batched. */
+static void
+UA_WriterGroup_publishCallbackBatched(UA_Server *server, UA_WriterGroup *writerGroup) {
+    publishWriterGroup(server, writerGroup, true);
+}
+
 /* Add new publishCallback. The first execution is triggered directly after
  * creation. */
 UA_StatusCode
 UA_WriterGroup_addPublishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
+
+    /* The deterministic publisher keeps the cycles aligned to the base time */
+    UA_DateTime *baseTime = NULL;
+    UA_TimerPolicy timerPolicy = UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME;
+    if(writerGroup->config.rtLevel == UA_PUBSUB_RT_DETERMINISTIC) {
+        UA_WriterGroup_initCycle(writerGroup);
+        baseTime = &writerGroup->cycleBaseTime;
+        timerPolicy = UA_TIMER_HANDLE_CYCLEMISS_WITH_BASETIME;
+    }
+
     if(writerGroup->config.pubsubManagerCallback.addCustomCallback)
         retval |= writerGroup->config.pubsubManagerCallback.
             addCustomCallback(server, writerGroup->identifier,
                               (UA_ServerCallback) UA_WriterGroup_publishCallback,
                               writerGroup, writerGroup->config.publishingInterval,
-                              NULL,                                        // TODO: Send base time from writer group config
-                              UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME,  // TODO: Send timer policy from writer group config
+                              baseTime, timerPolicy,
                               &writerGroup->publishCallbackId);
     else
         retval |= UA_PubSubManager_addRepeatedCallback(server,
-                     (UA_ServerCallback) UA_WriterGroup_publishCallback,
+                     (UA_ServerCallback) UA_WriterGroup_publishCallbackBatched,
                      writerGroup, writerGroup->config.publishingInterval,
-                     NULL,                                        // TODO: Send base time from writer group config
-                     UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME,  // TODO: Send timer policy from writer group config
+                     baseTime, timerPolicy,
                      &writerGroup->publishCallbackId);
 
     if(retval == UA_STATUSCODE_GOOD)
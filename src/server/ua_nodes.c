@@ -389,6 +389,83 @@ UA_NodeReferenceKind_findTarget(const UA_NodeReferenceKind *rk,
     return NULL;
 }
 
+/***************/
+/* Value Cells */
+/***************/
+
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+
+void
+UA_ValueCellEntry_delete(UA_ValueCellEntry *entry) {
+    UA_DataValue_clear(&entry->value);
+    UA_free(entry);
+}
+
+static void
+clearValueCellEntry(void *application, void *data) {
+    UA_ValueCellEntry *entry = (UA_ValueCellEntry*)data;
+    UA_DataValue_clear(&entry->value);
+}
+
+void
+UA_ValueCell_release(UA_ValueCell *cell) {
+    if(UA_atomic_subSize(&cell->refCount, 1) > 0)
+        return;
+    UA_ValueCellEntry_delete(cell->current);
+    UA_free(cell);
+}
+
+UA_StatusCode
+UA_VariableNode_publishValue(UA_Server *server, UA_VariableNode *node,
+                             UA_ValueCellEntry *entry) {
+    UA_ValueCell *cell = node->value.data.cell;
+    if(!cell) {
+        cell = (UA_ValueCell*)UA_calloc(1, sizeof(UA_ValueCell));
+        if(!cell) {
+            UA_ValueCellEntry_delete(entry);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        cell->current = entry;
+        cell->refCount = 1;
+        UA_DataValue_clear(&node->value.data.value);
+        node->value.data.cell = cell;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    UA_ValueCellEntry *old = (UA_ValueCellEntry*)
+        UA_atomic_xchg((void * volatile *)&cell->current, entry);
+    UA_atomic_addSize(&cell->version, 1);
+    UA_EventLoop *el = server->config.eventLoop;
+    if(!el) {
+        UA_ValueCellEntry_delete(old);
+        return UA_STATUSCODE_GOOD;
+    }
+    old->cleanup.callback = clearValueCellEntry;
+    old->cleanup.application = NULL;
+    old->cleanup.data = old;
+    el->addDelayedCallback(el, &old->cleanup);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_VariableNode_shareValueCell(const UA_Node *orig, UA_Node *copy) {
+    if(orig->head.nodeClass != UA_NODECLASS_VARIABLE &&
+       orig->head.nodeClass != UA_NODECLASS_VARIABLETYPE)
+        return;
+    UA_ValueCell *cell = orig->variableNode.value.data.cell;
+    if(orig->variableNode.valueSource != UA_VALUESOURCE_DATA || !cell ||
+       copy->variableNode.valueSource != UA_VALUESOURCE_DATA ||
+       copy->variableNode.value.data.cell)
+        return;
+
+    /* Drop the value that was copied from the cell */
+    UA_DataValue_clear(&copy->variableNode.value.data.value);
+    UA_atomic_addSize(&cell->refCount, 1);
+    copy->variableNode.value.data.cell = cell;
+}
+
+#endif
+
 /* General node handling methods. There is no UA_Node_new() method here.
  * Creating nodes is part of the Nodestore layer */
 
@@ -419,8 +496,15 @@ void UA_Node_clear(UA_Node *node) {
                         &UA_TYPES[UA_TYPES_INT32]);
         p->arrayDimensions = NULL;
         p->arrayDimensionsSize = 0;
-        if(p->valueSource == UA_VALUESOURCE_DATA)
+        if(p->valueSource == UA_VALUESOURCE_DATA) {
             UA_DataValue_clear(&p->value.data.value);
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+            if(p->value.data.cell) {
+                UA_ValueCell_release(p->value.data.cell);
+                p->value.data.cell = NULL;
+            }
+#endif
+        }
         break;
     }
     case UA_NODECLASS_REFERENCETYPE: {
@@ -455,9 +539,13 @@ UA_CommonVariableNode_copy(const UA_VariableNode *src, UA_VariableNode *dst) {
     dst->valueRank = src->valueRank;
     dst->valueSource = src->valueSource;
     if(src->valueSource == UA_VALUESOURCE_DATA) {
-        retval |= UA_DataValue_copy(&src->value.data.value,
+        /* The copy does not share the value cell */
+        retval |= UA_DataValue_copy(getNodeDataValue(src),
                                     &dst->value.data.value);
         dst->value.data.callback = src->value.data.callback;
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+        dst->value.data.cell = NULL;
+#endif
     } else
         dst->value.dataSource = src->value.dataSource;
     return retval;
@@ -189,7 +189,11 @@ void UA_Server_delete(UA_Server *server) {
 #endif
 
 #ifdef UA_ENABLE_PUBSUB
+    /* The PubSub configuration is removed through the public API that takes
+     * the service lock */
+    UA_UNLOCK(&server->serviceMutex);
     UA_PubSubManager_delete(server, &server->pubSubManager);
+    UA_LOCK(&server->serviceMutex);
 #endif
 
 #ifdef UA_ENABLE_DISCOVERY
@@ -213,10 +217,15 @@ void UA_Server_delete(UA_Server *server) {
     /* Clean up the Admin Session */
     UA_Session_clear(&server->adminSession, server);
 
+    /* Stop the crypto workers after the SecureChannels are removed */
+    UA_ThreadPool_delete(server->chunkCryptoPool);
+    server->chunkCryptoPool = NULL;
+
     UA_UNLOCK(&server->serviceMutex); /* The timer has its own mutex */
 
     /* Clean up the config */
     UA_ServerConfig_clean(&server->config);
+    UA_TypeHierarchy_clear(&server->typeHierarchy);
 
 #if UA_MULTITHREADING >= 100
     UA_LOCK_DESTROY(&server->networkMutex);
@@ -528,6 +537,16 @@ UA_ServerStatistics UA_Server_getStatistics(UA_Server *server)
    return server->serverStats;
 }
 
+void
+UA_Server_getServiceStatistics(UA_Server *server, UA_ServiceStatistics *stats) {
+    UA_LOCK(&server->serviceMutex);
+    *stats = server->serviceStats;
+    channel_entry *entry;
+    TAILQ_FOREACH(entry, &server->channels, pointers)
+        addSecureChannelTraffic(&stats->traffic, &entry->channel.traffic);
+    UA_UNLOCK(&server->serviceMutex);
+}
+
 /********************/
 /* Main Server Loop */
 /********************/
@@ -585,6 +604,29 @@ UA_Server_run_startup(UA_Server *server) {
     UA_CHECK_STATUS(retVal, return retVal);
 #endif
 
+    /* Spin up the workers for the chunk crypto */
+#if UA_MULTITHREADING >= 100
+    if(server->config.chunkCryptoThreads > 0 && !server->chunkCryptoPool) {
+        retVal = UA_ThreadPool_new(&server->chunkCryptoPool,
+                                   server->config.chunkCryptoThreads);
+        UA_CHECK_STATUS_WARN(retVal, server->chunkCryptoPool = NULL,
+                             &server->config.logger, UA_LOGCATEGORY_SERVER,
+                             "Could not start the workers for the chunk crypto. "
+                             "Continuing without.");
+    }
+#ifdef UA_ENABLE_PUBSUB
+    if(server->config.pubSubConfig.encodingThreads > 0 &&
+       !server->pubSubManager.encodingPool) {
+        retVal = UA_ThreadPool_new(&server->pubSubManager.encodingPool,
+                                   server->config.pubSubConfig.encodingThreads);
+        UA_CHECK_STATUS_WARN(retVal, server->pubSubManager.encodingPool = NULL,
+                             &server->config.logger, UA_LOGCATEGORY_SERVER,
+                             "Could not start the workers for the PubSub "
+                             "encoding. Continuing without.");
+    }
+#endif
+#endif
+
     /* Sample the start time and set it to the Server object */
     server->startTime = UA_DateTime_now();
     UA_Variant var;
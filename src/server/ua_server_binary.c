@@ -62,11 +62,12 @@ sendServiceFault(UA_SecureChannel *channel, UA_UInt32 requestId, UA_UInt32 reque
  /* This is not an ERR message, the connection is not closed afterwards */
 static UA_StatusCode
 decodeHeaderSendServiceFault(UA_SecureChannel *channel, const UA_ByteString *msg,
-                             size_t offset, const UA_DataType *responseType,
+                             size_t msgSegments, size_t offset,
+                             const UA_DataType *responseType,
                              UA_UInt32 requestId, UA_StatusCode error) {
     UA_RequestHeader requestHeader;
     UA_StatusCode retval =
-        UA_decodeBinaryInternal(msg, &offset, &requestHeader,
+        UA_decodeBinarySegments(msg, msgSegments, &offset, &requestHeader,
                                 &UA_TYPES[UA_TYPES_REQUESTHEADER], NULL);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
@@ -280,6 +281,98 @@ getServicePointers(UA_UInt32 requestTypeId, const UA_DataType **requestType,
     }
 }
 
+/* Map the response type to the latency statistics of the service group */
+static UA_ServiceLatencyStatistics *
+getServiceLatencyStatistics(UA_Server *server, const UA_DataType *responseType) {
+    UA_ServiceGroup group;
+    switch(responseType->binaryEncodingId.identifier.numeric) {
+    case UA_NS0ID_GETENDPOINTSRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_FINDSERVERSRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_FINDSERVERSONNETWORKRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_REGISTERSERVERRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_REGISTERSERVER2RESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_DISCOVERY;
+        break;
+    case UA_NS0ID_CREATESESSIONRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_ACTIVATESESSIONRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_CLOSESESSIONRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_SESSION;
+        break;
+    case UA_NS0ID_READRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_READ;
+        break;
+    case UA_NS0ID_WRITERESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_WRITE;
+        break;
+    case UA_NS0ID_BROWSERESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_BROWSENEXTRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_BROWSE;
+        break;
+    case UA_NS0ID_TRANSLATEBROWSEPATHSTONODEIDSRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_TRANSLATEBROWSEPATHS;
+        break;
+    case UA_NS0ID_REGISTERNODESRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_UNREGISTERNODESRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_REGISTERNODES;
+        break;
+    case UA_NS0ID_HISTORYREADRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_HISTORYREAD;
+        break;
+    case UA_NS0ID_HISTORYUPDATERESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_HISTORYUPDATE;
+        break;
+    case UA_NS0ID_CALLRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_CALL;
+        break;
+    case UA_NS0ID_CREATESUBSCRIPTIONRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_MODIFYSUBSCRIPTIONRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_SETPUBLISHINGMODERESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_DELETESUBSCRIPTIONSRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_TRANSFERSUBSCRIPTIONSRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_REPUBLISHRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_SUBSCRIPTION;
+        break;
+    case UA_NS0ID_CREATEMONITOREDITEMSRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_MODIFYMONITOREDITEMSRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_DELETEMONITOREDITEMSRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_SETMONITORINGMODERESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_SETTRIGGERINGRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_MONITOREDITEM;
+        break;
+    case UA_NS0ID_PUBLISHRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_PUBLISH;
+        break;
+    case UA_NS0ID_ADDNODESRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_ADDREFERENCESRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_DELETENODESRESPONSE_ENCODING_DEFAULTBINARY:
+    case UA_NS0ID_DELETEREFERENCESRESPONSE_ENCODING_DEFAULTBINARY:
+        group = UA_SERVICEGROUP_NODEMANAGEMENT;
+        break;
+    default:
+        return NULL;
+    }
+    return &server->serviceStats.services[group];
+}
+
+/* Take the service lock and record the time waiting for it. Returns the time
+ * when the service execution starts. */
+static UA_DateTime
+lockService(UA_Server *server, UA_ServiceLatencyStatistics *stats) {
+    UA_DateTime start = UA_DateTime_nowMonotonic();
+    UA_LOCK(&server->serviceMutex);
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    UA_LatencyHistogram_add(&stats->queueWait, now - start);
+    return now;
+}
+
+static void
+unlockService(UA_Server *server, UA_ServiceLatencyStatistics *stats,
+              UA_DateTime executionStart) {
+    UA_LatencyHistogram_add(&stats->execution,
+                            UA_DateTime_nowMonotonic() - executionStart);
+    UA_UNLOCK(&server->serviceMutex);
+}
+
 /*************************/
 /* Process Message Types */
 /*************************/
@@ -445,6 +538,7 @@ sendResponse(UA_Server *server, UA_Session *session, UA_SecureChannel *channel,
     }
 
     /* Start the message context */
+    UA_DateTime start = UA_DateTime_nowMonotonic();
     UA_MessageContext mc;
     UA_StatusCode retval = UA_MessageContext_begin(&mc, channel, requestId, UA_MESSAGETYPE_MSG);
     if(retval != UA_STATUSCODE_GOOD)
@@ -466,7 +560,106 @@ sendResponse(UA_Server *server, UA_Session *session, UA_SecureChannel *channel,
         return retval;
 
     /* Finish / send out */
-    return UA_MessageContext_finish(&mc);
+    retval = UA_MessageContext_finish(&mc);
+
+    /* Update the statistics. The encoding is interleaved with sending the
+     * chunks. */
+    UA_ServiceLatencyStatistics *stats =
+        getServiceLatencyStatistics(server, responseType);
+    if(stats) {
+        UA_DateTime total = UA_DateTime_nowMonotonic() - start;
+        UA_LatencyHistogram_add(&stats->encode, total - mc.sendDuration);
+        UA_LatencyHistogram_add(&stats->send, mc.sendDuration);
+    }
+    return retval;
+}
+
+UA_Boolean
+UA_ResponseStream_begin(UA_Server *server, UA_Session *session,
+                        const UA_DataType *resultType, size_t resultsSize) {
+    UA_ResponseStream *stream = session->responseStream;
+    if(!stream || stream->begun || stream->resultType != resultType ||
+       server->config.streamResponseThreshold == 0 ||
+       resultsSize < server->config.streamResponseThreshold ||
+       resultsSize > UA_INT32_MAX)
+        return false;
+
+    /* Start the message context */
+    stream->begun = true;
+    stream->resultsSize = resultsSize;
+    stream->status = UA_MessageContext_begin(&stream->mc, stream->channel,
+                                             stream->requestId, UA_MESSAGETYPE_MSG);
+    if(stream->status != UA_STATUSCODE_GOOD)
+        return true;
+
+    UA_LOG_DEBUG_SESSION(&server->config.logger, session,
+                         "Streaming the response for RequestId %u with %u results",
+                         (unsigned)stream->requestId, (unsigned)resultsSize);
+
+    /* Encode the response type, the ResponseHeader and the length of the
+     * results array */
+    UA_ResponseHeader rh = stream->response->responseHeader;
+    rh.timestamp = UA_DateTime_now();
+    rh.serviceResult = UA_STATUSCODE_GOOD;
+    UA_Int32 length = (UA_Int32)resultsSize;
+    stream->status =
+        UA_MessageContext_encode(&stream->mc, &stream->responseType->binaryEncodingId,
+                                 &UA_TYPES[UA_TYPES_NODEID]);
+    if(stream->status == UA_STATUSCODE_GOOD)
+        stream->status = UA_MessageContext_encode(&stream->mc, &rh,
+                                                  &UA_TYPES[UA_TYPES_RESPONSEHEADER]);
+    if(stream->status == UA_STATUSCODE_GOOD)
+        stream->status = UA_MessageContext_encode(&stream->mc, &length,
+                                                  &UA_TYPES[UA_TYPES_INT32]);
+    return true;
+}
+
+void
+UA_ResponseStream_encode(UA_ResponseStream *stream, const void *result) {
+    UA_assert(stream->begun);
+    UA_assert(stream->resultsEncoded < stream->resultsSize);
+    stream->resultsEncoded++;
+    if(stream->status != UA_STATUSCODE_GOOD)
+        return;
+    stream->status = UA_MessageContext_encode(&stream->mc, result, stream->resultType);
+}
+
+/* Encode the empty DiagnosticInfo array and send the final chunk. The chunks
+ * sent during the service execution count for the send statistics. */
+static UA_StatusCode
+finishResponseStream(UA_ResponseStream *stream, UA_ServiceLatencyStatistics *stats) {
+    if(stream->status != UA_STATUSCODE_GOOD)
+        return stream->status;
+    if(stream->resultsEncoded != stream->resultsSize) {
+        UA_MessageContext_abort(&stream->mc);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    UA_DateTime start = UA_DateTime_nowMonotonic();
+    UA_DateTime sendBefore = stream->mc.sendDuration;
+    UA_Int32 length = -1;
+    UA_StatusCode res = UA_MessageContext_encode(&stream->mc, &length,
+                                                 &UA_TYPES[UA_TYPES_INT32]);
+    UA_CHECK_STATUS(res, return res);
+    res = UA_MessageContext_finish(&stream->mc);
+    UA_DateTime total = UA_DateTime_nowMonotonic() - start;
+    UA_LatencyHistogram_add(&stats->encode,
+                            total - (stream->mc.sendDuration - sendBefore));
+    UA_LatencyHistogram_add(&stats->send, stream->mc.sendDuration);
+    return res;
+}
+
+/* Attach a response stream to the session for services that support it */
+static const UA_DataType *
+streamedResultType(const UA_DataType *requestType) {
+    if(requestType == &UA_TYPES[UA_TYPES_READREQUEST])
+        return &UA_TYPES[UA_TYPES_DATAVALUE];
+    if(requestType == &UA_TYPES[UA_TYPES_BROWSEREQUEST])
+        return &UA_TYPES[UA_TYPES_BROWSERESULT];
+#ifdef UA_ENABLE_HISTORIZING
+    if(requestType == &UA_TYPES[UA_TYPES_HISTORYREADREQUEST])
+        return &UA_TYPES[UA_TYPES_HISTORYREADRESULT];
+#endif
+    return NULL;
 }
 
 /* A Session is "bound" to a SecureChannel if it was created by the
@@ -505,8 +698,10 @@ static UA_StatusCode
 processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
                   UA_Service service, const UA_Request *request,
                   const UA_DataType *requestType, UA_Response *response,
-                  const UA_DataType *responseType, UA_Boolean sessionRequired) {
+                  const UA_DataType *responseType, UA_Boolean sessionRequired,
+                  UA_ServiceLatencyStatistics *stats) {
     const UA_RequestHeader *requestHeader = &request->requestHeader;
+    UA_DateTime executionStart;
 
     /* If it is an unencrypted (#None) channel, only allow the discovery services */
     if(server->config.securityPolicyNoneDiscoveryOnly &&
@@ -525,9 +720,9 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     if(requestType == &UA_TYPES[UA_TYPES_CREATESESSIONREQUEST] ||
        requestType == &UA_TYPES[UA_TYPES_ACTIVATESESSIONREQUEST] ||
        requestType == &UA_TYPES[UA_TYPES_CLOSESESSIONREQUEST]) {
-        UA_LOCK(&server->serviceMutex);
+        executionStart = lockService(server, stats);
         ((UA_ChannelService)service)(server, channel, request, response);
-        UA_UNLOCK(&server->serviceMutex);
+        unlockService(server, stats, executionStart);
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
         /* Store the authentication token so we can help fuzzing by setting
          * these values in the next request automatically */
@@ -603,9 +798,9 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* The publish request is not answered immediately */
     if(requestType == &UA_TYPES[UA_TYPES_PUBLISHREQUEST]) {
-        UA_LOCK(&server->serviceMutex);
+        executionStart = lockService(server, stats);
         Service_Publish(server, session, &request->publishRequest, requestId);
-        UA_UNLOCK(&server->serviceMutex);
+        unlockService(server, stats, executionStart);
         return UA_STATUSCODE_GOOD;
     }
 #endif
@@ -614,10 +809,10 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     /* The call request might not be answered immediately */
     if(requestType == &UA_TYPES[UA_TYPES_CALLREQUEST]) {
         UA_Boolean finished = true;
-        UA_LOCK(&server->serviceMutex);
+        executionStart = lockService(server, stats);
         Service_CallAsync(server, session, requestId, &request->callRequest,
                           &response->callResponse, &finished);
-        UA_UNLOCK(&server->serviceMutex);
+        unlockService(server, stats, executionStart);
 
         /* Async method calls remain. Don't send a response now */
         if(!finished)
@@ -628,22 +823,45 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     }
 #endif
 
+    /* Prepare streaming the response */
+    UA_ResponseStream stream;
+    memset(&stream, 0, sizeof(UA_ResponseStream));
+    stream.channel = channel;
+    stream.requestId = requestId;
+    stream.response = response;
+    stream.responseType = responseType;
+    stream.resultType = streamedResultType(requestType);
+
     /* Dispatch the synchronous service call and send the response */
-    UA_LOCK(&server->serviceMutex);
+    executionStart = lockService(server, stats);
+    if(stream.resultType)
+        session->responseStream = &stream;
     service(server, session, request, response);
+    session->responseStream = NULL;
+    UA_LatencyHistogram_add(&stats->execution, UA_DateTime_nowMonotonic() -
+                            executionStart - stream.mc.sendDuration);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(stream.begun)
+        retval = finishResponseStream(&stream, stats);
     UA_UNLOCK(&server->serviceMutex);
+    if(stream.begun)
+        return retval;
     return sendResponse(server, session, channel, requestId, response, responseType);
 }
 
 static UA_StatusCode
-processMSG(UA_Server *server, UA_SecureChannel *channel,
-           UA_UInt32 requestId, const UA_ByteString *msg) {
+processMSG(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
+           const UA_ByteString *msg, size_t msgSegments) {
     if(channel->state != UA_SECURECHANNELSTATE_OPEN)
         return UA_STATUSCODE_BADINTERNALERROR;
+    UA_DateTime decodeStart = UA_DateTime_nowMonotonic();
+
     /* Decode the nodeid */
     size_t offset = 0;
     UA_NodeId requestTypeId;
-    UA_StatusCode retval = UA_NodeId_decodeBinary(msg, &offset, &requestTypeId);
+    UA_StatusCode retval =
+        UA_decodeBinarySegments(msg, msgSegments, &offset, &requestTypeId,
+                                &UA_TYPES[UA_TYPES_NODEID], NULL);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
     if(requestTypeId.namespaceIndex != 0 ||
@@ -670,7 +888,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                                 "Unknown request with type identifier %" PRIi32,
                                 requestTypeId.identifier.numeric);
         }
-        return decodeHeaderSendServiceFault(channel, msg, requestPos,
+        return decodeHeaderSendServiceFault(channel, msg, msgSegments, requestPos,
                                             &UA_TYPES[UA_TYPES_SERVICEFAULT],
                                             requestId, UA_STATUSCODE_BADSERVICEUNSUPPORTED);
     }
@@ -678,16 +896,22 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
 
     /* Decode the request */
     UA_Request request;
-    retval = UA_decodeBinaryInternal(msg, &offset, &request,
+    retval = UA_decodeBinarySegments(msg, msgSegments, &offset, &request,
                                      requestType, server->config.customDataTypes);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_DEBUG_CHANNEL(&server->config.logger, channel,
                              "Could not decode the request with StatusCode %s",
                              UA_StatusCode_name(retval));
-        return decodeHeaderSendServiceFault(channel, msg, requestPos,
+        return decodeHeaderSendServiceFault(channel, msg, msgSegments, requestPos,
                                             responseType, requestId, retval);
     }
 
+    /* Update the statistics */
+    UA_ServiceLatencyStatistics *stats =
+        getServiceLatencyStatistics(server, responseType);
+    UA_assert(stats);
+    UA_LatencyHistogram_add(&stats->decode, UA_DateTime_nowMonotonic() - decodeStart);
+
     /* Check timestamp in the request header */
     UA_RequestHeader *requestHeader = &request.requestHeader;
     if(requestHeader->timestamp == 0) {
@@ -719,7 +943,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
     UA_init(&response, responseType);
     response.responseHeader.requestHandle = requestHeader->requestHandle;
     retval = processMSGDecoded(server, channel, requestId, service, &request, requestType,
-                               &response, responseType, sessionRequired);
+                               &response, responseType, sessionRequired, stats);
 
     /* Clean up */
     UA_clear(&request, requestType);
@@ -731,7 +955,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
 static UA_StatusCode
 processSecureChannelMessage(void *application, UA_SecureChannel *channel,
                             UA_MessageType messagetype, UA_UInt32 requestId,
-                            UA_ByteString *message) {
+                            UA_ByteString *message, size_t messageSegments) {
     UA_Server *server = (UA_Server*)application;
 
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
@@ -746,7 +970,7 @@ processSecureChannelMessage(void *application, UA_SecureChannel *channel,
         break;
     case UA_MESSAGETYPE_MSG:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a MSG");
-        retval = processMSG(server, channel, requestId, message);
+        retval = processMSG(server, channel, requestId, message, messageSegments);
         break;
     case UA_MESSAGETYPE_CLO:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a CLO");
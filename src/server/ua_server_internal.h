@@ -83,6 +83,23 @@ typedef enum {
     UA_SERVERLIFECYLE_RUNNING
 } UA_ServerLifecycle;
 
+/* Transitive closure of the HasSubtype hierarchy. The supertypes of a type
+ * node are computed with the first subtype check and then kept in a hash map
+ * until the hierarchy changes. */
+typedef struct UA_TypeHierarchyEntry {
+    struct UA_TypeHierarchyEntry *next; /* In the same bucket */
+    UA_UInt32 hash;
+    UA_NodeId typeId;
+    size_t supertypesSize;
+    UA_NodeId *supertypes; /* Direct and indirect supertypes, sorted */
+} UA_TypeHierarchyEntry;
+
+typedef struct {
+    UA_TypeHierarchyEntry **buckets;
+    size_t bucketsSize; /* Power of two */
+    size_t entriesSize;
+} UA_TypeHierarchy;
+
 struct UA_Server {
     /* Config */
     UA_ServerConfig config;
@@ -96,6 +113,7 @@ struct UA_Server {
     TAILQ_HEAD(, channel_entry) channels;
     UA_UInt32 lastChannelId;
     UA_UInt32 lastTokenId;
+    UA_ThreadPool *chunkCryptoPool; /* Shared by the SecureChannels */
 
 #if UA_MULTITHREADING >= 100
     UA_AsyncManager asyncManager;
@@ -116,6 +134,9 @@ struct UA_Server {
      * the parent and member instantiation */
     UA_Boolean bootstrapNS0;
 
+    /* Cached supertypes for the subtype checks */
+    UA_TypeHierarchy typeHierarchy;
+
     /* Discovery */
 #ifdef UA_ENABLE_DISCOVERY
     UA_DiscoveryManager discoveryManager;
@@ -152,6 +173,8 @@ struct UA_Server {
 
     /* Statistics */
     UA_ServerStatistics serverStats;
+    UA_ServiceStatistics serviceStats; /* The traffic of open channels is added
+                                        * when the statistics are read */
 };
 
 /***********************/
@@ -192,6 +215,10 @@ void
 UA_Server_closeSecureChannel(UA_Server *server, UA_SecureChannel *channel,
                              UA_DiagnosticEvent event);
 
+void
+addSecureChannelTraffic(UA_SecureChannelTraffic *sum,
+                        const UA_SecureChannelTraffic *traffic);
+
 /* Gets the a pointer to the context of a security policy supported by the
  * server matched by the security policy uri. */
 UA_SecurityPolicy *
@@ -266,6 +293,17 @@ UA_Boolean
 isNodeInTree_singleRef(UA_Server *server, const UA_NodeId *leafNode,
                        const UA_NodeId *nodeToFind, const UA_Byte relevantRefTypeIndex);
 
+/* Removes all cached supertypes */
+void
+UA_TypeHierarchy_clear(UA_TypeHierarchy *th);
+
+/* Called when a HasSubtype reference of the (sub)type is added or deleted and
+ * when the type node is removed. For a type without subtypes (e.g. a newly
+ * added type) only its own entry is removed. Otherwise all cached supertypes
+ * are dropped. */
+void
+UA_TypeHierarchy_invalidate(UA_Server *server, const UA_NodeId *typeId);
+
 /* Returns an array with the hierarchy of nodes. The start nodes can be returned
  * as well. The returned array starts at the leaf and continues "upwards" or
  * "downwards". Duplicate entries are removed. */
@@ -317,6 +355,44 @@ UA_StatusCode
 sendResponse(UA_Server *server, UA_Session *session, UA_SecureChannel *channel,
              UA_UInt32 requestId, UA_Response *response, const UA_DataType *responseType);
 
+/* Streamed Responses
+ * ------------------
+ * The Read, Browse and HistoryRead responses consist of the ResponseHeader,
+ * the results array and the (empty) DiagnosticInfo array. When the response
+ * is streamed, the results are encoded into the MessageContext one by one and
+ * freed. Full chunks are sent out right away. So the encoded response does not
+ * have to be built in memory first.
+ *
+ * The stream is attached to the session while the service is processed. The
+ * service begins the stream once all results are produced and the
+ * ServiceResult is known to be good. The operations can release the service
+ * mutex. No other message must be sent on the SecureChannel while the stream is
+ * open, so the stream is begun only after the last operation. If the stream is
+ * not begun, the response is sent the normal way afterwards. */
+struct UA_ResponseStream {
+    UA_SecureChannel *channel;
+    UA_UInt32 requestId;
+    const UA_Response *response; /* The ResponseHeader is taken from here */
+    const UA_DataType *responseType;
+    const UA_DataType *resultType;
+    size_t resultsSize;
+    size_t resultsEncoded;
+    UA_Boolean begun;
+    UA_StatusCode status; /* First encoding error. The message is aborted. */
+    UA_MessageContext mc;
+};
+
+/* Returns whether the stream was begun. Then all resultsSize results must be
+ * encoded with UA_ResponseStream_encode. */
+UA_Boolean
+UA_ResponseStream_begin(UA_Server *server, UA_Session *session,
+                        const UA_DataType *resultType, size_t resultsSize);
+
+/* Encode the next result. Errors are stored in the stream and returned when the
+ * stream is finished. */
+void
+UA_ResponseStream_encode(UA_ResponseStream *stream, const void *result);
+
 /* Many services come as an array of operations. This function generalizes the
  * processing of the operations. */
 typedef void (*UA_ServiceOperation)(UA_Server *server, UA_Session *session,
@@ -357,6 +433,12 @@ writeAttribute(UA_Server *server, UA_Session *session,
                const UA_NodeId *nodeId, const UA_AttributeId attributeId,
                const void *attr, const UA_DataType *attr_type);
 
+/* Write without taking the service lock. Used to write several values (e.g.
+ * the fields of a received DataSetMessage) under a single lock. */
+UA_StatusCode
+writeWithSession(UA_Server *server, UA_Session *session,
+                 const UA_WriteValue *value);
+
 static UA_INLINE UA_StatusCode
 writeValueAttribute(UA_Server *server, UA_Session *session,
                     const UA_NodeId *nodeId, const UA_Variant *value) {
@@ -640,6 +722,60 @@ UA_NODESTORE_GETFROMREF(UA_Server *server, UA_NodePointer target) {
     server->config.nodestore.getReferenceTypeId(server->config.nodestore.context, \
                                                 index)
 
+/***************/
+/* Value Cells */
+/***************/
+
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+
+/* A published DataValue is not edited anymore */
+typedef struct {
+    UA_DelayedCallback cleanup; /* Must be first. The EventLoop frees the entry
+                                 * after the cleanup callback. */
+    UA_DataValue value;
+} UA_ValueCellEntry;
+
+struct UA_ValueCell {
+    UA_ValueCellEntry * volatile current;
+    volatile size_t refCount; /* Nodes that share the cell */
+    volatile size_t version;  /* Incremented with every write */
+};
+
+void
+UA_ValueCellEntry_delete(UA_ValueCellEntry *entry);
+
+/* The cell is freed with the last node that references it */
+void
+UA_ValueCell_release(UA_ValueCell *cell);
+
+/* Publish the entry as the new value of the node. The first write creates the
+ * cell. This has to happen on an editable copy of the node. Later writes swap
+ * the entry in the cell. The previous entry is freed in a delayed callback, as
+ * it can still be used by a reader outside of the service lock. */
+UA_StatusCode
+UA_VariableNode_publishValue(UA_Server *server, UA_VariableNode *node,
+                             UA_ValueCellEntry *entry);
+
+/* Let the editable copy of a node use the value cell of the original. Then
+ * values written while the copy is edited are not lost when it replaces the
+ * original. */
+void
+UA_VariableNode_shareValueCell(const UA_Node *orig, UA_Node *copy);
+
+#endif
+
+/* The current value of a VariableNode with a "data" value source */
+static UA_INLINE const UA_DataValue *
+getNodeDataValue(const UA_VariableNode *node) {
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+    if(node->value.data.cell) {
+        UA_atomic_sync();
+        return &node->value.data.cell->current->value;
+    }
+#endif
+    return &node->value.data.value;
+}
+
 _UA_END_DECLS
 
 #endif /* UA_SERVER_INTERNAL_H_ */
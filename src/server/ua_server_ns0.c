@@ -559,6 +559,187 @@ readMinSamplingInterval(UA_Server *server, const UA_NodeId *sessionId, void *ses
 }
 #endif
 
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+
+/* Service statistics. The latency histograms are exposed as UInt64 arrays with
+ * the sample count, the sum of the latencies in microseconds and the
+ * logarithmic buckets. The services have a row for every processing stage. */
+
+#define UA_HISTOGRAM_VALUES (2 + UA_LATENCYHISTOGRAM_BUCKETS)
+#define UA_SERVICESTAGES \
+    (sizeof(UA_ServiceLatencyStatistics) / sizeof(UA_LatencyHistogram))
+
+static const char *serviceGroupNames[UA_SERVICEGROUP_COUNT] = {
+    "Discovery", "Session", "Read", "Write", "Browse", "TranslateBrowsePaths",
+    "RegisterNodes", "HistoryRead", "HistoryUpdate", "Call", "Subscription",
+    "MonitoredItem", "Publish", "NodeManagement"};
+
+static UA_StatusCode
+setStatisticsValue(UA_DataValue *value, UA_UInt64 *v, size_t rows, size_t columns,
+                   UA_Boolean includeSourceTimeStamp) {
+    UA_Variant_setArray(&value->value, v, rows * columns, &UA_TYPES[UA_TYPES_UINT64]);
+    if(rows > 1) {
+        value->value.arrayDimensions = (UA_UInt32*)
+            UA_Array_new(2, &UA_TYPES[UA_TYPES_UINT32]);
+        if(!value->value.arrayDimensions) {
+            UA_Variant_clear(&value->value);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        value->value.arrayDimensionsSize = 2;
+        value->value.arrayDimensions[0] = (UA_UInt32)rows;
+        value->value.arrayDimensions[1] = (UA_UInt32)columns;
+    }
+    value->hasValue = true;
+    if(includeSourceTimeStamp) {
+        value->hasSourceTimestamp = true;
+        value->sourceTimestamp = UA_DateTime_now();
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The context points to an array of histograms */
+static UA_StatusCode
+readLatencyHistograms(UA_DataValue *value, const UA_LatencyHistogram *h,
+                      size_t rows, const UA_NumericRange *range,
+                      UA_Boolean includeSourceTimeStamp) {
+    if(range) {
+        value->hasStatus = true;
+        value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+        return UA_STATUSCODE_GOOD;
+    }
+    UA_UInt64 *v = (UA_UInt64*)
+        UA_Array_new(rows * UA_HISTOGRAM_VALUES, &UA_TYPES[UA_TYPES_UINT64]);
+    if(!v)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_UInt64 *pos = v;
+    for(size_t i = 0; i < rows; i++) {
+        *pos++ = h[i].count;
+        *pos++ = h[i].sum;
+        for(size_t j = 0; j < UA_LATENCYHISTOGRAM_BUCKETS; j++)
+            *pos++ = h[i].buckets[j];
+    }
+    return setStatisticsValue(value, v, rows, UA_HISTOGRAM_VALUES,
+                              includeSourceTimeStamp);
+}
+
+static UA_StatusCode
+readServiceLatency(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                   const UA_NodeId *nodeid, void *nodeContext,
+                   UA_Boolean includeSourceTimeStamp, const UA_NumericRange *range,
+                   UA_DataValue *value) {
+    const UA_ServiceLatencyStatistics *stats =
+        (const UA_ServiceLatencyStatistics*)nodeContext;
+    return readLatencyHistograms(value, &stats->decode, UA_SERVICESTAGES,
+                                 range, includeSourceTimeStamp);
+}
+
+static UA_StatusCode
+readLatency(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+            const UA_NodeId *nodeid, void *nodeContext,
+            UA_Boolean includeSourceTimeStamp, const UA_NumericRange *range,
+            UA_DataValue *value) {
+    return readLatencyHistograms(value, (const UA_LatencyHistogram*)nodeContext,
+                                 1, range, includeSourceTimeStamp);
+}
+
+static UA_StatusCode
+readTraffic(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+            const UA_NodeId *nodeid, void *nodeContext,
+            UA_Boolean includeSourceTimeStamp, const UA_NumericRange *range,
+            UA_DataValue *value) {
+    if(range) {
+        value->hasStatus = true;
+        value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+        return UA_STATUSCODE_GOOD;
+    }
+    UA_LOCK(&server->serviceMutex);
+    UA_SecureChannelTraffic t = server->serviceStats.traffic;
+    channel_entry *entry;
+    TAILQ_FOREACH(entry, &server->channels, pointers)
+        addSecureChannelTraffic(&t, &entry->channel.traffic);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_UInt64 *v = (UA_UInt64*)UA_Array_new(6, &UA_TYPES[UA_TYPES_UINT64]);
+    if(!v)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    v[0] = t.bytesSent;
+    v[1] = t.bytesReceived;
+    v[2] = t.chunksSent;
+    v[3] = t.chunksReceived;
+    v[4] = t.messagesSent;
+    v[5] = t.messagesReceived;
+    return setStatisticsValue(value, v, 1, 6, includeSourceTimeStamp);
+}
+
+static UA_StatusCode
+addStatisticsVariable(UA_Server *server, const char *name, const char *description,
+                      UA_UInt32 rows, UA_UInt32 columns,
+                      UA_DataSource dataSource, void *context) {
+    char id[64];
+    UA_snprintf(id, sizeof(id), "ServiceStatistics.%s", name);
+    UA_UInt32 dims[2] = {rows, columns};
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("", (char*)(uintptr_t)name);
+    attr.description = UA_LOCALIZEDTEXT("", (char*)(uintptr_t)description);
+    attr.dataType = UA_TYPES[UA_TYPES_UINT64].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    if(rows > 1) {
+        attr.valueRank = UA_VALUERANK_TWO_DIMENSIONS;
+        attr.arrayDimensions = dims;
+        attr.arrayDimensionsSize = 2;
+    } else {
+        attr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+        attr.arrayDimensions = &dims[1];
+        attr.arrayDimensionsSize = 1;
+    }
+    return UA_Server_addDataSourceVariableNode(server, UA_NODEID_STRING(1, id),
+                UA_NODEID_STRING(1, "ServiceStatistics"),
+                UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                attr, dataSource, context, NULL);
+}
+
+static UA_StatusCode
+addServiceStatistics(UA_Server *server) {
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    oattr.displayName = UA_LOCALIZEDTEXT("", "ServiceStatistics");
+    UA_StatusCode retVal =
+        UA_Server_addObjectNode(server, UA_NODEID_STRING(1, "ServiceStatistics"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERDIAGNOSTICS),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                UA_QUALIFIEDNAME(1, "ServiceStatistics"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                oattr, NULL, NULL);
+    if(retVal != UA_STATUSCODE_GOOD)
+        return retVal;
+
+    UA_DataSource serviceLatency = {readServiceLatency, NULL};
+    for(size_t i = 0; i < UA_SERVICEGROUP_COUNT; i++)
+        retVal |= addStatisticsVariable(server, serviceGroupNames[i],
+                      "Latency histograms (count, sum in us, buckets) of the decode, "
+                      "queue wait, execution, encode and send stages",
+                      (UA_UInt32)UA_SERVICESTAGES, UA_HISTOGRAM_VALUES,
+                      serviceLatency, &server->serviceStats.services[i]);
+
+    UA_DataSource latency = {readLatency, NULL};
+    retVal |= addStatisticsVariable(server, "ChunkCrypto",
+                  "Latency histogram (count, sum in us, buckets) of the "
+                  "crypto operations per chunk", 1, UA_HISTOGRAM_VALUES,
+                  latency, &server->serviceStats.chunkCrypto);
+    retVal |= addStatisticsVariable(server, "PublishCycle",
+                  "Latency histogram (count, sum in us, buckets) of the "
+                  "subscription publish cycles", 1, UA_HISTOGRAM_VALUES,
+                  latency, &server->serviceStats.publish);
+
+    UA_DataSource traffic = {readTraffic, NULL};
+    retVal |= addStatisticsVariable(server, "Traffic",
+                  "Bytes sent/received, chunks sent/received and messages "
+                  "sent/received over all SecureChannels", 1, 6, traffic, NULL);
+    return retVal;
+}
+
+#endif
+
 #if defined(UA_GENERATED_NAMESPACE_ZERO) && defined(UA_ENABLE_METHODCALLS) && defined(UA_ENABLE_SUBSCRIPTIONS)
 static UA_StatusCode
 readMonitoredItems(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
@@ -919,6 +1100,9 @@ UA_Server_initNS0(UA_Server *server) {
     retVal |= UA_Server_writeAccessLevel(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERDIAGNOSTICS_ENABLEDFLAG),
                                          UA_ACCESSLEVELMASK_READ);
 
+    /* ServerDiagnostics - ServiceStatistics */
+    retVal |= addServiceStatistics(server);
+
     /* Auditing */
     UA_DataSource auditing = {readAuditing, NULL};
     retVal |= UA_Server_setVariableNode_dataSource(server,
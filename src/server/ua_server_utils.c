@@ -291,6 +291,13 @@ UA_Server_editNode(UA_Server *server, UA_Session *session,
         if(retval != UA_STATUSCODE_GOOD)
             return retval;
 
+        /* Keep the value cell of the original */
+        const UA_Node *orig = UA_NODESTORE_GET(server, nodeId);
+        if(orig) {
+            UA_VariableNode_shareValueCell(orig, node);
+            UA_NODESTORE_RELEASE(server, orig);
+        }
+
         /* Run the operation on the copy */
         retval = callback(server, session, node, data);
         if(retval != UA_STATUSCODE_GOOD) {
@@ -331,6 +338,21 @@ UA_Server_processServiceOperations(UA_Server *server, UA_Session *session,
         reqOp += requestOperationsType->memSize;
         respOp += responseOperationsType->memSize;
     }
+
+    /* Stream the results. The operations can release the service mutex (e.g.
+     * for DataSources and AccessControl). So all operations are processed
+     * before the stream is opened on the SecureChannel. */
+    if(!UA_ResponseStream_begin(server, session, responseOperationsType, ops))
+        return UA_STATUSCODE_GOOD;
+    respOp = (uintptr_t)*respPos;
+    for(size_t i = 0; i < ops; i++) {
+        UA_ResponseStream_encode(session->responseStream, (void*)respOp);
+        UA_clear((void*)respOp, responseOperationsType);
+        respOp += responseOperationsType->memSize;
+    }
+    UA_Array_delete(*respPos, ops, responseOperationsType);
+    *respPos = NULL;
+    *responseOperations = 0;
     return UA_STATUSCODE_GOOD;
 }
 
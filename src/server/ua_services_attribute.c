@@ -163,7 +163,7 @@ readValueAttributeFromNode(UA_Server *server, UA_Session *session,
                                        session ? &session->sessionId : NULL,
                                        session ? session->sessionHandle : NULL,
                                        &vn->head.nodeId, vn->head.context, rangeptr,
-                                       &vn->value.data.value);
+                                       getNodeDataValue(vn));
         UA_LOCK(&server->serviceMutex);
         vn = (const UA_VariableNode*)
             UA_NODESTORE_GET_SELECTIVE(server, &vn->head.nodeId,
@@ -176,8 +176,8 @@ readValueAttributeFromNode(UA_Server *server, UA_Session *session,
 
     /* Set the result */
     if(rangeptr)
-        return UA_Variant_copyRange(&vn->value.data.value.value, &v->value, *rangeptr);
-    UA_StatusCode retval = UA_DataValue_copy(&vn->value.data.value, v);
+        return UA_Variant_copyRange(&getNodeDataValue(vn)->value, &v->value, *rangeptr);
+    UA_StatusCode retval = UA_DataValue_copy(getNodeDataValue(vn), v);
 
     /* Clean up */
     if(vn->value.data.callback.onRead)
@@ -1249,7 +1249,20 @@ writeDataTypeAttribute(UA_Server *server, UA_Session *session,
 }
 
 static UA_StatusCode
-writeValueAttributeWithoutRange(UA_VariableNode *node, const UA_DataValue *value) {
+writeValueAttributeWithoutRange(UA_Server *server, UA_VariableNode *node,
+                                const UA_DataValue *value) {
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+    UA_ValueCellEntry *entry = (UA_ValueCellEntry*)
+        UA_calloc(1, sizeof(UA_ValueCellEntry));
+    if(!entry)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode retval = UA_DataValue_copy(value, &entry->value);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_free(entry);
+        return retval;
+    }
+    return UA_VariableNode_publishValue(server, node, entry);
+#else
     UA_DataValue new_value;
     UA_StatusCode retval = UA_DataValue_copy(value, &new_value);
     if(retval != UA_STATUSCODE_GOOD)
@@ -1257,14 +1270,17 @@ writeValueAttributeWithoutRange(UA_VariableNode *node, const UA_DataValue *value
     UA_DataValue_clear(&node->value.data.value);
     node->value.data.value = new_value;
     return UA_STATUSCODE_GOOD;
+#endif
 }
 
 static UA_StatusCode
-writeValueAttributeWithRange(UA_VariableNode *node, const UA_DataValue *value,
+writeValueAttributeWithRange(UA_Server *server, UA_VariableNode *node,
+                             const UA_DataValue *value,
                              const UA_NumericRange *rangeptr) {
     /* Value on both sides? */
-    if(value->status != node->value.data.value.status ||
-       !value->hasValue || !node->value.data.value.hasValue)
+    const UA_DataValue *current = getNodeDataValue(node);
+    if(value->status != current->status ||
+       !value->hasValue || !current->hasValue)
         return UA_STATUSCODE_BADINDEXRANGEINVALID;
 
     /* Make scalar a one-entry array for range matching */
@@ -1277,26 +1293,49 @@ writeValueAttributeWithRange(UA_VariableNode *node, const UA_DataValue *value,
     }
 
     /* Check that the type is an exact match and not only "compatible" */
-    if(!node->value.data.value.value.type || !v->type ||
-       !UA_NodeId_equal(&node->value.data.value.value.type->typeId,
+    if(!current->value.type || !v->type ||
+       !UA_NodeId_equal(&current->value.type->typeId,
                         &v->type->typeId))
         return UA_STATUSCODE_BADTYPEMISMATCH;
 
-    /* Write the value */
-    UA_StatusCode retval =
-        UA_Variant_setRangeCopy(&node->value.data.value.value,
-                                v->data, v->arrayLength, *rangeptr);
-    if(retval != UA_STATUSCODE_GOOD)
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+    /* Edit a copy of the current value */
+    UA_ValueCellEntry *entry = (UA_ValueCellEntry*)
+        UA_calloc(1, sizeof(UA_ValueCellEntry));
+    if(!entry)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode retval = UA_DataValue_copy(current, &entry->value);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_free(entry);
         return retval;
+    }
+    UA_DataValue *target = &entry->value;
+#else
+    UA_DataValue *target = &node->value.data.value;
+#endif
+
+    /* Write the value */
+    UA_StatusCode res =
+        UA_Variant_setRangeCopy(&target->value, v->data, v->arrayLength, *rangeptr);
+    if(res != UA_STATUSCODE_GOOD) {
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+        UA_ValueCellEntry_delete(entry);
+#endif
+        return res;
+    }
 
     /* Write the status and timestamps */
-    node->value.data.value.hasStatus = value->hasStatus;
-    node->value.data.value.status = value->status;
-    node->value.data.value.hasSourceTimestamp = value->hasSourceTimestamp;
-    node->value.data.value.sourceTimestamp = value->sourceTimestamp;
-    node->value.data.value.hasSourcePicoseconds = value->hasSourcePicoseconds;
-    node->value.data.value.sourcePicoseconds = value->sourcePicoseconds;
+    target->hasStatus = value->hasStatus;
+    target->status = value->status;
+    target->hasSourceTimestamp = value->hasSourceTimestamp;
+    target->sourceTimestamp = value->sourceTimestamp;
+    target->hasSourcePicoseconds = value->hasSourcePicoseconds;
+    target->sourcePicoseconds = value->sourcePicoseconds;
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+    return UA_VariableNode_publishValue(server, node, entry);
+#else
     return UA_STATUSCODE_GOOD;
+#endif
 }
 
 /* Stack layout: ... | node */
@@ -1362,9 +1401,10 @@ writeNodeValueAttribute(UA_Server *server, UA_Session *session,
             /* Ok, do it */
             if(node->valueSource == UA_VALUESOURCE_DATA) {
                 if(!rangeptr)
-                    retval = writeValueAttributeWithoutRange(node, &adjustedValue);
+                    retval = writeValueAttributeWithoutRange(server, node, &adjustedValue);
                 else
-                    retval = writeValueAttributeWithRange(node, &adjustedValue, rangeptr);
+                    retval = writeValueAttributeWithRange(server, node, &adjustedValue,
+                                                          rangeptr);
 
 #ifdef UA_ENABLE_HISTORIZING
                 /* node is a UA_VariableNode*, but it may also point to a
@@ -1694,6 +1734,12 @@ copyAttributeIntoNode(UA_Server *server, UA_Session *session,
     /* Trigger MonitoredItems with no SamplingInterval */
     triggerImmediateDataChange(server, session, node, wvalue);
 
+#if defined(UA_ENABLE_PUBSUB) && defined(UA_ENABLE_PUBSUB_DELTAFRAMES)
+    /* Mark the published variable for the next delta frame */
+    if(wvalue->attributeId == UA_ATTRIBUTEID_VALUE)
+        UA_PubSubManager_markValueChanged(server, &node->head.nodeId);
+#endif
+
     return UA_STATUSCODE_GOOD;
 }
 
@@ -1701,6 +1747,29 @@ static void
 Operation_Write(UA_Server *server, UA_Session *session, void *context,
                 const UA_WriteValue *wv, UA_StatusCode *result) {
     UA_assert(session != NULL);
+
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+    /* Writing the value of a node with a value cell only swaps the value in
+     * the cell. The node is not copied and replaced. */
+    if(wv->attributeId == UA_ATTRIBUTEID_VALUE) {
+        const UA_Node *node = UA_NODESTORE_GET(server, &wv->nodeId);
+        if(!node) {
+            *result = UA_STATUSCODE_BADNODEIDUNKNOWN;
+            return;
+        }
+        if((node->head.nodeClass == UA_NODECLASS_VARIABLE ||
+            node->head.nodeClass == UA_NODECLASS_VARIABLETYPE) &&
+           node->variableNode.valueSource == UA_VALUESOURCE_DATA &&
+           node->variableNode.value.data.cell) {
+            *result = copyAttributeIntoNode(server, session,
+                                            (UA_Node*)(uintptr_t)node, wv);
+            UA_NODESTORE_RELEASE(server, node);
+            return;
+        }
+        UA_NODESTORE_RELEASE(server, node);
+    }
+#endif
+
     *result = UA_Server_editNode(server, session, &wv->nodeId,
                                  (UA_EditNodeCallback)copyAttributeIntoNode,
                                  (void*)(uintptr_t)wv);
@@ -1741,6 +1810,15 @@ UA_Server_write(UA_Server *server, const UA_WriteValue *value) {
     return res;
 }
 
+UA_StatusCode
+writeWithSession(UA_Server *server, UA_Session *session,
+                 const UA_WriteValue *value) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    Operation_Write(server, session, NULL, value, &res);
+    return res;
+}
+
 /* Convenience function to be wrapped into inline functions */
 UA_StatusCode
 __UA_Server_write(UA_Server *server, const UA_NodeId *nodeId,
@@ -1807,6 +1885,7 @@ Service_HistoryRead(UA_Server *server, UA_Session *session,
 
     const UA_DataType *historyDataType = &UA_TYPES[UA_TYPES_HISTORYDATA];
     UA_HistoryDatabase_readFunc readHistory = NULL;
+    const UA_ReadProcessedDetails *processedDetails = NULL;
     if(request->historyReadDetails.content.decoded.type ==
        &UA_TYPES[UA_TYPES_READRAWMODIFIEDDETAILS]) {
         UA_ReadRawModifiedDetails *details = (UA_ReadRawModifiedDetails*)
@@ -1826,6 +1905,12 @@ Service_HistoryRead(UA_Server *server, UA_Session *session,
             server->config.historyDatabase.readEvent;
     } else if(request->historyReadDetails.content.decoded.type ==
               &UA_TYPES[UA_TYPES_READPROCESSEDDETAILS]) {
+        processedDetails = (const UA_ReadProcessedDetails*)
+            request->historyReadDetails.content.decoded.data;
+        if(processedDetails->aggregateTypeSize != request->nodesToReadSize) {
+            response->responseHeader.serviceResult = UA_STATUSCODE_BADAGGREGATELISTMISMATCH;
+            return;
+        }
         readHistory = (UA_HistoryDatabase_readFunc)
             server->config.historyDatabase.readProcessed;
     } else if(request->historyReadDetails.content.decoded.type ==
@@ -1887,6 +1972,23 @@ Service_HistoryRead(UA_Server *server, UA_Session *session,
                 response, historyData);
     UA_LOCK(&server->serviceMutex);
     UA_free(historyData);
+
+    /* Stream the results for many nodes. The history is read completely
+     * before. The service mutex is released while the backend runs and no
+     * other response must be sent on the SecureChannel while the stream is
+     * open. */
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD ||
+       !UA_ResponseStream_begin(server, session, &UA_TYPES[UA_TYPES_HISTORYREADRESULT],
+                                response->resultsSize))
+        return;
+    for(size_t i = 0; i < response->resultsSize; ++i) {
+        UA_ResponseStream_encode(session->responseStream, &response->results[i]);
+        UA_HistoryReadResult_clear(&response->results[i]);
+    }
+    UA_Array_delete(response->results, response->resultsSize,
+                    &UA_TYPES[UA_TYPES_HISTORYREADRESULT]);
+    response->results = NULL;
+    response->resultsSize = 0;
 }
 
 void
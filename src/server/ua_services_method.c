@@ -58,15 +58,16 @@ typeCheckArguments(UA_Server *server, UA_Session *session,
      * the "InputArguments" node */
     if(argRequirements->valueSource != UA_VALUESOURCE_DATA)
         return UA_STATUSCODE_BADINTERNALERROR;
-    if(!argRequirements->value.data.value.hasValue)
+    const UA_DataValue *argValue = getNodeDataValue(argRequirements);
+    if(!argValue->hasValue)
         return UA_STATUSCODE_BADINTERNALERROR;
-    if(argRequirements->value.data.value.value.type != &UA_TYPES[UA_TYPES_ARGUMENT])
+    if(argValue->value.type != &UA_TYPES[UA_TYPES_ARGUMENT])
         return UA_STATUSCODE_BADINTERNALERROR;
 
     /* Verify the number of arguments. A scalar argument value is interpreted as
      * an array of length 1. */
-    size_t argReqsSize = argRequirements->value.data.value.value.arrayLength;
-    if(UA_Variant_isScalar(&argRequirements->value.data.value.value))
+    size_t argReqsSize = argValue->value.arrayLength;
+    if(UA_Variant_isScalar(&argValue->value))
         argReqsSize = 1;
     if(argReqsSize > argsSize)
         return UA_STATUSCODE_BADARGUMENTSMISSING;
@@ -75,7 +76,7 @@ typeCheckArguments(UA_Server *server, UA_Session *session,
 
     /* Type-check every argument against the definition */
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
-    UA_Argument *argReqs = (UA_Argument*)argRequirements->value.data.value.value.data;
+    UA_Argument *argReqs = (UA_Argument*)argValue->value.data;
     for(size_t i = 0; i < argReqsSize; ++i) {
         if(compatibleValue(server, session, &argReqs[i].dataType, argReqs[i].valueRank,
                             argReqs[i].arrayDimensionsSize, argReqs[i].arrayDimensions,
@@ -302,7 +303,7 @@ callWithMethodAndObject(UA_Server *server, UA_Session *session,
     /* Allocate the output arguments array */
     size_t outputArgsSize = 0;
     if(outputArguments)
-        outputArgsSize = outputArguments->value.data.value.value.arrayLength;
+        outputArgsSize = getNodeDataValue(outputArguments)->value.arrayLength;
     result->outputArguments = (UA_Variant*)
         UA_Array_new(outputArgsSize, &UA_TYPES[UA_TYPES_VARIANT]);
     if(!result->outputArguments) {
@@ -1836,6 +1836,10 @@ deleteNodeSet(UA_Server *server, UA_Session *session,
         UA_NODESTORE_RELEASE(server, member);
         if(removeTargetRefs)
             removeIncomingReferences(server, session, &member->head);
+        /* The removed type can be cached as a supertype */
+        if(member->head.nodeClass & (UA_NODECLASS_OBJECTTYPE | UA_NODECLASS_VARIABLETYPE |
+                                     UA_NODECLASS_REFERENCETYPE | UA_NODECLASS_DATATYPE))
+            UA_TypeHierarchy_invalidate(server, &member->head.nodeId);
         UA_NODESTORE_REMOVE(server, &member->head.nodeId);
     }
 }
@@ -1971,6 +1975,9 @@ struct AddNodeInfo {
 static UA_StatusCode
 addOneWayReference(UA_Server *server, UA_Session *session, UA_Node *node,
                    const struct AddNodeInfo *info) {
+    if(info->refTypeIndex == UA_REFERENCETYPEINDEX_HASSUBTYPE)
+        UA_TypeHierarchy_invalidate(server, (info->isForward) ?
+                                    &info->targetNodeId->nodeId : &node->head.nodeId);
     return UA_Node_addReference(node, info->refTypeIndex, info->isForward,
                                 info->targetNodeId, info->targetBrowseNameHash);
 }
@@ -1987,6 +1994,9 @@ deleteOneWayReference(UA_Server *server, UA_Session *session, UA_Node *node,
     }
     UA_Byte refTypeIndex = refType->referenceTypeNode.referenceTypeIndex;
     UA_NODESTORE_RELEASE(server, refType);
+    if(refTypeIndex == UA_REFERENCETYPEINDEX_HASSUBTYPE)
+        UA_TypeHierarchy_invalidate(server, (item->isForward) ?
+                                    &item->targetNodeId.nodeId : &node->head.nodeId);
     return UA_Node_deleteReference(node, refTypeIndex, item->isForward, &item->targetNodeId);
 }
 
@@ -2319,8 +2329,14 @@ setDataSource(UA_Server *server, UA_Session *session,
               UA_VariableNode *node, const UA_DataSource *dataSource) {
     if(node->head.nodeClass != UA_NODECLASS_VARIABLE)
         return UA_STATUSCODE_BADNODECLASSINVALID;
-    if(node->valueSource == UA_VALUESOURCE_DATA)
+    if(node->valueSource == UA_VALUESOURCE_DATA) {
         UA_DataValue_clear(&node->value.data.value);
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+        if(node->value.data.cell)
+            UA_ValueCell_release(node->value.data.cell);
+        node->value.data.cell = NULL;
+#endif
+    }
     node->value.dataSource = *dataSource;
     node->valueSource = UA_VALUESOURCE_DATASOURCE;
     return UA_STATUSCODE_GOOD;
@@ -17,6 +17,17 @@
     (type *)((uintptr_t)ptr - offsetof(type,member))
 #endif
 
+void
+addSecureChannelTraffic(UA_SecureChannelTraffic *sum,
+                        const UA_SecureChannelTraffic *traffic) {
+    sum->bytesSent += traffic->bytesSent;
+    sum->bytesReceived += traffic->bytesReceived;
+    sum->chunksSent += traffic->chunksSent;
+    sum->chunksReceived += traffic->chunksReceived;
+    sum->messagesSent += traffic->messagesSent;
+    sum->messagesReceived += traffic->messagesReceived;
+}
+
 static void
 removeSecureChannelCallback(void *_, channel_entry *entry) {
     UA_SecureChannel_close(&entry->channel);
@@ -43,6 +54,7 @@ removeSecureChannel(UA_Server *server, channel_entry *entry,
     TAILQ_REMOVE(&server->channels, entry, pointers);
 
     /* Update the statistics */
+    addSecureChannelTraffic(&server->serviceStats.traffic, &entry->channel.traffic);
     UA_SecureChannelStatistics *scs = &server->serverStats.scs;
     UA_atomic_subSize(&scs->currentChannelCount, 1);
     switch(event) {
@@ -172,6 +184,8 @@ UA_Server_createSecureChannel(UA_Server *server, UA_Connection *connection) {
     UA_SecureChannel_init(&entry->channel, &server->config.networkLayers[0].localConnectionConfig);
     entry->channel.certificateVerification = &server->config.certificateVerification;
     entry->channel.processOPNHeader = UA_Server_configSecureChannel;
+    entry->channel.cryptoPool = server->chunkCryptoPool;
+    entry->channel.cryptoStatistics = &server->serviceStats.chunkCrypto;
 
     TAILQ_INSERT_TAIL(&server->channels, entry, pointers);
     UA_Connection_attachSecureChannel(connection, &entry->channel);
@@ -78,6 +78,246 @@ matchClassMask(const UA_Node *node, UA_UInt32 nodeClassMask) {
     return true;
 }
 
+/******************/
+/* Type Hierarchy */
+/******************/
+
+#define UA_TYPEHIERARCHY_MINBUCKETS 64
+
+#define UA_NODECLASS_TYPES                                              \
+    (UA_NODECLASS_OBJECTTYPE | UA_NODECLASS_VARIABLETYPE |              \
+     UA_NODECLASS_REFERENCETYPE | UA_NODECLASS_DATATYPE)
+
+static void
+UA_TypeHierarchyEntry_delete(UA_TypeHierarchyEntry *entry) {
+    UA_NodeId_clear(&entry->typeId);
+    UA_Array_delete(entry->supertypes, entry->supertypesSize,
+                    &UA_TYPES[UA_TYPES_NODEID]);
+    UA_free(entry);
+}
+
+void
+UA_TypeHierarchy_clear(UA_TypeHierarchy *th) {
+    for(size_t i = 0; i < th->bucketsSize; i++) {
+        UA_TypeHierarchyEntry *entry = th->buckets[i], *next;
+        for(; entry; entry = next) {
+            next = entry->next;
+            UA_TypeHierarchyEntry_delete(entry);
+        }
+    }
+    UA_free(th->buckets);
+    memset(th, 0, sizeof(UA_TypeHierarchy));
+}
+
+static UA_TypeHierarchyEntry *
+findTypeHierarchyEntry(const UA_TypeHierarchy *th, const UA_NodeId *typeId,
+                       UA_UInt32 hash) {
+    if(th->bucketsSize == 0)
+        return NULL;
+    UA_TypeHierarchyEntry *entry = th->buckets[hash & (th->bucketsSize - 1)];
+    for(; entry; entry = entry->next) {
+        if(entry->hash == hash && UA_NodeId_equal(&entry->typeId, typeId))
+            return entry;
+    }
+    return NULL;
+}
+
+static UA_StatusCode
+insertTypeHierarchyEntry(UA_TypeHierarchy *th, UA_TypeHierarchyEntry *entry) {
+    /* Grow the buckets to keep the chains short */
+    if(th->entriesSize >= th->bucketsSize) {
+        size_t newSize = (th->bucketsSize > 0) ?
+            th->bucketsSize * 2 : UA_TYPEHIERARCHY_MINBUCKETS;
+        UA_TypeHierarchyEntry **buckets = (UA_TypeHierarchyEntry**)
+            UA_calloc(newSize, sizeof(UA_TypeHierarchyEntry*));
+        if(!buckets)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        for(size_t i = 0; i < th->bucketsSize; i++) {
+            UA_TypeHierarchyEntry *e = th->buckets[i], *next;
+            for(; e; e = next) {
+                next = e->next;
+                size_t b = e->hash & (newSize - 1);
+                e->next = buckets[b];
+                buckets[b] = e;
+            }
+        }
+        UA_free(th->buckets);
+        th->buckets = buckets;
+        th->bucketsSize = newSize;
+    }
+
+    size_t b = entry->hash & (th->bucketsSize - 1);
+    entry->next = th->buckets[b];
+    th->buckets[b] = entry;
+    th->entriesSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+removeTypeHierarchyEntry(UA_TypeHierarchy *th, const UA_NodeId *typeId) {
+    if(th->bucketsSize == 0)
+        return;
+    UA_UInt32 hash = UA_NodeId_hash(typeId);
+    UA_TypeHierarchyEntry **prev = &th->buckets[hash & (th->bucketsSize - 1)];
+    for(; *prev; prev = &(*prev)->next) {
+        UA_TypeHierarchyEntry *entry = *prev;
+        if(entry->hash != hash || !UA_NodeId_equal(&entry->typeId, typeId))
+            continue;
+        *prev = entry->next;
+        UA_TypeHierarchyEntry_delete(entry);
+        th->entriesSize--;
+        return;
+    }
+}
+
+static UA_Boolean
+containsNodeId(const UA_NodeId *ids, size_t idsSize, const UA_NodeId *id) {
+    for(size_t i = 0; i < idsSize; i++) {
+        if(UA_NodeId_equal(&ids[i], id))
+            return true;
+    }
+    return false;
+}
+
+static int
+cmpNodeId(const void *a, const void *b) {
+    return (int)UA_NodeId_order((const UA_NodeId*)a, (const UA_NodeId*)b);
+}
+
+/* Binary search in the sorted supertypes */
+static UA_Boolean
+containsSupertype(const UA_TypeHierarchyEntry *entry, const UA_NodeId *id) {
+    size_t lo = 0, hi = entry->supertypesSize;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        UA_Order o = UA_NodeId_order(&entry->supertypes[mid], id);
+        if(o == UA_ORDER_EQ)
+            return true;
+        if(o == UA_ORDER_LESS)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return false;
+}
+
+/* Collect the supertypes breadth-first. The array of supertypes doubles as the
+ * queue of nodes whose inverse HasSubtype references are followed next. It is
+ * sorted afterwards for the lookup. Returns NULL if the node is no type node or
+ * if the hierarchy is deeper than what isNodeInTreeNoCircular considers. */
+static UA_TypeHierarchyEntry *
+computeTypeHierarchyEntry(UA_Server *server, const UA_NodeId *typeId,
+                          UA_UInt32 hash) {
+    const UA_ReferenceTypeSet hasSubtype =
+        UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASSUBTYPE);
+    UA_NodeId *supertypes = NULL;
+    size_t supertypesSize = 0;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t pos = 0; pos <= supertypesSize && res == UA_STATUSCODE_GOOD; pos++) {
+        const UA_NodeId *current = (pos == 0) ? typeId : &supertypes[pos-1];
+        const UA_Node *node =
+            UA_NODESTORE_GET_SELECTIVE(server, current, UA_NODEATTRIBUTESMASK_NONE,
+                                       hasSubtype, UA_BROWSEDIRECTION_INVERSE);
+        if(!node) {
+            if(pos == 0)
+                return NULL;
+            continue;
+        }
+        if(pos == 0 && (node->head.nodeClass & UA_NODECLASS_TYPES) == 0) {
+            UA_NODESTORE_RELEASE(server, node);
+            return NULL;
+        }
+
+        for(size_t i = 0; i < node->head.referencesSize; i++) {
+            const UA_NodeReferenceKind *rk = &node->head.references[i];
+            if(!rk->isInverse ||
+               rk->referenceTypeIndex != UA_REFERENCETYPEINDEX_HASSUBTYPE)
+                continue;
+            const UA_ReferenceTarget *t = NULL;
+            while((t = UA_NodeReferenceKind_iterate(rk, t))) {
+                if(!UA_NodePointer_isLocal(t->targetId))
+                    continue;
+                UA_NodeId id = UA_NodePointer_toNodeId(t->targetId);
+                if(UA_NodeId_equal(&id, typeId) ||
+                   containsNodeId(supertypes, supertypesSize, &id))
+                    continue;
+                if(supertypesSize >= UA_MAX_TREE_RECURSE) {
+                    res = UA_STATUSCODE_BADINTERNALERROR;
+                    break;
+                }
+                res = UA_Array_appendCopy((void**)&supertypes, &supertypesSize,
+                                          &id, &UA_TYPES[UA_TYPES_NODEID]);
+                if(res != UA_STATUSCODE_GOOD)
+                    break;
+            }
+            if(res != UA_STATUSCODE_GOOD)
+                break;
+        }
+        UA_NODESTORE_RELEASE(server, node);
+    }
+
+    UA_TypeHierarchyEntry *entry = NULL;
+    if(res == UA_STATUSCODE_GOOD)
+        entry = (UA_TypeHierarchyEntry*)UA_calloc(1, sizeof(UA_TypeHierarchyEntry));
+    if(entry)
+        res = UA_NodeId_copy(typeId, &entry->typeId);
+    if(!entry || res != UA_STATUSCODE_GOOD) {
+        UA_free(entry);
+        UA_Array_delete(supertypes, supertypesSize, &UA_TYPES[UA_TYPES_NODEID]);
+        return NULL;
+    }
+    if(supertypesSize > 1)
+        qsort(supertypes, supertypesSize, sizeof(UA_NodeId), cmpNodeId);
+    entry->hash = hash;
+    entry->supertypes = supertypes;
+    entry->supertypesSize = supertypesSize;
+    return entry;
+}
+
+/* Returns NULL if the supertypes cannot be cached */
+static const UA_TypeHierarchyEntry *
+getTypeHierarchyEntry(UA_Server *server, const UA_NodeId *typeId) {
+    UA_UInt32 hash = UA_NodeId_hash(typeId);
+    UA_TypeHierarchyEntry *entry =
+        findTypeHierarchyEntry(&server->typeHierarchy, typeId, hash);
+    if(entry)
+        return entry;
+    entry = computeTypeHierarchyEntry(server, typeId, hash);
+    if(!entry)
+        return NULL;
+    if(insertTypeHierarchyEntry(&server->typeHierarchy, entry) != UA_STATUSCODE_GOOD) {
+        UA_TypeHierarchyEntry_delete(entry);
+        return NULL;
+    }
+    return entry;
+}
+
+void
+UA_TypeHierarchy_invalidate(UA_Server *server, const UA_NodeId *typeId) {
+    /* Does the type have subtypes? */
+    const UA_ReferenceTypeSet hasSubtype =
+        UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASSUBTYPE);
+    const UA_Node *node =
+        UA_NODESTORE_GET_SELECTIVE(server, typeId, UA_NODEATTRIBUTESMASK_NONE,
+                                   hasSubtype, UA_BROWSEDIRECTION_FORWARD);
+    UA_Boolean leaf = (node != NULL);
+    for(size_t i = 0; node && i < node->head.referencesSize; i++) {
+        const UA_NodeReferenceKind *rk = &node->head.references[i];
+        if(!rk->isInverse &&
+           rk->referenceTypeIndex == UA_REFERENCETYPEINDEX_HASSUBTYPE &&
+           UA_NodeReferenceKind_iterate(rk, NULL) != NULL)
+            leaf = false;
+    }
+    if(node)
+        UA_NODESTORE_RELEASE(server, node);
+
+    /* Only the entry of the leaf type itself can contain it */
+    if(leaf)
+        removeTypeHierarchyEntry(&server->typeHierarchy, typeId);
+    else
+        UA_TypeHierarchy_clear(&server->typeHierarchy);
+}
+
 /****************/
 /* IsNodeInTree */
 /****************/
@@ -171,6 +411,19 @@ UA_Boolean
 isNodeInTree(UA_Server *server, const UA_NodeId *leafNode,
              const UA_NodeId *nodeToFind,
              const UA_ReferenceTypeSet *relevantRefs) {
+    /* Subtype checks use the cached supertypes of type nodes. That is a hash
+     * lookup and a binary search in the supertypes. Computing a missing entry
+     * walks the hierarchy once. */
+    const UA_ReferenceTypeSet hasSubtype =
+        UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASSUBTYPE);
+    if(memcmp(relevantRefs, &hasSubtype, sizeof(UA_ReferenceTypeSet)) == 0) {
+        if(UA_NodeId_equal(leafNode, nodeToFind))
+            return true;
+        const UA_TypeHierarchyEntry *entry = getTypeHierarchyEntry(server, leafNode);
+        if(entry)
+            return containsSupertype(entry, nodeToFind);
+    }
+
     UA_NodePointer leafP = UA_NodePointer_fromNodeId(leafNode);
     UA_NodePointer targetP = UA_NodePointer_fromNodeId(nodeToFind);
     struct ref_history visitedRefs = {NULL, leafP, 0};
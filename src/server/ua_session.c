@@ -223,6 +223,45 @@ UA_Server_closeSession(UA_Server *server, const UA_NodeId *sessionId) {
     return res;
 }
 
+UA_StatusCode
+UA_Server_getSessionTraffic(UA_Server *server, const UA_NodeId *sessionId,
+                            UA_SecureChannelTraffic *traffic) {
+    UA_LOCK(&server->serviceMutex);
+    UA_Session *session = UA_Server_getSessionById(server, sessionId);
+    UA_StatusCode res = UA_STATUSCODE_BADSESSIONIDINVALID;
+    if(session && session->header.channel) {
+        *traffic = session->header.channel->traffic;
+        res = UA_STATUSCODE_GOOD;
+    } else if(session) {
+        res = UA_STATUSCODE_BADSECURECHANNELIDINVALID;
+    }
+    UA_UNLOCK(&server->serviceMutex);
+    return res;
+}
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+UA_StatusCode
+UA_Server_getSubscriptionPublishLatency(UA_Server *server,
+                                        const UA_NodeId *sessionId,
+                                        UA_UInt32 subscriptionId,
+                                        UA_LatencyHistogram *latency) {
+    UA_LOCK(&server->serviceMutex);
+    UA_Session *session = UA_Server_getSessionById(server, sessionId);
+    if(!session) {
+        UA_UNLOCK(&server->serviceMutex);
+        return UA_STATUSCODE_BADSESSIONIDINVALID;
+    }
+    UA_Subscription *sub = UA_Session_getSubscriptionById(session, subscriptionId);
+    if(!sub) {
+        UA_UNLOCK(&server->serviceMutex);
+        return UA_STATUSCODE_BADSUBSCRIPTIONIDINVALID;
+    }
+    *latency = sub->publishLatency;
+    UA_UNLOCK(&server->serviceMutex);
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
 UA_StatusCode
 UA_Server_setSessionParameter(UA_Server *server, const UA_NodeId *sessionId,
                               const UA_QualifiedName key, const UA_Variant *value) {
@@ -27,6 +27,9 @@ ContinuationPoint_clear(ContinuationPoint *cp);
 struct UA_Subscription;
 typedef struct UA_Subscription UA_Subscription;
 
+struct UA_ResponseStream;
+typedef struct UA_ResponseStream UA_ResponseStream;
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
 typedef struct UA_PublishResponseEntry {
     SIMPLEQ_ENTRY(UA_PublishResponseEntry) listEntry;
@@ -54,6 +57,9 @@ typedef struct {
     size_t paramsSize;
     UA_KeyValuePair *params;
 
+    /* Set while a service with a streamable response is processed */
+    UA_ResponseStream *responseStream;
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* The queue is ordered according to the priority byte (higher bytes come
      * first). When a late subscription finally publishes, then it is pushed to
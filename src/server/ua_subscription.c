@@ -387,6 +387,7 @@ UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
     UA_LOG_DEBUG_SUBSCRIPTION(&server->config.logger, sub, "Publish Callback");
     UA_assert(sub);
+    UA_DateTime start = UA_DateTime_nowMonotonic();
 
     /* Dequeue a response */
     UA_PublishResponseEntry *pre = NULL;
@@ -530,6 +531,11 @@ UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
     sendResponse(server, sub->session, sub->session->header.channel, pre->requestId,
                  (UA_Response*)response, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
 
+    /* Update the statistics */
+    UA_DateTime latency = UA_DateTime_nowMonotonic() - start;
+    UA_LatencyHistogram_add(&sub->publishLatency, latency);
+    UA_LatencyHistogram_add(&server->serviceStats.publish, latency);
+
     /* Reset subscription state to normal */
     sub->state = UA_SUBSCRIPTIONSTATE_NORMAL;
     sub->currentKeepAliveCount = 0;
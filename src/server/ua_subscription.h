@@ -282,6 +282,9 @@ struct UA_Subscription {
     /* Retransmission Queue */
     NotificationMessageQueue retransmissionQueue;
     size_t retransmissionQueueSize;
+
+    /* Statistics */
+    UA_LatencyHistogram publishLatency;
 };
 
 UA_Subscription * UA_Subscription_new(void);
@@ -20,6 +20,14 @@ typedef struct {
     UA_ContentFilterResult *contentFilterResult;
     UA_Variant *valueResult;
     UA_UInt16 index;
+
+    /* Set for stored events that have no node. The SimpleAttributeOperands
+     * resolve to the field that was taken with the same select clause. */
+    UA_Boolean storedEvent;
+    const UA_Variant *fields;
+    const UA_SimpleAttributeOperand *fieldClauses;
+    size_t fieldsSize;
+    const UA_NodeId *eventType;
 } UA_FilterOperatorContext;
 
 static UA_StatusCode
@@ -113,6 +121,37 @@ resolveSimpleAttributeOperand(UA_Server *server, UA_Session *session,
     return v.status;
 }
 
+/* The TypeDefinitionId is not compared. The BrowsePath relative to the event
+ * identifies the field. */
+static UA_Boolean
+sameFieldOperand(const UA_SimpleAttributeOperand *a,
+                 const UA_SimpleAttributeOperand *b) {
+    if(a->attributeId != b->attributeId ||
+       a->browsePathSize != b->browsePathSize ||
+       !UA_String_equal(&a->indexRange, &b->indexRange))
+        return false;
+    for(size_t i = 0; i < a->browsePathSize; i++) {
+        if(!UA_QualifiedName_equal(&a->browsePath[i], &b->browsePath[i]))
+            return false;
+    }
+    return true;
+}
+
+/* The field is not copied. The stored event outlives the evaluation. */
+static UA_StatusCode
+resolveFieldOperand(UA_FilterOperatorContext *ctx,
+                    const UA_SimpleAttributeOperand *sao,
+                    UA_Variant *value) {
+    for(size_t i = 0; i < ctx->fieldsSize; i++) {
+        if(!sameFieldOperand(sao, &ctx->fieldClauses[i]))
+            continue;
+        *value = ctx->fields[i];
+        value->storageType = UA_VARIANT_DATA_NODELETE;
+        return UA_STATUSCODE_GOOD;
+    }
+    return UA_STATUSCODE_BADNOTFOUND;
+}
+
 /* Resolve operands to variants according to the operand type.
  * Part 4: 7.17.3 Table 142 specifies the allowed types. */
 static UA_Variant
@@ -121,7 +160,12 @@ resolveOperand(UA_FilterOperatorContext *ctx, UA_UInt16 nr) {
     UA_Variant variant;
     UA_Variant_init(&variant);
     UA_ExtensionObject *op = &ctx->contentFilter->elements[ctx->index].filterOperands[nr];
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) {
+    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND] &&
+       ctx->storedEvent) {
+        /* SimpleAttributeOperand of a stored event */
+        res = resolveFieldOperand(ctx, (UA_SimpleAttributeOperand *)op->content.decoded.data,
+                                  &variant);
+    } else if(op->content.decoded.type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) {
         /* SimpleAttributeOperand */
         res = resolveSimpleAttributeOperand(ctx->server, ctx->session, ctx->eventNode,
                                 (UA_SimpleAttributeOperand *)op->content.decoded.data,
@@ -169,6 +213,17 @@ ofTypeOperator(UA_FilterOperatorContext *ctx) {
         return UA_STATUSCODE_BADEVENTFILTERINVALID;
 
     UA_NodeId *literalOperandNodeId = (UA_NodeId *) literalOperand->value.data;
+
+    /* Stored events carry their EventType */
+    if(ctx->storedEvent) {
+        if(!ctx->eventType)
+            return UA_STATUSCODE_BADNOMATCH;
+        result = UA_NodeId_equal(ctx->eventType, literalOperandNodeId) ||
+            isNodeInTree_singleRef(ctx->server, ctx->eventType, literalOperandNodeId,
+                                   UA_REFERENCETYPEINDEX_HASSUBTYPE);
+        return (result) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADNOMATCH;
+    }
+
     UA_Variant typeNodeIdVariant;
     UA_Variant_init(&typeNodeIdVariant);
     UA_StatusCode readStatusCode =
@@ -519,6 +574,7 @@ compareOperation(UA_Variant *firstOperand, UA_Variant *secondOperand, UA_FilterO
 
 static UA_StatusCode
 compareOperator(UA_FilterOperatorContext *ctx) {
+    ctx->valueResult[ctx->index].type = &UA_TYPES[UA_TYPES_BOOLEAN];
     UA_Variant firstOperand = resolveOperand(ctx, 0);
     if(UA_Variant_isEmpty(&firstOperand))
         return UA_STATUSCODE_BADFILTEROPERANDINVALID;
@@ -825,6 +881,7 @@ UA_Server_evaluateWhereClauseContentFilter(UA_Server *server, UA_Session *sessio
     }
 
     UA_FilterOperatorContext ctx;
+    memset(&ctx, 0, sizeof(UA_FilterOperatorContext));
     ctx.server = server;
     ctx.session = session;
     ctx.eventNode = eventNode;
@@ -841,6 +898,71 @@ UA_Server_evaluateWhereClauseContentFilter(UA_Server *server, UA_Session *sessio
     return res;
 }
 
+UA_StatusCode
+UA_Server_evaluateWhereClauseFields(UA_Server *server,
+                                    const UA_ContentFilter *whereClause,
+                                    const UA_NodeId *eventType, size_t fieldsSize,
+                                    const UA_SimpleAttributeOperand *selectClauses,
+                                    const UA_Variant *fields) {
+    if(whereClause->elementsSize == 0)
+        return UA_STATUSCODE_GOOD;
+    if(whereClause->elementsSize > 256)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    /* The operand results are only used during the evaluation. Use a single
+     * buffer for all elements. */
+    size_t operands = 0;
+    for(size_t i = 0; i < whereClause->elementsSize; i++)
+        operands += whereClause->elements[i].filterOperandsSize;
+    UA_StatusCode *operandResults = (UA_StatusCode*)
+        UA_calloc(operands + 1, sizeof(UA_StatusCode));
+    UA_ContentFilterElementResult *elementResults = (UA_ContentFilterElementResult*)
+        UA_calloc(whereClause->elementsSize, sizeof(UA_ContentFilterElementResult));
+    if(!operandResults || !elementResults) {
+        UA_free(operandResults);
+        UA_free(elementResults);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    operands = 0;
+    for(size_t i = 0; i < whereClause->elementsSize; i++) {
+        elementResults[i].operandStatusCodes = &operandResults[operands];
+        elementResults[i].operandStatusCodesSize = whereClause->elements[i].filterOperandsSize;
+        operands += whereClause->elements[i].filterOperandsSize;
+    }
+    UA_ContentFilterResult contentFilterResult;
+    UA_ContentFilterResult_init(&contentFilterResult);
+    contentFilterResult.elementResults = elementResults;
+    contentFilterResult.elementResultsSize = whereClause->elementsSize;
+
+    UA_Variant valueResult[256];
+    for(size_t i = 0; i < whereClause->elementsSize; ++i)
+        UA_Variant_init(&valueResult[i]);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_FilterOperatorContext ctx;
+    memset(&ctx, 0, sizeof(UA_FilterOperatorContext));
+    ctx.server = server;
+    ctx.session = &server->adminSession;
+    ctx.contentFilter = whereClause;
+    ctx.contentFilterResult = &contentFilterResult;
+    ctx.valueResult = valueResult;
+    ctx.storedEvent = true;
+    ctx.fields = fields;
+    ctx.fieldClauses = selectClauses;
+    ctx.fieldsSize = fieldsSize;
+    ctx.eventType = eventType;
+    UA_StatusCode res = evaluateWhereClauseContentFilter(&ctx);
+    UA_UNLOCK(&server->serviceMutex);
+
+    for(size_t i = 0; i < whereClause->elementsSize; i++) {
+        if(!UA_Variant_isEmpty(&valueResult[i]))
+            UA_Variant_clear(&valueResult[i]);
+    }
+    UA_free(operandResults);
+    UA_free(elementResults);
+    return res;
+}
+
 static UA_Boolean
 isValidEvent(UA_Server *server, const UA_NodeId *validEventParent,
              const UA_NodeId *eventId) {
@@ -76,8 +76,7 @@ UA_SecureChannel_setSecurityPolicy(UA_SecureChannel *channel,
 
 static void
 UA_Chunk_delete(UA_Chunk *chunk) {
-    if(chunk->copied)
-        UA_ByteString_clear(&chunk->bytes);
+    UA_free(chunk->copy);
     UA_free(chunk);
 }
 
@@ -231,6 +230,11 @@ UA_SecureChannel_sendAsymmetricOPNMessage(UA_SecureChannel *channel,
 #ifdef UA_ENABLE_UNIT_TEST_FAILURE_HOOKS
     res |= sendAsym_sendFailure;
 #endif
+    if(res == UA_STATUSCODE_GOOD) {
+        UA_atomic_addSize(&channel->traffic.bytesSent, encryptedLength);
+        UA_atomic_addSize(&channel->traffic.chunksSent, 1);
+        UA_atomic_addSize(&channel->traffic.messagesSent, 1);
+    }
     return res;
 }
 
@@ -281,6 +285,65 @@ encodeHeadersSym(UA_MessageContext *mc, size_t totalLength) {
     return res;
 }
 
+/* Send a chunk. The buffer is freed in the network layer. */
+static UA_StatusCode
+sendChunk(UA_MessageContext *mc, UA_ByteString *buf) {
+    UA_SecureChannel *channel = mc->channel;
+    size_t length = buf->length;
+    UA_DateTime start = UA_DateTime_nowMonotonic();
+    UA_StatusCode res = channel->connection->send(channel->connection, buf);
+    mc->sendDuration += UA_DateTime_nowMonotonic() - start;
+    UA_CHECK_STATUS(res, return res);
+    UA_atomic_addSize(&channel->traffic.bytesSent, length);
+    UA_atomic_addSize(&channel->traffic.chunksSent, 1);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+releasePendingChunks(UA_MessageContext *mc) {
+    UA_Connection *connection = mc->channel->connection;
+    for(size_t i = 0; i < mc->pendingChunksSize; i++)
+        connection->releaseSendBuffer(connection, &mc->pendingChunks[i].buffer);
+    mc->pendingChunksSize = 0;
+}
+
+#ifdef UA_ENABLE_ENCRYPTION
+static void
+signAndEncryptPendingChunk(void *context, size_t index) {
+    UA_MessageContext *mc = (UA_MessageContext*)context;
+    UA_PendingChunk *pc = &mc->pendingChunks[index];
+    pc->res = signAndEncryptSym(mc->channel, &pc->buffer,
+                                pc->preSigLength, pc->buffer.length);
+}
+#endif
+
+/* Sign and encrypt the pending chunks in parallel. Then send them in order. If
+ * a chunk fails, it is not sent and the remaining chunks are released. */
+static UA_StatusCode
+sendPendingChunks(UA_MessageContext *mc) {
+    UA_SecureChannel *channel = mc->channel;
+    UA_Connection *connection = channel->connection;
+    UA_CHECK_MEM(connection, return UA_STATUSCODE_BADINTERNALERROR);
+
+#ifdef UA_ENABLE_ENCRYPTION
+    UA_ThreadPool_run(channel->cryptoPool, signAndEncryptPendingChunk,
+                      mc, mc->pendingChunksSize);
+#endif
+
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < mc->pendingChunksSize; i++) {
+        UA_PendingChunk *pc = &mc->pendingChunks[i];
+        if(res == UA_STATUSCODE_GOOD)
+            res = pc->res;
+        if(res == UA_STATUSCODE_GOOD)
+            res = sendChunk(mc, &pc->buffer);
+        else
+            connection->releaseSendBuffer(connection, &pc->buffer);
+    }
+    mc->pendingChunksSize = 0;
+    return res;
+}
+
 static UA_StatusCode
 sendSymmetricChunk(UA_MessageContext *mc) {
     UA_SecureChannel *channel = mc->channel;
@@ -339,18 +402,33 @@ sendSymmetricChunk(UA_MessageContext *mc) {
     res = encodeHeadersSym(mc, total_length);
     UA_CHECK_STATUS(res, goto error);
 
+    /* Hold the chunk back to sign and encrypt it as part of a batch */
+    if(channel->cryptoPool &&
+       channel->securityMode != UA_MESSAGESECURITYMODE_NONE) {
+        UA_PendingChunk *pc = &mc->pendingChunks[mc->pendingChunksSize++];
+        pc->buffer = mc->messageBuffer;
+        pc->preSigLength = pre_sig_length;
+        pc->res = UA_STATUSCODE_GOOD;
+        mc->messageBuffer = UA_BYTESTRING_NULL;
+        if(!mc->final && mc->pendingChunksSize < UA_MESSAGECONTEXT_MAXPENDINGCHUNKS)
+            return UA_STATUSCODE_GOOD;
+        return sendPendingChunks(mc);
+    }
+
 #ifdef UA_ENABLE_ENCRYPTION
     /* Sign and encrypt the messge */
-    res = signAndEncryptSym(mc, pre_sig_length, total_length);
+    res = signAndEncryptSym(channel, &mc->messageBuffer,
+                            pre_sig_length, total_length);
     UA_CHECK_STATUS(res, goto error);
 #endif
 
     /* Send the chunk, the buffer is freed in the network layer */
-    return connection->send(channel->connection, &mc->messageBuffer);
+    return sendChunk(mc, &mc->messageBuffer);
 
  error:
     /* Free the unused message buffer */
     connection->releaseSendBuffer(channel->connection, &mc->messageBuffer);
+    releasePendingChunks(mc);
     return res;
 }
 
@@ -373,7 +451,7 @@ sendSymmetricEncodingCallback(void *data, UA_Byte **buf_pos,
 
     res = c->getSendBuffer(c, mc->channel->config.sendBufferSize,
                            &mc->messageBuffer);
-    UA_CHECK_STATUS(res, return res);
+    UA_CHECK_STATUS(res, releasePendingChunks(mc); return res);
 
     /* Hide bytes for header, padding and signature */
     setBufPos(mc);
@@ -399,6 +477,8 @@ UA_MessageContext_begin(UA_MessageContext *mc, UA_SecureChannel *channel,
     mc->final = false;
     mc->messageBuffer = UA_BYTESTRING_NULL;
     mc->messageType = messageType;
+    mc->sendDuration = 0;
+    mc->pendingChunksSize = 0;
 
     /* Allocate the message buffer */
     UA_StatusCode res = c->getSendBuffer(c, channel->config.sendBufferSize,
@@ -416,7 +496,8 @@ UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
     UA_StatusCode res =
         UA_encodeBinaryInternal(content, contentType, &mc->buf_pos, &mc->buf_end,
                                 sendSymmetricEncodingCallback, mc);
-    if(res != UA_STATUSCODE_GOOD && mc->messageBuffer.length > 0)
+    if(res != UA_STATUSCODE_GOOD &&
+       (mc->messageBuffer.length > 0 || mc->pendingChunksSize > 0))
         UA_MessageContext_abort(mc);
     return res;
 }
@@ -424,12 +505,16 @@ UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
 UA_StatusCode
 UA_MessageContext_finish(UA_MessageContext *mc) {
     mc->final = true;
-    return sendSymmetricChunk(mc);
+    UA_StatusCode res = sendSymmetricChunk(mc);
+    if(res == UA_STATUSCODE_GOOD)
+        UA_atomic_addSize(&mc->channel->traffic.messagesSent, 1);
+    return res;
 }
 
 void
 UA_MessageContext_abort(UA_MessageContext *mc) {
     UA_Connection *connection = mc->channel->connection;
+    releasePendingChunks(mc);
     connection->releaseSendBuffer(connection, &mc->messageBuffer);
 }
 
@@ -590,10 +675,13 @@ unpackPayloadMSG(UA_SecureChannel *channel, UA_Chunk *chunk) {
     res = checkSymHeader(channel, tokenId);
     UA_CHECK_STATUS(res, return res);
 
-    /* Decrypt the chunk payload */
-    res = decryptAndVerifyChunk(channel,
-                                &channel->securityPolicy->symmetricModule.cryptoModule,
-                                chunk->messageType, &chunk->bytes, offset);
+    /* Decrypt the chunk payload. Unless this was already done in parallel. */
+    if(chunk->decrypted)
+        res = chunk->decryptStatus;
+    else
+        res = decryptAndVerifyChunk(channel,
+                                    &channel->securityPolicy->symmetricModule.cryptoModule,
+                                    chunk->messageType, &chunk->bytes, offset);
     UA_CHECK_STATUS(res, return res);
 
     /* Check the sequence number. Skip sequence number checking for fuzzer to
@@ -624,8 +712,9 @@ assembleProcessMessage(UA_SecureChannel *channel, void *application,
     if(chunk->chunkType == UA_CHUNKTYPE_FINAL) {
         SIMPLEQ_REMOVE_HEAD(&channel->decryptedChunks, pointers);
         UA_assert(chunk->chunkType == UA_CHUNKTYPE_FINAL);
+        UA_atomic_addSize(&channel->traffic.messagesReceived, 1);
         res = callback(application, channel, chunk->messageType,
-                       chunk->requestId, &chunk->bytes);
+                       chunk->requestId, &chunk->bytes, 1);
         UA_Chunk_delete(chunk);
         return res;
     }
@@ -635,7 +724,7 @@ assembleProcessMessage(UA_SecureChannel *channel, void *application,
     UA_ChunkType chunkType = chunk->chunkType;
     UA_assert(chunkType == UA_CHUNKTYPE_INTERMEDIATE);
 
-    size_t messageSize = 0;
+    size_t chunksCount = 0;
     SIMPLEQ_FOREACH(chunk, &channel->decryptedChunks, pointers) {
         /* Consistency check */
         if(requestId != chunk->requestId)
@@ -645,33 +734,38 @@ assembleProcessMessage(UA_SecureChannel *channel, void *application,
         if(chunk->messageType != messageType)
             return UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
 
-        /* Sum up the lengths */
-        messageSize += chunk->bytes.length;
+        /* Count the chunks */
+        chunksCount++;
         if(chunk->chunkType == UA_CHUNKTYPE_FINAL)
             break;
     }
 
-    /* Allocate memory for the full message */
-    UA_ByteString payload;
-    res = UA_ByteString_allocBuffer(&payload, messageSize);
-    UA_CHECK_STATUS(res, return res);
-    
-    /* Assemble the full message */
-    size_t offset = 0;
-    while(true) {
+    /* The payloads of the chunks are the segments of the message. They are
+     * decoded in place without assembling the message in a new buffer. All
+     * chunks have at least UA_DECODE_SEGMENT_HEADROOM bytes in front of the
+     * payload (the chunk header or the headroom of the copy). */
+    UA_ByteString *segments = (UA_ByteString*)
+        UA_malloc(chunksCount * sizeof(UA_ByteString));
+    if(!segments)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Move the chunks of the message out of the queue. The processing might
+     * close the channel and clear the queue. */
+    UA_ChunkQueue message;
+    SIMPLEQ_INIT(&message);
+    for(size_t i = 0; i < chunksCount; i++) {
         chunk = SIMPLEQ_FIRST(&channel->decryptedChunks);
-        memcpy(&payload.data[offset], chunk->bytes.data, chunk->bytes.length);
-        offset += chunk->bytes.length;
         SIMPLEQ_REMOVE_HEAD(&channel->decryptedChunks, pointers);
-        UA_ChunkType ct = chunk->chunkType;
-        UA_Chunk_delete(chunk);
-        if(ct == UA_CHUNKTYPE_FINAL)
-            break;
+        SIMPLEQ_INSERT_TAIL(&message, chunk, pointers);
+        segments[i] = chunk->bytes;
     }
-    
-    /* Process the assembled message */
-    res = callback(application, channel, messageType, requestId, &payload);
-    UA_ByteString_clear(&payload);
+
+    /* Process the message */
+    UA_atomic_addSize(&channel->traffic.messagesReceived, 1);
+    res = callback(application, channel, messageType, requestId,
+                   segments, chunksCount);
+    UA_free(segments);
+    deleteChunks(&message);
     return res;
 }
 
@@ -679,13 +773,14 @@ static UA_StatusCode
 persistCompleteChunks(UA_ChunkQueue *queue) {
     UA_Chunk *chunk;
     SIMPLEQ_FOREACH(chunk, queue, pointers) {
-        if(chunk->copied)
+        if(chunk->copy)
             continue;
-        UA_ByteString copy;
-        UA_StatusCode res = UA_ByteString_copy(&chunk->bytes, &copy);
-        UA_CHECK_STATUS(res, return res);
-        chunk->bytes = copy;
-        chunk->copied = true;
+        chunk->copy = (UA_Byte*)
+            UA_malloc(UA_DECODE_SEGMENT_HEADROOM + chunk->bytes.length);
+        UA_CHECK_MEM(chunk->copy, return UA_STATUSCODE_BADOUTOFMEMORY);
+        memcpy(chunk->copy + UA_DECODE_SEGMENT_HEADROOM,
+               chunk->bytes.data, chunk->bytes.length);
+        chunk->bytes.data = chunk->copy + UA_DECODE_SEGMENT_HEADROOM;
     }
     return UA_STATUSCODE_GOOD;
 }
@@ -702,12 +797,79 @@ persistIncompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
     return UA_STATUSCODE_GOOD;
 }
 
+#ifdef UA_ENABLE_ENCRYPTION
+typedef struct {
+    const UA_SecureChannel *channel;
+    UA_Chunk *chunks[UA_MESSAGECONTEXT_MAXPENDINGCHUNKS];
+} UA_DecryptBatch;
+
+static void
+decryptChunkJob(void *context, size_t index) {
+    UA_DecryptBatch *batch = (UA_DecryptBatch*)context;
+    const UA_SecureChannel *channel = batch->channel;
+    UA_Chunk *chunk = batch->chunks[index];
+    chunk->decryptStatus =
+        decryptAndVerifyChunk(channel, &channel->securityPolicy->symmetricModule.cryptoModule,
+                              chunk->messageType, &chunk->bytes,
+                              UA_SECURECHANNEL_MESSAGE_MIN_LENGTH);
+    chunk->decrypted = true;
+}
+
+/* Decrypt and verify the received symmetric chunks in parallel before they are
+ * processed in order. This stops at the first chunk that is not secured with
+ * the current SecurityToken, as processing might roll over the keys. The
+ * sequence numbers are checked later during the sequential processing. */
+static void
+decryptChunksParallel(UA_SecureChannel *channel) {
+    if(!channel->cryptoPool || !channel->securityPolicy ||
+       channel->securityMode == UA_MESSAGESECURITYMODE_NONE ||
+       channel->state != UA_SECURECHANNELSTATE_OPEN ||
+       channel->renewState != UA_SECURECHANNELRENEWSTATE_NORMAL)
+        return;
+
+    UA_DecryptBatch batch;
+    batch.channel = channel;
+    size_t batchSize = 0;
+    UA_Chunk *chunk;
+    SIMPLEQ_FOREACH(chunk, &channel->completeChunks, pointers) {
+        if(chunk->messageType != UA_MESSAGETYPE_MSG &&
+           chunk->messageType != UA_MESSAGETYPE_CLO)
+            break;
+
+        size_t offset = UA_SECURECHANNEL_MESSAGEHEADER_LENGTH;
+        UA_UInt32 secureChannelId = 0;
+        UA_UInt32 tokenId = 0;
+        UA_UInt32_decodeBinary(&chunk->bytes, &offset, &secureChannelId);
+        UA_UInt32_decodeBinary(&chunk->bytes, &offset, &tokenId);
+        if(secureChannelId != channel->securityToken.channelId ||
+           tokenId != channel->securityToken.tokenId)
+            break;
+
+        if(chunk->decrypted)
+            continue;
+        batch.chunks[batchSize++] = chunk;
+        if(batchSize == UA_MESSAGECONTEXT_MAXPENDINGCHUNKS) {
+            UA_ThreadPool_run(channel->cryptoPool, decryptChunkJob, &batch, batchSize);
+            batchSize = 0;
+        }
+    }
+
+    /* Don't bother the workers for a single chunk */
+    if(batchSize > 1)
+        UA_ThreadPool_run(channel->cryptoPool, decryptChunkJob, &batch, batchSize);
+}
+#endif
+
 /* Processes chunks and puts them into the payloads queue. Once a final chunk is
  * put into the queue, the message is assembled and the callback is called. The
  * queue will be cleared for the next message. */
 static UA_StatusCode
 processChunks(UA_SecureChannel *channel, void *application,
               UA_ProcessMessageCallback callback) {
+#ifdef UA_ENABLE_ENCRYPTION
+    decryptChunksParallel(channel);
+#endif
+
     UA_Chunk *chunk;
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     while((chunk = SIMPLEQ_FIRST(&channel->completeChunks))) {
@@ -837,6 +999,8 @@ extractCompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
 
     /* Add the chunk; forward the offset */
     *offset += hdr.messageSize;
+    UA_atomic_addSize(&channel->traffic.bytesReceived, hdr.messageSize);
+    UA_atomic_addSize(&channel->traffic.chunksReceived, 1);
     UA_Chunk *chunk = (UA_Chunk*)UA_malloc(sizeof(UA_Chunk));
     UA_CHECK_MEM(chunk, return UA_STATUSCODE_BADOUTOFMEMORY);
 
@@ -844,7 +1008,9 @@ extractCompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
     chunk->messageType = msgType;
     chunk->chunkType = chunkType;
     chunk->requestId = 0;
-    chunk->copied = false;
+    chunk->copy = NULL;
+    chunk->decrypted = false;
+    chunk->decryptStatus = UA_STATUSCODE_GOOD;
 
     SIMPLEQ_INSERT_TAIL(&channel->completeChunks, chunk, pointers);
     return UA_STATUSCODE_GOOD;
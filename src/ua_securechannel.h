@@ -20,6 +20,7 @@
 #include "open62541_queue.h"
 #include "ua_util_internal.h"
 #include "ua_connection_internal.h"
+#include "ua_threadpool.h"
 
 _UA_BEGIN_DECLS
 
@@ -77,8 +78,12 @@ typedef struct UA_Chunk {
     UA_MessageType messageType;
     UA_ChunkType chunkType;
     UA_UInt32 requestId;
-    UA_Boolean copied; /* Do the bytes point to a buffer from the network or was
-                        * memory allocated for the chunk separately */
+    UA_Byte *copy; /* The bytes point to a buffer from the network (NULL) or
+                    * into memory allocated for the chunk separately. The
+                    * copy leaves UA_DECODE_SEGMENT_HEADROOM in front. */
+    UA_Boolean decrypted; /* Decrypted and verified ahead of the (sequential)
+                           * processing. The result is in decryptStatus. */
+    UA_StatusCode decryptStatus;
 } UA_Chunk;
 
 typedef SIMPLEQ_HEAD(UA_ChunkQueue, UA_Chunk) UA_ChunkQueue;
@@ -155,6 +160,17 @@ struct UA_SecureChannel {
     UA_ByteString incompleteChunk; /* A half-received chunk (TCP is a
                                     * streaming protocol) is stored here */
 
+    /* Worker pool to sign/encrypt and decrypt/verify the chunks of a message in
+     * parallel. Optional and not owned by the SecureChannel. The symmetric
+     * crypto functions of the SecurityPolicy must be reentrant for the same
+     * channel context if the pool is set. */
+    UA_ThreadPool *cryptoPool;
+
+    /* Statistics. The latency histogram for the symmetric and asymmetric
+     * crypto of the chunks is optional and not owned by the SecureChannel. */
+    UA_SecureChannelTraffic traffic;
+    UA_LatencyHistogram *cryptoStatistics;
+
     UA_CertificateVerification *certificateVerification;
     UA_StatusCode (*processOPNHeader)(void *application, UA_SecureChannel *channel,
                                       const UA_AsymmetricAlgorithmSecurityHeader *asymHeader);
@@ -205,9 +221,27 @@ UA_SecureChannel_sendSymmetricMessage(UA_SecureChannel *channel, UA_UInt32 reque
                                       UA_MessageType messageType, void *payload,
                                       const UA_DataType *payloadType);
 
+/* Maximum number of chunks that are held back to be signed and encrypted as a
+ * batch when the SecureChannel has a cryptoPool. */
+#define UA_MESSAGECONTEXT_MAXPENDINGCHUNKS 16
+
+/* A chunk with encoded headers and padding that is yet to be signed, encrypted
+ * and sent */
+typedef struct {
+    UA_ByteString buffer; /* The length is the total length of the chunk */
+    size_t preSigLength;
+    UA_StatusCode res;
+} UA_PendingChunk;
+
 /* The MessageContext is forwarded into the encoding layer so that we can send
  * chunks before continuing to encode. This lets us reuse a fixed chunk-sized
- * messages buffer. */
+ * messages buffer.
+ *
+ * If the SecureChannel has a cryptoPool, full chunks are held back until a
+ * batch of chunks is complete (or the message is finished). The chunks of a
+ * batch are signed and encrypted in parallel and sent in order. The sequence
+ * numbers are assigned when the chunk is completed, so the order on the wire
+ * is not changed. */
 typedef struct {
     UA_SecureChannel *channel;
     UA_UInt32 requestId;
@@ -221,6 +255,11 @@ typedef struct {
     const UA_Byte *buf_end;
 
     UA_Boolean final;
+
+    UA_DateTime sendDuration; /* Time spent in the network layer so far */
+
+    size_t pendingChunksSize;
+    UA_PendingChunk pendingChunks[UA_MESSAGECONTEXT_MAXPENDINGCHUNKS];
 } UA_MessageContext;
 
 /* Start the context of a new symmetric message. */
@@ -250,10 +289,13 @@ UA_MessageContext_abort(UA_MessageContext *mc);
  * Receive Message
  * --------------- */
 
+/* The message body is passed as an array of segments. These are the payloads
+ * of the chunks the message was received in. Messages of a single chunk have
+ * a single segment. Decode with UA_decodeBinarySegments. */
 typedef UA_StatusCode
 (UA_ProcessMessageCallback)(void *application, UA_SecureChannel *channel,
                             UA_MessageType messageType, UA_UInt32 requestId,
-                            UA_ByteString *message);
+                            UA_ByteString *message, size_t messageSegments);
 
 /* Process a received buffer. The callback function is called with the message
  * body if the message is complete. The message is removed afterwards. Returns
@@ -326,8 +368,10 @@ signAndEncryptAsym(UA_SecureChannel *channel, size_t preSignLength,
                    UA_ByteString *buf, size_t securityHeaderLength,
                    size_t totalLength);
 
+/* Sign and encrypt a chunk with encoded headers and padding. The signature is
+ * placed directly after the preSigLength. */
 UA_StatusCode
-signAndEncryptSym(UA_MessageContext *messageContext,
+signAndEncryptSym(const UA_SecureChannel *channel, UA_ByteString *buf,
                   size_t preSigLength, size_t totalLength);
 
 /**
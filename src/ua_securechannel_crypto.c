@@ -310,21 +310,17 @@ signAndEncryptAsym(UA_SecureChannel *channel, size_t preSignLength,
 /* Send Symmetric Message */
 /**************************/
 
-UA_StatusCode
-signAndEncryptSym(UA_MessageContext *messageContext,
-                  size_t preSigLength, size_t totalLength) {
-    const UA_SecureChannel *channel = messageContext->channel;
-    if(channel->securityMode == UA_MESSAGESECURITYMODE_NONE)
-        return UA_STATUSCODE_GOOD;
-
+static UA_StatusCode
+signAndEncryptSymInternal(const UA_SecureChannel *channel, UA_ByteString *buf,
+                          size_t preSigLength, size_t totalLength) {
     /* Sign */
     const UA_SecurityPolicy *sp = channel->securityPolicy;
-    UA_ByteString dataToSign = messageContext->messageBuffer;
+    UA_ByteString dataToSign = *buf;
     dataToSign.length = preSigLength;
     UA_ByteString signature;
     signature.length = sp->symmetricModule.cryptoModule.signatureAlgorithm.
         getLocalSignatureSize(channel->channelContext);
-    signature.data = messageContext->buf_pos;
+    signature.data = buf->data + preSigLength;
     UA_StatusCode res = sp->symmetricModule.cryptoModule.signatureAlgorithm.
         sign(channel->channelContext, &dataToSign, &signature);
     UA_CHECK_STATUS(res, return res);
@@ -334,7 +330,7 @@ signAndEncryptSym(UA_MessageContext *messageContext,
 
     /* Encrypt */
     UA_ByteString dataToEncrypt;
-    dataToEncrypt.data = messageContext->messageBuffer.data +
+    dataToEncrypt.data = buf->data +
         UA_SECURECHANNEL_CHANNELHEADER_LENGTH + 
         UA_SECURECHANNEL_SYMMETRIC_SECURITYHEADER_LENGTH;
     dataToEncrypt.length = totalLength -
@@ -344,6 +340,21 @@ signAndEncryptSym(UA_MessageContext *messageContext,
         encrypt(channel->channelContext, &dataToEncrypt);
 }
 
+UA_StatusCode
+signAndEncryptSym(const UA_SecureChannel *channel, UA_ByteString *buf,
+                  size_t preSigLength, size_t totalLength) {
+    if(channel->securityMode == UA_MESSAGESECURITYMODE_NONE)
+        return UA_STATUSCODE_GOOD;
+    if(!channel->cryptoStatistics)
+        return signAndEncryptSymInternal(channel, buf, preSigLength, totalLength);
+    UA_DateTime start = UA_DateTime_nowMonotonic();
+    UA_StatusCode res =
+        signAndEncryptSymInternal(channel, buf, preSigLength, totalLength);
+    UA_LatencyHistogram_add(channel->cryptoStatistics,
+                            UA_DateTime_nowMonotonic() - start);
+    return res;
+}
+
 #endif /* UA_ENABLE_ENCRYPTION */
 
 void
@@ -432,13 +443,11 @@ verifySignature(const UA_SecureChannel *channel,
     return retval;
 }
 
-/* Sets the payload to a pointer inside the chunk buffer. Returns the requestId
- * and the sequenceNumber */
-UA_StatusCode
-decryptAndVerifyChunk(const UA_SecureChannel *channel,
-                      const UA_SecurityPolicyCryptoModule *cryptoModule,
-                      UA_MessageType messageType, UA_ByteString *chunk,
-                      size_t offset) {
+static UA_StatusCode
+decryptAndVerifyChunkInternal(const UA_SecureChannel *channel,
+                              const UA_SecurityPolicyCryptoModule *cryptoModule,
+                              UA_MessageType messageType, UA_ByteString *chunk,
+                              size_t offset) {
     /* Decrypt the chunk */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     if(channel->securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT ||
@@ -487,6 +496,26 @@ decryptAndVerifyChunk(const UA_SecureChannel *channel,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Sets the payload to a pointer inside the chunk buffer. Returns the requestId
+ * and the sequenceNumber */
+UA_StatusCode
+decryptAndVerifyChunk(const UA_SecureChannel *channel,
+                      const UA_SecurityPolicyCryptoModule *cryptoModule,
+                      UA_MessageType messageType, UA_ByteString *chunk,
+                      size_t offset) {
+    if(!channel->cryptoStatistics ||
+       (channel->securityMode == UA_MESSAGESECURITYMODE_NONE &&
+        messageType != UA_MESSAGETYPE_OPN))
+        return decryptAndVerifyChunkInternal(channel, cryptoModule,
+                                             messageType, chunk, offset);
+    UA_DateTime start = UA_DateTime_nowMonotonic();
+    UA_StatusCode res = decryptAndVerifyChunkInternal(channel, cryptoModule,
+                                                      messageType, chunk, offset);
+    UA_LatencyHistogram_add(channel->cryptoStatistics,
+                            UA_DateTime_nowMonotonic() - start);
+    return res;
+}
+
 UA_StatusCode
 checkAsymHeader(UA_SecureChannel *channel,
                 const UA_AsymmetricAlgorithmSecurityHeader *asymHeader) {
@@ -0,0 +1,170 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_threadpool.h"
+#include "ua_util_internal.h"
+
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+
+#include <pthread.h>
+
+struct UA_ThreadPool {
+    size_t threadsSize;
+    pthread_t *threads;
+
+    /* Only one batch of work at a time. Taken with trylock. */
+    pthread_mutex_t runMutex;
+
+    /* Protects the batch state and is used with the condition variables */
+    pthread_mutex_t mutex;
+    pthread_cond_t workCond; /* New batch posted or shutdown */
+    pthread_cond_t doneCond; /* The last index of the batch was processed */
+    UA_Boolean shutdown;
+
+    /* The current batch */
+    UA_ThreadPoolJob job;
+    void *context;
+    size_t count;   /* Number of indices */
+    size_t next;    /* Next index to be taken */
+    size_t pending; /* Indices taken but not yet processed */
+};
+
+/* Take and process indices until the batch is exhausted. Called with the mutex
+ * locked. Returns with the mutex locked. */
+static void
+processBatch(UA_ThreadPool *pool) {
+    while(pool->next < pool->count) {
+        size_t index = pool->next++;
+        UA_ThreadPoolJob job = pool->job;
+        void *context = pool->context;
+        pthread_mutex_unlock(&pool->mutex);
+        job(context, index);
+        pthread_mutex_lock(&pool->mutex);
+        pool->pending--;
+        if(pool->pending == 0)
+            pthread_cond_signal(&pool->doneCond);
+    }
+}
+
+static void *
+workerLoop(void *data) {
+    UA_ThreadPool *pool = (UA_ThreadPool*)data;
+    pthread_mutex_lock(&pool->mutex);
+    while(!pool->shutdown) {
+        if(pool->next >= pool->count) {
+            pthread_cond_wait(&pool->workCond, &pool->mutex);
+            continue;
+        }
+        processBatch(pool);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+UA_StatusCode
+UA_ThreadPool_new(UA_ThreadPool **pool, size_t threads) {
+    UA_ThreadPool *p = (UA_ThreadPool*)UA_calloc(1, sizeof(UA_ThreadPool));
+    UA_CHECK_MEM(p, return UA_STATUSCODE_BADOUTOFMEMORY);
+    if(threads > 0) {
+        p->threads = (pthread_t*)UA_calloc(threads, sizeof(pthread_t));
+        UA_CHECK_MEM(p->threads, UA_free(p); return UA_STATUSCODE_BADOUTOFMEMORY);
+    }
+
+    pthread_mutex_init(&p->runMutex, NULL);
+    pthread_mutex_init(&p->mutex, NULL);
+    pthread_cond_init(&p->workCond, NULL);
+    pthread_cond_init(&p->doneCond, NULL);
+
+    for(; p->threadsSize < threads; p->threadsSize++) {
+        if(pthread_create(&p->threads[p->threadsSize], NULL, workerLoop, p) != 0) {
+            UA_ThreadPool_delete(p);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+    }
+
+    *pool = p;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_ThreadPool_delete(UA_ThreadPool *pool) {
+    if(!pool)
+        return;
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->workCond);
+    pthread_mutex_unlock(&pool->mutex);
+    for(size_t i = 0; i < pool->threadsSize; i++)
+        pthread_join(pool->threads[i], NULL);
+    pthread_cond_destroy(&pool->doneCond);
+    pthread_cond_destroy(&pool->workCond);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_mutex_destroy(&pool->runMutex);
+    UA_free(pool->threads);
+    UA_free(pool);
+}
+
+size_t
+UA_ThreadPool_concurrency(const UA_ThreadPool *pool) {
+    return (pool) ? pool->threadsSize + 1 : 1;
+}
+
+void
+UA_ThreadPool_run(UA_ThreadPool *pool, UA_ThreadPoolJob job,
+                  void *context, size_t count) {
+    /* Sequential processing. Don't wake up the workers for a single index. */
+    if(!pool || pool->threadsSize == 0 || count < 2 ||
+       pthread_mutex_trylock(&pool->runMutex) != 0) {
+        for(size_t i = 0; i < count; i++)
+            job(context, i);
+        return;
+    }
+
+    /* Post the batch */
+    pthread_mutex_lock(&pool->mutex);
+    pool->job = job;
+    pool->context = context;
+    pool->count = count;
+    pool->next = 0;
+    pool->pending = count;
+    pthread_cond_broadcast(&pool->workCond);
+
+    /* Work on the batch and wait for the workers to finish */
+    processBatch(pool);
+    while(pool->pending > 0)
+        pthread_cond_wait(&pool->doneCond, &pool->mutex);
+
+    /* Reset so that the workers go back to sleep */
+    pool->job = NULL;
+    pool->context = NULL;
+    pool->count = 0;
+    pool->next = 0;
+    pthread_mutex_unlock(&pool->mutex);
+    pthread_mutex_unlock(&pool->runMutex);
+}
+
+#else /* UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX) */
+
+UA_StatusCode
+UA_ThreadPool_new(UA_ThreadPool **pool, size_t threads) {
+    return UA_STATUSCODE_BADNOTSUPPORTED;
+}
+
+void
+UA_ThreadPool_delete(UA_ThreadPool *pool) {}
+
+size_t
+UA_ThreadPool_concurrency(const UA_ThreadPool *pool) {
+    return 1;
+}
+
+void
+UA_ThreadPool_run(UA_ThreadPool *pool, UA_ThreadPoolJob job,
+                  void *context, size_t count) {
+    for(size_t i = 0; i < count; i++)
+        job(context, i);
+}
+
+#endif /* UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX) */
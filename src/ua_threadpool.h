@@ -0,0 +1,51 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_THREADPOOL_H_
+#define UA_THREADPOOL_H_
+
+#include <open62541/types.h>
+
+_UA_BEGIN_DECLS
+
+/**
+ * Thread Pool
+ * -----------
+ * A small pool of worker threads for data-parallel work inside the stack (e.g.
+ * the cryptography for the chunks of a large message). The pool executes a
+ * "parallel for" over an index range. The calling thread participates in the
+ * processing and the call returns only once all indices are processed.
+ *
+ * Worker threads are only available with UA_MULTITHREADING >= 100 on POSIX.
+ * Otherwise (and with a NULL pool) all work is done sequentially in the calling
+ * thread. The job function must not call back into the same pool. */
+
+struct UA_ThreadPool;
+typedef struct UA_ThreadPool UA_ThreadPool;
+
+typedef void (*UA_ThreadPoolJob)(void *context, size_t index);
+
+/* Create a pool with the given number of worker threads. Returns
+ * UA_STATUSCODE_BADNOTSUPPORTED if the architecture has no thread support. */
+UA_StatusCode
+UA_ThreadPool_new(UA_ThreadPool **pool, size_t threads);
+
+/* Stops and joins the worker threads */
+void
+UA_ThreadPool_delete(UA_ThreadPool *pool);
+
+/* Number of threads (including the calling thread) that can work in parallel */
+size_t
+UA_ThreadPool_concurrency(const UA_ThreadPool *pool);
+
+/* Execute job(context, i) for all i in [0, count). Blocks until done. If the
+ * pool is currently used by another thread, the work is done sequentially. */
+void
+UA_ThreadPool_run(UA_ThreadPool *pool, UA_ThreadPoolJob job,
+                  void *context, size_t count);
+
+_UA_END_DECLS
+
+#endif /* UA_THREADPOOL_H_ */
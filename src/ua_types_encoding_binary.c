@@ -33,7 +33,14 @@
  * Breaking a message up into chunks is integrated with the encoding. When the
  * end of a buffer is reached, a callback is executed that sends the current
  * buffer as a chunk and exchanges the encoding buffer "underneath" the ongoing
- * encoding. This reduces the RAM requirements and unnecessary copying. */
+ * encoding. This reduces the RAM requirements and unnecessary copying.
+ *
+ * Conversely, the decoding can read a message that is spread over several
+ * segments (e.g. the payloads of the received chunks) without assembling them
+ * first. When a primitive value straddles the boundary between two segments,
+ * the remaining bytes of the current segment are moved into the headroom in
+ * front of the next segment. So every decoding function can still operate on a
+ * contiguous range of memory. */
 
 /* Part 6 §5.1.5: Decoders shall support at least 100 nesting levels */
 #define UA_ENCODING_MAX_RECURSION 100
@@ -49,6 +56,15 @@ typedef struct {
     const UA_DataTypeArray *customTypes;
     UA_exchangeEncodeBuffer exchangeBufferCallback;
     void *exchangeBufferCallbackHandle;
+
+    /* Decoding from segments. The current segment is segments[segment]. Its
+     * first byte has the offset segmentOffset in the overall message. The
+     * segments after the current one contain segmentsRemaining bytes. */
+    const UA_ByteString *segments;
+    size_t segmentsSize;
+    size_t segment;
+    size_t segmentOffset;
+    size_t segmentsRemaining;
 } Ctx;
 
 typedef status
@@ -111,6 +127,56 @@ encodeWithExchangeBuffer(const void *ptr, const UA_DataType *type, Ctx *ctx) {
     return ret;
 }
 
+/* Continue decoding in the next segment until at least length bytes are
+ * available. The bytes left over in the current segment are moved into the
+ * headroom of the next segment. So they are contiguous with its content. */
+static UA_Boolean
+nextSegment(Ctx *ctx, size_t length) {
+    UA_assert(length <= UA_DECODE_SEGMENT_HEADROOM);
+    while(ctx->segment + 1 < ctx->segmentsSize) {
+        size_t left = (uintptr_t)ctx->end - (uintptr_t)ctx->pos;
+        UA_assert(left <= UA_DECODE_SEGMENT_HEADROOM);
+        const UA_ByteString *cur = &ctx->segments[ctx->segment];
+        const UA_ByteString *next = &ctx->segments[++ctx->segment];
+        ctx->segmentOffset += cur->length;
+        ctx->segmentsRemaining -= next->length;
+        u8 *start = next->data - left;
+        memmove(start, ctx->pos, left);
+        ctx->pos = start;
+        ctx->end = next->data + next->length;
+        if(ctx->pos + length <= ctx->end)
+            return true;
+    }
+    return false;
+}
+
+/* Ensure that the next length bytes can be read from ctx->pos */
+#define DECODE_ENSURE(length)                                           \
+    UA_CHECK(ctx->pos + (length) <= ctx->end || nextSegment(ctx, length), \
+             return UA_STATUSCODE_BADDECODINGERROR)
+
+/* Number of bytes left to be decoded over all segments */
+static UA_INLINE size_t
+decodeRemaining(const Ctx *ctx) {
+    return ((uintptr_t)ctx->end - (uintptr_t)ctx->pos) + ctx->segmentsRemaining;
+}
+
+/* Copy bytes that can span several segments */
+static status
+decodeBytes(Ctx *ctx, u8 *dst, size_t length) {
+    while(ctx->pos + length > ctx->end) {
+        size_t possible = (uintptr_t)ctx->end - (uintptr_t)ctx->pos;
+        memcpy(dst, ctx->pos, possible);
+        dst += possible;
+        length -= possible;
+        ctx->pos += possible;
+        UA_CHECK(nextSegment(ctx, 1), return UA_STATUSCODE_BADDECODINGERROR);
+    }
+    memcpy(dst, ctx->pos, length);
+    ctx->pos += length;
+    return UA_STATUSCODE_GOOD;
+}
+
 /*****************/
 /* Integer Types */
 /*****************/
@@ -178,7 +244,7 @@ ENCODE_BINARY(Boolean) {
 }
 
 DECODE_BINARY(Boolean) {
-    UA_CHECK(ctx->pos + 1 <= ctx->end, return UA_STATUSCODE_BADDECODINGERROR);
+    DECODE_ENSURE(1);
     *dst = (*ctx->pos > 0) ? true : false;
     ++ctx->pos;
     return UA_STATUSCODE_GOOD;
@@ -194,8 +260,7 @@ ENCODE_BINARY(Byte) {
 }
 
 DECODE_BINARY(Byte) {
-    UA_CHECK(ctx->pos + sizeof(u8) <= ctx->end,
-             return UA_STATUSCODE_BADDECODINGERROR);
+    DECODE_ENSURE(sizeof(u8));
     *dst = *ctx->pos;
     ++ctx->pos;
     return UA_STATUSCODE_GOOD;
@@ -215,8 +280,7 @@ ENCODE_BINARY(UInt16) {
 }
 
 DECODE_BINARY(UInt16) {
-    UA_CHECK(ctx->pos + sizeof(u16) <= ctx->end,
-             return UA_STATUSCODE_BADDECODINGERROR);
+    DECODE_ENSURE(sizeof(u16));
 #if UA_BINARY_OVERLAYABLE_INTEGER
     memcpy(dst, ctx->pos, sizeof(u16));
 #else
@@ -240,8 +304,7 @@ ENCODE_BINARY(UInt32) {
 }
 
 DECODE_BINARY(UInt32) {
-    UA_CHECK(ctx->pos + sizeof(u32) <= ctx->end,
-             return UA_STATUSCODE_BADDECODINGERROR);
+    DECODE_ENSURE(sizeof(u32));
 #if UA_BINARY_OVERLAYABLE_INTEGER
     memcpy(dst, ctx->pos, sizeof(u32));
 #else
@@ -265,8 +328,7 @@ ENCODE_BINARY(UInt64) {
 }
 
 DECODE_BINARY(UInt64) {
-    UA_CHECK(ctx->pos + sizeof(u64) <= ctx->end,
-             return UA_STATUSCODE_BADDECODINGERROR);
+    DECODE_ENSURE(sizeof(u64));
 #if UA_BINARY_OVERLAYABLE_INTEGER
     memcpy(dst, ctx->pos, sizeof(u64));
 #else
@@ -477,7 +539,7 @@ Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
      * is too small for the array length. This prevents the allocation of very
      * long arrays for bogus messages.*/
     size_t length = (size_t)signed_length;
-    UA_CHECK(ctx->pos + ((type->memSize * length) / 32) <= ctx->end,
+    UA_CHECK((type->memSize * length) / 32 <= decodeRemaining(ctx),
              return UA_STATUSCODE_BADDECODINGERROR);
 
     /* Allocate memory */
@@ -486,10 +548,8 @@ Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
 
     if(type->overlayable) {
         /* memcpy overlayable array */
-        UA_CHECK(ctx->pos + (type->memSize * length) <= ctx->end,
-                 UA_free(*dst); *dst = NULL; return UA_STATUSCODE_BADDECODINGERROR);
-        memcpy(*dst, ctx->pos, type->memSize * length);
-        ctx->pos += type->memSize * length;
+        ret = decodeBytes(ctx, (u8*)*dst, type->memSize * length);
+        UA_CHECK_STATUS(ret, UA_free(*dst); *dst = NULL; return ret);
     } else {
         /* Decode array members */
         uintptr_t ptr = (uintptr_t)*dst;
@@ -534,8 +594,7 @@ DECODE_BINARY(Guid) {
     ret |= DECODE_DIRECT(&dst->data1, UInt32);
     ret |= DECODE_DIRECT(&dst->data2, UInt16);
     ret |= DECODE_DIRECT(&dst->data3, UInt16);
-    UA_CHECK(ctx->pos + (8*sizeof(u8)) <= ctx->end,
-             return UA_STATUSCODE_BADDECODINGERROR);
+    DECODE_ENSURE(8*sizeof(u8));
     memcpy(dst->data4, ctx->pos, 8*sizeof(u8));
     ctx->pos += 8;
     return ret;
@@ -693,7 +752,7 @@ ENCODE_BINARY(ExpandedNodeId) {
 
 DECODE_BINARY(ExpandedNodeId) {
     /* Decode the encoding mask */
-    UA_CHECK(ctx->pos + 1 <= ctx->end, return UA_STATUSCODE_BADDECODINGERROR);
+    DECODE_ENSURE(1);
     u8 encoding = *ctx->pos;
 
     /* Decode the NodeId */
@@ -869,13 +928,15 @@ ExtensionObject_decodeBinaryContent(UA_ExtensionObject *dst, const UA_NodeId *ty
         return DECODE_DIRECT(&dst->content.encoded.body, String); /* ByteString */
     }
 
+    /* Jump over the length field (TODO: check if the decoded length matches) */
+    u32 length;
+    status ret = DECODE_DIRECT(&length, UInt32);
+    UA_CHECK_STATUS(ret, return ret);
+
     /* Allocate memory */
     dst->content.decoded.data = UA_new(type);
     UA_CHECK_MEM(dst->content.decoded.data, return UA_STATUSCODE_BADOUTOFMEMORY);
 
-    /* Jump over the length field (TODO: check if the decoded length matches) */
-    ctx->pos += 4;
-
     /* Decode */
     dst->encoding = UA_EXTENSIONOBJECT_DECODED;
     dst->content.decoded.type = type;
@@ -1012,8 +1073,9 @@ ENCODE_BINARY(Variant) {
 static status
 Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     /* Save the position in the ByteString. If unwrapping is not possible, start
-     * from here to decode a normal ExtensionObject. */
-    u8 *old_pos = ctx->pos;
+     * from here to decode a normal ExtensionObject. The segment is saved as
+     * well, as the position might move to the next segment. */
+    Ctx oldCtx = *ctx;
 
     /* Decode the DataType */
     UA_NodeId typeId;
@@ -1030,11 +1092,13 @@ Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     if(encoding == UA_EXTENSIONOBJECT_ENCODED_BYTESTRING &&
        (dst->type = UA_findDataTypeByBinaryInternal(&typeId, ctx)) != NULL) {
         /* Jump over the length field (TODO: check if length matches) */
-        ctx->pos += 4;
+        u32 length;
+        ret = DECODE_DIRECT(&length, UInt32);
+        UA_CHECK_STATUS(ret, UA_NodeId_clear(&typeId); return ret);
     } else {
         /* Reset and decode as ExtensionObject */
         dst->type = &UA_TYPES[UA_TYPES_EXTENSIONOBJECT];
-        ctx->pos = old_pos;
+        *ctx = oldCtx;
     }
     UA_NodeId_clear(&typeId);
 
@@ -1686,23 +1750,47 @@ const decodeBinarySignature decodeBinaryJumpTable[UA_DATATYPEKINDS] = {
 };
 
 status
-UA_decodeBinaryInternal(const UA_ByteString *src, size_t *offset,
-                        void *dst, const UA_DataType *type,
+UA_decodeBinarySegments(const UA_ByteString *segments, size_t segmentsSize,
+                        size_t *offset, void *dst, const UA_DataType *type,
                         const UA_DataTypeArray *customTypes) {
     /* Set up the context */
     Ctx ctx;
-    ctx.pos = &src->data[*offset];
-    ctx.end = &src->data[src->length];
     ctx.depth = 0;
     ctx.customTypes = customTypes;
+    ctx.segments = segments;
+    ctx.segmentsSize = segmentsSize;
+    ctx.segment = 0;
+    ctx.segmentOffset = 0;
+    ctx.segmentsRemaining = 0;
+
+    /* Find the segment with the offset. An offset at the end of a segment
+     * points there and not to the beginning of the next segment. */
+    for(size_t i = 1; i < segmentsSize; i++)
+        ctx.segmentsRemaining += segments[i].length;
+    while(ctx.segment + 1 < segmentsSize &&
+          *offset > ctx.segmentOffset + segments[ctx.segment].length) {
+        ctx.segmentOffset += segments[ctx.segment].length;
+        ctx.segment++;
+        ctx.segmentsRemaining -= segments[ctx.segment].length;
+    }
+    const UA_ByteString *seg = &segments[ctx.segment];
+    UA_CHECK(*offset <= ctx.segmentOffset + seg->length,
+             return UA_STATUSCODE_BADDECODINGERROR);
+    ctx.pos = &seg->data[*offset - ctx.segmentOffset];
+    ctx.end = &seg->data[seg->length];
 
     /* Decode */
     memset(dst, 0, type->memSize); /* Initialize the value */
     status ret = decodeBinaryJumpTable[type->typeKind](dst, type, &ctx);
 
     if(UA_LIKELY(ret == UA_STATUSCODE_GOOD)) {
-        /* Set the new offset */
-        *offset = (size_t)(ctx.pos - src->data) / sizeof(u8);
+        /* Set the new offset. The position can be in the headroom of the
+         * current segment (before its first byte). */
+        seg = &segments[ctx.segment];
+        if(ctx.pos >= seg->data)
+            *offset = ctx.segmentOffset + (size_t)(ctx.pos - seg->data);
+        else
+            *offset = ctx.segmentOffset - (size_t)(seg->data - ctx.pos);
     } else {
         /* Clean up */
         UA_clear(dst, type);
@@ -1711,6 +1799,13 @@ UA_decodeBinaryInternal(const UA_ByteString *src, size_t *offset,
     return ret;
 }
 
+status
+UA_decodeBinaryInternal(const UA_ByteString *src, size_t *offset,
+                        void *dst, const UA_DataType *type,
+                        const UA_DataTypeArray *customTypes) {
+    return UA_decodeBinarySegments(src, 1, offset, dst, type, customTypes);
+}
+
 UA_StatusCode
 UA_decodeBinary(const UA_ByteString *inBuf,
                 void *p, const UA_DataType *type,
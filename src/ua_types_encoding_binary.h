@@ -67,6 +67,28 @@ UA_decodeBinaryInternal(const UA_ByteString *src, size_t *offset,
                         const UA_DataTypeArray *customTypes)
     UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Bytes of writable memory required in front of every segment (except the
+ * first) for decoding from segments */
+#define UA_DECODE_SEGMENT_HEADROOM 8
+
+/* Decodes a scalar value from a message that is split into segments, as if the
+ * segments were concatenated. This avoids assembling a message from its chunks
+ * before decoding. A value may straddle the boundary between segments. Then the
+ * last bytes of a segment are moved into the UA_DECODE_SEGMENT_HEADROOM bytes
+ * in front of the next segment. So the memory before the segments is
+ * overwritten during decoding.
+ *
+ * @param segments The array of segments. Must not be NULL.
+ * @param segmentsSize The number of segments. Must be at least one.
+ * @param offset The current position in the concatenated segments. Must not be
+ *        NULL. The value is advanced as decoding progresses.
+ * The other arguments are as for UA_decodeBinaryInternal. */
+UA_StatusCode
+UA_decodeBinarySegments(const UA_ByteString *segments, size_t segmentsSize,
+                        size_t *offset, void *dst, const UA_DataType *type,
+                        const UA_DataTypeArray *customTypes)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 const UA_DataType *
 UA_findDataTypeByBinary(const UA_NodeId *typeId);
 
@@ -304,3 +304,30 @@ UA_KeyValueMap_delete(UA_KeyValuePair **map, size_t *mapSize,
         break;
     }
 }
+
+void
+UA_LatencyHistogram_add(UA_LatencyHistogram *h, UA_DateTime duration) {
+    size_t us = (duration > 0) ? (size_t)(duration / UA_DATETIME_USEC) : 0;
+    size_t bucket = 0;
+    while(bucket < UA_LATENCYHISTOGRAM_BUCKETS - 1 && (us >> bucket) > 0)
+        bucket++;
+    UA_atomic_addSize(&h->buckets[bucket], 1);
+    UA_atomic_addSize(&h->sum, us);
+    UA_atomic_addSize(&h->count, 1);
+}
+
+UA_UInt64
+UA_LatencyHistogram_quantile(const UA_LatencyHistogram *h, UA_Double q) {
+    if(h->count == 0)
+        return 0;
+    if(q > 1.0)
+        q = 1.0;
+    UA_Double rank = q * (UA_Double)h->count;
+    size_t seen = 0;
+    for(size_t i = 0; i < UA_LATENCYHISTOGRAM_BUCKETS - 1; i++) {
+        seen += h->buckets[i];
+        if((UA_Double)seen >= rank)
+            return (UA_UInt64)1 << i;
+    }
+    return (UA_UInt64)1 << (UA_LATENCYHISTOGRAM_BUCKETS - 1);
+}
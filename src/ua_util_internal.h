@@ -214,6 +214,11 @@ UA_findDataTypeWithCustom(const UA_NodeId *typeId,
 size_t UA_EXPORT
 getCountOfOptionalFields(const UA_DataType *type);
 
+/* Add a sample to the latency histogram. Uses atomic operations so that
+ * concurrent threads can record without holding a lock. */
+void
+UA_LatencyHistogram_add(UA_LatencyHistogram *h, UA_DateTime duration);
+
 /* Dump packet for debugging / fuzzing */
 #ifdef UA_DEBUG_DUMP_PKGS
 void UA_EXPORT
@@ -80,11 +80,68 @@ START_TEST(registerDuplicate) {
     el = NULL;
 } END_TEST
 
+#ifndef _WIN32
+static void
+socketCallback(UA_InterruptManager *im,
+               uintptr_t interruptHandle, void *interruptContext,
+               size_t instanceInfosSize, const UA_KeyValuePair *instanceInfos) {
+    char buf[16];
+    ssize_t len = read((int)interruptHandle, buf, sizeof(buf));
+    ck_assert(len > 0);
+    counter++;
+}
+
+START_TEST(watchSocket) {
+    counter = 0;
+    int fds[2];
+    ck_assert_int_eq(pipe(fds), 0);
+
+    UA_EventLoop *el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    UA_InterruptManager *im = UA_InterruptManager_new_POSIX_Socket(UA_STRING("sim"));
+    el->registerEventSource(el, &im->eventSource);
+
+    /* Registered before the EventLoop is started */
+    UA_StatusCode res =
+        im->registerInterrupt(im, (uintptr_t)fds[0], 0, NULL, socketCallback, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    el->start(el);
+
+    /* Nothing to read */
+    el->run(el, 0);
+    ck_assert_uint_eq(counter, 0);
+
+    ck_assert(write(fds[1], "x", 1) == 1);
+    el->run(el, 0);
+    ck_assert_uint_eq(counter, 1);
+
+    /* No further callback after the deregistration */
+    im->deregisterInterrupt(im, (uintptr_t)fds[0]);
+    ck_assert(write(fds[1], "x", 1) == 1);
+    el->run(el, 0);
+    ck_assert_uint_eq(counter, 1);
+
+    /* Stop the EventLoop */
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    el->free(el);
+    el = NULL;
+
+    close(fds[0]);
+    close(fds[1]);
+} END_TEST
+#endif
+
 int main(void) {
     Suite *s  = suite_create("Test EventLoop Interrupts");
     TCase *tc = tcase_create("test cases");
     tcase_add_test(tc, catchInterrupt);
     tcase_add_test(tc, registerDuplicate);
+#ifndef _WIN32
+    tcase_add_test(tc, watchSocket);
+#endif
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
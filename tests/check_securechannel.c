@@ -491,9 +491,10 @@ START_TEST(SecureChannel_sendSymmetricMessage_invalidParameters) {
 static UA_StatusCode
 process_callback(void *application, UA_SecureChannel *channel,
                  UA_MessageType messageType, UA_UInt32 requestId,
-                 UA_ByteString *message) {
+                 UA_ByteString *message, size_t messageSegments) {
     ck_assert_ptr_ne(message, NULL);
     ck_assert_ptr_ne(application, NULL);
+    ck_assert_uint_ne(messageSegments, 0);
     if(message == NULL || application == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     ck_assert_uint_ne(message->length, 0);
@@ -134,6 +134,78 @@ START_TEST(decodeShallFailWithTruncatedBufferButSurvive) {
 }
 END_TEST
 
+/* Decode a message that is split into segments of the given length. Every
+ * segment has the required headroom in front. */
+START_TEST(decodeSegmentsShallYieldDecode) {
+    // given
+    UA_ReadResponse resp;
+    UA_ReadResponse_init(&resp);
+    resp.responseHeader.timestamp = 12345678;
+    resp.results = (UA_DataValue*)UA_Array_new(4, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    resp.resultsSize = 4;
+    UA_Double doubles[5] = {1.0, 2.0, 3.0, 4.0, 5.0};
+    UA_Variant_setArrayCopy(&resp.results[0].value, doubles, 5, &UA_TYPES[UA_TYPES_DOUBLE]);
+    resp.results[0].hasValue = true;
+    resp.results[0].sourceTimestamp = 42;
+    resp.results[0].hasSourceTimestamp = true;
+    UA_String str = UA_STRING("A string that is longer than the segments");
+    UA_Variant_setScalarCopy(&resp.results[1].value, &str, &UA_TYPES[UA_TYPES_STRING]);
+    resp.results[1].hasValue = true;
+    UA_Range range = {-1.5, 1.5};
+    UA_Variant_setScalarCopy(&resp.results[2].value, &range, &UA_TYPES[UA_TYPES_RANGE]);
+    resp.results[2].hasValue = true;
+    UA_Guid guid = UA_Guid_random();
+    UA_Variant_setScalarCopy(&resp.results[3].value, &guid, &UA_TYPES[UA_TYPES_GUID]);
+    resp.results[3].hasValue = true;
+
+    UA_ByteString msg = UA_BYTESTRING_NULL;
+    UA_StatusCode retval = UA_encodeBinary(&resp, &UA_TYPES[UA_TYPES_READRESPONSE], &msg);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    // when
+    size_t segLen = (size_t)_i;
+    size_t segmentsSize = (msg.length + segLen - 1) / segLen;
+    UA_ByteString *segments = (UA_ByteString*)
+        UA_calloc(segmentsSize, sizeof(UA_ByteString));
+    UA_Byte **mem = (UA_Byte**)UA_calloc(segmentsSize, sizeof(UA_Byte*));
+    for(size_t i = 0; i < segmentsSize; i++) {
+        size_t len = segLen;
+        if(i == segmentsSize - 1)
+            len = msg.length - (i * segLen);
+        mem[i] = (UA_Byte*)UA_malloc(UA_DECODE_SEGMENT_HEADROOM + len);
+        segments[i].data = mem[i] + UA_DECODE_SEGMENT_HEADROOM;
+        segments[i].length = len;
+        memcpy(segments[i].data, &msg.data[i * segLen], len);
+    }
+
+    UA_ReadResponse resp2;
+    size_t offset = 0;
+    retval = UA_decodeBinarySegments(segments, segmentsSize, &offset, &resp2,
+                                     &UA_TYPES[UA_TYPES_READRESPONSE], NULL);
+
+    // then
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(offset, msg.length);
+    ck_assert(UA_order(&resp, &resp2, &UA_TYPES[UA_TYPES_READRESPONSE]) == UA_ORDER_EQ);
+
+    // the truncated message fails
+    UA_ReadResponse_clear(&resp2);
+    segments[segmentsSize - 1].length--;
+    offset = 0;
+    retval = UA_decodeBinarySegments(segments, segmentsSize, &offset, &resp2,
+                                     &UA_TYPES[UA_TYPES_READRESPONSE], NULL);
+    ck_assert_int_ne(retval, UA_STATUSCODE_GOOD);
+
+    // finally
+    for(size_t i = 0; i < segmentsSize; i++)
+        UA_free(mem[i]);
+    UA_free(mem);
+    UA_free(segments);
+    UA_ByteString_clear(&msg);
+    UA_ReadResponse_clear(&resp);
+}
+END_TEST
+
 #define RANDOM_TESTS 1000
 
 START_TEST(decodeScalarBasicTypeFromRandomBufferShallSucceed) {
@@ -241,6 +313,10 @@ int main(void) {
                         UA_TYPES_BOOLEAN, UA_TYPES_COUNT - 1);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("Segmented Buffers");
+    tcase_add_loop_test(tc, decodeSegmentsShallYieldDecode, 1, 17);
+    suite_add_tcase(s, tc);
+
     tc = tcase_create("Fuzzing with Random Buffers");
     tcase_add_loop_test(tc, decodeScalarBasicTypeFromRandomBufferShallSucceed,
                         UA_TYPES_BOOLEAN, UA_TYPES_DOUBLE);
@@ -169,6 +169,144 @@ START_TEST(Client_read) {
 }
 END_TEST
 
+#define STREAMED_RESULTS 3000
+
+/* Enough results to stream the response */
+START_TEST(Client_readStreamed) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ReadValueId rvi[STREAMED_RESULTS];
+    for(size_t i = 0; i < STREAMED_RESULTS; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        rvi[i].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
+    }
+    rvi[1].nodeId = UA_NODEID_STRING(1, "my.variable");
+    rvi[2].nodeId = UA_NODEID_NUMERIC(1, 12345678); /* Unknown */
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = STREAMED_RESULTS;
+    UA_ReadResponse response = UA_Client_Service_read(client, request);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, STREAMED_RESULTS);
+
+    ck_assert(response.results[0].hasValue);
+    ck_assert(response.results[0].value.type == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert(response.results[1].value.type == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_uint_eq(response.results[1].value.arrayLength, VARLENGTH);
+    UA_Int32 *var = (UA_Int32*)response.results[1].value.data;
+    for(size_t i = 0; i < VARLENGTH; i++)
+        ck_assert_uint_eq((size_t)var[i], i);
+    ck_assert_uint_eq(response.results[2].status, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    ck_assert(response.results[STREAMED_RESULTS-1].value.type ==
+              &UA_TYPES[UA_TYPES_INT32]);
+
+    UA_ReadResponse_clear(&response);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
+START_TEST(Client_browseStreamed) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_BrowseDescription bd[STREAMED_RESULTS];
+    for(size_t i = 0; i < STREAMED_RESULTS; i++) {
+        UA_BrowseDescription_init(&bd[i]);
+        bd[i].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+        bd[i].browseDirection = UA_BROWSEDIRECTION_FORWARD;
+        bd[i].resultMask = UA_BROWSERESULTMASK_ALL;
+    }
+
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.nodesToBrowse = bd;
+    request.nodesToBrowseSize = STREAMED_RESULTS;
+    UA_BrowseResponse response = UA_Client_Service_browse(client, request);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, STREAMED_RESULTS);
+    for(size_t i = 0; i < STREAMED_RESULTS; i++) {
+        ck_assert_uint_eq(response.results[i].statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(response.results[i].referencesSize,
+                          response.results[0].referencesSize);
+    }
+    ck_assert_uint_gt(response.results[0].referencesSize, 0);
+
+    UA_BrowseResponse_clear(&response);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
+START_TEST(Client_serviceStatistics) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Variant val;
+    for(size_t i = 0; i < 3; i++) {
+        retval = UA_Client_readValueAttribute(client, UA_NODEID_STRING(1, "my.variable"),
+                                              &val);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        UA_Variant_clear(&val);
+    }
+
+    /* C API */
+    UA_ServiceStatistics stats;
+    UA_Server_getServiceStatistics(server, &stats);
+    UA_ServiceLatencyStatistics *read = &stats.services[UA_SERVICEGROUP_READ];
+    ck_assert_uint_ge(read->decode.count, 3);
+    ck_assert_uint_ge(read->queueWait.count, 3);
+    ck_assert_uint_ge(read->execution.count, 3);
+    ck_assert_uint_ge(read->encode.count, 3);
+    ck_assert_uint_ge(read->send.count, 3);
+    ck_assert_uint_ge(stats.services[UA_SERVICEGROUP_SESSION].execution.count, 2);
+    ck_assert_uint_eq(stats.services[UA_SERVICEGROUP_WRITE].execution.count, 0);
+    ck_assert_uint_gt(stats.traffic.bytesReceived, 0);
+    ck_assert_uint_gt(stats.traffic.bytesSent, VARLENGTH * 3 * sizeof(UA_Int32));
+    ck_assert_uint_ge(stats.traffic.messagesReceived, stats.traffic.messagesSent);
+    ck_assert_uint_ge(stats.traffic.chunksSent, stats.traffic.messagesSent);
+
+    size_t buckets = 0;
+    for(size_t i = 0; i < UA_LATENCYHISTOGRAM_BUCKETS; i++)
+        buckets += read->send.buckets[i];
+    ck_assert_uint_eq(buckets, read->send.count);
+    ck_assert_uint_gt(UA_LatencyHistogram_quantile(&read->send, 0.99), 0);
+    ck_assert_uint_ge(UA_LatencyHistogram_quantile(&read->send, 1.0),
+                      UA_LatencyHistogram_quantile(&read->send, 0.5));
+
+    /* Diagnostics node */
+    retval = UA_Client_readValueAttribute(client,
+                 UA_NODEID_STRING(1, "ServiceStatistics.Read"), &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(val.type == &UA_TYPES[UA_TYPES_UINT64]);
+    ck_assert_uint_eq(val.arrayDimensionsSize, 2);
+    ck_assert_uint_eq(val.arrayDimensions[0], 5);
+    ck_assert_uint_eq(val.arrayDimensions[1], 2 + UA_LATENCYHISTOGRAM_BUCKETS);
+    ck_assert_uint_ge(((UA_UInt64*)val.data)[0], 4); /* Decode count */
+    UA_Variant_clear(&val);
+
+    retval = UA_Client_readValueAttribute(client,
+                 UA_NODEID_STRING(1, "ServiceStatistics.Traffic"), &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(val.arrayLength, 6);
+    ck_assert_uint_gt(((UA_UInt64*)val.data)[0], 0);
+    UA_Variant_clear(&val);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
 START_TEST(Client_renewSecureChannel) {
     UA_Client *client = UA_Client_new();
     UA_ClientConfig_setDefault(UA_Client_getConfig(client));
@@ -409,6 +547,9 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_client, Client_endpoints);
     tcase_add_test(tc_client, Client_endpoints_empty);
     tcase_add_test(tc_client, Client_read);
+    tcase_add_test(tc_client, Client_readStreamed);
+    tcase_add_test(tc_client, Client_browseStreamed);
+    tcase_add_test(tc_client, Client_serviceStatistics);
     suite_add_tcase(s,tc_client);
     TCase *tc_client_reconnect = tcase_create("Client Reconnect");
     tcase_add_checked_fixture(tc_client_reconnect, setup, teardown);
@@ -36,7 +36,7 @@ THREAD_CALLBACK(serverloop) {
     return 0;
 }
 
-static void setup(void) {
+static void setupServer(UA_UInt16 chunkCryptoThreads) {
     running = true;
 
     /* Load certificate and private key */
@@ -83,10 +83,23 @@ static void setup(void) {
     for(size_t i = 0; i < trustListSize; i++)
         UA_ByteString_clear(&trustList[i]);
 
+#if UA_MULTITHREADING >= 100
+    config->chunkCryptoThreads = chunkCryptoThreads;
+#endif
+
     UA_Server_run_startup(server);
     THREAD_CREATE(server_thread, serverloop);
 }
 
+static void setup(void) {
+    setupServer(0);
+}
+
+/* Encrypt and decrypt the chunks of large messages in parallel */
+static void setupParallel(void) {
+    setupServer(3);
+}
+
 static void teardown(void) {
     running = false;
     THREAD_JOIN(server_thread);
@@ -256,6 +269,78 @@ START_TEST(encryption_connect_pem) {
 }
 END_TEST
 
+#define LARGE_VALUE_LENGTH (1024 * 1024)
+
+START_TEST(encryption_large_message) {
+    UA_ByteString *trustList = NULL;
+    size_t trustListSize = 0;
+    UA_ByteString *revocationList = NULL;
+    size_t revocationListSize = 0;
+
+    UA_ByteString certificate;
+    certificate.length = CERT_DER_LENGTH;
+    certificate.data = CERT_DER_DATA;
+
+    UA_ByteString privateKey;
+    privateKey.length = KEY_DER_LENGTH;
+    privateKey.data = KEY_DER_DATA;
+
+    /* A variable holding a value that spans many chunks */
+    UA_ByteString large;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&large, LARGE_VALUE_LENGTH);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < large.length; i++)
+        large.data[i] = (UA_Byte)(i * 7);
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_Variant_setScalar(&attr.value, &large, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    UA_NodeId largeId = UA_NODEID_STRING(1, "large");
+    retval = UA_Server_addVariableNode(server, largeId,
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_QUALIFIEDNAME(1, "large"),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                       attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefaultEncryption(cc, certificate, privateKey,
+                                         trustList, trustListSize,
+                                         revocationList, revocationListSize);
+    cc->securityPolicyUri =
+        UA_STRING_ALLOC("http://opcfoundation.org/UA/SecurityPolicy#Basic256Sha256");
+    retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Response with many chunks */
+    UA_Variant val;
+    UA_Variant_init(&val);
+    retval = UA_Client_readValueAttribute(client, largeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&val, &UA_TYPES[UA_TYPES_BYTESTRING]));
+    ck_assert(UA_ByteString_equal((UA_ByteString*)val.data, &large));
+    UA_Variant_clear(&val);
+
+    /* Request with many chunks */
+    for(size_t i = 0; i < large.length; i++)
+        large.data[i] = (UA_Byte)(i * 13);
+    UA_Variant_setScalar(&val, &large, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    retval = UA_Client_writeValueAttribute(client, largeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    retval = UA_Client_readValueAttribute(client, largeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(UA_ByteString_equal((UA_ByteString*)val.data, &large));
+    UA_Variant_clear(&val);
+
+    UA_ByteString_clear(&large);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
 static Suite* testSuite_encryption(void) {
     Suite *s = suite_create("Encryption");
     TCase *tc_encryption = tcase_create("Encryption basic256sha256");
@@ -265,6 +350,13 @@ static Suite* testSuite_encryption(void) {
     tcase_add_test(tc_encryption, encryption_connect_pem);
 #endif /* UA_ENABLE_ENCRYPTION */
     suite_add_tcase(s,tc_encryption);
+
+    TCase *tc_parallel = tcase_create("Encryption basic256sha256 parallel chunks");
+    tcase_add_checked_fixture(tc_parallel, setupParallel, teardown);
+#ifdef UA_ENABLE_ENCRYPTION
+    tcase_add_test(tc_parallel, encryption_large_message);
+#endif /* UA_ENABLE_ENCRYPTION */
+    suite_add_tcase(s,tc_parallel);
     return s;
 }
 
@@ -0,0 +1,185 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/securitypolicy.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "certificates.h"
+#include "check.h"
+
+/* Sign+encrypt and decrypt+verify full chunks with the symmetric module of
+ * every security policy. The chunks pass from a "sending" to a "receiving"
+ * channel context with the same keys. The throughput is logged. */
+
+#define CHUNK_SIZE 8192
+#define CHUNK_COUNT 256
+
+UA_Server *server;
+
+static void setup(void) {
+    UA_ByteString certificate;
+    certificate.length = CERT_DER_LENGTH;
+    certificate.data = CERT_DER_DATA;
+
+    UA_ByteString privateKey;
+    privateKey.length = KEY_DER_LENGTH;
+    privateKey.data = KEY_DER_DATA;
+
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_StatusCode res =
+        UA_ServerConfig_setDefaultWithSecurityPolicies(config, 4840, &certificate,
+                                                       &privateKey, NULL, 0,
+                                                       NULL, 0, NULL, 0);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+static void
+fillKey(UA_ByteString *key, size_t length, UA_Byte seed) {
+    UA_StatusCode res = UA_ByteString_allocBuffer(key, length);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < length; i++)
+        key->data[i] = (UA_Byte)(seed + i);
+}
+
+/* Set the same keys as local keys of the sender and remote keys of the
+ * receiver */
+static void
+setKeys(const UA_SecurityPolicy *sp, void *sender, void *receiver, UA_Byte seed) {
+    const UA_SecurityPolicySymmetricModule *sm = &sp->symmetricModule;
+    UA_ByteString signingKey, encryptingKey, iv;
+    fillKey(&signingKey,
+            sm->cryptoModule.signatureAlgorithm.getLocalKeyLength(sender), seed);
+    fillKey(&encryptingKey,
+            sm->cryptoModule.encryptionAlgorithm.getLocalKeyLength(sender), seed);
+    fillKey(&iv, sm->cryptoModule.encryptionAlgorithm.getRemoteBlockSize(sender), seed);
+
+    const UA_SecurityPolicyChannelModule *cm = &sp->channelModule;
+    ck_assert_uint_eq(cm->setLocalSymSigningKey(sender, &signingKey), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cm->setLocalSymEncryptingKey(sender, &encryptingKey), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cm->setLocalSymIv(sender, &iv), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cm->setRemoteSymSigningKey(receiver, &signingKey), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cm->setRemoteSymEncryptingKey(receiver, &encryptingKey), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cm->setRemoteSymIv(receiver, &iv), UA_STATUSCODE_GOOD);
+
+    UA_ByteString_clear(&signingKey);
+    UA_ByteString_clear(&encryptingKey);
+    UA_ByteString_clear(&iv);
+}
+
+/* Sign and encrypt the chunk like the SecureChannel does. Then decrypt and
+ * verify. */
+static UA_StatusCode
+roundtrip(const UA_SecurityPolicy *sp, void *sender, void *receiver,
+          UA_ByteString *chunk, size_t plainLength) {
+    const UA_SecurityPolicyCryptoModule *cm = &sp->symmetricModule.cryptoModule;
+    UA_ByteString plain = {plainLength, chunk->data};
+    UA_ByteString signature = {chunk->length - plainLength, chunk->data + plainLength};
+    UA_ByteString data = *chunk;
+
+    UA_StatusCode res = cm->signatureAlgorithm.sign(sender, &plain, &signature);
+    res |= cm->encryptionAlgorithm.encrypt(sender, &data);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    data = *chunk;
+    res = cm->encryptionAlgorithm.decrypt(receiver, &data);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    return cm->signatureAlgorithm.verify(receiver, &plain, &signature);
+}
+
+START_TEST(encryption_throughput) {
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ByteString chunk;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&chunk, CHUNK_SIZE);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < config->securityPoliciesSize; i++) {
+        UA_SecurityPolicy *sp = &config->securityPolicies[i];
+        if(UA_String_equal(&sp->policyUri, &UA_SECURITY_POLICY_NONE_URI))
+            continue;
+
+        void *sender = NULL;
+        void *receiver = NULL;
+        res = sp->channelModule.newContext(sp, &sp->localCertificate, &sender);
+        res |= sp->channelModule.newContext(sp, &sp->localCertificate, &receiver);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        setKeys(sp, sender, receiver, 1);
+
+        /* Fill up the chunk with the signature at the end */
+        size_t sigSize = sp->symmetricModule.cryptoModule.signatureAlgorithm.
+            getLocalSignatureSize(sender);
+        size_t plainLength = CHUNK_SIZE - sigSize;
+        for(size_t j = 0; j < plainLength; j++)
+            chunk.data[j] = (UA_Byte)j;
+
+        clock_t start = clock();
+        for(size_t j = 0; j < CHUNK_COUNT; j++) {
+            res = roundtrip(sp, sender, receiver, &chunk, plainLength);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        }
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        /* The content survived the roundtrips */
+        for(size_t j = 0; j < plainLength; j++)
+            ck_assert_uint_eq(chunk.data[j], (UA_Byte)j);
+
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND,
+                    "%.*s: %.1f MB/s (sign+encrypt+decrypt+verify)",
+                    (int)sp->policyUri.length, (char*)sp->policyUri.data,
+                    (seconds > 0.0) ?
+                    (double)(CHUNK_SIZE * CHUNK_COUNT) / (seconds * 1024 * 1024) : 0.0);
+
+        /* New keys for the sender only. The cached contexts must not retain
+         * the old keys. */
+        setKeys(sp, sender, sender, 2);
+        res = roundtrip(sp, sender, receiver, &chunk, plainLength);
+        ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+
+        /* Both sides with the new keys */
+        setKeys(sp, sender, receiver, 2);
+        for(size_t j = 0; j < plainLength; j++)
+            chunk.data[j] = (UA_Byte)j;
+        res = roundtrip(sp, sender, receiver, &chunk, plainLength);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        sp->channelModule.deleteContext(sender);
+        sp->channelModule.deleteContext(receiver);
+    }
+
+    UA_ByteString_clear(&chunk);
+}
+END_TEST
+
+static Suite* testSuite_encryption_throughput(void) {
+    Suite *s = suite_create("Encryption Throughput");
+    TCase *tc_throughput = tcase_create("Symmetric throughput");
+    tcase_add_checked_fixture(tc_throughput, setup, teardown);
+#ifdef UA_ENABLE_ENCRYPTION
+    tcase_add_test(tc_throughput, encryption_throughput);
+#endif /* UA_ENABLE_ENCRYPTION */
+    suite_add_tcase(s,tc_throughput);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_encryption_throughput();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
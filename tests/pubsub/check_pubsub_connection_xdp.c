@@ -18,8 +18,12 @@
 
 #include <linux/bpf.h>
 #include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
 #include <sys/resource.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
 
 #include <check.h>
 
@@ -29,9 +33,26 @@
 #define             RECEIVE_QUEUE_2                    2
 #define             RECEIVE_QUEUE_3                    3
 #define             XDP_FLAG                           XDP_FLAGS_SKB_MODE
+#define             ETHERTYPE_UADP                     0xb62c
+#define             XDP_TEST_FRAMES                    100
 
 UA_Server *server = NULL;
 UA_String ethernetInterface;
+/* Optional peer interface for the send/receive tests. The tests use generic
+ * (SKB) XDP mode and can run on a veth pair in a network namespace:
+ *
+ *   ip netns add opcua-xdp
+ *   ip netns exec opcua-xdp ip link add veth0 type veth peer name veth1
+ *   ip netns exec opcua-xdp ip link set veth0 up
+ *   ip netns exec opcua-xdp ip link set veth1 up
+ *   ip netns exec opcua-xdp ./bin/tests/check_pubsub_connection_xdp veth0 veth1
+ *
+ * The frames are sent and received on the peer interface with an AF_PACKET
+ * socket. */
+char *peerInterface = NULL;
+
+/* The target MAC of MULTICAST_MAC_ADDRESS */
+static const UA_Byte targetMac[ETH_ALEN] = {0x01, 0x00, 0x5E, 0x00, 0x00, 0x01};
 
 static void setup(void) {
     server = UA_Server_new();
@@ -49,7 +70,7 @@ static void teardown(void) {
 
 static void
 usage(char *progname) {
-    printf("usage: %s <ethernet_interface> \n", progname);
+    printf("usage: %s <ethernet_interface> [<peer_interface>]\n", progname);
     printf("Provide the Interface parameter to run the application. Exiting \n");
 }
 
@@ -283,6 +304,143 @@ START_TEST(GetMaximalConnectionConfigurationAndCompareValues){
     UA_PubSubConnectionConfig_clear(&connectionConfig);
 } END_TEST
 
+static UA_StatusCode
+addXdpConnection(UA_NodeId *connectionIdent) {
+    UA_NetworkAddressUrlDataType networkAddressUrl = {ethernetInterface, UA_STRING(MULTICAST_MAC_ADDRESS)};
+    UA_KeyValuePair connectionOptions[4];
+    connectionOptions[0].key = UA_QUALIFIEDNAME(0, "enableXdpSocket");
+    UA_Boolean enableXdp = UA_TRUE;
+    UA_Variant_setScalar(&connectionOptions[0].value, &enableXdp, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    connectionOptions[1].key = UA_QUALIFIEDNAME(0, "xdpflag");
+    UA_UInt32 flags = XDP_FLAG;
+    UA_Variant_setScalar(&connectionOptions[1].value, &flags, &UA_TYPES[UA_TYPES_UINT32]);
+    connectionOptions[2].key = UA_QUALIFIEDNAME(0, "hwreceivequeue");
+    UA_UInt32 rxqueue = RECEIVE_QUEUE_0;
+    UA_Variant_setScalar(&connectionOptions[2].value, &rxqueue, &UA_TYPES[UA_TYPES_UINT32]);
+    connectionOptions[3].key = UA_QUALIFIEDNAME(0, "xdpbindflag");
+    UA_UInt16 bindflags = XDP_COPY; /* veth has no zero-copy support */
+    UA_Variant_setScalar(&connectionOptions[3].value, &bindflags, &UA_TYPES[UA_TYPES_UINT16]);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("XDP Connection");
+    connectionConfig.transportProfileUri = UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-eth-uadp");
+    connectionConfig.enabled = true;
+    connectionConfig.connectionPropertiesSize = 4;
+    connectionConfig.connectionProperties = connectionOptions;
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    return UA_Server_addPubSubConnection(server, &connectionConfig, connectionIdent);
+}
+
+/* Raw socket on the peer interface */
+static int
+openPeerSocket(struct sockaddr_ll *sll) {
+    int fd = socket(PF_PACKET, SOCK_RAW, htons(ETHERTYPE_UADP));
+    ck_assert_int_ge(fd, 0);
+    memset(sll, 0, sizeof(struct sockaddr_ll));
+    sll->sll_family = AF_PACKET;
+    sll->sll_protocol = htons(ETHERTYPE_UADP);
+    sll->sll_ifindex = (int)if_nametoindex(peerInterface);
+    sll->sll_halen = ETH_ALEN;
+    memcpy(sll->sll_addr, targetMac, ETH_ALEN);
+    ck_assert_int_eq(bind(fd, (struct sockaddr*)sll, sizeof(struct sockaddr_ll)), 0);
+    return fd;
+}
+
+static size_t receivedCount;
+static UA_Byte lastReceived;
+
+static UA_StatusCode
+countMessages(UA_PubSubChannel *channel, void *context, const UA_ByteString *buffer) {
+    ck_assert_uint_gt(buffer->length, 0);
+    /* The payload starts with the sequence number of the frame */
+    ck_assert_uint_eq(buffer->data[0], (UA_Byte)(lastReceived + 1));
+    lastReceived = buffer->data[0];
+    receivedCount++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Several frames are queued before the receive. They are all processed in one
+ * call (batches of descriptors) directly from the UMEM frames. Frames with a
+ * different target address are dropped and their UMEM frames recycled. */
+START_TEST(ReceiveMultipleFramesPerPoll){
+    if(!peerInterface)
+        return;
+    UA_NodeId connectionIdent;
+    ck_assert_int_eq(addXdpConnection(&connectionIdent), UA_STATUSCODE_GOOD);
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, connectionIdent);
+    ck_assert(connection && connection->channel);
+
+    struct sockaddr_ll sll;
+    int fd = openPeerSocket(&sll);
+
+    UA_Byte frame[64];
+    memset(frame, 0, sizeof(frame));
+    struct ether_header *eth = (struct ether_header*)frame;
+    eth->ether_type = htons(ETHERTYPE_UADP);
+    UA_Byte *payload = &frame[sizeof(struct ether_header)];
+
+    /* Send more frames than the fill ring holds over several rounds to
+     * exercise the recycling of the UMEM frames */
+    lastReceived = 0;
+    receivedCount = 0;
+    UA_Byte seq = 0;
+    for(size_t round = 0; round < 50; round++) {
+        for(size_t i = 0; i < XDP_TEST_FRAMES; i++) {
+            /* Every tenth frame goes to a different target */
+            if(i % 10 == 9) {
+                memset(eth->ether_dhost, 0xaa, ETH_ALEN);
+                payload[0] = 0;
+            } else {
+                memcpy(eth->ether_dhost, targetMac, ETH_ALEN);
+                payload[0] = ++seq;
+            }
+            ck_assert_int_eq(sendto(fd, frame, sizeof(frame), 0,
+                                    (struct sockaddr*)&sll, sizeof(sll)),
+                             (ssize_t)sizeof(frame));
+        }
+
+        size_t expected = receivedCount + (XDP_TEST_FRAMES / 10 * 9);
+        for(size_t tries = 0; receivedCount < expected && tries < 10; tries++)
+            connection->channel->receive(connection->channel, NULL, countMessages,
+                                         NULL, 100000);
+        ck_assert_uint_eq(receivedCount, expected);
+    }
+
+    close(fd);
+} END_TEST
+
+/* Sending uses a separate set of UMEM frames that are returned from the
+ * completion ring. Send more messages than there are tx frames. */
+START_TEST(SendRecyclesFrames){
+    if(!peerInterface)
+        return;
+    UA_NodeId connectionIdent;
+    ck_assert_int_eq(addXdpConnection(&connectionIdent), UA_STATUSCODE_GOOD);
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, connectionIdent);
+    ck_assert(connection && connection->channel);
+
+    struct sockaddr_ll sll;
+    int fd = openPeerSocket(&sll);
+
+    UA_Byte payload[100];
+    memset(payload, 0, sizeof(payload));
+    UA_ByteString buf = {sizeof(payload), payload};
+    size_t received = 0;
+    UA_Byte frame[256];
+    for(size_t i = 0; i < 5000; i++) {
+        ck_assert_int_eq(connection->channel->send(connection->channel, NULL, &buf),
+                         UA_STATUSCODE_GOOD);
+        while(recv(fd, frame, sizeof(frame), MSG_DONTWAIT) > 0)
+            received++;
+    }
+    ck_assert_uint_gt(received, 0);
+    close(fd);
+} END_TEST
+
 int main(int argc, char **argv) {
     if (argc < 2) {
         usage(argv[0]);
@@ -294,6 +452,8 @@ int main(int argc, char **argv) {
             return EXIT_SUCCESS;
         }
         ethernetInterface = UA_STRING(argv[1]);
+        if(argc > 2)
+            peerInterface = argv[2];
     }
 
     TCase *tc_add_pubsub_connections_minimal_config = tcase_create("Create PubSub XDP Connections with minimal valid config");
@@ -314,10 +474,16 @@ int main(int argc, char **argv) {
     tcase_add_test(tc_add_pubsub_connections_maximal_config, AddSingleConnectionWithMaximalConfiguration);
     tcase_add_test(tc_add_pubsub_connections_maximal_config, GetMaximalConnectionConfigurationAndCompareValues);
 
+    TCase *tc_xdp_send_receive = tcase_create("Send and receive with PubSub XDP Connections");
+    tcase_add_checked_fixture(tc_xdp_send_receive, setup, teardown);
+    tcase_add_test(tc_xdp_send_receive, ReceiveMultipleFramesPerPoll);
+    tcase_add_test(tc_xdp_send_receive, SendRecyclesFrames);
+
     Suite *s = suite_create("PubSub XDP connection creation");
     suite_add_tcase(s, tc_add_pubsub_connections_minimal_config);
     suite_add_tcase(s, tc_add_pubsub_connections_invalid_config);
     suite_add_tcase(s, tc_add_pubsub_connections_maximal_config);
+    suite_add_tcase(s, tc_xdp_send_receive);
 
     SRunner *sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
@@ -0,0 +1,363 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+#include <open62541/plugin/pubsub_udp.h>
+
+#include "ua_pubsub.h"
+#include "ua_pubsub_networkmessage.h"
+#include "thread_wrapper.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#define EXCHANGE_ITERATIONS 1000000
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdentifier, publishedDataSetIdent, writerGroupIdent,
+    dataSetWriterIdent, dataSetFieldIdent, readerGroupIdentifier, readerIdentifier;
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+    UA_ServerConfig_addPubSubTransportLayer(config, UA_PubSubTransportLayerUDPMP());
+    UA_Server_run_startup(server);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+/* All parts of the Guid are derived from the counter. A torn read shows up as
+ * an inconsistent Guid. */
+static void
+counterToGuid(UA_UInt32 counter, UA_Guid *guid) {
+    guid->data1 = counter;
+    guid->data2 = (UA_UInt16)counter;
+    guid->data3 = (UA_UInt16)(counter >> 16);
+    for(size_t i = 0; i < 8; i++)
+        guid->data4[i] = (UA_Byte)(counter + i);
+}
+
+static UA_Boolean
+guidIsConsistent(const UA_Guid *guid) {
+    UA_Guid expected;
+    counterToGuid(guid->data1, &expected);
+    return UA_Guid_equal(guid, &expected);
+}
+
+START_TEST(InitRejectsTypesWithPointers) {
+    UA_PubSubExchangeBuffer eb;
+    ck_assert_int_eq(UA_PubSubExchangeBuffer_init(&eb, &UA_TYPES[UA_TYPES_STRING]),
+                     UA_STATUSCODE_BADNOTSUPPORTED);
+    ck_assert_int_eq(UA_PubSubExchangeBuffer_init(&eb, &UA_TYPES[UA_TYPES_UINT32]),
+                     UA_STATUSCODE_GOOD);
+    ck_assert(eb.value.hasValue);
+    ck_assert(UA_Variant_hasScalarType(&eb.value.value, &UA_TYPES[UA_TYPES_UINT32]));
+    ck_assert_uint_eq(*(UA_UInt32*)eb.value.value.data, 0);
+    UA_PubSubExchangeBuffer_clear(&eb);
+} END_TEST
+
+START_TEST(ReadLatestValue) {
+    UA_PubSubExchangeBuffer eb;
+    ck_assert_int_eq(UA_PubSubExchangeBuffer_init(&eb, &UA_TYPES[UA_TYPES_UINT32]),
+                     UA_STATUSCODE_GOOD);
+    void *data = eb.value.value.data;
+
+    /* Nothing written yet */
+    ck_assert(!UA_PubSubExchangeBuffer_read(&eb));
+
+    /* The latest value wins */
+    for(UA_UInt32 i = 1; i <= 5; i++)
+        UA_PubSubExchangeBuffer_write(&eb, &i);
+    ck_assert(UA_PubSubExchangeBuffer_read(&eb));
+    ck_assert_uint_eq(*(UA_UInt32*)eb.value.value.data, 5);
+
+    /* No new value. The last value is kept. */
+    ck_assert(!UA_PubSubExchangeBuffer_read(&eb));
+    ck_assert_uint_eq(*(UA_UInt32*)eb.value.value.data, 5);
+
+    /* Alternate writes and reads */
+    for(UA_UInt32 i = 6; i < 20; i++) {
+        UA_PubSubExchangeBuffer_write(&eb, &i);
+        ck_assert(UA_PubSubExchangeBuffer_read(&eb));
+        ck_assert_uint_eq(*(UA_UInt32*)eb.value.value.data, i);
+    }
+
+    /* The value storage does not move */
+    ck_assert_ptr_eq(eb.value.value.data, data);
+    UA_PubSubExchangeBuffer_clear(&eb);
+} END_TEST
+
+static UA_PubSubExchangeBuffer threadBuffer;
+
+THREAD_CALLBACK(produce) {
+    UA_Guid guid;
+    for(UA_UInt32 i = 1; i <= EXCHANGE_ITERATIONS; i++) {
+        counterToGuid(i, &guid);
+        UA_PubSubExchangeBuffer_write(&threadBuffer, &guid);
+    }
+    return 0;
+}
+
+START_TEST(ConcurrentProducerConsumer) {
+    ck_assert_int_eq(UA_PubSubExchangeBuffer_init(&threadBuffer, &UA_TYPES[UA_TYPES_GUID]),
+                     UA_STATUSCODE_GOOD);
+
+    THREAD_HANDLE producer;
+    THREAD_CREATE(producer, produce);
+
+    /* Consume until the last value arrived. Every value is complete and the
+     * values never go back in time. */
+    UA_UInt32 last = 0;
+    size_t reads = 0;
+    const UA_Guid *guid = (const UA_Guid*)threadBuffer.value.value.data;
+    while(last < EXCHANGE_ITERATIONS) {
+        if(!UA_PubSubExchangeBuffer_read(&threadBuffer))
+            continue;
+        reads++;
+        ck_assert(guidIsConsistent(guid));
+        ck_assert_uint_gt(guid->data1, last);
+        last = guid->data1;
+    }
+
+    THREAD_JOIN(producer);
+    ck_assert_uint_gt(reads, 0);
+    UA_PubSubExchangeBuffer_clear(&threadBuffer);
+} END_TEST
+
+typedef struct {
+    UA_ByteString *buffer;
+    size_t offset;
+} UA_ReceiveContext;
+
+static UA_StatusCode
+recvTestFun(UA_PubSubChannel *channel, void *context, const UA_ByteString *buffer) {
+    UA_ReceiveContext *ctx = (UA_ReceiveContext*)context;
+    memcpy(ctx->buffer->data + ctx->offset, buffer->data, buffer->length);
+    ctx->offset += buffer->length;
+    ctx->buffer->length = ctx->offset;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+receiveSingleMessageRT(UA_PubSubConnection *connection, UA_DataSetReader *dsr) {
+    UA_ByteString buffer;
+    ck_assert_int_eq(UA_ByteString_allocBuffer(&buffer, 512), UA_STATUSCODE_GOOD);
+    ck_assert(connection->channel != NULL);
+
+    UA_ReceiveContext testCtx = {&buffer, 0};
+    UA_StatusCode res =
+        connection->channel->receive(connection->channel, NULL,
+                                     recvTestFun, &testCtx, 1000000);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_gt(buffer.length, 0);
+
+    size_t currentPosition = 0;
+    res = UA_NetworkMessage_updateBufferedNwMessage(&dsr->bufferedMessage,
+                                                    &buffer, &currentPosition);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, dsr->linkedReaderGroup);
+    UA_DataSetReader_process(server, rg, dsr,
+                             dsr->bufferedMessage.nm->payload.dataSetPayload.dataSetMessages);
+
+    UA_DataSetMessage *dsm = dsr->bufferedMessage.nm->payload.dataSetPayload.dataSetMessages;
+    if(dsm->header.fieldEncoding == UA_FIELDENCODING_VARIANT) {
+        for(UA_UInt16 i = 0; i < dsm->data.keyFrameData.fieldCount; i++)
+            UA_Variant_clear(&dsm->data.keyFrameData.dataSetFields[i].value);
+    }
+
+    buffer.length = 512;
+    UA_ByteString_clear(&buffer);
+}
+
+/* The RT publisher takes the value from an exchange buffer. The RT subscriber
+ * writes the received value into another exchange buffer. */
+START_TEST(PublishSubscribeWithExchangeBuffers) {
+    UA_PubSubExchangeBuffer pubBuffer, subBuffer;
+    ck_assert_int_eq(UA_PubSubExchangeBuffer_init(&pubBuffer, &UA_TYPES[UA_TYPES_UINT32]),
+                     UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(UA_PubSubExchangeBuffer_init(&subBuffer, &UA_TYPES[UA_TYPES_UINT32]),
+                     UA_STATUSCODE_GOOD);
+
+    /* Connection */
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherId.numeric = 2234;
+    ck_assert_int_eq(UA_Server_addPubSubConnection(server, &connectionConfig,
+                                                   &connectionIdentifier),
+                     UA_STATUSCODE_GOOD);
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, connectionIdentifier);
+
+    /* PublishedDataSet with a field from the exchange buffer */
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("Demo PDS");
+    ck_assert_int_eq(UA_Server_addPublishedDataSet(server, &pdsConfig,
+                                                   &publishedDataSetIdent).addResult,
+                     UA_STATUSCODE_GOOD);
+
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.field.variable.fieldNameAlias = UA_STRING("Published UInt32");
+    dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = UA_TRUE;
+    dsfConfig.field.variable.rtValueSource.exchangeBuffer = &pubBuffer;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    ck_assert_int_eq(UA_Server_addDataSetField(server, publishedDataSetIdent, &dsfConfig,
+                                               &dataSetFieldIdent).result,
+                     UA_STATUSCODE_GOOD);
+
+    /* WriterGroup and DataSetWriter */
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    ck_assert_int_eq(UA_Server_addWriterGroup(server, connectionIdentifier,
+                                              &writerGroupConfig, &writerGroupIdent),
+                     UA_STATUSCODE_GOOD);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 62541;
+    ck_assert_int_eq(UA_Server_addDataSetWriter(server, writerGroupIdent,
+                                                publishedDataSetIdent,
+                                                &dataSetWriterConfig, &dataSetWriterIdent),
+                     UA_STATUSCODE_GOOD);
+
+    /* ReaderGroup and DataSetReader with the target in the exchange buffer */
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+    readerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    ck_assert_int_eq(UA_Server_addReaderGroup(server, connectionIdentifier,
+                                              &readerGroupConfig, &readerGroupIdentifier),
+                     UA_STATUSCODE_GOOD);
+
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader Test");
+    UA_UInt16 publisherIdentifier = 2234;
+    readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+    readerConfig.publisherId.data = &publisherIdentifier;
+    readerConfig.writerGroupId = 100;
+    readerConfig.dataSetWriterId = 62541;
+    readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    readerConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+    UA_UadpDataSetReaderMessageDataType *dsrm = UA_UadpDataSetReaderMessageDataType_new();
+    dsrm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    readerConfig.messageSettings.content.decoded.data = dsrm;
+
+    UA_DataSetMetaDataType *pMetaData = &readerConfig.dataSetMetaData;
+    UA_DataSetMetaDataType_init(pMetaData);
+    pMetaData->name = UA_STRING("DataSet Test");
+    pMetaData->fieldsSize = 1;
+    pMetaData->fields = (UA_FieldMetaData*)
+        UA_Array_new(pMetaData->fieldsSize, &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+    pMetaData->fields[0].dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    pMetaData->fields[0].builtInType = UA_NS0ID_UINT32;
+    pMetaData->fields[0].valueRank = -1; /* scalar */
+
+    UA_FieldTargetVariable targetVariable;
+    memset(&targetVariable, 0, sizeof(UA_FieldTargetVariable));
+    targetVariable.targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+    targetVariable.exchangeBuffer = &subBuffer;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize = 1;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariables = &targetVariable;
+    ck_assert_int_eq(UA_Server_addDataSetReader(server, readerGroupIdentifier,
+                                                &readerConfig, &readerIdentifier),
+                     UA_STATUSCODE_GOOD);
+    UA_UadpDataSetReaderMessageDataType_delete(dsrm);
+    UA_free(pMetaData->fields);
+
+    ck_assert_int_eq(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdentifier),
+                     UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent),
+                     UA_STATUSCODE_GOOD);
+
+    /* Publish two values and receive them */
+    UA_DataSetReader *dsr = UA_ReaderGroup_findDSRbyId(server, readerIdentifier);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+    ck_assert_uint_eq(wg->exchangeBuffersSize, 1);
+    for(UA_UInt32 v = 1000; v < 1002; v++) {
+        UA_PubSubExchangeBuffer_write(&pubBuffer, &v);
+        ck_assert_int_eq(UA_Server_setWriterGroupOperational(server, writerGroupIdent),
+                         UA_STATUSCODE_GOOD);
+        receiveSingleMessageRT(connection, dsr);
+        ck_assert_int_eq(UA_Server_setWriterGroupDisabled(server, writerGroupIdent),
+                         UA_STATUSCODE_GOOD);
+
+        ck_assert(UA_PubSubExchangeBuffer_read(&subBuffer));
+        ck_assert_uint_eq(*(UA_UInt32*)subBuffer.value.value.data, v);
+    }
+
+    ck_assert_int_eq(UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdentifier),
+                     UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupIdent),
+                     UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(wg->exchangeBuffersSize, 0);
+
+    /* Remove the PubSub configuration before the buffers are cleared */
+    UA_Server_removePubSubConnection(server, connectionIdentifier);
+    UA_PubSubExchangeBuffer_clear(&pubBuffer);
+    UA_PubSubExchangeBuffer_clear(&subBuffer);
+} END_TEST
+
+int main(void) {
+    TCase *tc_buffer = tcase_create("PubSub exchange buffer");
+    tcase_add_test(tc_buffer, InitRejectsTypesWithPointers);
+    tcase_add_test(tc_buffer, ReadLatestValue);
+    tcase_add_test(tc_buffer, ConcurrentProducerConsumer);
+    tcase_set_timeout(tc_buffer, 60);
+
+    TCase *tc_rt = tcase_create("PubSub RT with exchange buffers");
+    tcase_add_checked_fixture(tc_rt, setup, teardown);
+    tcase_add_test(tc_rt, PublishSubscribeWithExchangeBuffers);
+
+    Suite *s = suite_create("PubSub exchange buffer");
+    suite_add_tcase(s, tc_buffer);
+    suite_add_tcase(s, tc_rt);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -13,6 +13,8 @@
 #include "ua_pubsub_networkmessage.h"
 #include <server/ua_server_internal.h>
 
+#include "testing_clock.h"
+
 #include <check.h>
 #include <stdio.h>
 
@@ -309,6 +311,66 @@ START_TEST(PublishSingleFieldWithFixedOffsets) {
         UA_Server_delete(server);
     } END_TEST
 
+START_TEST(PublishDeterministicCycles) {
+        ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
+        UA_WriterGroupConfig writerGroupConfig;
+        memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+        writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+        writerGroupConfig.publishingInterval = 10;
+        writerGroupConfig.enabled = UA_FALSE;
+        writerGroupConfig.writerGroupId = 100;
+        writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+        writerGroupConfig.rtLevel = UA_PUBSUB_RT_DETERMINISTIC;
+        UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+        wgm->networkMessageContentMask = UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+        writerGroupConfig.messageSettings.content.decoded.data = wgm;
+        writerGroupConfig.messageSettings.content.decoded.type =
+            &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+        writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+        ck_assert(UA_Server_addWriterGroup(server, connectionIdentifier, &writerGroupConfig, &writerGroupIdent) == UA_STATUSCODE_GOOD);
+        UA_UadpWriterGroupMessageDataType_delete(wgm);
+        UA_DataSetWriterConfig dataSetWriterConfig;
+        memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+        dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+        dataSetWriterConfig.dataSetWriterId = 62541;
+        UA_DataSetFieldConfig dsfConfig;
+        memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+        UA_UInt32 *intValue = UA_UInt32_new();
+        *intValue = (UA_UInt32) 1000;
+        UA_DataValue *dataValue = UA_DataValue_new();
+        UA_Variant_setScalar(&dataValue->value, intValue, &UA_TYPES[UA_TYPES_UINT32]);
+        dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = UA_TRUE;
+        dsfConfig.field.variable.rtValueSource.staticValueSource = &dataValue;
+        dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        ck_assert(UA_Server_addDataSetField(server, publishedDataSetIdent, &dsfConfig, &dataSetFieldIdent).result == UA_STATUSCODE_GOOD);
+        ck_assert(UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent, &dataSetWriterConfig, &dataSetWriterIdent) == UA_STATUSCODE_GOOD);
+
+        ck_assert(UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent) == UA_STATUSCODE_GOOD);
+        ck_assert(UA_Server_setWriterGroupOperational(server, writerGroupIdent) == UA_STATUSCODE_GOOD);
+
+        /* Publish in every cycle */
+        for(size_t i = 0; i < 5; i++) {
+            UA_fakeSleep(10);
+            UA_Server_run_iterate(server, false);
+        }
+        UA_WriterGroupCycleStatistics stats;
+        ck_assert(UA_Server_WriterGroup_getCycleStatistics(server, writerGroupIdent, &stats) == UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(stats.cycles, 6); /* Including the first run */
+        ck_assert_uint_eq(stats.deadlineMisses, 0);
+        ck_assert_uint_eq(stats.jitter.count, 6);
+
+        /* Two cycles are skipped */
+        UA_fakeSleep(30);
+        UA_Server_run_iterate(server, false);
+        ck_assert(UA_Server_WriterGroup_getCycleStatistics(server, writerGroupIdent, &stats) == UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(stats.cycles, 7);
+        ck_assert_uint_eq(stats.deadlineMisses, 2);
+
+        ck_assert(UA_Server_setWriterGroupDisabled(server, writerGroupIdent) == UA_STATUSCODE_GOOD);
+        ck_assert(UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupIdent) == UA_STATUSCODE_GOOD);
+        UA_DataValue_delete(dataValue);
+    } END_TEST
+
 START_TEST(PublishPDSWithMultipleFieldsAndFixedOffset) {
         ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
         UA_PubSubConnection *connection = UA_PubSubConnection_findConnectionbyId(server, connectionIdentifier);
@@ -654,9 +716,14 @@ int main(void) {
     tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishPDSWithMultipleFieldsAndFixedOffset);
     tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishSingleFieldInCustomCallback);
 
+    TCase *tc_pubsub_rt_deterministic = tcase_create("PubSub RT deterministic publish");
+    tcase_add_checked_fixture(tc_pubsub_rt_deterministic, setup, teardown);
+    tcase_add_test(tc_pubsub_rt_deterministic, PublishDeterministicCycles);
+
     Suite *s = suite_create("PubSub RT configuration levels");
     suite_add_tcase(s, tc_pubsub_rt_static_value_source);
     suite_add_tcase(s, tc_pubsub_rt_fixed_offsets);
+    suite_add_tcase(s, tc_pubsub_rt_deterministic);
 
     SRunner *sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
@@ -10,6 +10,7 @@
 #include <open62541/server_pubsub.h>
 
 #include "ua_server_internal.h"
+#include "testing_clock.h"
 
 #include <check.h>
 
@@ -402,6 +403,436 @@ START_TEST(CheckSingleDSMRawEncodedMessage){
     UA_NetworkMessage_clear(&networkMessages[1]);
 } END_TEST
 
+static UA_StatusCode
+countTestFun(UA_PubSubChannel *channel, void *context, const UA_ByteString *buffer) {
+    size_t *counter = (size_t*)context;
+    (*counter)++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Count the batches before they are handed to the transport */
+static UA_StatusCode
+(*channelSendBatch)(UA_PubSubChannel *channel, size_t bufsSize,
+                    const UA_ByteString *bufs);
+static size_t sendBatchCalls;
+static size_t sendBatchMessages;
+
+static UA_StatusCode
+countSendBatch(UA_PubSubChannel *channel, size_t bufsSize,
+               const UA_ByteString *bufs) {
+    sendBatchCalls++;
+    sendBatchMessages += bufsSize;
+    return channelSendBatch(channel, bufsSize, bufs);
+}
+
+START_TEST(CheckBatchedWriterGroups){
+    UA_PubSubConnection *connection = UA_PubSubConnection_findConnectionbyId(server, connection1);
+    ck_assert(connection);
+    UA_StatusCode rv = connection->channel->regist(connection->channel, NULL, NULL);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+    ck_assert(connection->channel->sendBatch != NULL);
+    channelSendBatch = connection->channel->sendBatch;
+    connection->channel->sendBatch = countSendBatch;
+    sendBatchCalls = 0;
+    sendBatchMessages = 0;
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+    dataSetWriterConfig.keyFrameCount = 1;
+
+    /* Three WriterGroups with the same interval on one connection. Each sends
+     * out once directly when it becomes operational. */
+    for(UA_UInt16 i = 0; i < 3; i++) {
+        writerGroupConfig.writerGroupId = (UA_UInt16)(100 + i);
+        UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroupIdent);
+        dataSetWriterConfig.dataSetWriterId = (UA_UInt16)(10 + i);
+        UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                   &dataSetWriterConfig, &dataSetWriterIdent);
+        UA_Server_setWriterGroupOperational(server, writerGroupIdent);
+    }
+    ck_assert(connection->sendBatch == NULL);
+    ck_assert_uint_eq(sendBatchCalls, 0);
+
+    size_t counter = 0;
+    connection->channel->receive(connection->channel, NULL, countTestFun,
+                                 &counter, 80000);
+    ck_assert_uint_eq(counter, 3);
+
+    /* The cyclic callbacks are batched. The batch is sent in a timed callback
+     * after the WriterGroups that were due. */
+    UA_fakeSleep(11);
+    UA_Server_run_iterate(server, false);
+    ck_assert(connection->sendBatch == NULL);
+    ck_assert_uint_eq(sendBatchCalls, 1);
+    ck_assert_uint_eq(sendBatchMessages, 3);
+
+    counter = 0;
+    connection->channel->receive(connection->channel, NULL, countTestFun,
+                                 &counter, 80000);
+    ck_assert_uint_eq(counter, 3);
+    connection->channel->sendBatch = channelSendBatch;
+} END_TEST
+
+START_TEST(CheckTemplatedNetworkMessage){
+    UA_PubSubConnection *connection = UA_PubSubConnection_findConnectionbyId(server, connection1);
+    ck_assert(connection);
+    UA_StatusCode rv = connection->channel->regist(connection->channel, NULL, NULL);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.maxEncapsulatedDataSetMessageCount = 10;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_SEQUENCENUMBER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroupIdent);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 10;
+    dataSetWriterConfig.keyFrameCount = 1;
+    UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                               &dataSetWriterConfig, &dataSetWriterIdent);
+
+    /* The first message is encoded in full and kept as the template */
+    UA_Server_setWriterGroupOperational(server, writerGroupIdent);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+    ck_assert(wg);
+    ck_assert_uint_eq(wg->templatesSize, 1);
+    ck_assert_uint_gt(wg->templates[0].buffer.length, 0);
+    const UA_Byte *templateData = wg->templates[0].buffer.data;
+
+    UA_ByteString buffer = UA_BYTESTRING("");
+    UA_NetworkMessage networkMessage;
+    receiveAvailableMessages(buffer, connection, &networkMessage);
+    UA_UInt16 sequenceNumber = networkMessage.groupHeader.sequenceNumber;
+    UA_Byte_delete(networkMessage.payload.dataSetPayload.dataSetMessages[0].data.keyFrameData.rawFields.data);
+    UA_NetworkMessage_clear(&networkMessage);
+
+    /* The next cycles patch the template */
+    for(size_t i = 1; i <= 3; i++) {
+        UA_fakeSleep(10);
+        UA_Server_run_iterate(server, false);
+        ck_assert_uint_eq(wg->templatesSize, 1);
+        ck_assert_ptr_eq(wg->templates[0].buffer.data, templateData);
+        receiveAvailableMessages(buffer, connection, &networkMessage);
+        ck_assert_uint_eq(networkMessage.publisherId.publisherIdUInt16, 62541);
+        ck_assert_uint_eq(networkMessage.groupHeader.writerGroupId, 100);
+        ck_assert_uint_eq(networkMessage.groupHeader.sequenceNumber,
+                          (UA_UInt16)(sequenceNumber + i));
+        ck_assert_uint_eq(networkMessage.payloadHeader.dataSetPayloadHeader.count, 1);
+        UA_DataSetMessage *dsm = &networkMessage.payload.dataSetPayload.dataSetMessages[0];
+        ck_assert_uint_eq(dsm->data.keyFrameData.fieldCount, 1);
+        ck_assert(dsm->data.keyFrameData.dataSetFields[0].value.type ==
+                  &UA_TYPES[UA_TYPES_DATETIME]);
+        ck_assert_int_eq(*(UA_DateTime*)dsm->data.keyFrameData.dataSetFields[0].value.data,
+                         UA_DateTime_now());
+        UA_Byte_delete(dsm->data.keyFrameData.rawFields.data);
+        UA_NetworkMessage_clear(&networkMessage);
+    }
+} END_TEST
+
+START_TEST(CheckZeroCopyVariableField){
+    UA_PubSubConnection *connection = UA_PubSubConnection_findConnectionbyId(server, connection1);
+    ck_assert(connection);
+    UA_StatusCode rv = connection->channel->regist(connection->channel, NULL, NULL);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+
+    /* A plain variable is published without copying the value */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_String value = UA_STRING("initial");
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_STRING]);
+    UA_NodeId variableId;
+    rv = UA_Server_addVariableNode(server, UA_NODEID_NULL,
+                                   UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                   UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                   UA_QUALIFIEDNAME(1, "Published String"),
+                                   UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                   attr, NULL, &variableId);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig publishedDataSetConfig;
+    memset(&publishedDataSetConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    publishedDataSetConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    publishedDataSetConfig.name = UA_STRING("Zero-Copy PDS");
+    UA_NodeId pdsId;
+    UA_Server_addPublishedDataSet(server, &publishedDataSetConfig, &pdsId);
+
+    UA_DataSetFieldConfig dataSetFieldConfig;
+    memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Published String");
+    dataSetFieldConfig.field.variable.publishParameters.publishedVariable = variableId;
+    dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_NodeId fieldId;
+    UA_Server_addDataSetField(server, pdsId, &dataSetFieldConfig, &fieldId);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroupIdent);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 10;
+    dataSetWriterConfig.keyFrameCount = 1;
+    UA_Server_addDataSetWriter(server, writerGroupIdent, pdsId,
+                               &dataSetWriterConfig, &dataSetWriterIdent);
+    UA_Server_setWriterGroupOperational(server, writerGroupIdent);
+
+    const char *values[3] = {"initial", "second", "a longer third value"};
+    UA_ByteString buffer = UA_BYTESTRING("");
+    UA_NetworkMessage networkMessage;
+    for(size_t i = 0; i < 3; i++) {
+        if(i > 0) {
+            /* Replace the value between the cycles */
+            value = UA_STRING((char*)(uintptr_t)values[i]);
+            UA_Variant v;
+            UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_STRING]);
+            rv = UA_Server_writeValue(server, variableId, v);
+            ck_assert(rv == UA_STATUSCODE_GOOD);
+            UA_fakeSleep(10);
+            UA_Server_run_iterate(server, false);
+        }
+
+        receiveAvailableMessages(buffer, connection, &networkMessage);
+        UA_DataSetMessage *dsm = &networkMessage.payload.dataSetPayload.dataSetMessages[0];
+        ck_assert_uint_eq(dsm->data.keyFrameData.fieldCount, 1);
+        UA_DataValue *dv = &dsm->data.keyFrameData.dataSetFields[0];
+        ck_assert(dv->value.type == &UA_TYPES[UA_TYPES_STRING]);
+        UA_String expected = UA_STRING((char*)(uintptr_t)values[i]);
+        ck_assert(UA_String_equal((UA_String*)dv->value.data, &expected));
+        UA_Byte_delete(dsm->data.keyFrameData.rawFields.data);
+        UA_NetworkMessage_clear(&networkMessage);
+    }
+
+    /* The node value is untouched by the publisher */
+    UA_Variant v;
+    rv = UA_Server_readValue(server, variableId, &v);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+    ck_assert(UA_String_equal((UA_String*)v.data, &value));
+    UA_Variant_clear(&v);
+} END_TEST
+
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+static UA_Int32
+deltaFieldValue(const UA_DataSetMessage_DeltaFrameField *dff) {
+    ck_assert(dff->fieldValue.value.type == &UA_TYPES[UA_TYPES_INT32]);
+    return *(UA_Int32*)dff->fieldValue.value.data;
+}
+
+START_TEST(CheckDeltaFrameWrittenFields){
+    UA_PublishedDataSetConfig publishedDataSetConfig;
+    memset(&publishedDataSetConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    publishedDataSetConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    publishedDataSetConfig.name = UA_STRING("Delta Frame PDS");
+    UA_NodeId pdsId;
+    UA_Server_addPublishedDataSet(server, &publishedDataSetConfig, &pdsId);
+
+    /* Plain variables are tracked by the Write service */
+    UA_NodeId variableIds[4];
+    for(UA_Int32 i = 0; i < 4; i++) {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        UA_Variant_setScalar(&attr.value, &i, &UA_TYPES[UA_TYPES_INT32]);
+        UA_StatusCode rv =
+            UA_Server_addVariableNode(server, UA_NODEID_NULL,
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, "Published Int32"),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                      attr, NULL, &variableIds[i]);
+        ck_assert(rv == UA_STATUSCODE_GOOD);
+
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Published Int32");
+        dataSetFieldConfig.field.variable.publishParameters.publishedVariable = variableIds[i];
+        dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        UA_Server_addDataSetField(server, pdsId, &dataSetFieldConfig, NULL);
+    }
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroupIdent);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 10;
+    dataSetWriterConfig.keyFrameCount = 10;
+    UA_Server_addDataSetWriter(server, writerGroupIdent, pdsId,
+                               &dataSetWriterConfig, &dataSetWriterIdent);
+    UA_DataSetWriter *dsw = UA_DataSetWriter_findDSWbyId(server, dataSetWriterIdent);
+    ck_assert(dsw);
+    ck_assert_uint_eq(dsw->untrackedSamplesCount, 0);
+
+    /* The first DataSetMessage is a keyframe */
+    UA_DataSetMessage dsm;
+    UA_StatusCode rv = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw, false);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATAKEYFRAME);
+    ck_assert_uint_eq(dsm.data.keyFrameData.fieldCount, 4);
+    UA_DataSetMessage_clear(&dsm);
+
+    /* Nothing was written */
+    rv = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw, false);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    ck_assert_uint_eq(dsm.data.deltaFrameData.fieldCount, 0);
+    UA_DataSetMessage_clear(&dsm);
+
+    /* Only the written fields are contained. Once, with the latest value. */
+    UA_Int32 values[3] = {42, 7, 43};
+    size_t written[3] = {2, 0, 2};
+    for(size_t i = 0; i < 3; i++) {
+        UA_Variant v;
+        UA_Variant_setScalar(&v, &values[i], &UA_TYPES[UA_TYPES_INT32]);
+        rv = UA_Server_writeValue(server, variableIds[written[i]], v);
+        ck_assert(rv == UA_STATUSCODE_GOOD);
+    }
+    rv = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw, false);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    ck_assert_uint_eq(dsm.data.deltaFrameData.fieldCount, 2);
+    UA_DataSetMessage_DeltaFrameField *dff = dsm.data.deltaFrameData.deltaFrameFields;
+    ck_assert_uint_eq(dff[0].fieldIndex, 2);
+    ck_assert_int_eq(deltaFieldValue(&dff[0]), 43);
+    ck_assert_uint_eq(dff[1].fieldIndex, 0);
+    ck_assert_int_eq(deltaFieldValue(&dff[1]), 7);
+    UA_DataSetMessage_clear(&dsm);
+
+    /* The changes were consumed */
+    rv = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw, false);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    ck_assert_uint_eq(dsm.data.deltaFrameData.fieldCount, 0);
+    UA_DataSetMessage_clear(&dsm);
+
+    /* Removing the writer removes the tracking */
+    UA_Server_removeDataSetWriter(server, dataSetWriterIdent);
+    ck_assert(server->pubSubManager.trackedVariables.root == NULL);
+} END_TEST
+#endif
+
+#if UA_MULTITHREADING >= 100
+START_TEST(CheckParallelEncoding){
+    UA_PubSubConnection *connection = UA_PubSubConnection_findConnectionbyId(server, connection1);
+    ck_assert(connection);
+    UA_StatusCode rv = connection->channel->regist(connection->channel, NULL, NULL);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+
+    /* Usually started from pubSubConfig.encodingThreads */
+    rv = UA_ThreadPool_new(&server->pubSubManager.encodingPool, 2);
+    ck_assert(rv == UA_STATUSCODE_GOOD);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.maxEncapsulatedDataSetMessageCount = 3;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_SEQUENCENUMBER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroupIdent);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+
+    /* Four writers -> two NetworkMessages */
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+    dataSetWriterConfig.keyFrameCount = 1;
+    for(UA_UInt16 i = 0; i < 4; i++) {
+        dataSetWriterConfig.dataSetWriterId = (UA_UInt16)(10 + i);
+        UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                   &dataSetWriterConfig, &dataSetWriterIdent);
+    }
+    UA_Server_setWriterGroupOperational(server, writerGroupIdent);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+    ck_assert(wg);
+
+    /* The DataSetMessages are sent in the order of the writers */
+    UA_UInt16 writerIds[4];
+    size_t writersSize = 0;
+    UA_DataSetWriter *dsw;
+    LIST_FOREACH(dsw, &wg->writers, listEntry)
+        writerIds[writersSize++] = dsw->config.dataSetWriterId;
+    ck_assert_uint_eq(writersSize, 4);
+
+    for(size_t cycle = 0; cycle < 3; cycle++) {
+        if(cycle > 0) {
+            UA_fakeSleep(10);
+            UA_Server_run_iterate(server, false);
+        }
+        ck_assert_uint_eq(wg->templatesSize, 2);
+
+        UA_NetworkMessage networkMessages[2];
+        UA_ReceiveContext ctx = {0, networkMessages};
+        rv = connection->channel->receive(connection->channel, NULL, recvTestFun,
+                                          &ctx, 80000);
+        ck_assert(rv == UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(ctx.counter, 2);
+
+        /* The payload order is preserved */
+        size_t pos = 0;
+        UA_UInt16 sequenceNumber = networkMessages[0].groupHeader.sequenceNumber;
+        for(size_t i = 0; i < 2; i++) {
+            UA_NetworkMessage *nm = &networkMessages[i];
+            ck_assert_uint_eq(nm->groupHeader.sequenceNumber, sequenceNumber + i);
+            UA_Byte count = nm->payloadHeader.dataSetPayloadHeader.count;
+            ck_assert_uint_eq(count, (i == 0) ? 3 : 1);
+            for(UA_Byte k = 0; k < count; k++) {
+                ck_assert_uint_eq(nm->payloadHeader.dataSetPayloadHeader.dataSetWriterIds[k],
+                                  writerIds[pos]);
+                pos++;
+                UA_Byte_delete(nm->payload.dataSetPayload.dataSetMessages[k].
+                               data.keyFrameData.rawFields.data);
+            }
+            UA_NetworkMessage_clear(nm);
+        }
+    }
+} END_TEST
+#endif
+
 int main(void) {
     TCase *tc_add_pubsub_DSMandNMcalculation = tcase_create("PubSub NM and DSM");
     tcase_add_checked_fixture(tc_add_pubsub_DSMandNMcalculation, setup, teardown);
@@ -412,9 +843,22 @@ int main(void) {
     tcase_add_checked_fixture(tc_raw_encoded_messages, setup, teardown);
     tcase_add_test(tc_raw_encoded_messages, CheckSingleDSMRawEncodedMessage);
 
+    TCase *tc_publish_cycles = tcase_create("Publish cycles");
+    tcase_add_checked_fixture(tc_publish_cycles, setup, teardown);
+    tcase_add_test(tc_publish_cycles, CheckBatchedWriterGroups);
+    tcase_add_test(tc_publish_cycles, CheckTemplatedNetworkMessage);
+    tcase_add_test(tc_publish_cycles, CheckZeroCopyVariableField);
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+    tcase_add_test(tc_publish_cycles, CheckDeltaFrameWrittenFields);
+#endif
+#if UA_MULTITHREADING >= 100
+    tcase_add_test(tc_publish_cycles, CheckParallelEncoding);
+#endif
+
     Suite *s = suite_create("PubSub NM and DSM calculation");
     suite_add_tcase(s, tc_add_pubsub_DSMandNMcalculation);
     suite_add_tcase(s, tc_raw_encoded_messages);
+    suite_add_tcase(s, tc_publish_cycles);
 
     SRunner *sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
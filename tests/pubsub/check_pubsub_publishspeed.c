@@ -88,10 +88,92 @@ START_TEST(PublishSpeedTest) {
 
 } END_TEST
 
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+/* Large DataSet with sparse changes. The delta frames only contain (and only
+ * sample) the written variables. */
+#define DELTAFRAME_FIELDS 1000
+#define DELTAFRAME_CHANGES 10
+#define DELTAFRAME_CYCLES 2000
+
+START_TEST(PublishDeltaFrameSpeedTest) {
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet 2");
+    UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSet2);
+
+    UA_NodeId *variables = (UA_NodeId*)
+        UA_calloc(DELTAFRAME_FIELDS, sizeof(UA_NodeId));
+    ck_assert(variables != NULL);
+    for(UA_Int32 i = 0; i < DELTAFRAME_FIELDS; i++) {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        UA_Variant_setScalar(&attr.value, &i, &UA_TYPES[UA_TYPES_INT32]);
+        UA_StatusCode retval =
+            UA_Server_addVariableNode(server, UA_NODEID_NULL,
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, "Variable"),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                      attr, NULL, &variables[i]);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Variable");
+        dataSetFieldConfig.field.variable.publishParameters.publishedVariable = variables[i];
+        dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        UA_Server_addDataSetField(server, publishedDataSet2, &dataSetFieldConfig, NULL);
+    }
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup 2");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroup2);
+    UA_Server_setWriterGroupOperational(server, writerGroup2);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter 2");
+    dataSetWriterConfig.keyFrameCount = 100;
+    UA_Server_addDataSetWriter(server, writerGroup2, publishedDataSet2,
+                               &dataSetWriterConfig, &dataSetWriter2);
+
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroup2);
+
+    printf("start sending %d publish messages with %d of %d fields changed\n",
+           DELTAFRAME_CYCLES, DELTAFRAME_CHANGES, DELTAFRAME_FIELDS);
+
+    clock_t writeTime = 0, publishTime = 0;
+    for(UA_Int32 i = 0; i < DELTAFRAME_CYCLES; i++) {
+        clock_t begin = clock();
+        for(UA_Int32 j = 0; j < DELTAFRAME_CHANGES; j++) {
+            UA_Variant value;
+            UA_Variant_setScalar(&value, &i, &UA_TYPES[UA_TYPES_INT32]);
+            UA_Server_writeValue(server, variables[UA_UInt32_random() % DELTAFRAME_FIELDS],
+                                 value);
+        }
+        clock_t middle = clock();
+        UA_WriterGroup_publishCallback(server, wg);
+        writeTime += middle - begin;
+        publishTime += clock() - middle;
+    }
+
+    printf("duration of the writes was %f s\n", (double)writeTime / CLOCKS_PER_SEC);
+    printf("duration of the publishing was %f s\n", (double)publishTime / CLOCKS_PER_SEC);
+    UA_free(variables);
+} END_TEST
+#endif
+
 int main(void) {
     TCase *tc_publishspeed = tcase_create("Speed of the publisher");
     tcase_add_checked_fixture(tc_publishspeed, setup, teardown);
     tcase_add_test(tc_publishspeed, PublishSpeedTest);
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+    tcase_add_test(tc_publishspeed, PublishDeltaFrameSpeedTest);
+#endif
 
     Suite *s = suite_create("PubSub Speed Test");
     suite_add_tcase(s, tc_publishspeed);
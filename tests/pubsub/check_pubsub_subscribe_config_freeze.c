@@ -264,12 +264,88 @@ START_TEST(CreateLockAndEditConfiguration) {
     ck_assert(retval == UA_STATUSCODE_GOOD);
     } END_TEST
 
+START_TEST(CacheFieldTypesOnFreeze) {
+    UA_NodeId connection1, readerGroup1, dataSetReader1;
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl = {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri = UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_Server_addPubSubConnection(server, &connectionConfig, &connection1);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(readerGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup 1");
+    readerGroupConfig.rtLevel = UA_PUBSUB_RT_NONE;
+    UA_Server_addReaderGroup(server, connection1, &readerGroupConfig, &readerGroup1);
+
+    /* Int32, Double and a custom DataType that is not yet known */
+    UA_DataType customType = UA_TYPES[UA_TYPES_INT32];
+    customType.typeId = UA_NODEID_NUMERIC(1, 4242);
+    UA_DataSetReaderConfig dataSetReaderConfig;
+    memset(&dataSetReaderConfig, 0, sizeof(dataSetReaderConfig));
+    dataSetReaderConfig.name = UA_STRING("DataSetReader 1");
+    UA_DataSetMetaDataType *pMetaData = &dataSetReaderConfig.dataSetMetaData;
+    UA_DataSetMetaDataType_init(pMetaData);
+    pMetaData->name = UA_STRING("DataSet Test");
+    pMetaData->fieldsSize = 3;
+    pMetaData->fields = (UA_FieldMetaData*)UA_Array_new(pMetaData->fieldsSize,
+                         &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+    pMetaData->fields[0].dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    pMetaData->fields[0].builtInType = UA_NS0ID_INT32;
+    pMetaData->fields[0].valueRank = -1; /* scalar */
+    pMetaData->fields[1].dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
+    pMetaData->fields[1].builtInType = UA_NS0ID_DOUBLE;
+    pMetaData->fields[1].valueRank = -1; /* scalar */
+    pMetaData->fields[2].dataType = customType.typeId;
+    pMetaData->fields[2].builtInType = UA_NS0ID_INT32;
+    pMetaData->fields[2].valueRank = -1; /* scalar */
+    UA_StatusCode retval =
+        UA_Server_addDataSetReader(server, readerGroup1, &dataSetReaderConfig, &dataSetReader1);
+    UA_free(pMetaData->fields);
+    ck_assert(retval == UA_STATUSCODE_GOOD);
+
+    UA_DataSetReader *dataSetReader = UA_ReaderGroup_findDSRbyId(server, dataSetReader1);
+    ck_assert(dataSetReader != NULL);
+    ck_assert(dataSetReader->fieldTypes == NULL);
+
+    /* The types are resolved when the configuration is frozen. So the custom
+     * DataType added after the reader is found. */
+    UA_DataTypeArray customDataTypes = {NULL, 1, &customType};
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->customDataTypes = &customDataTypes;
+
+    retval = UA_Server_freezeReaderGroupConfiguration(server, readerGroup1);
+    ck_assert(retval == UA_STATUSCODE_GOOD);
+    ck_assert(dataSetReader->fieldTypes != NULL);
+    ck_assert(dataSetReader->fieldTypes[0] == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert(dataSetReader->fieldTypes[1] == &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert(dataSetReader->fieldTypes[2] == &customType);
+
+    /* The cache is released with the freeze */
+    retval = UA_Server_unfreezeReaderGroupConfiguration(server, readerGroup1);
+    ck_assert(retval == UA_STATUSCODE_GOOD);
+    ck_assert(dataSetReader->fieldTypes == NULL);
+
+    /* Without the custom DataType, the field stays unresolved */
+    config->customDataTypes = NULL;
+    retval = UA_Server_freezeReaderGroupConfiguration(server, readerGroup1);
+    ck_assert(retval == UA_STATUSCODE_GOOD);
+    ck_assert(dataSetReader->fieldTypes[0] == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert(dataSetReader->fieldTypes[2] == NULL);
+    retval = UA_Server_unfreezeReaderGroupConfiguration(server, readerGroup1);
+    ck_assert(retval == UA_STATUSCODE_GOOD);
+    } END_TEST
+
 int main(void) {
     TCase *tc_lock_configuration = tcase_create("Create and Lock");
     tcase_add_checked_fixture(tc_lock_configuration, setup, teardown);
     tcase_add_test(tc_lock_configuration, CreateAndLockConfiguration);
     tcase_add_test(tc_lock_configuration, CreateAndReleaseMultipleLocks);
     tcase_add_test(tc_lock_configuration, CreateLockAndEditConfiguration);
+    tcase_add_test(tc_lock_configuration, CacheFieldTypesOnFreeze);
 
     Suite *s = suite_create("PubSub subscriber configuration lock mechanism");
     suite_add_tcase(s, tc_lock_configuration);
@@ -26,7 +26,7 @@ static UA_DataValue *pFastPathSubscriberValue = 0;
 
 /***************************************************************************************************/
 /***************************************************************************************************/
-static void setup(void) {
+static void setupServer(UA_Boolean socketEvents) {
 
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "\n\nsetup\n\n");
 
@@ -42,12 +42,30 @@ static void setup(void) {
     UA_ServerConfig_setDefault(config);
     UA_ServerConfig_addPubSubTransportLayer(config, UA_PubSubTransportLayerUDPMP());
 
+    /* Without the socket InterruptManager, the ReaderGroups poll their
+     * socket in a cyclic callback */
+    if(!socketEvents) {
+        UA_EventLoop *el = config->eventLoop;
+        UA_EventSource *es = el->findEventSource(el, UA_STRING("pubsub-sockets"));
+        ck_assert(es != NULL);
+        ck_assert(el->deregisterEventSource(el, es) == UA_STATUSCODE_GOOD);
+        es->free(es);
+    }
+
     UA_StatusCode res = UA_Server_run_startup(server);
     ck_assert(UA_STATUSCODE_GOOD == res);
 
     UseFastPath = UA_FALSE;
 }
 
+static void setup(void) {
+    setupServer(UA_TRUE);
+}
+
+static void setup_polling(void) {
+    setupServer(UA_FALSE);
+}
+
 /***************************************************************************************************/
 static void teardown(void) {
 
@@ -838,13 +856,10 @@ static void PubSubStateChangeCallback_wrong_timeout (
 }
 
 /***************************************************************************************************/
-START_TEST(Test_wrong_timeout) {
-
-    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "\n\nSTART: Test_wrong_timeout");
-
-    /* 
-        Connection 1: WG1 : DSW1    --> Connection 1: RG1 : DSR1
-    */
+/* Connection 1: WG1 : DSW1    --> Connection 1: RG1 : DSR1
+   The reader receives the messages, but always too late. Returns the state
+   of the reader after the late message. */
+static UA_PubSubState RunWrongTimeout(void) {
 
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "prepare configuration");
 
@@ -920,13 +935,108 @@ START_TEST(Test_wrong_timeout) {
     /* then there should have happened another timeout */
     ck_assert_int_eq(2, CallbackCnt);
 
-    /* DataSetReader state toggles from error to operational, because it receives messages but always too late */
     ck_assert(UA_Server_DataSetReader_getState(server, DSRId_Conn1_RG1_DSR1, &state) == UA_STATUSCODE_GOOD);
-    ck_assert(state == UA_PUBSUBSTATE_ERROR);
+    return state;
+}
+
+/***************************************************************************************************/
+START_TEST(Test_wrong_timeout) {
+
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "\n\nSTART: Test_wrong_timeout");
+
+    /* DataSetReader state toggles from error to operational, because it receives messages but always too late */
+    ck_assert(RunWrongTimeout() == UA_PUBSUBSTATE_ERROR);
 
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "END: Test_wrong_timeout\n\n");
 } END_TEST
 
+/***************************************************************************************************/
+START_TEST(Test_wrong_timeout_socket_event) {
+
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "\n\nSTART: Test_wrong_timeout_socket_event");
+
+    /* The timeout is recorded before the late message. The message arrives
+     * in the same iteration and is processed right away on the socket event.
+     * So the reader is operational again, but the timeout was counted. */
+    ck_assert(RunWrongTimeout() == UA_PUBSUBSTATE_OPERATIONAL);
+
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "END: Test_wrong_timeout_socket_event\n\n");
+} END_TEST
+
+/***************************************************************************************************/
+START_TEST(Test_socket_event_reader_groups) {
+
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "\n\nSTART: Test_socket_event_reader_groups");
+
+    /* 
+        Connection 1: WG1 : DSW1    --> Connection 1: RG1 : DSR1
+                                    --> Connection 1: RG2 : DSR2
+        Both ReaderGroups receive on the socket event of the connection
+    */
+
+    UA_NodeId ConnId_1;
+    UA_NodeId_init(&ConnId_1);
+    UA_UInt32 PublisherNo_Conn1 = 1;
+    AddConnection("Conn1", PublisherNo_Conn1, &ConnId_1);
+
+    UA_NodeId WGId_Conn1_WG1;
+    UA_NodeId_init(&WGId_Conn1_WG1);
+    UA_UInt32 WGNo_Conn1_WG1 = 1;
+    UA_Duration PublishingInterval_Conn1_WG1 = 100.0;
+    AddWriterGroup(&ConnId_1, "Conn1_WG1", WGNo_Conn1_WG1, PublishingInterval_Conn1_WG1, &WGId_Conn1_WG1);
+
+    UA_NodeId DsWId_Conn1_WG1_DS1;
+    UA_NodeId_init(&DsWId_Conn1_WG1_DS1);
+    UA_NodeId VarId_Conn1_WG1_DS1;
+    UA_NodeId_init(&VarId_Conn1_WG1_DS1);
+    UA_NodeId PDSId_Conn1_WG1_PDS1;
+    UA_NodeId_init(&PDSId_Conn1_WG1_PDS1);
+    UA_UInt32 DSWNo_Conn1_WG1 = 1;
+    AddPublishedDataSet(&WGId_Conn1_WG1, "Conn1_WG1_PDS1", "Conn1_WG1_DS1", DSWNo_Conn1_WG1, &PDSId_Conn1_WG1_PDS1, 
+        &VarId_Conn1_WG1_DS1, &DsWId_Conn1_WG1_DS1);
+
+    UA_NodeId RGId_Conn1_RG1;
+    UA_NodeId_init(&RGId_Conn1_RG1);
+    AddReaderGroup(&ConnId_1, "Conn1_RG1", &RGId_Conn1_RG1);
+    UA_NodeId RGId_Conn1_RG2;
+    UA_NodeId_init(&RGId_Conn1_RG2);
+    AddReaderGroup(&ConnId_1, "Conn1_RG2", &RGId_Conn1_RG2);
+
+    UA_NodeId DSRId_Conn1_RG1_DSR1;
+    UA_NodeId_init(&DSRId_Conn1_RG1_DSR1);
+    UA_NodeId VarId_Conn1_RG1_DSR1;
+    UA_NodeId_init(&VarId_Conn1_RG1_DSR1);
+    AddDataSetReader(&RGId_Conn1_RG1, "Conn1_RG1_DSR1", PublisherNo_Conn1, WGNo_Conn1_WG1, DSWNo_Conn1_WG1, 
+        1000.0, &VarId_Conn1_RG1_DSR1, &DSRId_Conn1_RG1_DSR1);
+    UA_NodeId DSRId_Conn1_RG2_DSR1;
+    UA_NodeId_init(&DSRId_Conn1_RG2_DSR1);
+    UA_NodeId VarId_Conn1_RG2_DSR1;
+    UA_NodeId_init(&VarId_Conn1_RG2_DSR1);
+    AddDataSetReader(&RGId_Conn1_RG2, "Conn1_RG2_DSR1", PublisherNo_Conn1, WGNo_Conn1_WG1, DSWNo_Conn1_WG1, 
+        1000.0, &VarId_Conn1_RG2_DSR1, &DSRId_Conn1_RG2_DSR1);
+
+    ck_assert(UA_STATUSCODE_GOOD == UA_Server_setWriterGroupOperational(server, WGId_Conn1_WG1));
+    ck_assert(UA_STATUSCODE_GOOD == UA_Server_setReaderGroupOperational(server, RGId_Conn1_RG1));
+    ck_assert(UA_STATUSCODE_GOOD == UA_Server_setReaderGroupOperational(server, RGId_Conn1_RG2));
+
+    UA_PubSubConnection *connection = UA_PubSubConnection_findConnectionbyId(server, ConnId_1);
+    ck_assert(connection != NULL);
+    ck_assert_uint_eq(connection->socketReaderGroups, 2);
+
+    /* The readers of both ReaderGroups receive the published values */
+    ValidatePublishSubscribe(VarId_Conn1_WG1_DS1, VarId_Conn1_RG1_DSR1, 10, (UA_UInt32) PublishingInterval_Conn1_WG1, 3);
+    ValidatePublishSubscribe(VarId_Conn1_WG1_DS1, VarId_Conn1_RG2_DSR1, 33, (UA_UInt32) PublishingInterval_Conn1_WG1, 3);
+    ValidatePublishSubscribe(VarId_Conn1_WG1_DS1, VarId_Conn1_RG1_DSR1, 44, (UA_UInt32) PublishingInterval_Conn1_WG1, 3);
+
+    UA_PubSubState state = UA_PUBSUBSTATE_DISABLED;
+    ck_assert(UA_Server_DataSetReader_getState(server, DSRId_Conn1_RG1_DSR1, &state) == UA_STATUSCODE_GOOD);
+    ck_assert(state == UA_PUBSUBSTATE_OPERATIONAL);
+    ck_assert(UA_Server_DataSetReader_getState(server, DSRId_Conn1_RG2_DSR1, &state) == UA_STATUSCODE_GOOD);
+    ck_assert(state == UA_PUBSUBSTATE_OPERATIONAL);
+
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "END: Test_socket_event_reader_groups\n\n");
+} END_TEST
+
 
 
 /***************************************************************************************************/
@@ -1750,8 +1860,15 @@ int main(void) {
     /* test case description: 
         - 1 Connection, 1 DataSetWriter, 1 DataSetReader
         - reader with wrong timeout setting (timeout is smaller than publishing interval)
+        - the late message is processed on the socket event in the iteration of the timeout
+    */
+    tcase_add_test(tc_basic, Test_wrong_timeout_socket_event);
+
+    /* test case description:
+        - 1 Connection, 1 DataSetWriter, 2 ReaderGroups with 1 DataSetReader each
+        - the messages received on the socket event reach both ReaderGroups
     */
-    tcase_add_test(tc_basic, Test_wrong_timeout);
+    tcase_add_test(tc_basic, Test_socket_event_reader_groups);
 
     /* test case description:
         - configure multiple connections with multiple readers and writers
@@ -1775,8 +1892,19 @@ int main(void) {
     */
     tcase_add_test(tc_basic, Test_fast_path);
 
+    /* The ReaderGroups poll their socket in a cyclic callback */
+    TCase *tc_polling = tcase_create("Message Receive Timeout with polling");
+    tcase_add_checked_fixture(tc_polling, setup_polling, teardown);
+
+    /* test case description: 
+        - 1 Connection, 1 DataSetWriter, 1 DataSetReader
+        - reader with wrong timeout setting (timeout is smaller than publishing interval)
+    */
+    tcase_add_test(tc_polling, Test_wrong_timeout);
+
     Suite *s = suite_create("PubSub timeout test suite: message receive timeout");
     suite_add_tcase(s, tc_basic);
+    suite_add_tcase(s, tc_polling);
 
     SRunner *sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
@@ -10,6 +10,8 @@
 #include <open62541/client_highlevel.h>
 #include <open62541/plugin/historydata/history_data_backend.h>
 #include <open62541/plugin/historydata/history_data_backend_memory.h>
+#include <open62541/plugin/historydata/history_data_backend_columnar.h>
+#include <open62541/plugin/historydata/history_data_backend_file.h>
 #include <open62541/plugin/historydata/history_data_gathering_default.h>
 #include <open62541/plugin/historydata/history_database_default.h>
 #include <open62541/plugin/historydatabase.h>
@@ -29,6 +31,7 @@
 #include "randomindextest_backend.h"
 #endif
 #include <stddef.h>
+#include <time.h>
 
 static UA_Server *server;
 #ifdef UA_ENABLE_HISTORIZING
@@ -988,6 +991,751 @@ START_TEST(Server_HistorizingBackendMemory)
 }
 END_TEST
 
+START_TEST(Server_HistorizingBackendColumnar)
+{
+    /* Small chunks to read across chunk boundaries */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Columnar(1, 3);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // empty backend should not crash
+    UA_UInt32 retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%x tests expected failed.\n", retval);
+
+    // fill backend (the test data is not sorted)
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend), true);
+
+    // read all in one
+    retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%x tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous one at one request
+    retval = testHistoricalDataBackend(1);
+    fprintf(stderr, "%x tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous two at one request
+    retval = testHistoricalDataBackend(2);
+    fprintf(stderr, "%x tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+    UA_HistoryDataBackend_Columnar_clear(&setting.historizingBackend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingBackendColumnarUpdate)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Columnar(1, 3);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // fill backend with insert
+    ck_assert_str_eq(UA_StatusCode_name(updateHistory(UA_PERFORMUPDATETYPE_INSERT, testData, NULL, NULL))
+                                        , UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    testResult(testDataSorted, NULL);
+
+    // delete some values
+    ck_assert_str_eq(UA_StatusCode_name(deleteHistory(DELETE_START_TIME, DELETE_STOP_TIME)),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    testResult(testDataAfterDelete, NULL);
+
+    // update all and insert some
+    UA_StatusCode *result = NULL;
+    size_t resultSize = 0;
+    ck_assert_uint_eq(updateHistory(UA_PERFORMUPDATETYPE_UPDATE, testDataSorted, &result, &resultSize),
+                      UA_STATUSCODE_GOOD);
+
+    for (size_t i = 0; i < resultSize; ++i) {
+        ck_assert_str_eq(UA_StatusCode_name(result[i]), UA_StatusCode_name(testDataUpdateResult[i]));
+    }
+    UA_Array_delete(result, resultSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
+
+    UA_HistoryData data;
+    UA_HistoryData_init(&data);
+
+    testResult(testDataSorted, &data);
+
+    for (size_t i = 0; i < data.dataValuesSize; ++i) {
+        ck_assert_uint_eq(data.dataValues[i].hasValue, true);
+        ck_assert(data.dataValues[i].value.type == &UA_TYPES[UA_TYPES_INT64]);
+        ck_assert_uint_eq(*((UA_Int64*)data.dataValues[i].value.data), UA_PERFORMUPDATETYPE_UPDATE);
+    }
+
+    UA_HistoryData_clear(&data);
+    UA_HistoryDataBackend_Columnar_clear(&setting.historizingBackend);
+}
+END_TEST
+
+/* The samples are read back unchanged from the compressed columns and the
+ * binary encoded chunks */
+START_TEST(Server_HistorizingBackendColumnarRoundtrip)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Columnar(1, 0);
+    const size_t count = 5000;
+    UA_DataValue *samples = (UA_DataValue*)
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_DateTime t = UA_DateTime_now();
+    for(size_t i = 0; i < count; i++) {
+        UA_DataValue *dv = &samples[i];
+        /* 1Hz with some jitter */
+        t += UA_DATETIME_SEC + (UA_DateTime)((i * 7919) % 5000) - 2500;
+        dv->hasSourceTimestamp = true;
+        dv->sourceTimestamp = t;
+        dv->hasServerTimestamp = (i % 5 != 0);
+        dv->serverTimestamp = t + (UA_DateTime)(i % 3) * UA_DATETIME_MSEC;
+        dv->hasStatus = (i % 100 >= 90);
+        dv->status = UA_STATUSCODE_UNCERTAININITIALVALUE;
+        if(i % 250 == 10)
+            continue; /* No value */
+        if(i >= 4000 && i < 4010) {
+            UA_String s = UA_STRING("not numeric");
+            UA_Variant_setScalarCopy(&dv->value, &s, &UA_TYPES[UA_TYPES_STRING]);
+        } else if(i >= 3000 && i < 3500) {
+            UA_Int32 v = (UA_Int32)(i * i) - 1000000;
+            UA_Variant_setScalarCopy(&dv->value, &v, &UA_TYPES[UA_TYPES_INT32]);
+        } else {
+            UA_Double v = (UA_Double)(i % 17) * 0.25 + ((i % 1000 == 0) ? 1e300 : 0.0);
+            UA_Variant_setScalarCopy(&dv->value, &v, &UA_TYPES[UA_TYPES_DOUBLE]);
+        }
+        dv->hasValue = true;
+    }
+    /* Picoseconds are stored in the binary encoding */
+    samples[4500].hasSourcePicoseconds = true;
+    samples[4500].sourcePicoseconds = 42;
+
+    for(size_t i = 0; i < count; i++) {
+        UA_StatusCode ret = backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                         &outNodeId, true, &samples[i]);
+        ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &outNodeId), count);
+
+    UA_DataValue *values = (UA_DataValue*)
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_NumericRange range = {0, NULL};
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    UA_ByteString outCp = UA_BYTESTRING_NULL;
+    size_t provided = 0;
+
+    /* Forward */
+    UA_StatusCode ret = backend.copyDataValues(server, backend.context, NULL, NULL, &outNodeId,
+                                               0, count - 1, false, count, range, false,
+                                               &cp, &outCp, &provided, values);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(provided, count);
+    ck_assert_uint_eq(outCp.length, 0);
+    for(size_t i = 0; i < count; i++)
+        ck_assert(UA_order(&values[i], &samples[i], &UA_TYPES[UA_TYPES_DATAVALUE]) == UA_ORDER_EQ);
+    UA_Array_delete(values, count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+
+    /* Reverse, limited */
+    values = (UA_DataValue*)UA_Array_new(100, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    ret = backend.copyDataValues(server, backend.context, NULL, NULL, &outNodeId,
+                                 4049, 0, true, 100, range, false,
+                                 &cp, &outCp, &provided, values);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(provided, 100);
+    ck_assert_uint_gt(outCp.length, 0);
+    for(size_t i = 0; i < 100; i++)
+        ck_assert(UA_order(&values[i], &samples[4049 - i], &UA_TYPES[UA_TYPES_DATAVALUE]) == UA_ORDER_EQ);
+    UA_Array_delete(values, 100, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_ByteString_clear(&outCp);
+
+    /* Lookup by timestamp */
+    size_t index = backend.getDateTimeMatch(server, backend.context, NULL, NULL, &outNodeId,
+                                            samples[1234].sourceTimestamp, MATCH_EQUAL);
+    ck_assert_uint_eq(index, 1234);
+    index = backend.getDateTimeMatch(server, backend.context, NULL, NULL, &outNodeId,
+                                     samples[1234].sourceTimestamp + 1, MATCH_EQUAL_OR_BEFORE);
+    ck_assert_uint_eq(index, 1234);
+    index = backend.getDateTimeMatch(server, backend.context, NULL, NULL, &outNodeId,
+                                     samples[1234].sourceTimestamp, MATCH_AFTER);
+    ck_assert_uint_eq(index, 1235);
+
+    UA_Array_delete(samples, count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_HistoryDataBackend_Columnar_clear(&backend);
+}
+END_TEST
+
+#ifdef UA_ARCHITECTURE_POSIX
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static void
+createTempDir(char *dir) {
+    strcpy(dir, "/tmp/open62541_history_XXXXXX");
+    ck_assert_ptr_ne(mkdtemp(dir), NULL);
+}
+
+static void
+removeTempDir(const char *dir) {
+    DIR *d = opendir(dir);
+    ck_assert_ptr_ne(d, NULL);
+    char path[256];
+    struct dirent *e;
+    while((e = readdir(d))) {
+        if(e->d_name[0] == '.')
+            continue;
+        int len = snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        if(len < 0 || (size_t)len >= sizeof(path))
+            continue; /* Truncated */
+        unlink(path);
+    }
+    closedir(d);
+    rmdir(dir);
+}
+
+/* Close the backend and open the history from the directory */
+static void
+reopenFileBackend(UA_HistoryDataBackend *backend, const char *dir, size_t segmentSize) {
+    UA_HistoryDataBackend_File_clear(backend);
+    *backend = UA_HistoryDataBackend_File(dir, 1, segmentSize, 0);
+    ck_assert_ptr_ne(backend->context, NULL);
+    const UA_HistorizingNodeIdSettings *setting =
+        gathering->getHistorizingSetting(server, gathering->context, &outNodeId);
+    if(!setting)
+        return;
+    UA_HistorizingNodeIdSettings newSetting = *setting;
+    newSetting.historizingBackend = *backend;
+    gathering->updateNodeIdSetting(server, gathering->context, &outNodeId, newSetting);
+}
+
+START_TEST(Server_HistorizingBackendFile)
+{
+    char dir[64];
+    createTempDir(dir);
+
+    /* Small segments to read across segment boundaries */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 1, 3, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // empty backend should not crash
+    UA_UInt32 retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%x tests expected failed.\n", retval);
+
+    // fill backend
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend), true);
+
+    // read all in one
+    retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%x tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // the history is restored from the sealed segments and the WAL
+    reopenFileBackend(&backend, dir, 3);
+
+    // read continuous one at one request
+    retval = testHistoricalDataBackend(1);
+    fprintf(stderr, "%x tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous two at one request
+    retval = testHistoricalDataBackend(2);
+    fprintf(stderr, "%x tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+    UA_HistoryDataBackend_File_clear(&backend);
+    removeTempDir(dir);
+}
+END_TEST
+
+START_TEST(Server_HistorizingBackendFileUpdate)
+{
+    char dir[64];
+    createTempDir(dir);
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 1, 3, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // fill backend with insert (unsorted, rewrites the sealed segments)
+    ck_assert_str_eq(UA_StatusCode_name(updateHistory(UA_PERFORMUPDATETYPE_INSERT, testData, NULL, NULL))
+                                        , UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    testResult(testDataSorted, NULL);
+
+    // delete some values
+    ck_assert_str_eq(UA_StatusCode_name(deleteHistory(DELETE_START_TIME, DELETE_STOP_TIME)),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    testResult(testDataAfterDelete, NULL);
+    reopenFileBackend(&backend, dir, 3);
+    testResult(testDataAfterDelete, NULL);
+
+    // update all and insert some
+    UA_StatusCode *result = NULL;
+    size_t resultSize = 0;
+    ck_assert_uint_eq(updateHistory(UA_PERFORMUPDATETYPE_UPDATE, testDataSorted, &result, &resultSize),
+                      UA_STATUSCODE_GOOD);
+
+    for (size_t i = 0; i < resultSize; ++i) {
+        ck_assert_str_eq(UA_StatusCode_name(result[i]), UA_StatusCode_name(testDataUpdateResult[i]));
+    }
+    UA_Array_delete(result, resultSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
+
+    reopenFileBackend(&backend, dir, 3);
+
+    UA_HistoryData data;
+    UA_HistoryData_init(&data);
+
+    testResult(testDataSorted, &data);
+
+    for (size_t i = 0; i < data.dataValuesSize; ++i) {
+        ck_assert_uint_eq(data.dataValues[i].hasValue, true);
+        ck_assert(data.dataValues[i].value.type == &UA_TYPES[UA_TYPES_INT64]);
+        ck_assert_uint_eq(*((UA_Int64*)data.dataValues[i].value.data), UA_PERFORMUPDATETYPE_UPDATE);
+    }
+
+    UA_HistoryData_clear(&data);
+    UA_HistoryDataBackend_File_clear(&backend);
+    removeTempDir(dir);
+}
+END_TEST
+
+static void
+setFileSample(UA_HistoryDataBackend *backend, UA_UInt32 value) {
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Variant_setScalar(&dv.value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    dv.hasValue = true;
+    dv.hasSourceTimestamp = true;
+    dv.sourceTimestamp = (UA_DateTime)value * UA_DATETIME_SEC;
+    UA_StatusCode ret = backend->serverSetHistoryData(server, backend->context, NULL, NULL,
+                                                      &outNodeId, true, &dv);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+}
+
+static UA_UInt32
+getFileSample(UA_HistoryDataBackend *backend, size_t index) {
+    const UA_DataValue *dv = backend->getDataValue(server, backend->context, NULL, NULL,
+                                                   &outNodeId, index);
+    ck_assert(dv->hasValue);
+    ck_assert(dv->value.type == &UA_TYPES[UA_TYPES_UINT32]);
+    return *(UA_UInt32*)dv->value.data;
+}
+
+/* Torn WAL records are discarded. Retention and compaction drop the old
+ * samples. */
+START_TEST(Server_HistorizingBackendFileRecovery)
+{
+    char dir[64];
+    createTempDir(dir);
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 1, 4, 0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    for(UA_UInt32 i = 0; i < 10; i++)
+        setFileSample(&backend, i);
+
+    /* A crash while appending to the WAL */
+    char path[128];
+    snprintf(path, sizeof(path), "%s/wal", dir);
+    int fd = open(path, O_WRONLY | O_APPEND);
+    ck_assert_int_ge(fd, 0);
+    const UA_Byte torn[] = {100, 0, 0, 0, 1, 2, 3, 4, 5};
+    ck_assert_int_eq(write(fd, torn, sizeof(torn)), (int)sizeof(torn));
+    close(fd);
+
+    reopenFileBackend(&backend, dir, 4);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &outNodeId), 10);
+    for(UA_UInt32 i = 0; i < 10; i++)
+        ck_assert_uint_eq(getFileSample(&backend, i), i);
+
+    /* Continue after the recovery */
+    setFileSample(&backend, 10);
+    reopenFileBackend(&backend, dir, 4);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &outNodeId), 11);
+    ck_assert_uint_eq(getFileSample(&backend, 10), 10);
+
+    /* Remove everything before 6s. Splits the second segment. */
+    UA_StatusCode ret = UA_HistoryDataBackend_File_compact(&backend, 6 * UA_DATETIME_SEC);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    reopenFileBackend(&backend, dir, 4);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &outNodeId), 5);
+    ck_assert_uint_eq(getFileSample(&backend, 0), 6);
+    UA_HistoryDataBackend_File_clear(&backend);
+
+    /* Keep 10s of history. Sealed segments that are entirely older are
+     * dropped. */
+    backend = UA_HistoryDataBackend_File(dir, 1, 4, 10000.0);
+    ck_assert_ptr_ne(backend.context, NULL);
+    for(UA_UInt32 i = 11; i < 40; i++)
+        setFileSample(&backend, i);
+    size_t end = backend.getEnd(server, backend.context, NULL, NULL, &outNodeId);
+    ck_assert_uint_lt(end, 20);
+    ck_assert_uint_ge(getFileSample(&backend, 0), 39 - 10 - 4);
+    ck_assert_uint_eq(getFileSample(&backend, end - 1), 39);
+
+    UA_HistoryDataBackend_File_clear(&backend);
+    removeTempDir(dir);
+}
+END_TEST
+
+#endif /* UA_ARCHITECTURE_POSIX */
+
+/* Insert throughput of the gathering and the backends depending on the number of
+ * historized nodes. The NodeIds are looked up for every sample. */
+#define BENCHMARK_SAMPLES 100000
+
+static void
+benchmarkHistorizedNodes(UA_HistoryDataBackend backend, const char *name,
+                         size_t nodesCount) {
+    UA_HistoryDataGathering g = UA_HistoryDataGathering_Default(1);
+    UA_HistorizingNodeIdSettings setting;
+    memset(&setting, 0, sizeof(UA_HistorizingNodeIdSettings));
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_VALUESET;
+
+    /* Mix numeric and string NodeIds */
+    UA_NodeId *nodeIds = (UA_NodeId*)UA_Array_new(nodesCount, &UA_TYPES[UA_TYPES_NODEID]);
+    ck_assert_ptr_ne(nodeIds, NULL);
+    for(size_t i = 0; i < nodesCount; i++) {
+        if(i % 2 == 0) {
+            nodeIds[i] = UA_NODEID_NUMERIC(1, (UA_UInt32)(100000 + i));
+        } else {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "historized-%lu", (unsigned long)i);
+            nodeIds[i] = UA_NODEID_STRING_ALLOC(1, buf);
+        }
+        UA_StatusCode ret = g.registerNodeId(server, g.context, &nodeIds[i], setting);
+        ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(g.registerNodeId(server, g.context, &nodeIds[0], setting),
+                      UA_STATUSCODE_BADNODEIDEXISTS);
+
+    UA_DataValue value;
+    UA_DataValue_init(&value);
+    UA_UInt32 v = 0;
+    UA_Variant_setScalar(&value.value, &v, &UA_TYPES[UA_TYPES_UINT32]);
+    value.hasValue = true;
+    value.hasSourceTimestamp = true;
+
+    clock_t begin = clock();
+    for(size_t i = 0; i < BENCHMARK_SAMPLES; i++) {
+        v = (UA_UInt32)i;
+        value.sourceTimestamp = (UA_DateTime)(i / nodesCount) * UA_DATETIME_MSEC;
+        g.setValue(server, g.context, NULL, NULL, &nodeIds[i % nodesCount], true, &value);
+    }
+    clock_t finish = clock();
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("%s: %lu historized nodes, %.0f samples/s\n", name,
+           (unsigned long)nodesCount,
+           time_spent > 0 ? (double)BENCHMARK_SAMPLES / time_spent : 0.0);
+
+    /* Every node received its share of the samples */
+    for(size_t i = 0; i < nodesCount; i++) {
+        size_t expected = BENCHMARK_SAMPLES / nodesCount;
+        if(i < BENCHMARK_SAMPLES % nodesCount)
+            expected++;
+        size_t end = backend.getEnd(server, backend.context, NULL, NULL, &nodeIds[i]);
+        size_t first = backend.firstIndex(server, backend.context, NULL, NULL, &nodeIds[i]);
+        ck_assert_uint_eq(backend.resultSize(server, backend.context, NULL, NULL,
+                                             &nodeIds[i], first,
+                                             backend.lastIndex(server, backend.context,
+                                                               NULL, NULL, &nodeIds[i])),
+                          expected);
+        ck_assert_uint_ne(first, end);
+    }
+
+    g.deleteMembers(&g);
+    UA_Array_delete(nodeIds, nodesCount, &UA_TYPES[UA_TYPES_NODEID]);
+}
+
+START_TEST(Server_HistorizingIngestionQueue)
+{
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = UA_HistoryDataBackend_Memory(3, 100);
+    setting.maxHistoryDataResponseSize = 100;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_VALUESET;
+
+    /* The server loop cannot drain the queue while the mutex is held */
+    serverMutexLock();
+    UA_StatusCode retval =
+        UA_HistoryDatabase_enableIngestionQueue(&config->historyDatabase, 8, 4, 50.0);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_fakeSleep(100);
+    UA_DateTime start = UA_DateTime_now();
+    for(UA_UInt32 i = 0; i < 20; ++i) {
+        UA_fakeSleep(10);
+        UA_Variant value;
+        UA_Variant_setScalar(&value, &i, &UA_TYPES[UA_TYPES_UINT32]);
+        retval = UA_Server_writeValue(server, outNodeId, value);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    /* Only the first eight values fit into the queue */
+    UA_HistoryIngestionStatistics stats;
+    retval = UA_HistoryDatabase_getIngestionStatistics(&config->historyDatabase, &stats);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(stats.capacity, 8);
+    ck_assert_uint_eq(stats.queued, 8);
+    ck_assert_uint_eq(stats.maxQueued, 8);
+    ck_assert_uint_eq(stats.enqueued, 8);
+    ck_assert_uint_eq(stats.dropped, 12);
+    ck_assert_uint_eq(stats.stored, 0);
+
+    /* The read drains the queue first */
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    requestHistory(start, UA_DateTime_now() + 1, &response, 0, false, NULL);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+    UA_HistoryData *data = (UA_HistoryData*)
+        response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 8);
+    for(size_t j = 0; j < data->dataValuesSize; ++j)
+        ck_assert_uint_eq(*(UA_UInt32*)data->dataValues[j].value.data, j);
+    UA_HistoryReadResponse_clear(&response);
+    UA_HistoryDatabase_getIngestionStatistics(&config->historyDatabase, &stats);
+    ck_assert_uint_eq(stats.queued, 0);
+    ck_assert_uint_eq(stats.stored, 8);
+
+    /* The repeated callback drains batches of four samples */
+    for(UA_UInt32 i = 100; i < 106; ++i) {
+        UA_fakeSleep(10);
+        UA_Variant value;
+        UA_Variant_setScalar(&value, &i, &UA_TYPES[UA_TYPES_UINT32]);
+        retval = UA_Server_writeValue(server, outNodeId, value);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    UA_fakeSleep(60);
+    UA_Server_run_iterate(server, false);
+    UA_HistoryDatabase_getIngestionStatistics(&config->historyDatabase, &stats);
+    ck_assert_uint_eq(stats.stored, 12);
+    ck_assert_uint_eq(stats.queued, 2);
+    UA_fakeSleep(60);
+    UA_Server_run_iterate(server, false);
+    UA_HistoryDatabase_getIngestionStatistics(&config->historyDatabase, &stats);
+    ck_assert_uint_eq(stats.stored, 14);
+    ck_assert_uint_eq(stats.queued, 0);
+    serverMutexUnlock();
+
+    UA_HistoryReadResponse_init(&response);
+    requestHistory(start, UA_DateTime_now() + 1, &response, 0, false, NULL);
+    data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 14);
+    ck_assert_uint_eq(*(UA_UInt32*)data->dataValues[13].value.data, 105);
+    UA_HistoryReadResponse_clear(&response);
+    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+}
+END_TEST
+
+static void
+setPagingSample(UA_HistoryDataBackend *backend, UA_Int64 seconds) {
+    UA_DataValue value;
+    UA_DataValue_init(&value);
+    UA_Variant_setScalar(&value.value, &seconds, &UA_TYPES[UA_TYPES_INT64]);
+    value.hasValue = true;
+    value.hasSourceTimestamp = true;
+    value.sourceTimestamp = seconds * UA_DATETIME_SEC;
+    value.hasServerTimestamp = true;
+    value.serverTimestamp = value.sourceTimestamp;
+    UA_StatusCode ret =
+        backend->serverSetHistoryData(server, backend->context, NULL, NULL,
+                                      &outNodeId, true, &value);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+}
+
+/* Reads the next page and appends the values. Returns false if there is no
+ * continuation point. */
+static UA_Boolean
+readPage(UA_DateTime start, UA_DateTime end, UA_ByteString *continuationPoint,
+         UA_Int64 *values, size_t *valuesSize) {
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    requestHistory(start, end, &response, 0, false, continuationPoint);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+    UA_HistoryData *data = (UA_HistoryData*)
+        response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_le(data->dataValuesSize, 3);
+    for(size_t i = 0; i < data->dataValuesSize; i++)
+        values[(*valuesSize)++] = *(UA_Int64*)data->dataValues[i].value.data;
+    UA_ByteString_clear(continuationPoint);
+    UA_ByteString_copy(&response.results[0].continuationPoint, continuationPoint);
+    UA_HistoryReadResponse_clear(&response);
+    return continuationPoint->length > 0;
+}
+
+START_TEST(Server_HistorizingContinuationPointInsert)
+{
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = UA_HistoryDataBackend_Memory(3, 100);
+    setting.maxHistoryDataResponseSize = 3;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    for(UA_Int64 i = 10; i <= 100; i += 10)
+        setPagingSample(&setting.historizingBackend, i);
+
+    /* Values inserted before the cursor are not returned. The values after
+     * the cursor are returned once without gaps. */
+    UA_Int64 values[32];
+    size_t valuesSize = 0;
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    UA_DateTime start = 5 * UA_DATETIME_SEC;
+    UA_DateTime end = 1000 * UA_DATETIME_SEC;
+    ck_assert(readPage(start, end, &cp, values, &valuesSize));
+    setPagingSample(&setting.historizingBackend, 15);
+    setPagingSample(&setting.historizingBackend, 45);
+    ck_assert(readPage(start, end, &cp, values, &valuesSize));
+    setPagingSample(&setting.historizingBackend, 25);
+    while(readPage(start, end, &cp, values, &valuesSize)) {}
+    UA_Int64 expected[] = {10, 20, 30, 40, 45, 50, 60, 70, 80, 90, 100};
+    ck_assert_uint_eq(valuesSize, sizeof(expected) / sizeof(UA_Int64));
+    for(size_t i = 0; i < valuesSize; i++)
+        ck_assert_int_eq(values[i], expected[i]);
+
+    /* The same in reverse direction */
+    valuesSize = 0;
+    ck_assert(readPage(end, start, &cp, values, &valuesSize));
+    setPagingSample(&setting.historizingBackend, 95);
+    setPagingSample(&setting.historizingBackend, 65);
+    while(readPage(end, start, &cp, values, &valuesSize)) {}
+    UA_Int64 expectedReverse[] = {100, 90, 80, 70, 65, 60, 50, 45, 40, 30, 25, 20, 15, 10};
+    ck_assert_uint_eq(valuesSize, sizeof(expectedReverse) / sizeof(UA_Int64));
+    for(size_t i = 0; i < valuesSize; i++)
+        ck_assert_int_eq(values[i], expectedReverse[i]);
+
+    /* A continuation point of another format is rejected */
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    UA_ByteString invalid = UA_BYTESTRING("invalid");
+    requestHistory(start, end, &response, 0, false, &invalid);
+    ck_assert_uint_eq(response.results[0].statusCode,
+                      UA_STATUSCODE_BADCONTINUATIONPOINTINVALID);
+    UA_HistoryReadResponse_clear(&response);
+    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+}
+END_TEST
+
+#define STREAMED_HISTORY_NODES 2000
+
+/* Enough nodes to stream the response. The response spans many chunks. */
+START_TEST(Server_HistorizingReadStreamed)
+{
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = UA_HistoryDataBackend_Memory(1, 100);
+    setting.maxHistoryDataResponseSize = 100;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+
+    UA_DateTime start = UA_DateTime_now();
+    for(UA_UInt32 i = 0; i < 10; ++i) {
+        UA_DataValue value;
+        UA_DataValue_init(&value);
+        value.hasValue = true;
+        UA_Variant_setScalar(&value.value, &i, &UA_TYPES[UA_TYPES_UINT32]);
+        value.hasSourceTimestamp = true;
+        value.sourceTimestamp = start + (i * UA_DATETIME_SEC);
+        serverMutexLock();
+        ret = setting.historizingBackend.serverSetHistoryData(server, setting.historizingBackend.context,
+                                                              NULL, NULL, &outNodeId, UA_FALSE, &value);
+        serverMutexUnlock();
+        ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    }
+
+    UA_ReadRawModifiedDetails details;
+    UA_ReadRawModifiedDetails_init(&details);
+    details.startTime = start;
+    details.endTime = start + (10 * UA_DATETIME_SEC);
+
+    UA_HistoryReadValueId items[STREAMED_HISTORY_NODES];
+    for(size_t i = 0; i < STREAMED_HISTORY_NODES; i++) {
+        UA_HistoryReadValueId_init(&items[i]);
+        items[i].nodeId = outNodeId;
+    }
+    items[1].nodeId = UA_NODEID_NUMERIC(1, 12345678); /* Unknown */
+
+    UA_HistoryReadRequest request;
+    UA_HistoryReadRequest_init(&request);
+    request.nodesToRead = items;
+    request.nodesToReadSize = STREAMED_HISTORY_NODES;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SOURCE;
+    UA_ExtensionObject_setValue(&request.historyReadDetails, &details,
+                                &UA_TYPES[UA_TYPES_READRAWMODIFIEDDETAILS]);
+    UA_HistoryReadResponse response = UA_Client_Service_historyRead(client, request);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, STREAMED_HISTORY_NODES);
+
+    /* Larger than several chunks of the default size */
+    ck_assert_uint_gt(UA_calcSizeBinary(&response, &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE]),
+                      4 * 65535);
+
+    for(size_t i = 0; i < STREAMED_HISTORY_NODES; i++) {
+        if(i == 1) {
+            ck_assert(UA_StatusCode_isBad(response.results[i].statusCode));
+            continue;
+        }
+        ck_assert_uint_eq(response.results[i].statusCode, UA_STATUSCODE_GOOD);
+        ck_assert(response.results[i].historyData.content.decoded.type ==
+                  &UA_TYPES[UA_TYPES_HISTORYDATA]);
+        UA_HistoryData *data = (UA_HistoryData*)
+            response.results[i].historyData.content.decoded.data;
+        ck_assert_uint_eq(data->dataValuesSize, 10);
+        for(size_t j = 0; j < data->dataValuesSize; j++) {
+            ck_assert(data->dataValues[j].value.type == &UA_TYPES[UA_TYPES_UINT32]);
+            ck_assert_uint_eq(*(UA_UInt32*)data->dataValues[j].value.data, j);
+        }
+    }
+
+    UA_HistoryReadResponse_clear(&response);
+    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingBenchmarkNodeIdIndex)
+{
+    size_t counts[] = {10, 100, 1000, 10000};
+    for(size_t i = 0; i < sizeof(counts) / sizeof(size_t); i++) {
+        UA_HistoryDataBackend memory = UA_HistoryDataBackend_Memory(1, 1);
+        benchmarkHistorizedNodes(memory, "Memory", counts[i]);
+        UA_HistoryDataBackend_Memory_clear(&memory);
+
+        UA_HistoryDataBackend columnar = UA_HistoryDataBackend_Columnar(1, 0);
+        benchmarkHistorizedNodes(columnar, "Columnar", counts[i]);
+        UA_HistoryDataBackend_Columnar_clear(&columnar);
+    }
+}
+END_TEST
+
 START_TEST(Server_HistorizingRandomIndexBackend)
 {
     UA_HistoryDataBackend backend = UA_HistoryDataBackend_randomindextest(testData);
@@ -1018,6 +1766,285 @@ START_TEST(Server_HistorizingRandomIndexBackend)
 }
 END_TEST
 
+static void
+setProcessedSample(UA_HistoryDataBackend *backend, UA_DateTime t,
+                   UA_UInt32 value, UA_StatusCode code) {
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Variant_setScalar(&dv.value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    dv.hasValue = true;
+    dv.hasStatus = (code != UA_STATUSCODE_GOOD);
+    dv.status = code;
+    dv.hasSourceTimestamp = true;
+    dv.sourceTimestamp = t;
+    UA_StatusCode ret = backend->serverSetHistoryData(server, backend->context, NULL, NULL,
+                                                      &outNodeId, true, &dv);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+}
+
+static UA_HistoryReadResponse
+readProcessed(UA_UInt32 aggregate, UA_DateTime start, UA_DateTime end,
+              UA_Double processingInterval, const UA_ByteString *continuationPoint) {
+    UA_NodeId aggregateType = UA_NODEID_NUMERIC(0, aggregate);
+    UA_ReadProcessedDetails details;
+    UA_ReadProcessedDetails_init(&details);
+    details.startTime = start;
+    details.endTime = end;
+    details.processingInterval = processingInterval;
+    details.aggregateTypeSize = 1;
+    details.aggregateType = &aggregateType;
+    details.aggregateConfiguration.useServerCapabilitiesDefaults = true;
+
+    UA_HistoryReadValueId item;
+    UA_HistoryReadValueId_init(&item);
+    item.nodeId = outNodeId;
+    if(continuationPoint)
+        item.continuationPoint = *continuationPoint;
+
+    UA_HistoryReadRequest request;
+    UA_HistoryReadRequest_init(&request);
+    request.nodesToRead = &item;
+    request.nodesToReadSize = 1;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SOURCE;
+    UA_ExtensionObject_setValue(&request.historyReadDetails, &details,
+                                &UA_TYPES[UA_TYPES_READPROCESSEDDETAILS]);
+    return UA_Client_Service_historyRead(client, request);
+}
+
+static UA_HistoryData *
+processedData(UA_HistoryReadResponse *response) {
+    ck_assert_uint_eq(response->responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response->resultsSize, 1);
+    ck_assert_uint_eq(response->results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert(response->results[0].historyData.content.decoded.type ==
+              &UA_TYPES[UA_TYPES_HISTORYDATA]);
+    return (UA_HistoryData*)response->results[0].historyData.content.decoded.data;
+}
+
+static UA_Double
+processedValue(const UA_DataValue *dv) {
+    ck_assert(dv->hasValue);
+    if(dv->value.type == &UA_TYPES[UA_TYPES_DOUBLE])
+        return *(UA_Double*)dv->value.data;
+    if(dv->value.type == &UA_TYPES[UA_TYPES_INT32])
+        return *(UA_Int32*)dv->value.data;
+    ck_assert(dv->value.type == &UA_TYPES[UA_TYPES_UINT32]);
+    return *(UA_UInt32*)dv->value.data;
+}
+
+#define PROCESSED_CALCULATED (0x0400 | 0x01)
+#define PROCESSED_INTERPOLATED (0x0400 | 0x02)
+#define PROCESSED_PARTIAL 0x04
+
+/* Checks the values and StatusCodes of all intervals */
+static void
+checkProcessed(UA_UInt32 aggregate, UA_DateTime start, UA_DateTime end,
+               UA_Double processingInterval, size_t expectedSize,
+               const UA_Double *values, const UA_StatusCode *codes) {
+    UA_HistoryReadResponse response =
+        readProcessed(aggregate, start, end, processingInterval, NULL);
+    UA_HistoryData *data = processedData(&response);
+    ck_assert_uint_eq(data->dataValuesSize, expectedSize);
+    ck_assert_uint_eq(response.results[0].continuationPoint.length, 0);
+    UA_DateTime step = (UA_DateTime)(processingInterval * UA_DATETIME_MSEC);
+    for(size_t i = 0; i < expectedSize; i++) {
+        const UA_DataValue *dv = &data->dataValues[i];
+        ck_assert_uint_eq(dv->status, codes[i]);
+        ck_assert(dv->hasSourceTimestamp);
+        if(start < end)
+            ck_assert_int_eq(dv->sourceTimestamp, start + (UA_DateTime)i * step);
+        else
+            ck_assert_int_eq(dv->sourceTimestamp, start - (UA_DateTime)i * step);
+        if(UA_StatusCode_isBad(codes[i]))
+            continue;
+        ck_assert(processedValue(dv) > values[i] - 1e-9);
+        ck_assert(processedValue(dv) < values[i] + 1e-9);
+    }
+    UA_HistoryReadResponse_clear(&response);
+}
+
+START_TEST(Server_HistorizingReadProcessed)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 100);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    /* One sample per second with the value 10 * second. The sample at 5s is
+     * bad. */
+    const UA_DateTime t0 = 1000 * UA_DATETIME_SEC;
+    for(UA_UInt32 i = 0; i < 10; i++)
+        setProcessedSample(&backend, t0 + i * UA_DATETIME_SEC, 10 * i,
+                           (i == 5) ? UA_STATUSCODE_BADINTERNALERROR : UA_STATUSCODE_GOOD);
+
+    const UA_StatusCode good = UA_STATUSCODE_GOOD;
+    const UA_StatusCode calc = PROCESSED_CALCULATED;
+    const UA_StatusCode uncertain = UA_STATUSCODE_UNCERTAINDATASUBNORMAL | PROCESSED_CALCULATED;
+    const UA_StatusCode interp = PROCESSED_INTERPOLATED;
+    const UA_DateTime t10 = t0 + 10 * UA_DATETIME_SEC;
+
+    const UA_Double average[5] = {5, 25, 40, 65, 85};
+    const UA_StatusCode averageStatus[5] = {calc, calc, uncertain, calc, calc};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, t0, t10, 2000, 5, average, averageStatus);
+
+    const UA_Double count[5] = {2, 2, 1, 2, 2};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_COUNT, t0, t10, 2000, 5, count, averageStatus);
+
+    const UA_Double minimum[5] = {0, 20, 40, 60, 80};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_MINIMUM, t0, t10, 2000, 5, minimum, averageStatus);
+
+    const UA_Double maximum[5] = {10, 30, 40, 70, 90};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM, t0, t10, 2000, 5, maximum, averageStatus);
+
+    const UA_Double delta[5] = {10, 10, 0, 10, 10};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_DELTA, t0, t10, 2000, 5, delta, averageStatus);
+
+    /* Start and End return the raw samples */
+    const UA_StatusCode raw[5] = {good, good, good, good, good};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_START, t0, t10, 2000, 5, minimum, raw);
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_END, t0, t10, 2000, 5, maximum, raw);
+
+    /* The bad sample is skipped for the interpolation */
+    const UA_Double interpolative[4] = {5, 25, 45, 65};
+    const UA_StatusCode interpolativeStatus[4] =
+        {interp, interp, interp, interp | PROCESSED_PARTIAL};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_INTERPOLATIVE, t0 + UA_DATETIME_SEC / 2,
+                   t0 + 8 * UA_DATETIME_SEC, 2000, 4, interpolative, interpolativeStatus);
+
+    /* The bounds are interpolated with the samples of the next interval. There
+     * is no sample after 9s, so the last bound is extrapolated. */
+    const UA_Double timeAverage[5] = {10, 30, 50, 70, 87.5};
+    const UA_StatusCode timeAverageStatus[5] = {calc, calc, uncertain, calc, uncertain};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE, t0, t10, 2000, 5,
+                   timeAverage, timeAverageStatus);
+
+    /* Reverse order */
+    const UA_Double reverse[5] = {85, 65, 40, 25, 5};
+    const UA_StatusCode reverseStatus[5] = {calc, calc, uncertain, calc, calc};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, t10, t0, 2000, 5, reverse, reverseStatus);
+
+    /* The last interval is shorter than the processing interval */
+    const UA_Double partial[2] = {15, 50};
+    const UA_StatusCode partialStatus[2] = {calc, uncertain | PROCESSED_PARTIAL};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, t0, t0 + 7 * UA_DATETIME_SEC,
+                   4000, 2, partial, partialStatus);
+
+    /* Intervals without samples */
+    const UA_Double none[2] = {0, 0};
+    const UA_StatusCode noData[2] = {UA_STATUSCODE_BADNODATA, UA_STATUSCODE_BADNODATA};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, t0 + 20 * UA_DATETIME_SEC,
+                   t0 + 24 * UA_DATETIME_SEC, 2000, 2, none, noData);
+    const UA_StatusCode noCount[2] = {calc, calc};
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_COUNT, t0 + 20 * UA_DATETIME_SEC,
+                   t0 + 24 * UA_DATETIME_SEC, 2000, 2, none, noCount);
+
+    /* Unknown aggregates are rejected per node */
+    UA_HistoryReadResponse response =
+        readProcessed(UA_NS0ID_AGGREGATEFUNCTION_RANGE, t0, t10, 2000, NULL);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_BADAGGREGATENOTSUPPORTED);
+    UA_HistoryReadResponse_clear(&response);
+
+    /* Page through the intervals with continuation points */
+    setting.maxHistoryDataResponseSize = 2;
+    serverMutexLock();
+    gathering->updateNodeIdSetting(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    UA_ByteString continuationPoint = UA_BYTESTRING_NULL;
+    size_t counter = 0;
+    do {
+        response = readProcessed(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, t0, t10,
+                                 2000, &continuationPoint);
+        UA_HistoryData *data = processedData(&response);
+        ck_assert_uint_le(data->dataValuesSize, 2);
+        for(size_t i = 0; i < data->dataValuesSize; i++) {
+            ck_assert_uint_eq(data->dataValues[i].status, averageStatus[counter]);
+            ck_assert(processedValue(&data->dataValues[i]) > average[counter] - 1e-9);
+            ck_assert(processedValue(&data->dataValues[i]) < average[counter] + 1e-9);
+            counter++;
+        }
+        UA_ByteString_clear(&continuationPoint);
+        UA_ByteString_copy(&response.results[0].continuationPoint, &continuationPoint);
+        UA_HistoryReadResponse_clear(&response);
+    } while(continuationPoint.length > 0);
+    ck_assert_uint_eq(counter, 5);
+
+    /* Tiny intervals over a long range are paged also without a configured
+     * maxHistoryDataResponseSize */
+    setting.maxHistoryDataResponseSize = 0;
+    serverMutexLock();
+    gathering->updateNodeIdSetting(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    for(size_t page = 0; page < 2; page++) {
+        response = readProcessed(UA_NS0ID_AGGREGATEFUNCTION_COUNT, t0,
+                                 t0 + 3600 * UA_DATETIME_SEC, 0.001, &continuationPoint);
+        UA_HistoryData *data = processedData(&response);
+        ck_assert_uint_gt(data->dataValuesSize, 0);
+        ck_assert_uint_le(data->dataValuesSize, 10000);
+        ck_assert_uint_gt(response.results[0].continuationPoint.length, 0);
+        UA_ByteString_clear(&continuationPoint);
+        UA_ByteString_copy(&response.results[0].continuationPoint, &continuationPoint);
+        UA_HistoryReadResponse_clear(&response);
+    }
+    UA_ByteString_clear(&continuationPoint);
+
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+/* The intervals span the batches in which the samples are read */
+START_TEST(Server_HistorizingReadProcessedBatches)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Columnar(1, 100);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    const UA_DateTime t0 = 1000 * UA_DATETIME_SEC;
+    for(UA_UInt32 i = 0; i < 3000; i++)
+        setProcessedSample(&backend, t0 + i * UA_DATETIME_SEC, i, UA_STATUSCODE_GOOD);
+
+    UA_Double average[30], timeAverage[30], minimum[30], count[30];
+    UA_StatusCode codes[30], timeAverageStatus[30];
+    for(size_t i = 0; i < 30; i++) {
+        average[i] = (UA_Double)i * 100 + 49.5;
+        timeAverage[i] = (UA_Double)i * 100 + 50;
+        minimum[i] = (UA_Double)i * 100;
+        count[i] = 100;
+        codes[i] = PROCESSED_CALCULATED;
+        timeAverageStatus[i] = PROCESSED_CALCULATED;
+    }
+    /* The last bound is extrapolated */
+    timeAverage[29] = 2949.5 + 0.5 * 0.01 * 99;
+    timeAverageStatus[29] = UA_STATUSCODE_UNCERTAINDATASUBNORMAL | PROCESSED_CALCULATED;
+
+    const UA_DateTime end = t0 + 3000 * UA_DATETIME_SEC;
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, t0, end, 100000, 30, average, codes);
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_MINIMUM, t0, end, 100000, 30, minimum, codes);
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_COUNT, t0, end, 100000, 30, count, codes);
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE, t0, end, 100000, 30,
+                   timeAverage, timeAverageStatus);
+
+    /* One interval over all samples */
+    const UA_Double all = 1499.5;
+    const UA_StatusCode allStatus = PROCESSED_CALCULATED;
+    checkProcessed(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, t0, end, 0, 1, &all, &allStatus);
+
+    UA_HistoryDataBackend_Columnar_clear(&backend);
+}
+END_TEST
+
 #endif /*UA_ENABLE_HISTORIZING*/
 
 static Suite* testSuite_Client(void)
@@ -1030,7 +2057,21 @@ static Suite* testSuite_Client(void)
     tcase_add_test(tc_server, Server_HistorizingStrategyUser);
     tcase_add_test(tc_server, Server_HistorizingStrategyValueSet);
     tcase_add_test(tc_server, Server_HistorizingBackendMemory);
+    tcase_add_test(tc_server, Server_HistorizingBackendColumnar);
+    tcase_add_test(tc_server, Server_HistorizingBackendColumnarUpdate);
+    tcase_add_test(tc_server, Server_HistorizingBackendColumnarRoundtrip);
+#ifdef UA_ARCHITECTURE_POSIX
+    tcase_add_test(tc_server, Server_HistorizingBackendFile);
+    tcase_add_test(tc_server, Server_HistorizingBackendFileUpdate);
+    tcase_add_test(tc_server, Server_HistorizingBackendFileRecovery);
+#endif
     tcase_add_test(tc_server, Server_HistorizingRandomIndexBackend);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessed);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessedBatches);
+    tcase_add_test(tc_server, Server_HistorizingIngestionQueue);
+    tcase_add_test(tc_server, Server_HistorizingContinuationPointInsert);
+    tcase_add_test(tc_server, Server_HistorizingReadStreamed);
+    tcase_add_test(tc_server, Server_HistorizingBenchmarkNodeIdIndex);
     tcase_add_test(tc_server, Server_HistorizingUpdateDelete);
     tcase_add_test(tc_server, Server_HistorizingUpdateInsert);
     tcase_add_test(tc_server, Server_HistorizingUpdateReplace);
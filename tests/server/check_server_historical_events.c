@@ -0,0 +1,418 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_gathering_default.h>
+#include <open62541/plugin/historydata/history_database_default.h>
+#include <open62541/plugin/historydata/history_event_backend_memory.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include "server/ua_server_internal.h"
+
+#include <check.h>
+
+#if defined(UA_ENABLE_HISTORIZING) && defined(UA_ENABLE_SUBSCRIPTIONS_EVENTS)
+
+#define EVENTCOUNT 100
+#define EVENTSTART (UA_DateTime)(1600000000LL * UA_DATETIME_SEC)
+
+static UA_Server *server;
+static UA_NodeId baseType;  /* Subtype of BaseEventType */
+static UA_NodeId childType; /* Subtype of baseType */
+static UA_NodeId emitterId;
+
+static const char *selectNames[] = {"Time", "EventType", "Severity", "Message"};
+#define SELECTCOUNT 4
+
+void
+Service_HistoryRead(UA_Server *server, UA_Session *session,
+                    const UA_HistoryReadRequest *request,
+                    UA_HistoryReadResponse *response);
+
+static void
+setSelectClause(UA_SimpleAttributeOperand *sao, const char *name) {
+    UA_SimpleAttributeOperand_init(sao);
+    sao->typeDefinitionId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+    sao->attributeId = UA_ATTRIBUTEID_VALUE;
+    sao->browsePathSize = 1;
+    sao->browsePath = UA_QualifiedName_new();
+    *sao->browsePath = UA_QUALIFIEDNAME_ALLOC(0, name);
+}
+
+static void
+addEventType(const char *name, const UA_NodeId parent, UA_NodeId *outId) {
+    UA_ObjectTypeAttributes attr = UA_ObjectTypeAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", (char*)(uintptr_t)name);
+    UA_StatusCode res =
+        UA_Server_addObjectTypeNode(server, UA_NODEID_NULL, parent,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                    UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                    attr, NULL, outId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+addEmitter(const char *name, UA_Byte eventNotifier, UA_NodeId *outId) {
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    oattr.displayName = UA_LOCALIZEDTEXT("en-US", (char*)(uintptr_t)name);
+    oattr.eventNotifier = eventNotifier;
+    UA_StatusCode res =
+        UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                oattr, NULL, outId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The HistoricalEventFilter selects the fields that are stored */
+    UA_EventFilter filter;
+    UA_EventFilter_init(&filter);
+    filter.selectClauses = (UA_SimpleAttributeOperand*)
+        UA_Array_new(SELECTCOUNT, &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    filter.selectClausesSize = SELECTCOUNT;
+    for(size_t i = 0; i < SELECTCOUNT; i++)
+        setSelectClause(&filter.selectClauses[i], selectNames[i]);
+
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    vattr.displayName = UA_LOCALIZEDTEXT("en-US", "HistoricalEventFilter");
+    UA_Variant_setScalar(&vattr.value, &filter, &UA_TYPES[UA_TYPES_EVENTFILTER]);
+    res = UA_Server_addVariableNode(server, UA_NODEID_NULL, *outId,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASPROPERTY),
+                                    UA_QUALIFIEDNAME(0, "HistoricalEventFilter"),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_PROPERTYTYPE),
+                                    vattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_EventFilter_clear(&filter);
+}
+
+/* Event i has the time EVENTSTART + i seconds and the severity i. Even events
+ * are of the baseType, odd events of the childType. */
+static void
+triggerEvent_i(size_t i) {
+    UA_NodeId eventId;
+    UA_StatusCode res =
+        UA_Server_createEvent(server, (i % 2 == 0) ? baseType : childType, &eventId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DateTime time = EVENTSTART + (UA_DateTime)i * UA_DATETIME_SEC;
+    UA_Server_writeObjectProperty_scalar(server, eventId, UA_QUALIFIEDNAME(0, "Time"),
+                                         &time, &UA_TYPES[UA_TYPES_DATETIME]);
+    UA_UInt16 severity = (UA_UInt16)i;
+    UA_Server_writeObjectProperty_scalar(server, eventId, UA_QUALIFIEDNAME(0, "Severity"),
+                                         &severity, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_LocalizedText message = UA_LOCALIZEDTEXT("en-US", "Historical event");
+    UA_Server_writeObjectProperty_scalar(server, eventId, UA_QUALIFIEDNAME(0, "Message"),
+                                         &message, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+
+    res = UA_Server_triggerEvent(server, eventId, emitterId, NULL, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+setupServer(size_t maxEventsPerNode) {
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+    config->historyDatabase =
+        UA_HistoryDatabase_defaultWithEvents(UA_HistoryDataGathering_Default(1),
+                                             UA_HistoryEventBackend_Memory(1, maxEventsPerNode));
+    addEventType("HistoryBaseEventType",
+                 UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE), &baseType);
+    addEventType("HistoryChildEventType", baseType, &childType);
+    addEmitter("Emitter", UA_EVENTNOTIFIER_SUBSCRIBE_TO_EVENT | UA_EVENTNOTIFIER_HISTORY_READ,
+               &emitterId);
+}
+
+static void setup(void) {
+    setupServer(0);
+    for(size_t i = 0; i < EVENTCOUNT; i++)
+        triggerEvent_i(i);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+/* Reads Severity, EventType and the unstored SourceName */
+static UA_StatusCode
+readEvents(const UA_NodeId *nodeId, UA_DateTime start, UA_DateTime end,
+           UA_UInt32 numValuesPerNode, const UA_ContentFilter *where,
+           const UA_ByteString *continuationPoint, UA_HistoryEvent *out,
+           UA_ByteString *outContinuationPoint) {
+    UA_ReadEventDetails *details = UA_ReadEventDetails_new();
+    details->startTime = start;
+    details->endTime = end;
+    details->numValuesPerNode = numValuesPerNode;
+    details->filter.selectClauses = (UA_SimpleAttributeOperand*)
+        UA_Array_new(3, &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    details->filter.selectClausesSize = 3;
+    setSelectClause(&details->filter.selectClauses[0], "Severity");
+    setSelectClause(&details->filter.selectClauses[1], "EventType");
+    setSelectClause(&details->filter.selectClauses[2], "SourceName");
+    if(where)
+        UA_ContentFilter_copy(where, &details->filter.whereClause);
+
+    UA_HistoryReadValueId *valueId = UA_HistoryReadValueId_new();
+    UA_NodeId_copy(nodeId, &valueId->nodeId);
+    if(continuationPoint)
+        UA_ByteString_copy(continuationPoint, &valueId->continuationPoint);
+
+    UA_HistoryReadRequest request;
+    UA_HistoryReadRequest_init(&request);
+    request.historyReadDetails.encoding = UA_EXTENSIONOBJECT_DECODED;
+    request.historyReadDetails.content.decoded.type = &UA_TYPES[UA_TYPES_READEVENTDETAILS];
+    request.historyReadDetails.content.decoded.data = details;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    request.nodesToReadSize = 1;
+    request.nodesToRead = valueId;
+
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_HistoryRead(server, &server->adminSession, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_HistoryReadRequest_clear(&request);
+
+    UA_StatusCode res = response.responseHeader.serviceResult;
+    if(res == UA_STATUSCODE_GOOD) {
+        ck_assert_uint_eq(response.resultsSize, 1);
+        res = response.results[0].statusCode;
+    }
+    if(res == UA_STATUSCODE_GOOD) {
+        UA_ExtensionObject *data = &response.results[0].historyData;
+        ck_assert_uint_eq(data->encoding, UA_EXTENSIONOBJECT_DECODED);
+        ck_assert(data->content.decoded.type == &UA_TYPES[UA_TYPES_HISTORYEVENT]);
+        *out = *(UA_HistoryEvent*)data->content.decoded.data;
+        UA_HistoryEvent_init((UA_HistoryEvent*)data->content.decoded.data);
+        if(outContinuationPoint) {
+            *outContinuationPoint = response.results[0].continuationPoint;
+            UA_ByteString_init(&response.results[0].continuationPoint);
+        }
+    }
+    UA_HistoryReadResponse_clear(&response);
+    return res;
+}
+
+static UA_UInt16
+severityOf(const UA_HistoryEvent *he, size_t i) {
+    ck_assert_uint_eq(he->events[i].eventFieldsSize, 3);
+    const UA_Variant *v = &he->events[i].eventFields[0];
+    ck_assert(UA_Variant_hasScalarType(v, &UA_TYPES[UA_TYPES_UINT16]));
+    return *(UA_UInt16*)v->data;
+}
+
+START_TEST(Server_HistoricalEventsReadRange) {
+    UA_HistoryEvent he;
+    UA_HistoryEvent_init(&he);
+    UA_StatusCode res =
+        readEvents(&emitterId, EVENTSTART + 10 * UA_DATETIME_SEC,
+                   EVENTSTART + 20 * UA_DATETIME_SEC, 0, NULL, NULL, &he, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(he.eventsSize, 10);
+    for(size_t i = 0; i < he.eventsSize; i++) {
+        ck_assert_uint_eq(severityOf(&he, i), 10 + i);
+        const UA_Variant *type = &he.events[i].eventFields[1];
+        ck_assert(UA_Variant_hasScalarType(type, &UA_TYPES[UA_TYPES_NODEID]));
+        ck_assert(UA_NodeId_equal((UA_NodeId*)type->data,
+                                  (i % 2 == 0) ? &baseType : &childType));
+        /* The SourceName is not selected in the HistoricalEventFilter */
+        ck_assert(UA_Variant_isEmpty(&he.events[i].eventFields[2]));
+    }
+    UA_HistoryEvent_clear(&he);
+} END_TEST
+
+START_TEST(Server_HistoricalEventsReadReverse) {
+    UA_HistoryEvent he;
+    UA_HistoryEvent_init(&he);
+    UA_StatusCode res =
+        readEvents(&emitterId, EVENTSTART + 20 * UA_DATETIME_SEC,
+                   EVENTSTART + 10 * UA_DATETIME_SEC, 0, NULL, NULL, &he, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(he.eventsSize, 10);
+    for(size_t i = 0; i < he.eventsSize; i++)
+        ck_assert_uint_eq(severityOf(&he, i), 20 - i);
+    UA_HistoryEvent_clear(&he);
+
+    /* The latest three events */
+    res = readEvents(&emitterId, 0, EVENTSTART + EVENTCOUNT * UA_DATETIME_SEC,
+                     3, NULL, NULL, &he, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(he.eventsSize, 3);
+    ck_assert_uint_eq(severityOf(&he, 0), EVENTCOUNT - 1);
+    ck_assert_uint_eq(severityOf(&he, 2), EVENTCOUNT - 3);
+    UA_HistoryEvent_clear(&he);
+} END_TEST
+
+START_TEST(Server_HistoricalEventsWhereClause) {
+    /* OfType(childType) AND Severity >= 50 */
+    UA_ContentFilter where;
+    UA_ContentFilter_init(&where);
+    where.elements = (UA_ContentFilterElement*)
+        UA_Array_new(3, &UA_TYPES[UA_TYPES_CONTENTFILTERELEMENT]);
+    where.elementsSize = 3;
+
+    UA_ElementOperand andOperands[2];
+    andOperands[0].index = 1;
+    andOperands[1].index = 2;
+    where.elements[0].filterOperator = UA_FILTEROPERATOR_AND;
+    where.elements[0].filterOperands = (UA_ExtensionObject*)
+        UA_Array_new(2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    where.elements[0].filterOperandsSize = 2;
+    for(size_t i = 0; i < 2; i++)
+        UA_ExtensionObject_setValueCopy(&where.elements[0].filterOperands[i],
+                                        &andOperands[i], &UA_TYPES[UA_TYPES_ELEMENTOPERAND]);
+
+    UA_LiteralOperand typeOperand;
+    UA_Variant_setScalar(&typeOperand.value, &childType, &UA_TYPES[UA_TYPES_NODEID]);
+    where.elements[1].filterOperator = UA_FILTEROPERATOR_OFTYPE;
+    where.elements[1].filterOperands = UA_ExtensionObject_new();
+    where.elements[1].filterOperandsSize = 1;
+    UA_ExtensionObject_setValueCopy(where.elements[1].filterOperands, &typeOperand,
+                                    &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+
+    UA_SimpleAttributeOperand severityOperand;
+    setSelectClause(&severityOperand, "Severity");
+    UA_UInt16 minSeverity = 50;
+    UA_LiteralOperand severityLiteral;
+    UA_Variant_setScalar(&severityLiteral.value, &minSeverity, &UA_TYPES[UA_TYPES_UINT16]);
+    where.elements[2].filterOperator = UA_FILTEROPERATOR_GREATERTHANOREQUAL;
+    where.elements[2].filterOperands = (UA_ExtensionObject*)
+        UA_Array_new(2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    where.elements[2].filterOperandsSize = 2;
+    UA_ExtensionObject_setValueCopy(&where.elements[2].filterOperands[0],
+                                    &severityOperand,
+                                    &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    UA_ExtensionObject_setValueCopy(&where.elements[2].filterOperands[1],
+                                    &severityLiteral, &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+    UA_SimpleAttributeOperand_clear(&severityOperand);
+
+    UA_HistoryEvent he;
+    UA_HistoryEvent_init(&he);
+    UA_StatusCode res =
+        readEvents(&emitterId, EVENTSTART, EVENTSTART + EVENTCOUNT * UA_DATETIME_SEC,
+                   0, &where, NULL, &he, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(he.eventsSize, (EVENTCOUNT - 50) / 2);
+    for(size_t i = 0; i < he.eventsSize; i++)
+        ck_assert_uint_eq(severityOf(&he, i), 51 + 2 * i);
+    UA_HistoryEvent_clear(&he);
+
+    /* All events are of a subtype of the baseType */
+    UA_ExtensionObject_clear(where.elements[1].filterOperands);
+    UA_Variant_setScalar(&typeOperand.value, &baseType, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_ExtensionObject_setValueCopy(where.elements[1].filterOperands, &typeOperand,
+                                    &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+    res = readEvents(&emitterId, EVENTSTART, EVENTSTART + EVENTCOUNT * UA_DATETIME_SEC,
+                     0, &where, NULL, &he, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(he.eventsSize, EVENTCOUNT - 50);
+    UA_HistoryEvent_clear(&he);
+    UA_ContentFilter_clear(&where);
+
+    /* Only OfType(childType) */
+    where.elements = UA_ContentFilterElement_new();
+    where.elementsSize = 1;
+    where.elements[0].filterOperator = UA_FILTEROPERATOR_OFTYPE;
+    where.elements[0].filterOperands = UA_ExtensionObject_new();
+    where.elements[0].filterOperandsSize = 1;
+    UA_Variant_setScalar(&typeOperand.value, &childType, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_ExtensionObject_setValueCopy(where.elements[0].filterOperands, &typeOperand,
+                                    &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+    res = readEvents(&emitterId, EVENTSTART, EVENTSTART + EVENTCOUNT * UA_DATETIME_SEC,
+                     0, &where, NULL, &he, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(he.eventsSize, EVENTCOUNT / 2);
+    for(size_t i = 0; i < he.eventsSize; i++)
+        ck_assert_uint_eq(severityOf(&he, i), 1 + 2 * i);
+    UA_HistoryEvent_clear(&he);
+    UA_ContentFilter_clear(&where);
+} END_TEST
+
+START_TEST(Server_HistoricalEventsContinuationPoint) {
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    size_t received = 0;
+    size_t calls = 0;
+    do {
+        UA_HistoryEvent he;
+        UA_HistoryEvent_init(&he);
+        UA_ByteString next = UA_BYTESTRING_NULL;
+        UA_StatusCode res =
+            readEvents(&emitterId, EVENTSTART, EVENTSTART + EVENTCOUNT * UA_DATETIME_SEC,
+                       7, NULL, &cp, &he, &next);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_le(he.eventsSize, 7);
+        for(size_t i = 0; i < he.eventsSize; i++)
+            ck_assert_uint_eq(severityOf(&he, i), received + i);
+        received += he.eventsSize;
+        calls++;
+        UA_HistoryEvent_clear(&he);
+        UA_ByteString_clear(&cp);
+        cp = next;
+    } while(cp.length > 0);
+    ck_assert_uint_eq(received, EVENTCOUNT);
+    ck_assert_uint_eq(calls, (EVENTCOUNT + 6) / 7);
+} END_TEST
+
+START_TEST(Server_HistoricalEventsAccessDenied) {
+    UA_NodeId otherId;
+    addEmitter("NoHistoryEmitter", UA_EVENTNOTIFIER_SUBSCRIBE_TO_EVENT, &otherId);
+    UA_HistoryEvent he;
+    UA_HistoryEvent_init(&he);
+    UA_StatusCode res =
+        readEvents(&otherId, EVENTSTART, EVENTSTART + EVENTCOUNT * UA_DATETIME_SEC,
+                   0, NULL, NULL, &he, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADUSERACCESSDENIED);
+} END_TEST
+
+START_TEST(Server_HistoricalEventsMaxEventsPerNode) {
+    setupServer(10);
+    for(size_t i = 0; i < EVENTCOUNT; i++)
+        triggerEvent_i(i);
+    UA_HistoryEvent he;
+    UA_HistoryEvent_init(&he);
+    UA_StatusCode res =
+        readEvents(&emitterId, EVENTSTART, EVENTSTART + EVENTCOUNT * UA_DATETIME_SEC,
+                   0, NULL, NULL, &he, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(he.eventsSize, 10);
+    for(size_t i = 0; i < he.eventsSize; i++)
+        ck_assert_uint_eq(severityOf(&he, i), EVENTCOUNT - 10 + i);
+    UA_HistoryEvent_clear(&he);
+    UA_Server_delete(server);
+} END_TEST
+
+#endif /* UA_ENABLE_HISTORIZING && UA_ENABLE_SUBSCRIPTIONS_EVENTS */
+
+static Suite *testSuite_HistoricalEvents(void) {
+    Suite *s = suite_create("Server Historical Events");
+    TCase *tc_server = tcase_create("Server Historical Events");
+#if defined(UA_ENABLE_HISTORIZING) && defined(UA_ENABLE_SUBSCRIPTIONS_EVENTS)
+    tcase_add_checked_fixture(tc_server, setup, teardown);
+    tcase_add_test(tc_server, Server_HistoricalEventsReadRange);
+    tcase_add_test(tc_server, Server_HistoricalEventsReadReverse);
+    tcase_add_test(tc_server, Server_HistoricalEventsWhereClause);
+    tcase_add_test(tc_server, Server_HistoricalEventsContinuationPoint);
+    tcase_add_test(tc_server, Server_HistoricalEventsAccessDenied);
+#endif
+    suite_add_tcase(s, tc_server);
+
+    TCase *tc_limit = tcase_create("Server Historical Events Limit");
+#if defined(UA_ENABLE_HISTORIZING) && defined(UA_ENABLE_SUBSCRIPTIONS_EVENTS)
+    tcase_add_test(tc_limit, Server_HistoricalEventsMaxEventsPerNode);
+#endif
+    suite_add_tcase(s, tc_limit);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_HistoricalEvents();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -977,6 +977,87 @@ START_TEST(WriteSingleDataSourceAttributeValue) {
     ck_assert_int_eq(retval, UA_STATUSCODE_BADWRITENOTSUPPORTED);
 } END_TEST
 
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+static void
+writeAnswer(UA_Int32 v) {
+    UA_WriteValue wValue;
+    UA_WriteValue_init(&wValue);
+    UA_Variant_setScalar(&wValue.value.value, &v, &UA_TYPES[UA_TYPES_INT32]);
+    wValue.value.hasValue = true;
+    wValue.nodeId = UA_NODEID_STRING(1, "the.answer");
+    wValue.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_StatusCode retval = UA_Server_write(server, &wValue);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static UA_Int32
+readAnswer(void) {
+    UA_Variant value;
+    UA_StatusCode retval =
+        UA_Server_readValue(server, UA_NODEID_STRING(1, "the.answer"), &value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Int32 res = *(UA_Int32*)value.data;
+    UA_Variant_clear(&value);
+    return res;
+}
+
+static const UA_Node *
+getAnswerNode(void) {
+    UA_NodeId id = UA_NODEID_STRING(1, "the.answer");
+    UA_LOCK(&server->serviceMutex);
+    const UA_Node *node = UA_NODESTORE_GET(server, &id);
+    UA_NODESTORE_RELEASE(server, node);
+    UA_UNLOCK(&server->serviceMutex);
+    return node;
+}
+
+/* After the first write, the value is published in the value cell of the node.
+ * Further writes do not replace the node in the nodestore. */
+START_TEST(WriteSingleAttributeValueCell) {
+    writeAnswer(1);
+    ck_assert_int_eq(readAnswer(), 1);
+    const UA_Node *node = getAnswerNode();
+
+    writeAnswer(2);
+    ck_assert_int_eq(readAnswer(), 2);
+    ck_assert_ptr_eq(getAnswerNode(), node);
+
+    /* Replacing the node for another attribute keeps the value */
+    UA_LocalizedText name = UA_LOCALIZEDTEXT("en-US", "answer");
+    UA_StatusCode retval =
+        UA_Server_writeDisplayName(server, UA_NODEID_STRING(1, "the.answer"), name);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(readAnswer(), 2);
+
+    writeAnswer(3);
+    ck_assert_int_eq(readAnswer(), 3);
+
+    /* Index ranges are written into a copy of the current value */
+    UA_Int32 myInteger = 20;
+    UA_WriteValue wValue;
+    UA_WriteValue_init(&wValue);
+    UA_Variant_setScalar(&wValue.value.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    wValue.value.hasValue = true;
+    wValue.nodeId = UA_NODEID_STRING(1, "myarray");
+    wValue.indexRange = UA_STRING("0,0");
+    wValue.attributeId = UA_ATTRIBUTEID_VALUE;
+    retval = UA_Server_write(server, &wValue);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    myInteger = 21;
+    wValue.indexRange = UA_STRING("1,1");
+    retval = UA_Server_write(server, &wValue);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Variant value;
+    retval = UA_Server_readValue(server, UA_NODEID_STRING(1, "myarray"), &value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(value.arrayLength, 9);
+    ck_assert_int_eq(((UA_Int32*)value.data)[0], 20);
+    ck_assert_int_eq(((UA_Int32*)value.data)[4], 21);
+    UA_Variant_clear(&value);
+} END_TEST
+#endif
+
 static Suite * testSuite_services_attributes(void) {
     Suite *s = suite_create("services_attributes_read");
 
@@ -1040,6 +1121,9 @@ static Suite * testSuite_services_attributes(void) {
     tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeHistorizing);
     tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeExecutable);
     tcase_add_test(tc_writeSingleAttributes, WriteSingleDataSourceAttributeValue);
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+    tcase_add_test(tc_writeSingleAttributes, WriteSingleAttributeValueCell);
+#endif
 
     suite_add_tcase(s, tc_writeSingleAttributes);
 
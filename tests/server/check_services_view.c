@@ -303,6 +303,101 @@ START_TEST(Service_Browse_Recursive) {
 }
 END_TEST
 
+static UA_Boolean
+isSubtype(UA_Server *server, UA_NodeId subtype, UA_NodeId supertype) {
+    return isNodeInTree_singleRef(server, &subtype, &supertype,
+                                  UA_REFERENCETYPEINDEX_HASSUBTYPE);
+}
+
+static UA_Boolean
+isCached(UA_Server *server, UA_NodeId typeId) {
+    const UA_TypeHierarchy *th = &server->typeHierarchy;
+    for(size_t i = 0; i < th->bucketsSize; i++) {
+        for(UA_TypeHierarchyEntry *e = th->buckets[i]; e; e = e->next) {
+            if(UA_NodeId_equal(&e->typeId, &typeId))
+                return true;
+        }
+    }
+    return false;
+}
+
+/* The cached supertypes follow changes of the type hierarchy */
+START_TEST(Service_Browse_TypeHierarchy) {
+    UA_Server *server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+
+    UA_NodeId baseObjectType = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+    UA_NodeId folderType = UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE);
+    UA_NodeId hasSubtype = UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE);
+    UA_NodeId typeA = UA_NODEID_STRING(1, "TypeA");
+    UA_NodeId typeB = UA_NODEID_STRING(1, "TypeB");
+    UA_NodeId typeC = UA_NODEID_STRING(1, "TypeC");
+
+    UA_ObjectTypeAttributes attr = UA_ObjectTypeAttributes_default;
+    UA_StatusCode res =
+        UA_Server_addObjectTypeNode(server, typeA, baseObjectType, hasSubtype,
+                                    UA_QUALIFIEDNAME(1, "TypeA"), attr, NULL, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_addObjectTypeNode(server, typeB, typeA, hasSubtype,
+                                      UA_QUALIFIEDNAME(1, "TypeB"), attr, NULL, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    ck_assert(isSubtype(server, typeB, typeB));
+    ck_assert(isSubtype(server, typeB, typeA));
+    ck_assert(isSubtype(server, typeB, baseObjectType));
+    ck_assert(!isSubtype(server, typeA, typeB));
+    ck_assert(!isSubtype(server, typeB, folderType));
+    ck_assert_uint_gt(server->typeHierarchy.entriesSize, 0);
+
+    /* Instances are not cached */
+    UA_NodeId objects = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    ck_assert(isSubtype(server, objects, objects));
+    ck_assert(!isSubtype(server, objects, folderType));
+
+    /* Move TypeB below the FolderType */
+    res = UA_Server_deleteReference(server, typeA, hasSubtype, true,
+                                    UA_EXPANDEDNODEID_STRING(1, "TypeB"), true);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_addReference(server, folderType, hasSubtype,
+                                 UA_EXPANDEDNODEID_STRING(1, "TypeB"), true);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(!isSubtype(server, typeB, typeA));
+    ck_assert(isSubtype(server, typeB, folderType));
+    ck_assert(isSubtype(server, typeB, baseObjectType));
+
+    /* Re-create TypeC with another supertype */
+    res = UA_Server_addObjectTypeNode(server, typeC, typeA, hasSubtype,
+                                      UA_QUALIFIEDNAME(1, "TypeC"), attr, NULL, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(isSubtype(server, typeC, typeA));
+    res = UA_Server_deleteNode(server, typeC, true);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(!isSubtype(server, typeC, typeA));
+
+    /* Adding the new leaf type TypeC keeps the other entries */
+    ck_assert(isCached(server, typeB));
+    res = UA_Server_addObjectTypeNode(server, typeC, typeB, hasSubtype,
+                                      UA_QUALIFIEDNAME(1, "TypeC"), attr, NULL, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(isCached(server, typeB));
+    ck_assert(!isSubtype(server, typeC, typeA));
+    ck_assert(isSubtype(server, typeC, typeB));
+    ck_assert(isSubtype(server, typeC, folderType));
+
+    /* Moving TypeB with its subtype TypeC drops the cached entry of TypeC */
+    res = UA_Server_deleteReference(server, folderType, hasSubtype, true,
+                                    UA_EXPANDEDNODEID_STRING(1, "TypeB"), true);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_addReference(server, typeA, hasSubtype,
+                                 UA_EXPANDEDNODEID_STRING(1, "TypeB"), true);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(isSubtype(server, typeC, typeA));
+    ck_assert(!isSubtype(server, typeC, folderType));
+
+    UA_Server_delete(server);
+}
+END_TEST
+
 START_TEST(Service_TranslateBrowsePathsToNodeIds) {
     UA_Client *client = UA_Client_new();
     UA_ClientConfig_setDefault(UA_Client_getConfig(client));
@@ -440,6 +535,7 @@ static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     tcase_add_test(tc_browse, Service_Browse_ReferenceTypes);
     tcase_add_test(tc_browse, Service_Browse_WithMaxResults);
     tcase_add_test(tc_browse, Service_Browse_Recursive);
+    tcase_add_test(tc_browse, Service_Browse_TypeHierarchy);
     suite_add_tcase(s, tc_browse);
 
     TCase *tc_translate = tcase_create("TranslateBrowsePathsToNodeIds");